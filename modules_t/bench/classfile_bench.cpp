@@ -0,0 +1,488 @@
+// 类文件解析基准测试
+// 测量ClassReader原语解码、MUTF-8解码、常量池读取和完整解析的速度，结果输出为JSON，
+// 方便在不同版本之间diff。语料 = 命令行给出的jar/目录/.class + 内置生成的大类。
+//
+// 用法：classfile_bench [--min-time 秒] [--repeat 次数] [--out 文件] [语料路径...]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "../util.hpp"
+#include "../classfile/class_reader.hpp"
+#include "../classfile/constant_pool.h"
+#include "../classfile/class_file.hpp"
+#include "../classpath/entry.hpp"
+
+// 统计堆分配次数：基准只关心次数，不关心大小
+// 替换后的new/delete都基于malloc/free，GCC看不出两者配对，关掉这条误报
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct ClassBlob {
+    std::string name;
+    std::vector<uint8_t> data;
+};
+
+struct Options {
+    double min_time = 0.2;      // 每个样本至少运行的时间（秒）
+    int repeat = 5;             // 样本数，报告中位数
+    std::string out;            // 为空时输出到stdout
+    std::vector<std::string> inputs;
+};
+
+// 一次完整遍历处理的工作量
+struct Work {
+    uint64_t bytes = 0;
+    uint64_t items = 0;         // 类数或字符串数或读取次数
+};
+
+struct Result {
+    std::string name;
+    std::string unit;           // items的含义
+    uint64_t passes = 0;
+    double ns_per_pass = 0;
+    Work work;
+    double allocations_per_item = 0;
+};
+
+// ---------------------------------------------------------------- 语料
+
+bool ends_with(const std::string& s, const char* suffix) {
+    size_t n = strlen(suffix);
+    return s.size() > n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+bool read_file(const std::string& path, std::vector<uint8_t>& data) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    data.clear();
+    uint8_t buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        data.insert(data.end(), buf, buf + n);
+    }
+    fclose(f);
+    return true;
+}
+
+void add_directory(const std::string& dir_path, std::vector<ClassBlob>& corpus) {
+    DIR* dir = opendir(dir_path.c_str());
+    if (!dir) return;
+    std::vector<std::string> names;
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name != "." && name != "..") names.push_back(name);
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+
+    for (const std::string& name : names) {
+        std::string path = dir_path + "/" + name;
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) continue;
+        if (S_ISDIR(st.st_mode)) {
+            add_directory(path, corpus);
+        } else if (ends_with(name, ".class")) {
+            ClassBlob blob{path, {}};
+            if (read_file(path, blob.data)) corpus.push_back(std::move(blob));
+        }
+    }
+}
+
+bool add_input(const std::string& input, std::vector<ClassBlob>& corpus) {
+    if (ends_with(input, ".jar") || ends_with(input, ".zip")) {
+        jvm::classpath::ZipArchive archive(input);
+        if (!archive.is_open()) return false;
+        std::string data;
+        for (uint64_t i = 0; i < archive.entry_count(); ++i) {
+            std::string name = archive.entry_name(i);
+            if (ends_with(name, ".class") && archive.read(i, data)) {
+                corpus.push_back(ClassBlob{name, std::vector<uint8_t>(data.begin(), data.end())});
+            }
+        }
+        return true;
+    }
+    struct stat st;
+    if (stat(input.c_str(), &st) != 0) return false;
+    if (S_ISDIR(st.st_mode)) {
+        add_directory(input, corpus);
+        return true;
+    }
+    ClassBlob blob{input, {}};
+    if (!read_file(input, blob.data)) return false;
+    corpus.push_back(std::move(blob));
+    return true;
+}
+
+// 生成确定性的大类：大量常量（含非ASCII和内嵌NUL的MUTF-8串）、字段和带Code的方法
+class ClassGenerator {
+public:
+    std::vector<uint8_t> generate(const std::string& class_name, int constants, int fields, int methods) {
+        _pool.clear();
+        _count = 1;
+
+        uint16_t this_class = class_ref(class_name);
+        uint16_t super_class = class_ref("java/lang/Object");
+        uint16_t code_name = utf8("Code");
+        uint16_t source_name = utf8("SourceFile");
+        uint16_t source_file = utf8(class_name + ".java");
+        uint16_t field_desc = utf8("I");
+        uint16_t method_desc = utf8("(ILjava/lang/String;J)I");
+
+        std::vector<uint16_t> field_names, method_names;
+        for (int i = 0; i < fields; i++) field_names.push_back(utf8("field" + std::to_string(i)));
+        for (int i = 0; i < methods; i++) method_names.push_back(utf8("method" + std::to_string(i)));
+
+        for (int i = 0; i < constants; i++) {
+            switch (i % 6) {
+                case 0: utf8("ascii_constant_" + std::to_string(i)); break;
+                // "名字" + NUL，MUTF-8里NUL是C0 80
+                case 1: utf8("\xE5\x90\x8D\xE5\xAD\x97_" + std::to_string(i) + std::string("\xC0\x80", 2)); break;
+                case 2: string_ref("string constant number " + std::to_string(i)); break;
+                case 3: integer(i * 7919); break;
+                case 4: long_value(static_cast<uint64_t>(i) << 33); break;
+                case 5: method_ref(this_class, method_names.empty() ? utf8("m") : method_names[i % method_names.size()], method_desc); break;
+            }
+        }
+
+        std::vector<uint8_t> out;
+        u4(out, 0xCAFEBABE);
+        u2(out, 0);
+        u2(out, 52);
+        u2(out, _count);
+        out.insert(out.end(), _pool.begin(), _pool.end());
+        u2(out, 0x0021);
+        u2(out, this_class);
+        u2(out, super_class);
+        u2(out, 0);                                     // interfaces
+
+        u2(out, static_cast<uint16_t>(fields));
+        for (uint16_t name : field_names) {
+            u2(out, 0x0002); u2(out, name); u2(out, field_desc); u2(out, 0);
+        }
+
+        u2(out, static_cast<uint16_t>(methods));
+        for (size_t i = 0; i < method_names.size(); i++) {
+            u2(out, 0x0001); u2(out, method_names[i]); u2(out, method_desc); u2(out, 1);
+            // Code: bipush i; ireturn
+            u2(out, code_name); u4(out, 2 + 2 + 4 + 3 + 2 + 2);
+            u2(out, 1); u2(out, 5);
+            u4(out, 3);
+            out.push_back(0x10); out.push_back(static_cast<uint8_t>(i & 0x7F)); out.push_back(0xAC);
+            u2(out, 0); u2(out, 0);
+        }
+
+        u2(out, 1);
+        u2(out, source_name); u4(out, 2); u2(out, source_file);
+        return out;
+    }
+
+private:
+    static void u2(std::vector<uint8_t>& out, uint16_t v) {
+        out.push_back(static_cast<uint8_t>(v >> 8));
+        out.push_back(static_cast<uint8_t>(v));
+    }
+    static void u4(std::vector<uint8_t>& out, uint32_t v) {
+        u2(out, static_cast<uint16_t>(v >> 16));
+        u2(out, static_cast<uint16_t>(v));
+    }
+
+    uint16_t utf8(const std::string& s) {
+        _pool.push_back(1);
+        u2(_pool, static_cast<uint16_t>(s.size()));
+        _pool.insert(_pool.end(), s.begin(), s.end());
+        return _count++;
+    }
+    uint16_t class_ref(const std::string& name) {
+        uint16_t name_index = utf8(name);
+        _pool.push_back(7);
+        u2(_pool, name_index);
+        return _count++;
+    }
+    uint16_t string_ref(const std::string& s) {
+        uint16_t index = utf8(s);
+        _pool.push_back(8);
+        u2(_pool, index);
+        return _count++;
+    }
+    uint16_t integer(uint32_t v) {
+        _pool.push_back(3);
+        u4(_pool, v);
+        return _count++;
+    }
+    uint16_t long_value(uint64_t v) {
+        _pool.push_back(5);
+        u4(_pool, static_cast<uint32_t>(v >> 32));
+        u4(_pool, static_cast<uint32_t>(v));
+        uint16_t index = _count;
+        _count += 2;
+        return index;
+    }
+    uint16_t method_ref(uint16_t class_index, uint16_t name, uint16_t descriptor) {
+        _pool.push_back(12);
+        u2(_pool, name);
+        u2(_pool, descriptor);
+        uint16_t name_and_type = _count++;
+        _pool.push_back(10);
+        u2(_pool, class_index);
+        u2(_pool, name_and_type);
+        return _count++;
+    }
+
+    std::vector<uint8_t> _pool;
+    uint16_t _count = 1;
+};
+
+// ---------------------------------------------------------------- 计时
+
+volatile uint64_t g_sink = 0;
+
+// pass执行一次完整遍历；先单独跑一遍统计分配次数，再按min_time采样repeat次取中位数
+Result measure(const Options& opts, const std::string& name, const std::string& unit,
+               const std::function<Work()>& pass) {
+    Result result;
+    result.name = name;
+    result.unit = unit;
+
+    uint64_t before = g_allocations.load(std::memory_order_relaxed);
+    result.work = pass();
+    uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - before;
+    result.allocations_per_item = result.work.items ? static_cast<double>(allocations) / result.work.items : 0;
+
+    std::vector<double> samples;
+    for (int r = 0; r < opts.repeat; r++) {
+        uint64_t passes = 0;
+        auto start = Clock::now();
+        double elapsed = 0;
+        do {
+            pass();
+            passes++;
+            elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        } while (elapsed < opts.min_time);
+        samples.push_back(elapsed * 1e9 / passes);
+        result.passes += passes;
+    }
+    std::sort(samples.begin(), samples.end());
+    result.ns_per_pass = samples[samples.size() / 2];
+    return result;
+}
+
+template <typename T, T (jvm::classfile::ClassReader::*READ)() noexcept>
+Work reader_pass(const std::vector<uint8_t>& buffer) {
+    jvm::classfile::ClassReader reader(buffer.data(), buffer.size());
+    uint64_t sum = 0, count = buffer.size() / sizeof(T);
+    for (uint64_t i = 0; i < count; i++) {
+        sum += (reader.*READ)();
+    }
+    g_sink = g_sink + sum;
+    return Work{count * sizeof(T), count};
+}
+
+// ---------------------------------------------------------------- 输出
+
+void append_json_string(std::string& text, const std::string& s) {
+    text += '"';
+    for (char ch : s) {
+        if (ch == '"' || ch == '\\') {
+            text += '\\';
+            text += ch;
+        } else if (static_cast<unsigned char>(ch) < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(ch));
+            text += buf;
+        } else {
+            text += ch;
+        }
+    }
+    text += '"';
+}
+
+std::string to_json(const std::vector<ClassBlob>& corpus, size_t generated, const std::vector<Result>& results) {
+    uint64_t corpus_bytes = 0;
+    for (const ClassBlob& blob : corpus) corpus_bytes += blob.data.size();
+
+    std::string text = "{\n  \"schema\": 1,\n  \"compiler\": ";
+    append_json_string(text, __VERSION__);
+    char buf[512];
+    snprintf(buf, sizeof(buf), ",\n  \"corpus\": {\"classes\": %zu, \"generated\": %zu, \"bytes\": %llu},\n  \"benchmarks\": [",
+             corpus.size(), generated, static_cast<unsigned long long>(corpus_bytes));
+    text += buf;
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        double seconds = r.ns_per_pass / 1e9;
+        text += i ? ",\n    {\"name\": " : "\n    {\"name\": ";
+        append_json_string(text, r.name);
+        text += ", \"unit\": ";
+        append_json_string(text, r.unit);
+        snprintf(buf, sizeof(buf),
+                 ", \"passes\": %llu, \"ns_per_pass\": %.1f, \"ns_per_item\": %.3f, "
+                 "\"items_per_s\": %.1f, \"mb_per_s\": %.2f, \"allocations_per_item\": %.3f}",
+                 static_cast<unsigned long long>(r.passes), r.ns_per_pass,
+                 r.work.items ? r.ns_per_pass / r.work.items : 0.0,
+                 seconds > 0 ? r.work.items / seconds : 0.0,
+                 seconds > 0 ? r.work.bytes / seconds / 1e6 : 0.0,
+                 r.allocations_per_item);
+        text += buf;
+    }
+    text += "\n  ]\n}\n";
+    return text;
+}
+
+bool parse_args(int argc, char* argv[], Options& opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--min-time" && i + 1 < argc) {
+            opts.min_time = atof(argv[++i]);
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            opts.repeat = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--out" && i + 1 < argc) {
+            opts.out = argv[++i];
+        } else if (!arg.empty() && arg[0] == '-') {
+            fprintf(stderr, "usage: %s [--min-time sec] [--repeat n] [--out file] [jar|dir|class...]\n", argv[0]);
+            return false;
+        } else {
+            opts.inputs.push_back(arg);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    using namespace jvm::classfile;
+
+    Options opts;
+    if (!parse_args(argc, argv, opts)) return 2;
+
+    std::vector<ClassBlob> corpus;
+    for (const std::string& input : opts.inputs) {
+        if (!add_input(input, corpus)) {
+            fprintf(stderr, "bench: cannot read %s\n", input.c_str());
+            return 1;
+        }
+    }
+    ClassGenerator generator;
+    corpus.push_back(ClassBlob{"generated/Constants", generator.generate("bench/Constants", 20000, 16, 16)});
+    corpus.push_back(ClassBlob{"generated/Members", generator.generate("bench/Members", 200, 1000, 2000)});
+    const size_t generated = 2;
+
+    // 只保留能成功解析的类，保证各项基准处理的是同一批数据
+    std::vector<ClassBlob> valid;
+    for (ClassBlob& blob : corpus) {
+        ParseResult result = ClassFile::try_parse(blob.data);
+        if (result) {
+            valid.push_back(std::move(blob));
+        } else {
+            fprintf(stderr, "bench: skipping %s: %s (at offset %zu)\n",
+                    blob.name.c_str(), result.error.message(), result.error.offset);
+        }
+    }
+    corpus.swap(valid);
+
+    // ClassReader原语：1MB伪随机数据
+    std::vector<uint8_t> buffer(1 << 20);
+    uint32_t seed = 0x9E3779B9;
+    for (uint8_t& b : buffer) {
+        seed = seed * 1664525 + 1013904223;
+        b = static_cast<uint8_t>(seed >> 24);
+    }
+
+    // MUTF-8：标识符长度的短串，纯ASCII和混合（2/3字节字符、NUL、代理对）两组
+    std::vector<std::string> ascii_strings, mixed_strings;
+    for (int i = 0; i < 4096; i++) {
+        ascii_strings.push_back("java/lang/SomeIdentifier" + std::to_string(i));
+        mixed_strings.push_back("\xC3\xA9t\xE5\x90\x8D\xE5\xAD\x97" + std::to_string(i) +
+                                std::string("\xC0\x80", 2) + "\xED\xA0\xBD\xED\xB8\x80");
+    }
+    auto mutf8_pass = [](const std::vector<std::string>& strings) {
+        Work work;
+        for (const std::string& s : strings) {
+            std::string decoded = util::util_mutf8::decode(reinterpret_cast<const uint8_t*>(s.data()), s.size());
+            g_sink = g_sink + decoded.size();
+            work.bytes += s.size();
+            work.items++;
+        }
+        return work;
+    };
+
+    std::vector<Result> results;
+    results.push_back(measure(opts, "reader.u1", "reads", [&] { return reader_pass<uint8_t, &ClassReader::read_uint8>(buffer); }));
+    results.push_back(measure(opts, "reader.u2", "reads", [&] { return reader_pass<uint16_t, &ClassReader::read_uint16>(buffer); }));
+    results.push_back(measure(opts, "reader.u4", "reads", [&] { return reader_pass<uint32_t, &ClassReader::read_uint32>(buffer); }));
+    results.push_back(measure(opts, "reader.u8", "reads", [&] { return reader_pass<uint64_t, &ClassReader::read_uint64>(buffer); }));
+    results.push_back(measure(opts, "mutf8.ascii", "strings", [&] { return mutf8_pass(ascii_strings); }));
+    results.push_back(measure(opts, "mutf8.mixed", "strings", [&] { return mutf8_pass(mixed_strings); }));
+
+    results.push_back(measure(opts, "constant_pool", "classes", [&] {
+        Work work;
+        for (const ClassBlob& blob : corpus) {
+            ClassReader reader(blob.data.data(), blob.data.size());
+            reader.skip(8);     // magic + 版本
+            auto p_pool = ConstantPool::read_constant_pool(reader);
+            g_sink = g_sink + p_pool->size();
+            work.bytes += blob.data.size();
+            work.items++;
+        }
+        return work;
+    }));
+
+    results.push_back(measure(opts, "parse", "classes", [&] {
+        Work work;
+        for (const ClassBlob& blob : corpus) {
+            ParseResult result = ClassFile::try_parse(blob.data);
+            g_sink = g_sink + result.class_file->methods().size();
+            work.bytes += blob.data.size();
+            work.items++;
+        }
+        return work;
+    }));
+
+    std::string json = to_json(corpus, generated, results);
+    if (opts.out.empty()) {
+        fputs(json.c_str(), stdout);
+    } else {
+        FILE* f = fopen(opts.out.c_str(), "w");
+        if (!f) {
+            fprintf(stderr, "bench: cannot write %s\n", opts.out.c_str());
+            return 1;
+        }
+        fputs(json.c_str(), f);
+        fclose(f);
+        fprintf(stderr, "bench: results written to %s\n", opts.out.c_str());
+    }
+    return 0;
+}
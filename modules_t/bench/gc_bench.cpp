@@ -0,0 +1,213 @@
+// GC基准测试：binary-trees
+// 先建一棵长寿的深树，再按深度反复建短命的树并遍历校验，短命的树在年轻代回收中大量死亡，
+// 长寿的树被晋升，正在建的树是每次年轻代回收要复制的存活对象。
+// 每换一个深度就换一棵新的长寿树，旧树在老年代里死亡，由并发标记找出来、混合回收收回。
+// 依次用不同的GC工作线程数（-XX:ParallelGCThreads）各跑一遍，比较年轻代停顿。结果输出为JSON。
+// 树节点是长度为2的引用数组（int[][]），子节点放在元素0和1，建树时用线程的本地句柄保存子树。
+// --check时每一遍都必须完成过并发周期、做过混合回收，否则返回1。
+//
+// 用法：gc_bench [--depth 深度] [--heap 字节数] [--workers 1,2,4,...] [--ihop 百分比] [--max-pause 毫秒]
+//               [--check] [--out 文件]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "../rtda/heap.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using namespace jvm::rtda;
+
+struct Options {
+    int depth = 18;                     // 最深的树
+    size_t heap = size_t(256) << 20;    // -Xms和-Xmx
+    std::vector<size_t> workers;        // 为空时用1, 2, 4, ...直到默认线程数
+    size_t ihop = jvm::gc::ConcurrentMarker::DEFAULT_INITIATING_OCCUPANCY;   // -XX:InitiatingHeapOccupancyPercent
+    uint64_t max_pause_ms = jvm::gc::PausePolicy::DEFAULT_MAX_PAUSE_MILLIS;   // -XX:MaxGCPauseMillis
+    bool check = false;
+    std::string out;                    // 为空时输出到stdout
+};
+
+struct Result {
+    size_t workers = 0;
+    double seconds = 0;
+    uint64_t young_gcs = 0;
+    uint64_t full_gcs = 0;
+    uint64_t mixed_gcs = 0;
+    uint64_t concurrent_cycles = 0;
+    uint64_t aborted_cycles = 0;
+    double total_pause_ms = 0;
+    double max_pause_ms = 0;
+    long checksum = 0;
+};
+
+const int MIN_DEPTH = 4;
+
+Class* node_class() {
+    return Class::primitiveArrayClass(ArrayType::INT)->arrayClass();
+}
+
+// 建一棵depth层的满二叉树：先建两棵子树，放进句柄，再分配父节点
+Object* build(Heap& heap, Thread& thread, int depth) {
+    if (depth == 0) {
+        return heap.newArray(thread, node_class(), 2);
+    }
+    size_t mark = thread.handleCount();
+    size_t left = thread.pushHandle(build(heap, thread, depth - 1));
+    size_t right = thread.pushHandle(build(heap, thread, depth - 1));
+    ArrayObject* p_node = heap.newArray(thread, node_class(), 2);
+    p_node->set<Object*>(0, thread.handle(left));
+    p_node->set<Object*>(1, thread.handle(right));
+    thread.popHandles(mark);
+    return p_node;
+}
+
+// 节点数，不分配
+long check(Object* p_tree) {
+    ArrayObject* p_node = static_cast<ArrayObject*>(p_tree);
+    Object* p_left = p_node->get<Object*>(0);
+    if (p_left == nullptr) return 1;
+    return 1 + check(p_left) + check(p_node->get<Object*>(1));
+}
+
+Result run(const Options& opts, size_t workers) {
+    Result result;
+    result.workers = workers;
+    Heap heap(opts.heap, opts.heap, workers, opts.ihop, opts.max_pause_ms);
+    Thread thread;
+    auto start = Clock::now();
+
+    size_t long_lived = thread.pushHandle(build(heap, thread, opts.depth));
+    for (int depth = MIN_DEPTH; depth <= opts.depth; depth += 2) {
+        int iterations = 1 << (opts.depth - depth + MIN_DEPTH);
+        for (int i = 0; i < iterations; i++) {
+            result.checksum += check(build(heap, thread, depth));
+        }
+        result.checksum += check(thread.handle(long_lived));
+        thread.setHandle(long_lived, build(heap, thread, opts.depth));
+    }
+    result.checksum += check(thread.handle(long_lived));
+    thread.popHandles(0);
+
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.young_gcs = heap.youngGcCount();
+    result.full_gcs = heap.fullGcCount();
+    result.mixed_gcs = heap.mixedGcCount();
+    result.concurrent_cycles = heap.concurrentCycleCount();
+    result.aborted_cycles = heap.abortedConcurrentCycleCount();
+    result.total_pause_ms = heap.totalPauseNanos() / 1e6;
+    result.max_pause_ms = heap.maxPauseNanos() / 1e6;
+    return result;
+}
+
+std::string to_json(const Options& opts, const std::vector<Result>& results) {
+    std::string text = "{\n  \"schema\": 1,\n  \"compiler\": \"" __VERSION__ "\"";
+    char buf[512];
+    snprintf(buf, sizeof(buf),
+             ",\n  \"depth\": %d,\n  \"heap_bytes\": %zu,\n  \"ihop\": %zu,\n  \"max_pause_ms\": %llu,\n  \"runs\": [",
+             opts.depth, opts.heap, opts.ihop, static_cast<unsigned long long>(opts.max_pause_ms));
+    text += buf;
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        uint64_t gcs = r.young_gcs + r.full_gcs;
+        snprintf(buf, sizeof(buf),
+                 "%s\n    {\"workers\": %zu, \"seconds\": %.3f, \"young_gcs\": %llu, \"full_gcs\": %llu, "
+                 "\"mixed_gcs\": %llu, \"concurrent_cycles\": %llu, \"aborted_cycles\": %llu, "
+                 "\"total_pause_ms\": %.2f, \"avg_pause_ms\": %.3f, \"max_pause_ms\": %.3f, \"checksum\": %ld}",
+                 i ? "," : "", r.workers, r.seconds, static_cast<unsigned long long>(r.young_gcs),
+                 static_cast<unsigned long long>(r.full_gcs), static_cast<unsigned long long>(r.mixed_gcs),
+                 static_cast<unsigned long long>(r.concurrent_cycles),
+                 static_cast<unsigned long long>(r.aborted_cycles), r.total_pause_ms,
+                 gcs ? r.total_pause_ms / gcs : 0.0, r.max_pause_ms, r.checksum);
+        text += buf;
+    }
+    text += "\n  ]\n}\n";
+    return text;
+}
+
+bool parse_args(int argc, char* argv[], Options& opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--depth" && i + 1 < argc) {
+            opts.depth = std::max(MIN_DEPTH, atoi(argv[++i]));
+        } else if (arg == "--heap" && i + 1 < argc) {
+            opts.heap = static_cast<size_t>(atoll(argv[++i]));
+        } else if (arg == "--workers" && i + 1 < argc) {
+            std::string list = argv[++i];
+            for (size_t pos = 0; pos < list.size();) {
+                size_t comma = list.find(',', pos);
+                if (comma == std::string::npos) comma = list.size();
+                opts.workers.push_back(std::max(1, atoi(list.substr(pos, comma - pos).c_str())));
+                pos = comma + 1;
+            }
+        } else if (arg == "--ihop" && i + 1 < argc) {
+            opts.ihop = static_cast<size_t>(atoi(argv[++i]));
+        } else if (arg == "--max-pause" && i + 1 < argc) {
+            opts.max_pause_ms = static_cast<uint64_t>(std::max(1, atoi(argv[++i])));
+        } else if (arg == "--check") {
+            opts.check = true;
+        } else if (arg == "--out" && i + 1 < argc) {
+            opts.out = argv[++i];
+        } else {
+            fprintf(stderr,
+                    "usage: %s [--depth n] [--heap bytes] [--workers n,n,...] [--ihop percent] [--max-pause ms] "
+                    "[--check] [--out file]\n",
+                    argv[0]);
+            return false;
+        }
+    }
+    if (opts.workers.empty()) {
+        size_t max_workers = jvm::gc::WorkGang::defaultWorkerCount();
+        for (size_t n = 1; n < max_workers; n *= 2) {
+            opts.workers.push_back(n);
+        }
+        opts.workers.push_back(max_workers);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opts;
+    if (!parse_args(argc, argv, opts)) return 2;
+
+    std::vector<Result> results;
+    bool failed = false;
+    for (size_t workers : opts.workers) {
+        results.push_back(run(opts, workers));
+        const Result& r = results.back();
+        fprintf(stderr,
+                "bench: %zu workers, %.2fs, %llu young (%llu mixed) + %llu full GCs, %llu concurrent cycles "
+                "(%llu aborted), pause total %.1fms max %.2fms\n",
+                r.workers, r.seconds, static_cast<unsigned long long>(r.young_gcs),
+                static_cast<unsigned long long>(r.mixed_gcs), static_cast<unsigned long long>(r.full_gcs),
+                static_cast<unsigned long long>(r.concurrent_cycles),
+                static_cast<unsigned long long>(r.aborted_cycles), r.total_pause_ms, r.max_pause_ms);
+        if (opts.check && (r.concurrent_cycles == 0 || r.mixed_gcs == 0)) {
+            fprintf(stderr, "bench: %zu workers: expected at least one concurrent cycle and one mixed GC\n",
+                    r.workers);
+            failed = true;
+        }
+    }
+
+    std::string json = to_json(opts, results);
+    if (opts.out.empty()) {
+        fputs(json.c_str(), stdout);
+    } else {
+        FILE* f = fopen(opts.out.c_str(), "w");
+        if (!f) {
+            fprintf(stderr, "bench: cannot write %s\n", opts.out.c_str());
+            return 1;
+        }
+        fputs(json.c_str(), f);
+        fclose(f);
+        fprintf(stderr, "bench: results written to %s\n", opts.out.c_str());
+    }
+    return failed ? 1 : 0;
+}
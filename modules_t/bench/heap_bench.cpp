@@ -0,0 +1,200 @@
+// 堆分配基准测试
+// 对比TLAB分配（Heap::newArray）与最朴素的指针碰撞：后者在一段新映射的内存里移动指针并初始化对象，
+// 是分配速度的上限。每轮都用新的堆，两边都要付缺页的代价。结果输出为JSON。
+//
+// 用法：heap_bench [--min-time 秒] [--repeat 次数] [--threads 线程数] [--out 文件]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+
+#include "../rtda/heap.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using namespace jvm::rtda;
+
+struct Options {
+    double min_time = 0.2;      // 每个样本至少运行的时间（秒）
+    int repeat = 5;             // 样本数，报告中位数
+    int threads = 4;            // 多线程分配的线程数
+    std::string out;            // 为空时输出到stdout
+};
+
+struct Result {
+    std::string name;
+    uint64_t passes = 0;
+    double ns_per_pass = 0;
+    uint64_t objects = 0;       // 每轮分配的对象数
+    uint64_t bytes = 0;         // 每轮分配的字节数
+};
+
+volatile uint64_t g_sink = 0;
+
+// 每轮分配的对象数和数组长度：int[4]占64字节，一轮约64MB
+const uint64_t OBJECTS = 1 << 20;
+const int32_t LENGTH = 4;
+// 大对象：long[8192]，64KB，走大对象路径
+const uint64_t LARGE_OBJECTS = 1 << 10;
+const int32_t LARGE_LENGTH = 8192;
+
+template <typename F>
+Result measure(const Options& opts, const char* name, uint64_t objects, uint64_t bytes, F&& pass) {
+    Result result;
+    result.name = name;
+    result.objects = objects;
+    result.bytes = bytes;
+    pass();     // 预热
+
+    std::vector<double> samples;
+    for (int r = 0; r < opts.repeat; r++) {
+        uint64_t passes = 0;
+        auto start = Clock::now();
+        double elapsed = 0;
+        do {
+            pass();
+            passes++;
+            elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        } while (elapsed < opts.min_time);
+        samples.push_back(elapsed * 1e9 / passes);
+        result.passes += passes;
+    }
+    std::sort(samples.begin(), samples.end());
+    result.ns_per_pass = samples[samples.size() / 2];
+    return result;
+}
+
+// 基线：新映射一段内存，指针碰撞 + 初始化对象头和元素
+void bump_pass(ArrayType type, int32_t length, uint64_t count) {
+    size_t size = ArrayObject::allocationSize(type, length);
+    size_t total = size * count;
+    void* p = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (p == MAP_FAILED) {
+        fprintf(stderr, "bench: mmap failed\n");
+        exit(1);
+    }
+    Class* p_class = Class::primitiveArrayClass(type);
+    char* top = static_cast<char*>(p);
+    for (uint64_t i = 0; i < count; i++) {
+        ArrayObject* p_array = ArrayObject::initialize(top, p_class, length);
+        top += size;
+        g_sink = g_sink + p_array->length();
+    }
+    munmap(p, total);
+}
+
+// 在一个新堆上用threads个线程各自的TLAB分配，共count个对象
+void heap_pass(ArrayType type, int32_t length, uint64_t count, int threads) {
+    size_t total = ArrayObject::allocationSize(type, length) * count;
+    // 留出TLAB尾部浪费和填充的余量
+    Heap heap(total + total / 4, total + total / 4 + Heap::TLAB_SIZE * threads * 2);
+    Class* p_class = Class::primitiveArrayClass(type);
+    auto work = [&](uint64_t n) {
+        Thread thread;
+        for (uint64_t i = 0; i < n; i++) {
+            ArrayObject* p_array = heap.newArray(thread, p_class, length);
+            g_sink = g_sink + p_array->length();
+        }
+    };
+    if (threads <= 1) {
+        work(count);
+        return;
+    }
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back(work, count / threads);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::string to_json(const Options& opts, const std::vector<Result>& results) {
+    std::string text = "{\n  \"schema\": 1,\n  \"compiler\": \"" __VERSION__ "\"";
+    char buf[512];
+    snprintf(buf, sizeof(buf), ",\n  \"threads\": %d,\n  \"benchmarks\": [", opts.threads);
+    text += buf;
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        double seconds = r.ns_per_pass / 1e9;
+        snprintf(buf, sizeof(buf),
+                 "%s\n    {\"name\": \"%s\", \"passes\": %llu, \"ns_per_pass\": %.1f, \"ns_per_object\": %.3f, "
+                 "\"objects_per_s\": %.1f, \"mb_per_s\": %.2f}",
+                 i ? "," : "", r.name.c_str(), static_cast<unsigned long long>(r.passes), r.ns_per_pass,
+                 r.objects ? r.ns_per_pass / r.objects : 0.0,
+                 seconds > 0 ? r.objects / seconds : 0.0,
+                 seconds > 0 ? r.bytes / seconds / 1e6 : 0.0);
+        text += buf;
+    }
+    text += "\n  ]\n}\n";
+    return text;
+}
+
+bool parse_args(int argc, char* argv[], Options& opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--min-time" && i + 1 < argc) {
+            opts.min_time = atof(argv[++i]);
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            opts.repeat = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            opts.threads = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--out" && i + 1 < argc) {
+            opts.out = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--min-time sec] [--repeat n] [--threads n] [--out file]\n", argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opts;
+    if (!parse_args(argc, argv, opts)) return 2;
+
+    const uint64_t small_bytes = ArrayObject::allocationSize(ArrayType::INT, LENGTH) * OBJECTS;
+    const uint64_t large_bytes = ArrayObject::allocationSize(ArrayType::LONG, LARGE_LENGTH) * LARGE_OBJECTS;
+
+    std::vector<Result> results;
+    results.push_back(measure(opts, "bump.small", OBJECTS, small_bytes, [] {
+        bump_pass(ArrayType::INT, LENGTH, OBJECTS);
+    }));
+    results.push_back(measure(opts, "tlab.small", OBJECTS, small_bytes, [] {
+        heap_pass(ArrayType::INT, LENGTH, OBJECTS, 1);
+    }));
+    results.push_back(measure(opts, "tlab.small.threads", OBJECTS, small_bytes, [&] {
+        heap_pass(ArrayType::INT, LENGTH, OBJECTS, opts.threads);
+    }));
+    results.push_back(measure(opts, "bump.large", LARGE_OBJECTS, large_bytes, [] {
+        bump_pass(ArrayType::LONG, LARGE_LENGTH, LARGE_OBJECTS);
+    }));
+    results.push_back(measure(opts, "heap.large", LARGE_OBJECTS, large_bytes, [] {
+        heap_pass(ArrayType::LONG, LARGE_LENGTH, LARGE_OBJECTS, 1);
+    }));
+
+    std::string json = to_json(opts, results);
+    if (opts.out.empty()) {
+        fputs(json.c_str(), stdout);
+    } else {
+        FILE* f = fopen(opts.out.c_str(), "w");
+        if (!f) {
+            fprintf(stderr, "bench: cannot write %s\n", opts.out.c_str());
+            return 1;
+        }
+        fputs(json.c_str(), f);
+        fclose(f);
+        fprintf(stderr, "bench: results written to %s\n", opts.out.c_str());
+    }
+    return 0;
+}
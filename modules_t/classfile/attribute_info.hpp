@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
@@ -22,7 +24,7 @@ public:
 
 std::vector<std::unique_ptr<AttributeInfo>> readAttributes(ClassReader* reader, const ConstantPool& cp);
 std::unique_ptr<AttributeInfo> readAttribute(ClassReader* reader, const ConstantPool& cp);
-std::unique_ptr<AttributeInfo> newAttributeInfo(const std::string& attrName, uint32_t attrLen, const ConstantPool& cp);
+std::unique_ptr<AttributeInfo> newAttributeInfo(AttributeKind kind, uint16_t attrNameIndex, uint32_t attrLen, const ConstantPool& cp);
 
 class UnparsedAttribute : public AttributeInfo {
 private:
@@ -102,6 +104,172 @@ public:
     }
 };
 
+///// StackMapTableAttribute 类型检查验证器使用的栈映射帧（Java 6+，50以上版本必需）
+// 验证类型，OBJECT的data是类常量索引，UNINITIALIZED的data是对应new指令的偏移
+enum class VerificationTypeTag : uint8_t {
+    TOP = 0,
+    INTEGER = 1,
+    FLOAT = 2,
+    DOUBLE = 3,
+    LONG = 4,
+    NULL_TYPE = 5,
+    UNINITIALIZED_THIS = 6,
+    OBJECT = 7,
+    UNINITIALIZED = 8,
+};
+
+struct VerificationType {
+    VerificationTypeTag tag;
+    uint16_t data;
+
+    // long/double在局部变量表和操作数栈中占两个槽位
+    bool isCategory2() const {
+        return tag == VerificationTypeTag::LONG || tag == VerificationTypeTag::DOUBLE;
+    }
+};
+
+// 帧的压缩形式，保留类文件中的增量编码，由验证器按需展开为完整的槽位形式
+enum class StackMapFrameKind : uint8_t {
+    SAME,                       // same_frame / same_frame_extended
+    SAME_LOCALS_1_STACK_ITEM,   // same_locals_1_stack_item_frame(_extended)
+    CHOP,                       // chop_frame：去掉最后chopCount个局部变量
+    APPEND,                     // append_frame：追加localsCount个局部变量
+    FULL,                       // full_frame
+};
+
+// 帧本身只有12字节，验证类型统一存放在属性的类型池中：
+// _types[typesBegin, typesBegin + localsCount)是局部变量，紧接着stackCount个是操作数栈
+struct StackMapFrame {
+    uint16_t pc;                // 已由offset_delta换算成的绝对字节码偏移
+    StackMapFrameKind kind;
+    uint8_t chopCount;
+    uint16_t localsCount;
+    uint16_t stackCount;
+    uint32_t typesBegin;
+};
+
+class StackMapTableAttribute : public AttributeInfo {
+private:
+    std::vector<StackMapFrame> _frames;
+    std::vector<VerificationType> _types;
+    // _pcIndex[pc]为0表示该pc没有帧，否则为帧下标+1；由所属Code属性在读完字节码后建立
+    std::vector<uint16_t> _pcIndex;
+
+public:
+    void readInfo(ClassReader* reader) override {
+        uint16_t numberOfEntries = reader->read_uint16();
+        _frames.reserve(numberOfEntries);
+        // 每个帧至少占1字节，类型池按每帧平均一个类型预留
+        _types.reserve(numberOfEntries);
+
+        uint32_t pc = 0;
+        for (uint16_t i = 0; i < numberOfEntries && !reader->failed(); i++) {
+            size_t frameOffset = reader->offset();
+            uint8_t frameType = reader->read_uint8();
+            StackMapFrame frame{0, StackMapFrameKind::SAME, 0, 0, 0, static_cast<uint32_t>(_types.size())};
+            uint16_t offsetDelta;
+
+            if (frameType < 64) {
+                offsetDelta = frameType;
+            } else if (frameType < 128) {
+                offsetDelta = frameType - 64;
+                frame.kind = StackMapFrameKind::SAME_LOCALS_1_STACK_ITEM;
+                frame.stackCount = 1;
+                readVerificationType(reader);
+            } else if (frameType < 247) {
+                // 128-246 为保留值
+                reader->fail_at(ClassFormatErrorKind::BAD_STACK_MAP_FRAME, frameOffset);
+                break;
+            } else if (frameType == 247) {
+                offsetDelta = reader->read_uint16();
+                frame.kind = StackMapFrameKind::SAME_LOCALS_1_STACK_ITEM;
+                frame.stackCount = 1;
+                readVerificationType(reader);
+            } else if (frameType < 251) {
+                offsetDelta = reader->read_uint16();
+                frame.kind = StackMapFrameKind::CHOP;
+                frame.chopCount = static_cast<uint8_t>(251 - frameType);
+            } else if (frameType == 251) {
+                offsetDelta = reader->read_uint16();
+            } else if (frameType < 255) {
+                offsetDelta = reader->read_uint16();
+                frame.kind = StackMapFrameKind::APPEND;
+                frame.localsCount = static_cast<uint16_t>(frameType - 251);
+                for (uint16_t k = 0; k < frame.localsCount; k++) {
+                    readVerificationType(reader);
+                }
+            } else {
+                offsetDelta = reader->read_uint16();
+                frame.kind = StackMapFrameKind::FULL;
+                frame.localsCount = reader->read_uint16();
+                for (uint16_t k = 0; k < frame.localsCount && !reader->failed(); k++) {
+                    readVerificationType(reader);
+                }
+                frame.stackCount = reader->read_uint16();
+                for (uint16_t k = 0; k < frame.stackCount && !reader->failed(); k++) {
+                    readVerificationType(reader);
+                }
+            }
+
+            // 第一帧的偏移就是offset_delta，之后每帧为 前一帧偏移 + offset_delta + 1，保证严格递增
+            pc = (i == 0) ? offsetDelta : pc + offsetDelta + 1;
+            if (pc > UINT16_MAX) {
+                reader->fail_at(ClassFormatErrorKind::BAD_STACK_MAP_FRAME, frameOffset);
+                break;
+            }
+            frame.pc = static_cast<uint16_t>(pc);
+            _frames.push_back(frame);
+        }
+    }
+
+    // 建立pc -> 帧的直接索引，之后frameAt是O(1)的；帧偏移超出字节码长度时返回false
+    bool buildPcIndex(size_t codeLength) {
+        if (!_frames.empty() && _frames.back().pc >= codeLength) {
+            return false;
+        }
+        _pcIndex.assign(codeLength, 0);
+        for (size_t i = 0; i < _frames.size(); i++) {
+            _pcIndex[_frames[i].pc] = static_cast<uint16_t>(i + 1);
+        }
+        return true;
+    }
+
+    // 返回以pc为起点的帧（分支目标、异常处理器入口等），没有则返回nullptr
+    const StackMapFrame* frameAt(uint32_t pc) const {
+        if (pc >= _pcIndex.size() || _pcIndex[pc] == 0) {
+            return nullptr;
+        }
+        return &_frames[_pcIndex[pc] - 1];
+    }
+
+    const std::vector<StackMapFrame>& getFrames() const { return _frames; }
+
+    const VerificationType* localsOf(const StackMapFrame& frame) const {
+        return _types.data() + frame.typesBegin;
+    }
+
+    const VerificationType* stackOf(const StackMapFrame& frame) const {
+        return _types.data() + frame.typesBegin + frame.localsCount;
+    }
+
+private:
+    void readVerificationType(ClassReader* reader) {
+        size_t typeOffset = reader->offset();
+        uint8_t tag = reader->read_uint8();
+        if (reader->failed()) return;
+        if (tag > static_cast<uint8_t>(VerificationTypeTag::UNINITIALIZED)) {
+            reader->fail_at(ClassFormatErrorKind::BAD_STACK_MAP_FRAME, typeOffset);
+            return;
+        }
+        VerificationTypeTag typeTag = static_cast<VerificationTypeTag>(tag);
+        uint16_t data = 0;
+        if (typeTag == VerificationTypeTag::OBJECT || typeTag == VerificationTypeTag::UNINITIALIZED) {
+            data = reader->read_uint16();
+        }
+        _types.push_back(VerificationType{typeTag, data});
+    }
+};
+
 ///// CodeAttribute 存储字节码等方法相关信息
 class ExceptionTableEntry {
 private:
@@ -122,6 +290,138 @@ public:
     uint16_t getCatchType() const { return _catchType; }
 };
 
+// 一个方法在各GC点（见gc/reference_map.hpp）执行之前存放引用的局部变量和操作数栈槽位（null和未初始化对象也算），
+// GC据此扫描解释器栈帧。所有GC点的位放在一个连续的位数组里，按pc升序登记每个GC点的起始位和栈深度；
+// 每个GC点先是max_locals个局部变量，再是当时操作数栈上的槽位。
+// jsr/ret子程序里的GC点另有一组待定位：子程序没改过的局部变量是不是引用取决于调用点，
+// GC读出返回地址，到调用它的jsr处的位图里查。建好之后只读，可以被多个线程共用
+class ReferenceMaps {
+public:
+    static constexpr uint32_t NO_BIT = UINT32_MAX;
+
+    // 一个GC点的位图
+    class Map {
+    public:
+        Map() = default;
+        Map(const uint64_t* p_words, uint32_t bit, uint16_t max_locals, uint16_t stack_depth,
+            uint32_t deferred_bit = NO_BIT, uint32_t return_address_slot = 0)
+            : _p_words(p_words), _bit(bit), _maxLocals(max_locals), _stackDepth(stack_depth),
+              _deferredBit(deferred_bit), _returnAddressSlot(return_address_slot) {}
+
+        uint16_t localCount() const { return _maxLocals; }
+        uint16_t stackDepth() const { return _stackDepth; }
+        bool local(size_t index) const { return test(_bit + index); }
+        bool stack(size_t index) const { return test(_bit + _maxLocals + index); }
+
+        // 待定的局部变量：要到调用点的位图里查；返回地址所在的槽位编号方式同add()
+        bool hasDeferred() const { return _deferredBit != NO_BIT; }
+        bool deferred(size_t index) const { return hasDeferred() && test(_deferredBit + index); }
+        uint32_t returnAddressSlot() const { return _returnAddressSlot; }
+
+    private:
+        bool test(size_t bit) const { return (_p_words[bit / 64] >> (bit % 64)) & 1; }
+
+        const uint64_t* _p_words = nullptr;
+        uint32_t _bit = 0;
+        uint16_t _maxLocals = 0;
+        uint16_t _stackDepth = 0;
+        uint32_t _deferredBit = NO_BIT;
+        uint32_t _returnAddressSlot = 0;
+    };
+
+    explicit ReferenceMaps(uint16_t max_locals) : _maxLocals(max_locals) {}
+
+    // 登记pc处的GC点，pc必须比已登记的都大；is_reference(i)回答第i个槽位是否是引用，
+    // i在[0, max_locals)是局部变量，之后是操作数栈（栈底在前）
+    template <typename F>
+    void add(uint32_t pc, uint16_t stack_depth, F&& is_reference) {
+        uint32_t bit = appendBits(uint32_t(_maxLocals) + stack_depth, is_reference);
+        _entries.push_back(Entry{static_cast<uint16_t>(pc), stack_depth, bit});
+    }
+
+    // 给最后登记的GC点加上待定位：is_deferred(i)回答第i个局部变量是否待定
+    template <typename F>
+    void defer(uint32_t return_address_slot, F&& is_deferred) {
+        uint32_t bit = appendBits(_maxLocals, is_deferred);
+        _deferred.push_back(Deferred{_entries.back().pc, static_cast<uint16_t>(return_address_slot), bit});
+    }
+
+    // 子程序调用点：jsr的pc和它的返回地址
+    void addCall(uint32_t jsr_pc, uint32_t return_pc) {
+        _calls.push_back(Call{static_cast<uint16_t>(return_pc), static_cast<uint16_t>(jsr_pc)});
+    }
+
+    // 登记完毕：调用点按返回地址排序，释放多余的容量
+    void finish() {
+        std::sort(_calls.begin(), _calls.end(), [](const Call& a, const Call& b) { return a.returnPc < b.returnPc; });
+        _words.shrink_to_fit();
+        _entries.shrink_to_fit();
+        _deferred.shrink_to_fit();
+        _calls.shrink_to_fit();
+    }
+
+    size_t size() const { return _entries.size(); }
+
+    // pc不是GC点时返回false
+    bool find(uint32_t pc, Map& map) const {
+        auto it = std::lower_bound(_entries.begin(), _entries.end(), pc,
+                                   [](const Entry& entry, uint32_t key) { return entry.pc < key; });
+        if (it == _entries.end() || it->pc != pc) return false;
+        auto d = std::lower_bound(_deferred.begin(), _deferred.end(), pc,
+                                  [](const Deferred& deferred, uint32_t key) { return deferred.pc < key; });
+        if (d != _deferred.end() && d->pc == pc) {
+            map = Map(_words.data(), it->bit, _maxLocals, it->stackDepth, d->bit, d->returnAddressSlot);
+        } else {
+            map = Map(_words.data(), it->bit, _maxLocals, it->stackDepth);
+        }
+        return true;
+    }
+
+    // 返回地址return_pc对应的jsr指令，不是调用点时返回false
+    bool findCall(uint32_t return_pc, uint32_t& jsr_pc) const {
+        auto it = std::lower_bound(_calls.begin(), _calls.end(), return_pc,
+                                   [](const Call& call, uint32_t key) { return call.returnPc < key; });
+        if (it == _calls.end() || it->returnPc != return_pc) return false;
+        jsr_pc = it->jsrPc;
+        return true;
+    }
+
+private:
+    // code_length不超过65535（验证器保证），pc用16位就够
+    struct Entry {
+        uint16_t pc;
+        uint16_t stackDepth;
+        uint32_t bit;
+    };
+    struct Deferred {
+        uint16_t pc;
+        uint16_t returnAddressSlot;
+        uint32_t bit;
+    };
+    struct Call {
+        uint16_t returnPc;
+        uint16_t jsrPc;
+    };
+
+    template <typename F>
+    uint32_t appendBits(uint32_t count, F&& is_set) {
+        uint32_t bit = _bitCount;
+        _bitCount += count;
+        _words.resize((_bitCount + 63) / 64, 0);
+        for (uint32_t i = 0; i < count; i++) {
+            if (is_set(i)) _words[(bit + i) / 64] |= uint64_t(1) << ((bit + i) % 64);
+        }
+        return bit;
+    }
+
+    uint16_t _maxLocals;
+    uint32_t _bitCount = 0;
+    std::vector<uint64_t> _words;
+    std::vector<Entry> _entries;
+    std::vector<Deferred> _deferred;
+    std::vector<Call> _calls;
+};
+
 class CodeAttribute : public AttributeInfo {
 private:
     const ConstantPool& _cp;
@@ -130,6 +430,8 @@ private:
     std::vector<uint8_t> _code;
     std::vector<std::unique_ptr<ExceptionTableEntry>> _exceptionTable;
     std::vector<std::unique_ptr<AttributeInfo>> _attributes;
+    // 指向_attributes中的StackMapTable属性，没有时为nullptr
+    const StackMapTableAttribute* _stackMapTable = nullptr;
 
     std::vector<std::unique_ptr<ExceptionTableEntry>> readExceptionTable(ClassReader* reader);
 
@@ -145,6 +447,28 @@ public:
     const std::vector<std::unique_ptr<ExceptionTableEntry>>& getExceptionTable() const {
         return _exceptionTable;
     }
+    const std::vector<std::unique_ptr<AttributeInfo>>& getAttributes() const { return _attributes; }
+    const StackMapTableAttribute* getStackMapTable() const { return _stackMapTable; }
+
+    // 验证结果：通过类型检查验证的方法在执行时可以去掉操作数栈/局部变量表的越界检查。
+    // 由验证任务写入，执行引擎在等待验证完成（future）之后读取
+    bool isVerified() const { return _verified; }
+    // 验证得到的实际最大栈深度（槽位数），不超过max_stack
+    uint16_t getVerifiedMaxStack() const { return _verifiedMaxStack; }
+    void markVerified(uint16_t maxStackDepth) {
+        _verifiedMaxStack = maxStackDepth;
+        _verified = true;
+    }
+
+    // 引用位图：类链接时由验证器在每个GC点算好，之后只读；内容相同的类共用同一份
+    // （见classloader::Verifier的缓存）。还没链接时返回nullptr
+    const ReferenceMaps* getReferenceMaps() const { return _referenceMaps.get(); }
+    void setReferenceMaps(std::shared_ptr<const ReferenceMaps> maps) { _referenceMaps = std::move(maps); }
+
+private:
+    bool _verified = false;
+    uint16_t _verifiedMaxStack = 0;
+    std::shared_ptr<const ReferenceMaps> _referenceMaps;
 };
 
 inline void CodeAttribute::readInfo(ClassReader* reader) {
@@ -153,7 +477,20 @@ inline void CodeAttribute::readInfo(ClassReader* reader) {
     uint32_t codeLength = reader->read_uint32();
     _code = reader->read_bytes(codeLength);
     _exceptionTable = readExceptionTable(reader);
+    size_t attributesOffset = reader->offset();
     _attributes = readAttributes(reader, _cp);
+    if (reader->failed()) return;
+
+    for (auto& attr : _attributes) {
+        if (auto* stackMap = dynamic_cast<StackMapTableAttribute*>(attr.get())) {
+            if (!stackMap->buildPcIndex(_code.size())) {
+                reader->fail_at(ClassFormatErrorKind::BAD_STACK_MAP_FRAME, attributesOffset);
+                return;
+            }
+            _stackMapTable = stackMap;
+            break;
+        }
+    }
 }
 
 inline std::vector<std::unique_ptr<ExceptionTableEntry>> 
@@ -162,7 +499,7 @@ CodeAttribute::readExceptionTable(ClassReader* reader) {
     std::vector<std::unique_ptr<ExceptionTableEntry>> exceptionTable;
     exceptionTable.reserve(exceptionTableLength);
 
-    for (uint16_t i = 0; i < exceptionTableLength; i++) {
+    for (uint16_t i = 0; i < exceptionTableLength && !reader->failed(); i++) {
         uint16_t startPc = reader->read_uint16();
         uint16_t endPc = reader->read_uint16();
         uint16_t handlerPc = reader->read_uint16();
@@ -206,31 +543,55 @@ public:
 };
 
 // LineNumberTableAttribute contains a list of line number information
+// 按start_pc排序后以结构数组(SoA)存储：pc数组单独连续存放，二分查找只触碰2字节/项，
+// 每项不再单独分配堆对象；构造栈轨迹时每帧一次O(log n)查找
 class LineNumberTableAttribute : public AttributeInfo {
 private:
-    std::vector<std::unique_ptr<LineNumberTableEntry>> _lineNumberTable;
+    std::vector<uint16_t> _startPcs;
+    std::vector<uint16_t> _lineNumbers;
 
 public:
     void readInfo(ClassReader* reader) override {
         uint16_t lineNumberTableLength = reader->read_uint16();
-        _lineNumberTable.reserve(lineNumberTableLength);
+        std::vector<LineNumberTableEntry> entries;
+        entries.reserve(lineNumberTableLength);
 
-        for (uint16_t i = 0; i < lineNumberTableLength; i++) {
+        for (uint16_t i = 0; i < lineNumberTableLength && !reader->failed(); i++) {
             uint16_t startPc = reader->read_uint16();
             uint16_t lineNumber = reader->read_uint16();
-            _lineNumberTable.push_back(
-                std::make_unique<LineNumberTableEntry>(startPc, lineNumber));
+            entries.emplace_back(startPc, lineNumber);
+        }
+
+        // javac输出的表通常已按pc有序，此时排序是线性的；
+        // stable_sort保证相同start_pc时仍以表中靠后的项为准
+        std::stable_sort(entries.begin(), entries.end(),
+            [](const LineNumberTableEntry& a, const LineNumberTableEntry& b) {
+                return a.getStartPc() < b.getStartPc();
+            });
+
+        _startPcs.reserve(entries.size());
+        _lineNumbers.reserve(entries.size());
+        for (const auto& e : entries) {
+            _startPcs.push_back(e.getStartPc());
+            _lineNumbers.push_back(e.getLineNumber());
         }
     }
 
+    // 返回覆盖pc的行号（start_pc <= pc 的最大项），找不到返回-1
     int getLineNumber(int pc) const {
-        // Search from end to beginning to find the most precise line number
-        for (auto it = _lineNumberTable.rbegin(); it != _lineNumberTable.rend(); ++it) {
-            if (pc >= (*it)->getStartPc()) {
-                return (*it)->getLineNumber();
-            }
+        if (pc < 0) return -1;
+        auto it = std::upper_bound(_startPcs.begin(), _startPcs.end(), static_cast<uint32_t>(pc),
+            [](uint32_t value, uint16_t startPc) { return value < startPc; });
+        if (it == _startPcs.begin()) {
+            return -1;
         }
-        return -1;
+        return _lineNumbers[(it - _startPcs.begin()) - 1];
+    }
+
+    size_t size() const { return _startPcs.size(); }
+
+    LineNumberTableEntry getEntry(size_t i) const {
+        return LineNumberTableEntry(_startPcs[i], _lineNumbers[i]);
     }
 };
 
@@ -257,34 +618,90 @@ public:
     uint16_t getNameIndex() const { return _nameIndex; }
     uint16_t getDescriptorIndex() const { return _descriptorIndex; }
     uint16_t getIndex() const { return _index; }
+
+    // pc是否落在该变量的作用域[start_pc, start_pc + length)内
+    bool covers(uint32_t pc) const {
+        return pc >= _startPc && pc < static_cast<uint32_t>(_startPc) + _length;
+    }
 };
 
+// 局部变量表按(局部变量槽位, start_pc)排序，并记录每个槽位的区间起点，
+// 调试器/栈遍历查询"某pc处某槽位是哪个变量"时只需在该槽位的区间内二分
 class LocalVariableTableAttribute : public AttributeInfo {
 private:
-    std::vector<std::unique_ptr<LocalVariableTableEntry>> _localVariableTable;
+    std::vector<LocalVariableTableEntry> _localVariableTable;
+    // _slotBegin[slot] .. _slotBegin[slot + 1] 是槽位slot的项在表中的范围
+    std::vector<uint32_t> _slotBegin;
 
 public:
     void readInfo(ClassReader* reader) override {
         uint16_t localVariableTableLength = reader->read_uint16();
         _localVariableTable.reserve(localVariableTableLength);
 
-        for (uint16_t i = 0; i < localVariableTableLength; i++) {
+        for (uint16_t i = 0; i < localVariableTableLength && !reader->failed(); i++) {
             uint16_t startPc = reader->read_uint16();
             uint16_t length = reader->read_uint16();
             uint16_t nameIndex = reader->read_uint16();
             uint16_t descriptorIndex = reader->read_uint16();
             uint16_t index = reader->read_uint16();
 
-            _localVariableTable.push_back(
-                std::make_unique<LocalVariableTableEntry>(
-                    startPc, length, nameIndex, descriptorIndex, index));
+            _localVariableTable.emplace_back(
+                startPc, length, nameIndex, descriptorIndex, index);
         }
+        buildIndex();
     }
 
-    const std::vector<std::unique_ptr<LocalVariableTableEntry>>& 
+    const std::vector<LocalVariableTableEntry>& 
     getLocalVariableTable() const {
         return _localVariableTable;
     }
+
+    // 查找pc处占用局部变量槽位slot的变量，找不到返回nullptr
+    const LocalVariableTableEntry* findLocal(uint16_t slot, uint32_t pc) const {
+        if (static_cast<size_t>(slot) + 1 >= _slotBegin.size()) {
+            return nullptr;
+        }
+        auto first = _localVariableTable.begin() + _slotBegin[slot];
+        auto last = _localVariableTable.begin() + _slotBegin[slot + 1];
+        // 同一槽位的作用域互不重叠，start_pc <= pc 的最后一项是唯一候选
+        auto it = std::upper_bound(first, last, pc,
+            [](uint32_t value, const LocalVariableTableEntry& e) { return value < e.getStartPc(); });
+        if (it == first) {
+            return nullptr;
+        }
+        --it;
+        return it->covers(pc) ? &*it : nullptr;
+    }
+
+    // 收集pc处所有存活的局部变量（按槽位升序）
+    std::vector<const LocalVariableTableEntry*> liveAt(uint32_t pc) const {
+        std::vector<const LocalVariableTableEntry*> live;
+        for (size_t slot = 0; slot + 1 < _slotBegin.size(); ++slot) {
+            if (_slotBegin[slot] == _slotBegin[slot + 1]) continue;
+            if (const LocalVariableTableEntry* e = findLocal(static_cast<uint16_t>(slot), pc)) {
+                live.push_back(e);
+            }
+        }
+        return live;
+    }
+
+private:
+    void buildIndex() {
+        std::sort(_localVariableTable.begin(), _localVariableTable.end(),
+            [](const LocalVariableTableEntry& a, const LocalVariableTableEntry& b) {
+                if (a.getIndex() != b.getIndex()) return a.getIndex() < b.getIndex();
+                return a.getStartPc() < b.getStartPc();
+            });
+
+        size_t slotCount = _localVariableTable.empty() ? 0 : _localVariableTable.back().getIndex() + 1;
+        _slotBegin.assign(slotCount + 1, 0);
+        for (const auto& e : _localVariableTable) {
+            ++_slotBegin[e.getIndex() + 1];
+        }
+        for (size_t slot = 1; slot <= slotCount; ++slot) {
+            _slotBegin[slot] += _slotBegin[slot - 1];
+        }
+    }
 };
 
 /////////////////// Attribute classes ///////////////////////
@@ -297,43 +714,66 @@ inline std::vector<std::unique_ptr<AttributeInfo>> readAttributes(ClassReader* r
     LOG(INFO, "attributes count: %d", attributesCount);
     
     for (uint16_t i = 0; i < attributesCount; i++) {
-        attributes.push_back(readAttribute(reader, cp));
+        auto attrInfo = readAttribute(reader, cp);
+        if (!attrInfo) break;
+        attributes.push_back(std::move(attrInfo));
     }
     return attributes;
 }
 
+// 读取单个属性，失败时在reader中记录错误并返回nullptr
 inline std::unique_ptr<AttributeInfo> readAttribute(ClassReader* reader, const ConstantPool& cp) {
+    size_t nameOffset = reader->offset();
     uint16_t attrNameIndex = reader->read_uint16();
-    std::string attrName = cp.get_utf8(attrNameIndex);
     uint32_t attrLen = reader->read_uint32();
-    LOG(INFO, "attr_index: %d attribute name: %s, length: %d", attrNameIndex, attrName.c_str(), attrLen);
+    if (reader->failed()) return nullptr;
+
+    AttributeKind kind = cp.attribute_kind(attrNameIndex);
+    if (kind == AttributeKind::INVALID) {
+        reader->fail_at(ClassFormatErrorKind::BAD_CONSTANT_INDEX, nameOffset);
+        return nullptr;
+    }
+    LOG(INFO, "attr_index: %d attribute kind: %d, length: %d", attrNameIndex, static_cast<int>(kind), attrLen);
     
-    auto attrInfo = newAttributeInfo(attrName, attrLen, cp);
+    size_t infoOffset = reader->offset();
+    auto attrInfo = newAttributeInfo(kind, attrNameIndex, attrLen, cp);
     attrInfo->readInfo(reader);
+    if (reader->failed()) return nullptr;
+
+    // 已知属性的解析结果必须恰好消费attribute_length个字节
+    if (reader->offset() - infoOffset != attrLen) {
+        reader->fail_at(ClassFormatErrorKind::BAD_ATTRIBUTE_LENGTH, nameOffset);
+        return nullptr;
+    }
     return attrInfo;
 }
 
-inline std::unique_ptr<AttributeInfo> newAttributeInfo(const std::string& attrName, 
+inline std::unique_ptr<AttributeInfo> newAttributeInfo(AttributeKind kind,
+                                                     uint16_t attrNameIndex,
                                                      uint32_t attrLen, 
                                                      const ConstantPool& cp) {
-    if (attrName == "Code") {
-        return std::make_unique<CodeAttribute>(cp);
-    } else if (attrName == "ConstantValue") {
-        return std::make_unique<ConstantValueAttribute>();
-    } else if (attrName == "Deprecated") {
-        return std::make_unique<DeprecatedAttribute>();
-    } else if (attrName == "Exceptions") {
-        return std::make_unique<ExceptionsAttribute>();
-    } else if (attrName == "LineNumberTable") {
-        return std::make_unique<LineNumberTableAttribute>();
-    } else if (attrName == "LocalVariableTable") {
-        return std::make_unique<LocalVariableTableAttribute>();
-    } else if (attrName == "SourceFile") {
-        return std::make_unique<SourceFileAttribute>(cp);
-    } else if (attrName == "Synthetic") {
-        return std::make_unique<SyntheticAttribute>();
-    } else {
-        return std::make_unique<UnparsedAttribute>(attrName, attrLen);
+    switch (kind) {
+        case AttributeKind::CODE:
+            return std::make_unique<CodeAttribute>(cp);
+        case AttributeKind::CONSTANT_VALUE:
+            return std::make_unique<ConstantValueAttribute>();
+        case AttributeKind::DEPRECATED:
+            return std::make_unique<DeprecatedAttribute>();
+        case AttributeKind::EXCEPTIONS:
+            return std::make_unique<ExceptionsAttribute>();
+        case AttributeKind::LINE_NUMBER_TABLE:
+            return std::make_unique<LineNumberTableAttribute>();
+        case AttributeKind::LOCAL_VARIABLE_TABLE:
+            return std::make_unique<LocalVariableTableAttribute>();
+        case AttributeKind::SOURCE_FILE:
+            return std::make_unique<SourceFileAttribute>(cp);
+        case AttributeKind::SYNTHETIC:
+            return std::make_unique<SyntheticAttribute>();
+        case AttributeKind::STACK_MAP_TABLE:
+            return std::make_unique<StackMapTableAttribute>();
+        default:
+            // 只有未解析的属性才需要把名字拷贝出来
+            return std::make_unique<UnparsedAttribute>(cp.get_utf8(attrNameIndex), attrLen);
     }
 }
 
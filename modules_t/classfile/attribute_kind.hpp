@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace jvm {
+namespace classfile {
+
+// 属性类型，由属性名解析得到
+enum class AttributeKind : uint8_t {
+    UNRESOLVED = 0,     // 常量池缓存中尚未解析
+    INVALID,            // 名字索引不是合法的Utf8常量
+    UNPARSED,           // 未知或暂不解析的属性
+    CODE,
+    CONSTANT_VALUE,
+    DEPRECATED,
+    EXCEPTIONS,
+    LINE_NUMBER_TABLE,
+    LOCAL_VARIABLE_TABLE,
+    SOURCE_FILE,
+    SYNTHETIC,
+    STACK_MAP_TABLE,
+    BOOTSTRAP_METHODS,
+    INNER_CLASSES,
+    ENCLOSING_METHOD,
+    SIGNATURE,
+    SOURCE_DEBUG_EXTENSION,
+    LOCAL_VARIABLE_TYPE_TABLE,
+    RUNTIME_VISIBLE_ANNOTATIONS,
+    RUNTIME_INVISIBLE_ANNOTATIONS,
+    RUNTIME_VISIBLE_PARAMETER_ANNOTATIONS,
+    RUNTIME_INVISIBLE_PARAMETER_ANNOTATIONS,
+    RUNTIME_VISIBLE_TYPE_ANNOTATIONS,
+    RUNTIME_INVISIBLE_TYPE_ANNOTATIONS,
+    ANNOTATION_DEFAULT,
+    METHOD_PARAMETERS,
+    MODULE,
+    MODULE_PACKAGES,
+    MODULE_MAIN_CLASS,
+    NEST_HOST,
+    NEST_MEMBERS,
+    RECORD,
+    PERMITTED_SUBCLASSES,
+};
+
+namespace detail {
+
+struct AttributeNameSlot {
+    const char* name;
+    size_t len;
+    AttributeKind kind;
+};
+
+constexpr size_t ATTRIBUTE_NAME_TABLE_SIZE = 64;
+
+// 哈希只看长度、首字符、中间字符和末字符
+constexpr size_t attribute_name_hash(const char* name, size_t len) noexcept {
+    if (len == 0) return 0;
+    return (len * 60
+            + static_cast<uint8_t>(name[0]) * 17
+            + static_cast<uint8_t>(name[len / 2]) * 3
+            + static_cast<uint8_t>(name[len - 1])) & (ATTRIBUTE_NAME_TABLE_SIZE - 1);
+}
+
+constexpr size_t const_strlen(const char* s) noexcept {
+    size_t n = 0;
+    while (s[n] != '\0') ++n;
+    return n;
+}
+
+constexpr AttributeNameSlot KNOWN_ATTRIBUTE_NAMES[] = {
+    {"Code", 0, AttributeKind::CODE},
+    {"ConstantValue", 0, AttributeKind::CONSTANT_VALUE},
+    {"Deprecated", 0, AttributeKind::DEPRECATED},
+    {"Exceptions", 0, AttributeKind::EXCEPTIONS},
+    {"LineNumberTable", 0, AttributeKind::LINE_NUMBER_TABLE},
+    {"LocalVariableTable", 0, AttributeKind::LOCAL_VARIABLE_TABLE},
+    {"SourceFile", 0, AttributeKind::SOURCE_FILE},
+    {"Synthetic", 0, AttributeKind::SYNTHETIC},
+    {"StackMapTable", 0, AttributeKind::STACK_MAP_TABLE},
+    {"BootstrapMethods", 0, AttributeKind::BOOTSTRAP_METHODS},
+    {"InnerClasses", 0, AttributeKind::INNER_CLASSES},
+    {"EnclosingMethod", 0, AttributeKind::ENCLOSING_METHOD},
+    {"Signature", 0, AttributeKind::SIGNATURE},
+    {"SourceDebugExtension", 0, AttributeKind::SOURCE_DEBUG_EXTENSION},
+    {"LocalVariableTypeTable", 0, AttributeKind::LOCAL_VARIABLE_TYPE_TABLE},
+    {"RuntimeVisibleAnnotations", 0, AttributeKind::RUNTIME_VISIBLE_ANNOTATIONS},
+    {"RuntimeInvisibleAnnotations", 0, AttributeKind::RUNTIME_INVISIBLE_ANNOTATIONS},
+    {"RuntimeVisibleParameterAnnotations", 0, AttributeKind::RUNTIME_VISIBLE_PARAMETER_ANNOTATIONS},
+    {"RuntimeInvisibleParameterAnnotations", 0, AttributeKind::RUNTIME_INVISIBLE_PARAMETER_ANNOTATIONS},
+    {"RuntimeVisibleTypeAnnotations", 0, AttributeKind::RUNTIME_VISIBLE_TYPE_ANNOTATIONS},
+    {"RuntimeInvisibleTypeAnnotations", 0, AttributeKind::RUNTIME_INVISIBLE_TYPE_ANNOTATIONS},
+    {"AnnotationDefault", 0, AttributeKind::ANNOTATION_DEFAULT},
+    {"MethodParameters", 0, AttributeKind::METHOD_PARAMETERS},
+    {"Module", 0, AttributeKind::MODULE},
+    {"ModulePackages", 0, AttributeKind::MODULE_PACKAGES},
+    {"ModuleMainClass", 0, AttributeKind::MODULE_MAIN_CLASS},
+    {"NestHost", 0, AttributeKind::NEST_HOST},
+    {"NestMembers", 0, AttributeKind::NEST_MEMBERS},
+    {"Record", 0, AttributeKind::RECORD},
+    {"PermittedSubclasses", 0, AttributeKind::PERMITTED_SUBCLASSES},
+};
+
+constexpr bool attribute_names_collision_free() noexcept {
+    bool used[ATTRIBUTE_NAME_TABLE_SIZE] = {};
+    for (const AttributeNameSlot& e : KNOWN_ATTRIBUTE_NAMES) {
+        size_t h = attribute_name_hash(e.name, const_strlen(e.name));
+        if (used[h]) return false;
+        used[h] = true;
+    }
+    return true;
+}
+
+static_assert(attribute_names_collision_free(),
+              "attribute name hash has collisions, adjust the hash coefficients");
+
+constexpr std::array<AttributeNameSlot, ATTRIBUTE_NAME_TABLE_SIZE> build_attribute_name_table() noexcept {
+    std::array<AttributeNameSlot, ATTRIBUTE_NAME_TABLE_SIZE> table{};
+    for (const AttributeNameSlot& e : KNOWN_ATTRIBUTE_NAMES) {
+        size_t len = const_strlen(e.name);
+        table[attribute_name_hash(e.name, len)] = AttributeNameSlot{e.name, len, e.kind};
+    }
+    return table;
+}
+
+constexpr std::array<AttributeNameSlot, ATTRIBUTE_NAME_TABLE_SIZE> ATTRIBUTE_NAME_TABLE = build_attribute_name_table();
+
+} // namespace detail
+
+// 已知属性名的编译期完美哈希查找：已知属性名之间没有冲突（由static_assert保证），
+// 所以一次哈希 + 一次比较即可确定类型，不在表中的返回UNPARSED
+inline AttributeKind lookupAttributeKind(const char* name, size_t len) noexcept {
+    const detail::AttributeNameSlot& slot =
+        detail::ATTRIBUTE_NAME_TABLE[detail::attribute_name_hash(name, len)];
+    if (slot.len == len && len != 0 && std::memcmp(slot.name, name, len) == 0) {
+        return slot.kind;
+    }
+    return AttributeKind::UNPARSED;
+}
+
+} // namespace classfile
+} // namespace jvm
@@ -1,32 +1,81 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
 
 #include "class_reader.hpp"
+#include "class_format_error.hpp"
+#include "class_visitor.hpp"
 
 #include "constant_pool.h"
+#include "constant_info.hpp"
 #include "member_info.h"
+#include "member_table.hpp"
+#include "parse_cache.hpp"
 
 
 namespace jvm {
 namespace classfile {
 
+class ClassFile;
+class ClassFileBuilder;
+
+// 解析结果：成功时class_file非空，失败时error记录错误类型和字节偏移
+struct ParseResult {
+    std::shared_ptr<ClassFile> class_file;
+    ClassFormatError error;
+
+    explicit operator bool() const noexcept { return class_file != nullptr; }
+};
+
 class ClassFile {
 public:
-    // 静态工厂方法，解析类文件数据
+    // 不抛异常的解析入口，适合批量扫描（大量畸形文件时不付出异常展开的代价）
+    // 注意：内存分配失败(std::bad_alloc)不属于类格式错误，会直接终止程序
+    static ParseResult try_parse(const uint8_t* data, size_t size) noexcept {
+        return try_parse(data, size, ParseCache::key(data, size));
+    }
+
+    static ParseResult try_parse(const std::vector<uint8_t>& class_data) noexcept {
+        return try_parse(class_data.data(), class_data.size());
+    }
+
+    // 先按内容哈希查磁盘缓存，命中时从缓存条目恢复（见read_cache_entry）；未命中则完整解析并回填缓存。
+    // 解析失败的结果同样会被缓存，重复扫描畸形文件时直接返回错误
+    static ParseResult try_parse_cached(const uint8_t* data, size_t size, const ParseCache& cache) noexcept {
+        uint64_t key = ParseCache::key(data, size);
+        std::string blob;
+        if (cache.load(key, blob)) {
+            if (std::optional<ParseResult> cached = read_cache_entry(blob, data, size)) {
+                if (cached->class_file) {
+                    cached->class_file->_content_hash = key;
+                }
+                return std::move(*cached);
+            }
+            LOG(WARNING, "Parse cache entry %016llx is stale, reparsing", static_cast<unsigned long long>(key));
+        }
+
+        ParseResult result = try_parse(data, size, key);
+        cache.store(key, make_cache_entry(data, size, result));
+        return result;
+    }
+
+    // 静态工厂方法，解析类文件数据（原有接口，包装try_parse；安装了ParseCache时走缓存）
     static std::tuple<std::shared_ptr<ClassFile>, bool> parse(const std::vector<uint8_t>& class_data) {
-        try {
-            ClassReader reader(class_data);
-            auto cf = std::make_shared<ClassFile>();
-            cf->read(reader);
-            return std::make_tuple(cf, true);
-        } catch (const std::exception& e) {
-            LOG(ERROR, "Parse class file failed: %s", e.what());
+        ParseCache* p_cache = ParseCache::instance();
+        ParseResult result = p_cache ? try_parse_cached(class_data.data(), class_data.size(), *p_cache)
+                                     : try_parse(class_data);
+        if (!result) {
+            LOG(ERROR, "Parse class file failed: %s (at offset %zu)",
+                result.error.message(), result.error.offset);
             return std::make_tuple(nullptr, false);
         }
+        return std::make_tuple(result.class_file, true);
     }
 
     // Getters
@@ -36,16 +85,43 @@ public:
     uint16_t access_flags() const { return _access_flags; }
     const std::vector<std::unique_ptr<MemberInfo>>& fields() const { return _fields; }
     const std::vector<std::unique_ptr<MemberInfo>>& methods() const { return _methods; }
+    // 类文件内容的XXH64哈希（与解析缓存的键相同），验证结果按它缓存
+    uint64_t content_hash() const { return _content_hash; }
     
     // 获取类名、父类名和接口名
     std::string class_name() const;
     std::string super_class_name() const;
     std::vector<std::string> interface_names() const;
 
+    // 链接：建立字段和方法的哈希查找表，只执行一次，可以多线程并发调用
+    void link() const;
+
+    // 按名字和描述符查找成员，找不到返回nullptr；未链接时先链接
+    const MemberInfo* find_field(Symbol name, Symbol descriptor) const;
+    const MemberInfo* find_method(Symbol name, Symbol descriptor) const;
+    const MemberInfo* find_field(std::string_view name, std::string_view descriptor) const {
+        link(); // 链接后表里的名字都已驻留，没驻留过的名字一定查不到
+        return find_field(Symbol::lookup(name), Symbol::lookup(descriptor));
+    }
+    const MemberInfo* find_method(std::string_view name, std::string_view descriptor) const {
+        link(); // 链接后表里的名字都已驻留，没驻留过的名字一定查不到
+        return find_method(Symbol::lookup(name), Symbol::lookup(descriptor));
+    }
+
 private:
-    void read(ClassReader& reader);
-    void read_and_check_magic(ClassReader& reader);
-    void read_and_check_version(ClassReader& reader);
+    // 解析缓存条目格式版本，解析器接受/拒绝的规则变化时必须递增，使旧条目失效
+    static const uint32_t CACHE_MAGIC = 0x4D4A5043;     // "MJPC"
+    static const uint16_t CACHE_FORMAT_VERSION = 4;
+
+    static ParseResult try_parse(const uint8_t* data, size_t size, uint64_t content_hash) noexcept;
+
+    static std::string make_cache_entry(const uint8_t* data, size_t size, const ParseResult& result);
+    static std::optional<ParseResult> read_cache_entry(const std::string& blob, const uint8_t* data, size_t size);
+    static bool replay_cache_entry(ClassReader& cached, ClassFileBuilder& builder);
+
+    bool check_version() const;
+
+    friend class ClassFileBuilder;
 
 private:
     uint16_t _minor_version;
@@ -58,81 +134,373 @@ private:
     std::vector<std::unique_ptr<MemberInfo>> _fields;
     std::vector<std::unique_ptr<MemberInfo>> _methods;
     std::vector<std::unique_ptr<AttributeInfo>> _attributes;
+    uint64_t _content_hash = 0;
+
+    mutable std::once_flag _link_once;
+    mutable MemberTable _field_table;
+    mutable MemberTable _method_table;
 };
 
 
-void ClassFile::read(ClassReader& reader)
+inline bool ClassFile::check_version() const
 {
-    read_and_check_magic(reader);
-    read_and_check_version(reader);
-    _constant_pool = ConstantPool::read_constant_pool(reader);
-    LOG(INFO, "constant pool count: %d", _constant_pool->size());
+    switch (_major_version) {
+        case 45:
+            return true;
+        case 46:
+        case 47:
+        case 48:
+        case 49:
+        case 50:
+        case 51:
+        case 52:
+        case 53:
+        case 54:
+        case 55:
+        case 56:
+        case 57:
+        case 58:
+        case 59:
+        case 60:
+        case 61:
+        case 62:
+        case 63:
+        case 64:
+        case 65:
+            // 56起minor_version为65535表示启用预览特性，这里不支持
+            if (_minor_version == 0) {
+                return true;
+            }
+    }
+    return false;
+}
+
+// ClassFile是ClassScanner的一个使用者：扫描器负责结构解码，
+// 这里把回调组装成对象图（常量项、成员和属性）
+class ClassFileBuilder : public ClassVisitor {
+public:
+    ClassFileBuilder(ClassFile& cf, const uint8_t* data, size_t size)
+        : _cf(cf), _data(data), _size(size) {}
+
+    const ClassFormatError& error() const { return _error; }
+
+    bool visitHeader(uint16_t minor_version, uint16_t major_version, uint16_t constant_pool_count) override {
+        LOG(INFO, "version: %d.%d", major_version, minor_version);
+        _cf._minor_version = minor_version;
+        _cf._major_version = major_version;
+        if (!_cf.check_version()) {
+            LOG(ERROR, "Unsupported class version: %d.%d", major_version, minor_version);
+            return fail(ClassFormatErrorKind::UNSUPPORTED_VERSION, 4);
+        }
+        _cf._constant_pool = ConstantPool::create(constant_pool_count);
+        return true;
+    }
 
-    _access_flags = reader.read_uint16();
-    LOG(INFO, "access flags: 0x%X", _access_flags);
+    bool visitConstant(uint16_t index, const ConstantView& constant) override {
+        ClassReader reader = reader_at(constant.offset);
+        std::shared_ptr<ConstantInfo> info = read_constant_info(reader, _cf._constant_pool);
+        if (reader.failed()) return fail(reader.error());
+        _cf._constant_pool->set_constant_info(index, std::move(info));
+        return true;
+    }
 
-    _this_class = reader.read_uint16();
-    LOG(INFO, "this class: %d", _this_class);
+    bool visitConstantPool(const ConstantPoolView& pool) override {
+        LOG(INFO, "constant pool count: %d", pool.count());
+        return true;
+    }
 
-    _super_class = reader.read_uint16();
-    LOG(INFO, "super class: %d", _super_class);
+    // 解析缓存命中时代替逐项的visitConstant：常量项从缓存条目读入，Utf8已是解码后的形式
+    bool restoreConstants(ClassReader& cached) {
+        ConstantPool::read_constants(cached, _cf._constant_pool, true);
+        if (cached.failed()) return fail(cached.error());
+        return true;
+    }
 
-    _interfaces = reader.read_uint16s();
-    LOG(INFO, "interfaces count: %ld", _interfaces.size());
+    bool visitClass(uint16_t access_flags, uint16_t this_class, uint16_t super_class, uint16_t interfaces_count) override {
+        LOG(INFO, "access flags: 0x%X, this class: %d, super class: %d, interfaces count: %d",
+            access_flags, this_class, super_class, interfaces_count);
+        _cf._access_flags = access_flags;
+        _cf._this_class = this_class;
+        _cf._super_class = super_class;
+        _cf._interfaces.reserve(interfaces_count);
+        return true;
+    }
 
-    _fields = MemberInfo::read_members(reader, (*_constant_pool));
-    LOG(INFO, "fields count: %ld", _fields.size());
+    bool visitInterface(uint16_t class_index) override {
+        _cf._interfaces.push_back(class_index);
+        return true;
+    }
 
-    _methods = MemberInfo::read_members(reader, (*_constant_pool));
-    LOG(INFO, "methods count: %ld", _methods.size());
-    
-    _attributes = readAttributes(&reader, (*_constant_pool));
-    LOG(INFO, "attributes count: %ld", _attributes.size());
+    bool visitMember(MemberKind kind, uint16_t access_flags, uint16_t name_index, uint16_t descriptor_index) override {
+        _member_kind = kind;
+        _member_access_flags = access_flags;
+        _member_name_index = name_index;
+        _member_descriptor_index = descriptor_index;
+        return true;
+    }
+
+    // 属性表整体交给readAttributes解析（它负责Code及其子属性），Code内部的属性表不再重复处理
+    bool visitAttributes(AttributeOwner owner, size_t offset) override {
+        if (owner == AttributeOwner::CODE) return true;
+
+        ClassReader reader = reader_at(offset);
+        ConstantPool& cp = *_cf._constant_pool;
+        std::vector<std::unique_ptr<AttributeInfo>> attributes = readAttributes(&reader, cp);
+        if (reader.failed()) return fail(reader.error());
+
+        if (owner == AttributeOwner::CLASS) {
+            LOG(INFO, "attributes count: %ld", attributes.size());
+            _cf._attributes = std::move(attributes);
+            return true;
+        }
+        auto& members = _member_kind == MemberKind::FIELD ? _cf._fields : _cf._methods;
+        members.push_back(std::make_unique<MemberInfo>(
+            cp, _member_access_flags, _member_name_index, _member_descriptor_index, std::move(attributes)));
+        return true;
+    }
+
+    void visitEnd() override {
+        LOG(INFO, "fields count: %ld, methods count: %ld", _cf._fields.size(), _cf._methods.size());
+    }
+
+private:
+    ClassReader reader_at(size_t offset) const {
+        ClassReader reader(_data, _size);
+        reader.skip(static_cast<uint32_t>(offset));
+        return reader;
+    }
+
+    bool fail(ClassFormatErrorKind kind, size_t offset) {
+        _error.kind = kind;
+        _error.offset = offset;
+        return false;
+    }
+
+    bool fail(const ClassFormatError& error) {
+        _error = error;
+        return false;
+    }
+
+    ClassFile& _cf;
+    const uint8_t* _data;
+    size_t _size;
+    ClassFormatError _error;
+
+    MemberKind _member_kind = MemberKind::FIELD;
+    uint16_t _member_access_flags = 0;
+    uint16_t _member_name_index = 0;
+    uint16_t _member_descriptor_index = 0;
+};
+
+// 解析成功后再扫描一遍类文件，写出缓存条目的成功部分（格式见make_cache_entry）：
+// 常量池换成解码后的形式，之后记下回调的顺序和参数，属性表只记位置
+class ParseCacheWriter : public ClassVisitor {
+public:
+    ParseCacheWriter(const ConstantPool& cp, std::string& blob) : _cp(cp), _blob(blob) {}
+
+    bool visitHeader(uint16_t minor_version, uint16_t major_version, uint16_t constant_pool_count) override {
+        put_uint16(_blob, minor_version);
+        put_uint16(_blob, major_version);
+        put_uint16(_blob, constant_pool_count);
+        return true;
+    }
+
+    bool visitConstant(uint16_t index, const ConstantView& constant) override {
+        put_uint8(_blob, constant.tag);
+        if (constant.tag == static_cast<uint8_t>(CONSTANT_TAG::UTF8)) {
+            const std::string& str = *_cp.find_utf8(index);
+            put_uint32(_blob, static_cast<uint32_t>(str.size()));
+            _blob.append(str);
+        } else {
+            _blob.append(reinterpret_cast<const char*>(constant.data), constant.size);
+        }
+        return true;
+    }
+
+    bool visitClass(uint16_t access_flags, uint16_t this_class, uint16_t super_class, uint16_t interfaces_count) override {
+        put_uint16(_blob, access_flags);
+        put_uint16(_blob, this_class);
+        put_uint16(_blob, super_class);
+        put_uint16(_blob, interfaces_count);
+        return true;
+    }
+
+    bool visitInterface(uint16_t class_index) override {
+        put_uint16(_blob, class_index);
+        return true;
+    }
+
+    bool visitMember(MemberKind /*kind*/, uint16_t access_flags, uint16_t name_index, uint16_t descriptor_index) override {
+        _member_access_flags = access_flags;
+        _member_name_index = name_index;
+        _member_descriptor_index = descriptor_index;
+        return true;
+    }
+
+    bool visitAttributes(AttributeOwner owner, size_t offset) override {
+        if (owner == AttributeOwner::CODE) return true;
+        put_uint8(_blob, static_cast<uint8_t>(owner));
+        if (owner != AttributeOwner::CLASS) {
+            put_uint16(_blob, _member_access_flags);
+            put_uint16(_blob, _member_name_index);
+            put_uint16(_blob, _member_descriptor_index);
+        }
+        put_uint32(_blob, static_cast<uint32_t>(offset));
+        return true;
+    }
+
+private:
+    const ConstantPool& _cp;
+    std::string& _blob;
+
+    uint16_t _member_access_flags = 0;
+    uint16_t _member_name_index = 0;
+    uint16_t _member_descriptor_index = 0;
+};
+
+// 扫描器只检查结构，版本和各项内容的错误由builder发现并停止扫描，builder的错误优先
+inline ParseResult ClassFile::try_parse(const uint8_t* data, size_t size, uint64_t content_hash) noexcept
+{
+    auto cf = std::make_shared<ClassFile>();
+    ClassFileBuilder builder(*cf, data, size);
+    ClassFormatError error = ClassScanner::scan(data, size, builder);
+    if (builder.error()) {
+        return ParseResult{nullptr, builder.error()};
+    }
+    if (error) {
+        return ParseResult{nullptr, error};
+    }
+    cf->_content_hash = content_hash;
+    return ParseResult{std::move(cf), ClassFormatError{}};
 }
 
+// 缓存条目布局（大端）：
+//   u4 magic, u2 format_version, u4 source_size, u1 status
+//   status == 1(失败): u1 error_kind, u4 error_offset
+//   status == 0(成功): u2 minor, u2 major, u2 cp_count, 常量池项...,
+//                      u2 access_flags, u2 this_class, u2 super_class, u2 interfaces_count, u2 interfaces...,
+//                      属性表记录...
+// 常量池中Utf8项以 tag, u4 length, 标准UTF-8字节 的已解码形式存放，其余常量与类文件格式相同。
+// 属性表记录按类文件顺序：字段和方法的是 u1 owner, u2 access_flags, u2 name_index, u2 descriptor_index,
+// u4 属性表在类文件中的偏移；最后一条是类的 u1 owner(CLASS), u4 偏移
+inline std::string ClassFile::make_cache_entry(const uint8_t* data, size_t size, const ParseResult& result)
+{
+    std::string blob;
+    put_uint32(blob, CACHE_MAGIC);
+    put_uint16(blob, CACHE_FORMAT_VERSION);
+    put_uint32(blob, static_cast<uint32_t>(size));
+    if (!result) {
+        put_uint8(blob, 1);
+        put_uint8(blob, static_cast<uint8_t>(result.error.kind));
+        put_uint32(blob, static_cast<uint32_t>(result.error.offset));
+        return blob;
+    }
+
+    blob.reserve(size);
+    put_uint8(blob, 0);
+    ParseCacheWriter writer(*result.class_file->_constant_pool, blob);
+    ClassScanner::scan(data, size, writer);
+    return blob;
+}
 
-void ClassFile::read_and_check_magic(ClassReader& reader)
+// 命中时走和完整解析相同的ClassFileBuilder：按记录的顺序重放扫描回调，常量池直接从条目读入，
+// 字段、方法和类的属性表仍由builder从类文件字节（data）解析，省去的是结构扫描和常量池解码。
+// 条目与当前格式不符或源长度不一致时返回空，调用者应重新解析
+inline std::optional<ParseResult> ClassFile::read_cache_entry(const std::string& blob, const uint8_t* data, size_t size)
 {
-    uint32_t magic = reader.read_uint32();
-    LOG(INFO, "magic: 0x%X", magic);
-    if (magic != 0xCAFEBABE)
-    {
-        LOG(ERROR, "Invalid class file magic number: 0x%X", magic);
-        throw std::runtime_error("java.lang.ClassFormatError: magic!");
+    ClassReader reader(reinterpret_cast<const uint8_t*>(blob.data()), blob.size());
+    if (reader.read_uint32() != CACHE_MAGIC ||
+        reader.read_uint16() != CACHE_FORMAT_VERSION ||
+        reader.read_uint32() != size) {
+        return std::nullopt;
     }
+
+    uint8_t status = reader.read_uint8();
+    if (status == 1) {
+        ClassFormatError error;
+        error.kind = static_cast<ClassFormatErrorKind>(reader.read_uint8());
+        error.offset = reader.read_uint32();
+        if (reader.failed()) return std::nullopt;
+        return ParseResult{nullptr, error};
+    }
+
+    auto cf = std::make_shared<ClassFile>();
+    ClassFileBuilder builder(*cf, data, size);
+    if (status != 0 || !replay_cache_entry(reader, builder) || reader.remaining() != 0) {
+        return std::nullopt;
+    }
+    return ParseResult{std::move(cf), ClassFormatError{}};
 }
 
-void ClassFile::read_and_check_version(ClassReader& reader)
+inline bool ClassFile::replay_cache_entry(ClassReader& cached, ClassFileBuilder& builder)
 {
-    _minor_version = reader.read_uint16();
-    _major_version = reader.read_uint16();
-    LOG(INFO, "version: %d.%d", _major_version, _minor_version);
-    
-    switch (_major_version) {
-        case 45:
-            return;
-        case 46:
-        case 47:
-        case 48:
-        case 49:
-        case 50:
-        case 51:
-        case 52:
-            if (_minor_version == 0) {
-                return;
+    uint16_t minor_version = cached.read_uint16();
+    uint16_t major_version = cached.read_uint16();
+    uint16_t cp_count = cached.read_uint16();
+    if (cached.failed() || !builder.visitHeader(minor_version, major_version, cp_count) ||
+        !builder.restoreConstants(cached)) {
+        return false;
+    }
+
+    uint16_t access_flags = cached.read_uint16();
+    uint16_t this_class = cached.read_uint16();
+    uint16_t super_class = cached.read_uint16();
+    uint16_t interfaces_count = cached.read_uint16();
+    if (cached.failed() || !builder.visitClass(access_flags, this_class, super_class, interfaces_count)) {
+        return false;
+    }
+    for (uint16_t i = 0; i < interfaces_count; i++) {
+        uint16_t class_index = cached.read_uint16();
+        if (cached.failed() || !builder.visitInterface(class_index)) return false;
+    }
+
+    for (;;) {
+        AttributeOwner owner = static_cast<AttributeOwner>(cached.read_uint8());
+        if (owner == AttributeOwner::FIELD || owner == AttributeOwner::METHOD) {
+            MemberKind kind = owner == AttributeOwner::FIELD ? MemberKind::FIELD : MemberKind::METHOD;
+            uint16_t member_access_flags = cached.read_uint16();
+            uint16_t name_index = cached.read_uint16();
+            uint16_t descriptor_index = cached.read_uint16();
+            if (cached.failed() || !builder.visitMember(kind, member_access_flags, name_index, descriptor_index)) {
+                return false;
             }
+        } else if (owner != AttributeOwner::CLASS) {
+            return false;
+        }
+        uint32_t offset = cached.read_uint32();
+        if (cached.failed() || !builder.visitAttributes(owner, offset)) return false;
+        if (owner == AttributeOwner::CLASS) break;
     }
-    
-    LOG(ERROR, "Unsupported class version: %d.%d", _major_version, _minor_version);
-    throw std::runtime_error("java.lang.UnsupportedClassVersionError!");
+    builder.visitEnd();
+    return true;
+}
+
+inline void ClassFile::link() const
+{
+    std::call_once(_link_once, [this] {
+        _field_table.build(_fields, *_constant_pool);
+        _method_table.build(_methods, *_constant_pool);
+    });
+}
+
+inline const MemberInfo* ClassFile::find_field(Symbol name, Symbol descriptor) const
+{
+    link();
+    return _field_table.find(name, descriptor);
+}
+
+inline const MemberInfo* ClassFile::find_method(Symbol name, Symbol descriptor) const
+{
+    link();
+    return _method_table.find(name, descriptor);
 }
 
-std::string ClassFile::class_name() const
+inline std::string ClassFile::class_name() const
 {
     return _constant_pool->get_class_name(_this_class);
 }
 
-std::string ClassFile::super_class_name() const
+inline std::string ClassFile::super_class_name() const
 {
     if (_super_class > 0) {
         return _constant_pool->get_class_name(_super_class);
@@ -140,7 +508,7 @@ std::string ClassFile::super_class_name() const
     return "";
 }
 
-std::vector<std::string> ClassFile::interface_names() const
+inline std::vector<std::string> ClassFile::interface_names() const
 {
     std::vector<std::string> names;
     names.reserve(_interfaces.size());
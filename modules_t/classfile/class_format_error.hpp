@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace jvm {
+namespace classfile {
+
+// java.lang.ClassFormatError 的细分类型
+enum class ClassFormatErrorKind : uint8_t {
+    NONE = 0,
+    TRUNCATED,              // 读取越过了数据末尾
+    BAD_MAGIC,              // 魔数不是0xCAFEBABE
+    UNSUPPORTED_VERSION,    // java.lang.UnsupportedClassVersionError
+    BAD_CONSTANT_TAG,       // 未知的常量池tag
+    BAD_CONSTANT_INDEX,     // 常量池索引越界或类型不符
+    BAD_ATTRIBUTE_LENGTH,   // 属性实际长度与attribute_length不一致
+    BAD_STACK_MAP_FRAME,    // StackMapTable中帧类型/验证类型非法或帧偏移越界
+};
+
+// 解析错误：错误类型 + 出错时的字节偏移
+struct ClassFormatError {
+    ClassFormatErrorKind kind = ClassFormatErrorKind::NONE;
+    size_t offset = 0;
+
+    explicit operator bool() const noexcept { return kind != ClassFormatErrorKind::NONE; }
+
+    const char* message() const noexcept {
+        switch (kind) {
+            case ClassFormatErrorKind::NONE:                 return "no error";
+            case ClassFormatErrorKind::TRUNCATED:            return "java.lang.ClassFormatError: truncated class file";
+            case ClassFormatErrorKind::BAD_MAGIC:            return "java.lang.ClassFormatError: magic!";
+            case ClassFormatErrorKind::UNSUPPORTED_VERSION:  return "java.lang.UnsupportedClassVersionError!";
+            case ClassFormatErrorKind::BAD_CONSTANT_TAG:     return "java.lang.ClassFormatError: constant pool tag!";
+            case ClassFormatErrorKind::BAD_CONSTANT_INDEX:   return "java.lang.ClassFormatError: bad constant pool index";
+            case ClassFormatErrorKind::BAD_ATTRIBUTE_LENGTH: return "java.lang.ClassFormatError: bad attribute length";
+            case ClassFormatErrorKind::BAD_STACK_MAP_FRAME:  return "java.lang.ClassFormatError: bad StackMapTable frame";
+        }
+        return "java.lang.ClassFormatError";
+    }
+};
+
+} // namespace classfile
+} // namespace jvm
@@ -3,73 +3,66 @@
 #include <vector>
 // #include "../log.hpp"  // 自定义日志模块（需确保项目中有该头文件）
 #include "../util.hpp"  // 工具类（需确保项目中有该头文件）
+#include "class_format_error.hpp"
 
 namespace jvm {
 namespace classfile {
 
-class ClassReader 
+// 不抛异常的类文件读取器
+// 读取越界时不抛出异常，而是记录第一个错误（类型+偏移）并返回0，之后的读取全部失败。
+// 解析代码只需在循环边界检查failed()提前退出，最后统一取error()。
+// 读取器只是数据的视图，不拷贝数据，调用者需保证数据在读取期间有效。
+class ClassReader
 {
 public:
     // 构造函数，接受字节码数据
-    explicit ClassReader(const std::vector<uint8_t>& data) 
-        : _data(data), _offset(0) {}
+    explicit ClassReader(const std::vector<uint8_t>& data) noexcept
+        : _data(data.data()), _size(data.size()), _offset(0) {}
+
+    ClassReader(const uint8_t* data, size_t size) noexcept
+        : _data(data), _size(size), _offset(0) {}
 
     // 读取单字节 (u1)
-    uint8_t read_uint8() 
+    uint8_t read_uint8() noexcept
     {
-        if (_offset >= _data.size()) 
-        {
-            throw std::out_of_range("ClassReader: Read out of range");
-        }
-        return _data[_offset++]; 
+        if (!ensure(1)) return 0;
+        return _data[_offset++];
     }
-    
+
     // 读取两个字节 (u2)，需要处理大端字节序
-    uint16_t read_uint16() 
+    uint16_t read_uint16() noexcept
     {
-        if( _offset + 1 >= _data.size()) 
-        {
-            throw std::out_of_range("ClassReader: Read out of range");
-        }
+        if (!ensure(2)) return 0;
         uint16_t val = util::util_byte_order::bigToHost16(&_data[_offset]);
         _offset += 2;
         return val;
     }
 
     // 读取四个字节 (u4)，需要处理大端字节序
-    uint32_t read_uint32()
+    uint32_t read_uint32() noexcept
     {
-        if( _offset + 3 >= _data.size()) 
-        {
-            throw std::out_of_range("ClassReader: Read out of range");
-        }
+        if (!ensure(4)) return 0;
         uint32_t val = util::util_byte_order::bigToHost32(&_data[_offset]);
         _offset += 4;
         return val;
     }
-    
+
     // 读取八个字节 (u8)，需要处理大端字节序
-    uint64_t read_uint64() 
+    uint64_t read_uint64() noexcept
     {
-        if( _offset + 7 >= _data.size()) 
-        {
-            throw std::out_of_range("ClassReader: Read out of range");
-        }
+        if (!ensure(8)) return 0;
         uint64_t val = util::util_byte_order::bigToHost64(&_data[_offset]);
         _offset += 8;
         return val;
     }
 
     // 读取uint16数组
-    std::vector<uint16_t> read_uint16s() 
+    std::vector<uint16_t> read_uint16s()
     {
         uint16_t n = read_uint16();
-        if( _offset + n * 2 > _data.size()) 
-        {
-            throw std::out_of_range("ClassReader: Read out of range");
-        }
+        if (!ensure(static_cast<size_t>(n) * 2)) return {};
         std::vector<uint16_t> s(n);
-        for (uint16_t i = 0; i < n; i++) 
+        for (uint16_t i = 0; i < n; i++)
         {
             s[i] = read_uint16();
         }
@@ -77,20 +70,54 @@ public:
     }
 
     // 读取指定长度的字节数组
-    std::vector<uint8_t> read_bytes(uint32_t n) 
+    std::vector<uint8_t> read_bytes(uint32_t n)
     {
-        if( _offset + n > _data.size()) 
-        {
-            throw std::out_of_range("ClassReader: Read out of range");
-        }
-        std::vector<uint8_t> bytes(_data.begin() + _offset,  _data.begin() + _offset + n);
+        if (!ensure(n)) return {};
+        std::vector<uint8_t> bytes(_data + _offset, _data + _offset + n);
         _offset += n;
         return bytes;
     }
 
+    // 跳过n个字节，返回被跳过数据的起始地址（失败返回nullptr），用于零拷贝访问
+    const uint8_t* skip(uint32_t n) noexcept
+    {
+        if (!ensure(n)) return nullptr;
+        const uint8_t* p = _data + _offset;
+        _offset += n;
+        return p;
+    }
+
+    // 在当前偏移处记录一个语义错误（只保留第一个错误）
+    void fail(ClassFormatErrorKind kind) noexcept { fail_at(kind, _offset); }
+
+    void fail_at(ClassFormatErrorKind kind, size_t offset) noexcept
+    {
+        if (!_error) {
+            _error.kind = kind;
+            _error.offset = offset;
+        }
+    }
+
+    bool failed() const noexcept { return static_cast<bool>(_error); }
+    const ClassFormatError& error() const noexcept { return _error; }
+    size_t offset() const noexcept { return _offset; }
+    size_t remaining() const noexcept { return _size - _offset; }
+
 private:
-    std::vector<uint8_t> _data; // 字节码数据
-    size_t _offset;            // 当前读取位置
+    bool ensure(size_t n) noexcept
+    {
+        if (_error) return false;
+        if (n > _size - _offset) {
+            fail(ClassFormatErrorKind::TRUNCATED);
+            return false;
+        }
+        return true;
+    }
+
+    const uint8_t* _data;   // 字节码数据
+    size_t _size;           // 数据长度
+    size_t _offset;         // 当前读取位置
+    ClassFormatError _error;
 };
 
 
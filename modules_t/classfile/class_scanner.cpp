@@ -0,0 +1,194 @@
+
+#include <vector>
+
+#include "class_visitor.hpp"
+#include "class_reader.hpp"
+
+namespace jvm {
+namespace classfile {
+
+namespace {
+
+const uint32_t CLASS_MAGIC = 0xCAFEBABE;
+
+// 一次扫描的状态，所有读取都经过同一个不抛异常的ClassReader
+class Scan {
+public:
+    Scan(const uint8_t* data, size_t size, ClassVisitor& visitor, std::vector<uint32_t>& offsets)
+        : _data(data), _reader(data, size), _visitor(visitor), _offsets(offsets),
+          _pool(data, nullptr, 0) {}
+
+    void run() {
+        uint32_t magic = _reader.read_uint32();
+        if (_reader.failed()) return;
+        if (magic != CLASS_MAGIC) {
+            _reader.fail_at(ClassFormatErrorKind::BAD_MAGIC, 0);
+            return;
+        }
+
+        uint16_t minor_version = _reader.read_uint16();
+        uint16_t major_version = _reader.read_uint16();
+        uint16_t cp_count = _reader.read_uint16();
+        if (_reader.failed() || !_visitor.visitHeader(minor_version, major_version, cp_count)) return;
+
+        if (!constants(cp_count)) return;
+        _pool = ConstantPoolView(_data, _offsets.data(), cp_count);
+        if (!_visitor.visitConstantPool(_pool)) return;
+
+        uint16_t access_flags = _reader.read_uint16();
+        uint16_t this_class = _reader.read_uint16();
+        uint16_t super_class = _reader.read_uint16();
+        uint16_t interfaces_count = _reader.read_uint16();
+        const uint8_t* interfaces = _reader.skip(static_cast<uint32_t>(interfaces_count) * 2);
+        if (interfaces == nullptr ||
+            !_visitor.visitClass(access_flags, this_class, super_class, interfaces_count)) {
+            return;
+        }
+        for (uint16_t i = 0; i < interfaces_count; i++) {
+            if (!_visitor.visitInterface(view_u2(interfaces + 2 * i))) return;
+        }
+
+        if (!members(MemberKind::FIELD) || !members(MemberKind::METHOD)) return;
+        if (!attributes(_reader, AttributeOwner::CLASS)) return;
+        _visitor.visitEnd();
+    }
+
+    const ClassFormatError& error() const { return _reader.error(); }
+
+private:
+    bool constants(uint16_t cp_count) {
+        _offsets.assign(cp_count, 0);
+        for (uint32_t i = 1; i < cp_count; i++) {
+            size_t offset = _reader.offset();
+            uint8_t tag = _reader.read_uint8();
+            int fixed_size = constant_info_size(tag);
+            if (_reader.failed()) return false;
+            if (fixed_size < 0) {
+                _reader.fail_at(ClassFormatErrorKind::BAD_CONSTANT_TAG, offset);
+                return false;
+            }
+
+            uint32_t size = static_cast<uint32_t>(fixed_size);
+            if (fixed_size == 0) {
+                size = 2 + _reader.read_uint16();
+                _reader.skip(size - 2);
+            } else {
+                _reader.skip(size);
+            }
+            if (_reader.failed()) return false;
+
+            _offsets[i] = static_cast<uint32_t>(offset);
+            if (!_visitor.visitConstant(static_cast<uint16_t>(i), ConstantView{tag, _data + offset + 1, size, offset})) {
+                return false;
+            }
+            // long和double占两个索引
+            if (tag == static_cast<uint8_t>(CONSTANT_TAG::LONG) || tag == static_cast<uint8_t>(CONSTANT_TAG::DOUBLE)) {
+                i++;
+            }
+        }
+        return true;
+    }
+
+    bool members(MemberKind kind) {
+        uint16_t count = _reader.read_uint16();
+        AttributeOwner owner = kind == MemberKind::FIELD ? AttributeOwner::FIELD : AttributeOwner::METHOD;
+        for (uint16_t i = 0; i < count; i++) {
+            uint16_t access_flags = _reader.read_uint16();
+            uint16_t name_index = _reader.read_uint16();
+            uint16_t descriptor_index = _reader.read_uint16();
+            if (_reader.failed() || !_visitor.visitMember(kind, access_flags, name_index, descriptor_index)) {
+                return false;
+            }
+            if (!attributes(_reader, owner)) return false;
+        }
+        return !_reader.failed();
+    }
+
+    bool attributes(ClassReader& reader, AttributeOwner owner) {
+        if (!_visitor.visitAttributes(owner, reader.offset())) return false;
+        uint16_t count = reader.read_uint16();
+        for (uint16_t i = 0; i < count && !reader.failed(); i++) {
+            size_t name_offset = reader.offset();
+            uint16_t name_index = reader.read_uint16();
+            uint32_t length = reader.read_uint32();
+            if (reader.failed()) break;
+            if (_pool.tag(name_index) != static_cast<uint8_t>(CONSTANT_TAG::UTF8)) {
+                reader.fail_at(ClassFormatErrorKind::BAD_CONSTANT_INDEX, name_offset);
+                break;
+            }
+            std::string_view name = _pool.utf8(name_index);
+            AttributeKind kind = lookupAttributeKind(name.data(), name.size());
+
+            size_t info_offset = reader.offset();
+            const uint8_t* info = reader.skip(length);
+            if (info == nullptr) break;
+            if (!_visitor.visitAttribute(owner, kind, name_index, info, length)) return false;
+            if (kind == AttributeKind::CODE && owner == AttributeOwner::METHOD &&
+                !code(reader, info_offset, length, name_offset)) {
+                return false;
+            }
+        }
+        return !reader.failed();
+    }
+
+    // Code属性内部用一个只看得到该属性范围的读取器，内容超出attribute_length即是长度错误
+    bool code(ClassReader& outer, size_t info_offset, uint32_t length, size_t name_offset) {
+        ClassReader reader(_data, info_offset + length);
+        reader.skip(static_cast<uint32_t>(info_offset));
+        uint16_t max_stack = reader.read_uint16();
+        uint16_t max_locals = reader.read_uint16();
+        uint32_t code_length = reader.read_uint32();
+        const uint8_t* code = reader.skip(code_length);
+        uint16_t exception_table_length = reader.read_uint16();
+        const uint8_t* exception_table = reader.skip(static_cast<uint32_t>(exception_table_length) * 8);
+        if (reader.failed()) {
+            outer.fail_at(ClassFormatErrorKind::BAD_ATTRIBUTE_LENGTH, name_offset);
+            return false;
+        }
+        if (!_visitor.visitCode(max_stack, max_locals, code, code_length, exception_table, exception_table_length)) {
+            return false;
+        }
+        if (!attributes(reader, AttributeOwner::CODE)) {
+            if (reader.error().kind == ClassFormatErrorKind::TRUNCATED) {
+                outer.fail_at(ClassFormatErrorKind::BAD_ATTRIBUTE_LENGTH, name_offset);
+            } else if (reader.failed()) {
+                outer.fail_at(reader.error().kind, reader.error().offset);
+            }
+            return false;
+        }
+        if (reader.remaining() != 0) {
+            outer.fail_at(ClassFormatErrorKind::BAD_ATTRIBUTE_LENGTH, name_offset);
+            return false;
+        }
+        return true;
+    }
+
+    const uint8_t* _data;
+    ClassReader _reader;
+    ClassVisitor& _visitor;
+    std::vector<uint32_t>& _offsets;
+    ConstantPoolView _pool;
+};
+
+} // namespace
+
+ClassFormatError ClassScanner::scan(const uint8_t* data, size_t size, ClassVisitor& visitor) noexcept {
+    // 常量池偏移表按线程复用，稳定状态下扫描不分配内存；
+    // visitor在回调里嵌套扫描别的类时改用局部缓冲
+    static thread_local std::vector<uint32_t> t_offsets;
+    static thread_local bool t_in_use = false;
+
+    std::vector<uint32_t> nested_offsets;
+    bool nested = t_in_use;
+    std::vector<uint32_t>& offsets = nested ? nested_offsets : t_offsets;
+    t_in_use = true;
+
+    Scan scan(data, size, visitor, offsets);
+    scan.run();
+
+    t_in_use = nested;
+    return scan.error();
+}
+
+} // namespace classfile
+} // namespace jvm
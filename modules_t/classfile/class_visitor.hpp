@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "attribute_kind.hpp"
+#include "class_format_error.hpp"
+#include "constant_tag.hpp"
+
+namespace jvm {
+namespace classfile {
+
+// 流式（SAX风格）类文件接口
+// ClassScanner直接在类文件字节上解码，按文件顺序回调ClassVisitor，不构建对象图、不分配内存
+// （常量池偏移表用线程局部缓冲复用）。回调中拿到的字符串和字节都是类文件数据的视图，
+// 只在扫描期间有效；字符串是原始的MUTF-8字节，需要标准UTF-8时用util_mutf8::decode。
+
+enum class MemberKind : uint8_t {
+    FIELD,
+    METHOD,
+};
+
+// 属性表的宿主
+enum class AttributeOwner : uint8_t {
+    CLASS,
+    FIELD,
+    METHOD,
+    CODE,
+};
+
+inline uint16_t view_u2(const uint8_t* p) { return static_cast<uint16_t>((p[0] << 8) | p[1]); }
+
+// 常量池项视图：tag + 紧跟在tag之后的原始字节
+struct ConstantView {
+    uint8_t tag;
+    const uint8_t* data;    // 不含tag，Utf8常量包含u2长度
+    uint32_t size;          // data的字节数
+    size_t offset;          // tag在类文件中的偏移
+
+    uint16_t u2(size_t at) const { return view_u2(data + at); }
+    uint32_t u4(size_t at) const { return (static_cast<uint32_t>(u2(at)) << 16) | u2(at + 2); }
+
+    // Utf8常量的内容（原始MUTF-8，不含长度）
+    std::string_view utf8() const {
+        return std::string_view(reinterpret_cast<const char*>(data) + 2, size - 2);
+    }
+};
+
+// 扫描完成的常量池的索引视图，解析索引引用时用，所有查找都是O(1)的
+// 索引无效或类型不符时返回空视图/false
+class ConstantPoolView {
+public:
+    ConstantPoolView(const uint8_t* data, const uint32_t* offsets, uint16_t count)
+        : _data(data), _offsets(offsets), _count(count) {}
+
+    uint16_t count() const { return _count; }
+
+    // 不存在的索引（0、越界、long/double的第二个槽位）返回0
+    uint8_t tag(uint16_t index) const {
+        return (index == 0 || index >= _count || _offsets[index] == 0) ? 0 : _data[_offsets[index]];
+    }
+
+    std::string_view utf8(uint16_t index) const {
+        if (tag(index) != static_cast<uint8_t>(CONSTANT_TAG::UTF8)) return {};
+        const uint8_t* p = _data + _offsets[index] + 1;
+        return std::string_view(reinterpret_cast<const char*>(p) + 2, view_u2(p));
+    }
+
+    // Class常量的名字（数组类为描述符）
+    std::string_view class_name(uint16_t index) const {
+        if (tag(index) != static_cast<uint8_t>(CONSTANT_TAG::CLASS)) return {};
+        return utf8(view_u2(_data + _offsets[index] + 1));
+    }
+
+    bool name_and_type(uint16_t index, std::string_view& name, std::string_view& descriptor) const {
+        if (tag(index) != static_cast<uint8_t>(CONSTANT_TAG::NAME_AND_TYPE)) return false;
+        const uint8_t* p = _data + _offsets[index] + 1;
+        name = utf8(view_u2(p));
+        descriptor = utf8(view_u2(p + 2));
+        return !name.empty() && !descriptor.empty();
+    }
+
+    // Fieldref/Methodref/InterfaceMethodref
+    bool member_ref(uint16_t index, std::string_view& class_name_out,
+                    std::string_view& name, std::string_view& descriptor) const {
+        uint8_t t = tag(index);
+        if (t != static_cast<uint8_t>(CONSTANT_TAG::FIELDREF) &&
+            t != static_cast<uint8_t>(CONSTANT_TAG::METHODREF) &&
+            t != static_cast<uint8_t>(CONSTANT_TAG::INTERFACE_METHODREF)) {
+            return false;
+        }
+        const uint8_t* p = _data + _offsets[index] + 1;
+        class_name_out = class_name(view_u2(p));
+        return !class_name_out.empty() && name_and_type(view_u2(p + 2), name, descriptor);
+    }
+
+private:
+    const uint8_t* _data;
+    const uint32_t* _offsets;   // 索引 -> tag在类文件中的偏移，0表示该索引没有常量
+    uint16_t _count;
+};
+
+// 所有回调默认什么都不做；返回false时扫描立即停止（例如只要类名的工具在visitClass之后就可以停）
+class ClassVisitor {
+public:
+    virtual ~ClassVisitor() = default;
+
+    virtual bool visitHeader(uint16_t /*minor_version*/, uint16_t /*major_version*/, uint16_t /*constant_pool_count*/) { return true; }
+    virtual bool visitConstant(uint16_t /*index*/, const ConstantView& /*constant*/) { return true; }
+    // 常量池扫描完成，pool在整个扫描期间有效，之后的回调里出现的索引都可以用它解析
+    virtual bool visitConstantPool(const ConstantPoolView& /*pool*/) { return true; }
+    virtual bool visitClass(uint16_t /*access_flags*/, uint16_t /*this_class*/, uint16_t /*super_class*/, uint16_t /*interfaces_count*/) { return true; }
+    virtual bool visitInterface(uint16_t /*class_index*/) { return true; }
+    virtual bool visitMember(MemberKind /*kind*/, uint16_t /*access_flags*/, uint16_t /*name_index*/, uint16_t /*descriptor_index*/) { return true; }
+    // 即将扫描一个属性表，offset是attributes_count在类文件中的偏移
+    virtual bool visitAttributes(AttributeOwner /*owner*/, size_t /*offset*/) { return true; }
+    virtual bool visitAttribute(AttributeOwner /*owner*/, AttributeKind /*kind*/, uint16_t /*name_index*/,
+                                const uint8_t* /*info*/, uint32_t /*length*/) { return true; }
+    // Code属性的结构化视图，之后紧跟它自己的属性表（AttributeOwner::CODE）
+    virtual bool visitCode(uint16_t /*max_stack*/, uint16_t /*max_locals*/, const uint8_t* /*code*/, uint32_t /*code_length*/,
+                           const uint8_t* /*exception_table*/, uint16_t /*exception_table_length*/) { return true; }
+    virtual void visitEnd() {}
+};
+
+class ClassScanner {
+public:
+    // 扫描类文件并回调visitor，返回第一个结构性错误；visitor主动停止时返回无错误。
+    // 这里只检查结构（魔数、常量tag、长度和属性名），不检查版本号，版本等语义由使用者判断
+    static ClassFormatError scan(const uint8_t* data, size_t size, ClassVisitor& visitor) noexcept;
+};
+
+} // namespace classfile
+} // namespace jvm
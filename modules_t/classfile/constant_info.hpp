@@ -4,6 +4,7 @@
 #include <vector>
 #include "../util.hpp"  // 工具类头文件
 #include "class_reader.hpp"
+#include "constant_tag.hpp"
 #include "constant_pool.h"  // 常量池头文件
 
 namespace jvm {
@@ -11,24 +12,6 @@ namespace classfile {
 
 class ConstantPool; // 前向声明
 
-// 常量池标签
-enum class CONSTANT_TAG : uint8_t {
-    UTF8               = 1,
-    INTEGER           = 3,
-    FLOAT            = 4,
-    LONG             = 5,
-    DOUBLE           = 6,
-    CLASS            = 7,
-    STRING           = 8,
-    FIELDREF         = 9,
-    METHODREF        = 10,
-    INTERFACE_METHODREF = 11,
-    NAME_AND_TYPE    = 12,
-    METHOD_HANDLE    = 15,
-    METHOD_TYPE      = 16,
-    INVOKE_DYNAMIC   = 18
-};
-
 
 // 常量信息基类
 class ConstantInfo {
@@ -49,14 +32,27 @@ public:
     // explicit ConstantUtf8Info(std::shared_ptr<ConstantPool> cp) : ConstantInfo(cp) {}
     void read_info(ClassReader& reader) override {
         uint16_t length = reader.read_uint16();
-        std::vector<uint8_t> bytes = reader.read_bytes(length);
+        const uint8_t* bytes = reader.skip(length);
+        if (bytes == nullptr) return;
         // 这里的字符串是以MUTF-8编码的
         // 需要转换为标准UTF-8编码
-        _str = util::util_mutf8::decode(bytes);
+        _str = util::util_mutf8::decode(bytes, length);
     }
     std::string get_string() const {
         return _str;
     }
+    // 不拷贝的访问方式
+    const std::string& str() const noexcept {
+        return _str;
+    }
+
+    // 读取已解码的标准UTF-8（u4长度 + 字节），用于解析缓存，省去MUTF-8解码
+    void read_decoded(ClassReader& reader) {
+        uint32_t length = reader.read_uint32();
+        const uint8_t* bytes = reader.skip(length);
+        if (bytes == nullptr) return;
+        _str.assign(reinterpret_cast<const char*>(bytes), length);
+    }
 
 private:
 
@@ -121,6 +117,9 @@ public:
     std::string get_name() {
         return _cp->get_utf8(_name_index);
     }
+    uint16_t get_name_index() const {
+        return _name_index;
+    }
 
 private:
     std::shared_ptr<ConstantPool> _cp;
@@ -242,6 +241,35 @@ public:
     uint16_t _name_and_type_index;
 };
 
+// Dynamic常量（Java 11+），结构与InvokeDynamic相同
+class ConstantDynamicInfo : public ConstantInfo {
+public:
+    void read_info(ClassReader& reader) override {
+        _bootstrap_method_attr_index = reader.read_uint16();
+        _name_and_type_index = reader.read_uint16();
+    }
+    uint16_t _bootstrap_method_attr_index;
+    uint16_t _name_and_type_index;
+};
+
+// Module和Package常量（Java 9+），只出现在module-info.class中
+class ConstantModuleInfo : public ConstantInfo {
+public:
+    void read_info(ClassReader& reader) override {
+        _name_index = reader.read_uint16();
+    }
+    uint16_t _name_index;
+};
+
+class ConstantPackageInfo : public ConstantInfo {
+public:
+    void read_info(ClassReader& reader) override {
+        _name_index = reader.read_uint16();
+    }
+    uint16_t _name_index;
+};
+
+
 // 工厂函数 - 创建常量信息对象
 inline std::shared_ptr<ConstantInfo> new_constant_info(uint8_t tag, std::shared_ptr<ConstantPool> cp) {
     switch (static_cast<CONSTANT_TAG>(tag)) {
@@ -273,17 +301,35 @@ inline std::shared_ptr<ConstantInfo> new_constant_info(uint8_t tag, std::shared_
             return std::make_shared<ConstantMethodHandleInfo>();
         case CONSTANT_TAG::INVOKE_DYNAMIC:
             return std::make_shared<ConstantInvokeDynamicInfo>();
+        case CONSTANT_TAG::DYNAMIC:
+            return std::make_shared<ConstantDynamicInfo>();
+        case CONSTANT_TAG::MODULE:
+            return std::make_shared<ConstantModuleInfo>();
+        case CONSTANT_TAG::PACKAGE:
+            return std::make_shared<ConstantPackageInfo>();
         default:
-            throw std::runtime_error("java.lang.ClassFormatError: constant pool tag!");
+            // 未知tag，由调用者记录ClassFormatError
+            return nullptr;
     }
     return nullptr;
 }
 
-// 读取常量信息 - 包装工厂方法
-inline std::shared_ptr<ConstantInfo> read_constant_info(ClassReader& reader, std::shared_ptr<ConstantPool> cp) {
+// 读取常量信息 - 包装工厂方法，失败时在reader中记录错误并返回nullptr
+// decoded_utf8为true时Utf8常量按解析缓存中的已解码格式读取
+inline std::shared_ptr<ConstantInfo> read_constant_info(ClassReader& reader, std::shared_ptr<ConstantPool> cp,
+                                                        bool decoded_utf8 = false) {
     uint8_t tag = reader.read_uint8();
+    if (reader.failed()) return nullptr;
     auto c = new_constant_info(tag, cp);
-    c->read_info(reader);
+    if (!c) {
+        reader.fail_at(ClassFormatErrorKind::BAD_CONSTANT_TAG, reader.offset() - 1);
+        return nullptr;
+    }
+    if (decoded_utf8 && static_cast<CONSTANT_TAG>(tag) == CONSTANT_TAG::UTF8) {
+        static_cast<ConstantUtf8Info*>(c.get())->read_decoded(reader);
+    } else {
+        c->read_info(reader);
+    }
     return c;
 }
 
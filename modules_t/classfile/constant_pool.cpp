@@ -6,23 +6,42 @@ namespace jvm {
 namespace classfile {
 
 // 读取常量池 这个后面可改造为构造函数
-std::shared_ptr<ConstantPool> ConstantPool::read_constant_pool(ClassReader& reader) {
+std::shared_ptr<ConstantPool> ConstantPool::read_constant_pool(ClassReader& reader, bool decoded_utf8) {
     uint16_t cp_count = reader.read_uint16();
-    auto cp = std::make_shared<ConstantPool>();
-    cp->_pool.resize(cp_count);
+    auto cp = create(cp_count);
+    read_constants(reader, cp, decoded_utf8);
+    return cp;
+}
 
+void ConstantPool::read_constants(ClassReader& reader, const std::shared_ptr<ConstantPool>& cp, bool decoded_utf8) {
     // The constant_pool table is indexed from 1 to constant_pool_count - 1
-    for (uint16_t i = 1; i < cp_count; i++) {
-        cp->_pool[i] = read_constant_info(reader, cp);
+    for (size_t i = 1; i < cp->_pool.size(); i++) {
+        cp->_pool[i] = read_constant_info(reader, cp, decoded_utf8);
+        if (reader.failed()) {
+            break;
+        }
         // Double and Long take up two slots
         if (dynamic_cast<ConstantLongInfo*>(cp->_pool[i].get()) ||
             dynamic_cast<ConstantDoubleInfo*>(cp->_pool[i].get())) {
             i++;
         }
     }
+}
+
+std::shared_ptr<ConstantPool> ConstantPool::create(uint16_t cp_count) {
+    auto cp = std::make_shared<ConstantPool>();
+    cp->_pool.resize(cp_count);
+    cp->_attribute_kinds.assign(cp_count, AttributeKind::UNRESOLVED);
     return cp;
 }
 
+void ConstantPool::set_constant_info(uint16_t index, std::shared_ptr<ConstantInfo> info) {
+    if (index == 0 || index >= _pool.size()) {
+        throw std::runtime_error("Invalid constant pool index: " + std::to_string(index));
+    }
+    _pool[index] = std::move(info);
+}
+
 // 按索引查找常量
 std::shared_ptr<ConstantInfo> ConstantPool::get_constant_info(uint16_t index) const {
     if (index >= _pool.size() || !_pool[index] || index == 0) {
@@ -31,9 +50,19 @@ std::shared_ptr<ConstantInfo> ConstantPool::get_constant_info(uint16_t index) co
     return _pool[index];
 }
 
+const ConstantInfo* ConstantPool::find_constant_info(uint16_t index) const noexcept {
+    if (index == 0 || index >= _pool.size()) {
+        return nullptr;
+    }
+    return _pool[index].get();
+}
+
 // 从常量池查找字段或方法的名字和描述符
 std::pair<std::string, std::string> ConstantPool::get_name_and_type(uint16_t index) const {
     auto nt_info = std::dynamic_pointer_cast<ConstantNameAndTypeInfo>(get_constant_info(index));
+    if (!nt_info) {
+        throw std::runtime_error("Not a name and type constant: " + std::to_string(index));
+    }
     std::string name = get_utf8(nt_info->get_name_index());
     std::string type = get_utf8(nt_info->get_descriptor_index());
     return {name, type};
@@ -45,6 +74,9 @@ std::string ConstantPool::get_class_name(uint16_t index) const {
         throw std::runtime_error("Invalid class index: " + std::to_string(index));
     }
     auto class_info = std::dynamic_pointer_cast<ConstantClassInfo>(get_constant_info(index));
+    if (!class_info) {
+        throw std::runtime_error("Not a class constant: " + std::to_string(index));
+    }
     return class_info->get_name();
 }
 
@@ -54,9 +86,34 @@ std::string ConstantPool::get_utf8(uint16_t index) const {
         throw std::runtime_error("Invalid UTF-8 index: " + std::to_string(index));
     }
     auto utf8_info = std::dynamic_pointer_cast<ConstantUtf8Info>(get_constant_info(index));
+    if (!utf8_info) {
+        throw std::runtime_error("Not a UTF-8 constant: " + std::to_string(index));
+    }
     return utf8_info->get_string();
 }
 
+// 不抛异常的UTF-8查找，索引无效或类型不符时返回nullptr
+const std::string* ConstantPool::find_utf8(uint16_t index) const noexcept {
+    if (index == 0 || index >= _pool.size() || !_pool[index]) {
+        return nullptr;
+    }
+    auto* utf8_info = dynamic_cast<const ConstantUtf8Info*>(_pool[index].get());
+    return utf8_info ? &utf8_info->str() : nullptr;
+}
+
+AttributeKind ConstantPool::attribute_kind(uint16_t name_index) const noexcept {
+    if (name_index >= _attribute_kinds.size()) {
+        return AttributeKind::INVALID;
+    }
+    AttributeKind& kind = _attribute_kinds[name_index];
+    if (kind == AttributeKind::UNRESOLVED) {
+        const std::string* p_name = find_utf8(name_index);
+        kind = p_name ? lookupAttributeKind(p_name->data(), p_name->size())
+                      : AttributeKind::INVALID;
+    }
+    return kind;
+}
+
 uint32_t ConstantPool::size() const {
     return _pool.size();
 }
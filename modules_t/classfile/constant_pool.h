@@ -5,6 +5,7 @@
 #include <memory>
 #include <stdexcept>
 #include "class_reader.hpp"
+#include "attribute_kind.hpp"
 
 namespace jvm {
 namespace classfile {
@@ -14,10 +15,18 @@ class ConstantInfo; // 前向声明
 class ConstantPool {
 public:
     // 读取常量池 这个后面可改造为构造函数吗？
-    static std::shared_ptr<ConstantPool> read_constant_pool(ClassReader& reader);
+    // decoded_utf8: 从解析缓存读取时Utf8常量已是解码后的标准UTF-8
+    static std::shared_ptr<ConstantPool> read_constant_pool(ClassReader& reader, bool decoded_utf8 = false);
+    // 依次读入cp的全部常量项（不含cp_count），cp由create创建
+    static void read_constants(ClassReader& reader, const std::shared_ptr<ConstantPool>& cp, bool decoded_utf8 = false);
+    // 创建cp_count个空槽位的常量池，由流式解析（ClassFileBuilder）逐项填充
+    static std::shared_ptr<ConstantPool> create(uint16_t cp_count);
+    void set_constant_info(uint16_t index, std::shared_ptr<ConstantInfo> info);
 
     // 按索引查找常量
     std::shared_ptr<ConstantInfo> get_constant_info(uint16_t index) const;
+    // 同上，但不抛异常，索引无效时返回nullptr（用于解析和验证路径）
+    const ConstantInfo* find_constant_info(uint16_t index) const noexcept;
     // 从常量池查找字段或方法的名字和描述符
     std::pair<std::string, std::string> get_name_and_type(uint16_t index) const;
     // 从常量池查找类名
@@ -25,12 +34,20 @@ public:
 
     // 从常量池查找UTF-8字符串
     std::string get_utf8(uint16_t index) const;
+    // 同上，但不抛异常也不拷贝，失败返回nullptr（用于解析路径）
+    const std::string* find_utf8(uint16_t index) const noexcept;
+
+    // 按属性名索引解析属性类型，结果按Utf8索引缓存，同一名字只做一次完美哈希查找
+    // 索引无效或不是Utf8常量时返回AttributeKind::INVALID
+    AttributeKind attribute_kind(uint16_t name_index) const noexcept;
 
     // 获取常量池的大小
     uint32_t size() const;
 
 private:
     std::vector<std::shared_ptr<ConstantInfo>> _pool;
+    // Utf8索引 -> 属性类型 的缓存，解析单个类时只在一个线程内访问
+    mutable std::vector<AttributeKind> _attribute_kinds;
 
     // ConstantPool() = default; // 私有构造函数
 };
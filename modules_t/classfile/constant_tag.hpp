@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+namespace jvm {
+namespace classfile {
+
+// 常量池标签
+enum class CONSTANT_TAG : uint8_t {
+    UTF8               = 1,
+    INTEGER           = 3,
+    FLOAT            = 4,
+    LONG             = 5,
+    DOUBLE           = 6,
+    CLASS            = 7,
+    STRING           = 8,
+    FIELDREF         = 9,
+    METHODREF        = 10,
+    INTERFACE_METHODREF = 11,
+    NAME_AND_TYPE    = 12,
+    METHOD_HANDLE    = 15,
+    METHOD_TYPE      = 16,
+    DYNAMIC          = 17,
+    INVOKE_DYNAMIC   = 18,
+    MODULE           = 19,
+    PACKAGE          = 20
+};
+
+// 定长常量的数据长度（不含tag），Utf8是变长的返回0，未知tag返回-1
+inline int constant_info_size(uint8_t tag) {
+    switch (static_cast<CONSTANT_TAG>(tag)) {
+        case CONSTANT_TAG::UTF8:
+            return 0;
+        case CONSTANT_TAG::CLASS:
+        case CONSTANT_TAG::STRING:
+        case CONSTANT_TAG::METHOD_TYPE:
+        case CONSTANT_TAG::MODULE:
+        case CONSTANT_TAG::PACKAGE:
+            return 2;
+        case CONSTANT_TAG::METHOD_HANDLE:
+            return 3;
+        case CONSTANT_TAG::INTEGER:
+        case CONSTANT_TAG::FLOAT:
+        case CONSTANT_TAG::FIELDREF:
+        case CONSTANT_TAG::METHODREF:
+        case CONSTANT_TAG::INTERFACE_METHODREF:
+        case CONSTANT_TAG::NAME_AND_TYPE:
+        case CONSTANT_TAG::DYNAMIC:
+        case CONSTANT_TAG::INVOKE_DYNAMIC:
+            return 4;
+        case CONSTANT_TAG::LONG:
+        case CONSTANT_TAG::DOUBLE:
+            return 8;
+        default:
+            return -1;
+    }
+}
+
+} // namespace classfile
+} // namespace jvm
@@ -20,7 +20,7 @@ std::vector<std::unique_ptr<MemberInfo>> MemberInfo::read_members(ClassReader& r
     members.reserve(member_count);
     LOG(INFO, "member count: %d", member_count);
     
-    for (int i = 0; i < member_count; i++) 
+    for (int i = 0; i < member_count && !reader.failed(); i++) 
     {
         members.push_back(read_member(reader, cp));
     }
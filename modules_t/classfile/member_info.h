@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <string>
 #include <memory>
@@ -7,6 +8,7 @@
 #include "class_reader.hpp"
 #include "constant_pool.h"
 #include "attribute_info.hpp"
+#include "method_descriptor.hpp"
 
 namespace jvm {
 namespace classfile {
@@ -26,6 +28,29 @@ public:
     uint16_t access_flags() const { return _access_flags; }
     std::string name() const { return _cp.get_utf8(_name_index); }
     std::string descriptor() const { return _cp.get_utf8(_descriptor_index); }
+    uint16_t name_index() const { return _name_index; }
+    uint16_t descriptor_index() const { return _descriptor_index; }
+    const std::vector<std::unique_ptr<AttributeInfo>>& attributes() const { return _attributes; }
+
+    // 方法的Code属性，抽象/native方法和字段返回nullptr
+    CodeAttribute* code_attribute() const {
+        for (const auto& attr : _attributes) {
+            if (auto* code = dynamic_cast<CodeAttribute*>(attr.get())) {
+                return code;
+            }
+        }
+        return nullptr;
+    }
+
+    // 方法描述符的驻留签名，第一次调用时解析，描述符非法时返回nullptr
+    const MethodSignature* signature() const {
+        const MethodSignature* p_signature = _signature.load(std::memory_order_acquire);
+        if (p_signature == nullptr) {
+            p_signature = MethodSignature::intern(_cp.get_utf8(_descriptor_index));
+            _signature.store(p_signature, std::memory_order_release);
+        }
+        return p_signature;
+    }
 
 private:
     ConstantPool& _cp;
@@ -33,6 +58,7 @@ private:
     uint16_t _name_index;
     uint16_t _descriptor_index;
     std::vector<std::unique_ptr<AttributeInfo>> _attributes;
+    mutable std::atomic<const MethodSignature*> _signature{nullptr};
 };
 
 }// namespace classfile
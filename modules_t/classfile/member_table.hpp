@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "member_info.h"
+#include "symbol.hpp"
+
+namespace jvm {
+namespace classfile {
+
+// 一个类的字段或方法查找表：(名字符号, 描述符符号) -> MemberInfo
+// 开放定址 + 线性探测，容量是2的幂且装载率不超过1/2，链接时建一次，之后只读
+class MemberTable {
+public:
+    void build(const std::vector<std::unique_ptr<MemberInfo>>& members, const ConstantPool& cp) {
+        size_t capacity = 4;
+        while (capacity < members.size() * 2) {
+            capacity <<= 1;
+        }
+        _entries.assign(capacity, Entry{});
+        _mask = capacity - 1;
+
+        for (const auto& p_member : members) {
+            const std::string* p_name = cp.find_utf8(p_member->name_index());
+            const std::string* p_descriptor = cp.find_utf8(p_member->descriptor_index());
+            if (p_name == nullptr || p_descriptor == nullptr) continue;
+
+            Symbol name = Symbol::intern(*p_name);
+            Symbol descriptor = Symbol::intern(*p_descriptor);
+            size_t i = slot_for(name, descriptor);
+            while (_entries[i].p_member != nullptr) {
+                // 重复的(名字, 描述符)保留先出现的成员
+                if (_entries[i].name == name && _entries[i].descriptor == descriptor) break;
+                i = (i + 1) & _mask;
+            }
+            if (_entries[i].p_member == nullptr) {
+                _entries[i] = Entry{name, descriptor, p_member.get()};
+            }
+        }
+    }
+
+    // 找不到时返回nullptr
+    const MemberInfo* find(Symbol name, Symbol descriptor) const {
+        if (_entries.empty() || !name || !descriptor) return nullptr;
+        for (size_t i = slot_for(name, descriptor); _entries[i].p_member != nullptr; i = (i + 1) & _mask) {
+            if (_entries[i].name == name && _entries[i].descriptor == descriptor) {
+                return _entries[i].p_member;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    struct Entry {
+        Symbol name;
+        Symbol descriptor;
+        const MemberInfo* p_member = nullptr;
+    };
+
+    size_t slot_for(Symbol name, Symbol descriptor) const {
+        uint64_t h = (static_cast<uint64_t>(name.hash()) * 31 + descriptor.hash()) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h >> 32) & _mask;
+    }
+
+    std::vector<Entry> _entries;
+    size_t _mask = 0;
+};
+
+} // namespace classfile
+} // namespace jvm
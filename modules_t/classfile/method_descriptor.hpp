@@ -0,0 +1,194 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace jvm {
+namespace classfile {
+
+// 描述符中值的类型，VOID只出现在返回值上
+enum class ValueKind : uint8_t {
+    VOID,
+    BOOLEAN,
+    BYTE,
+    CHAR,
+    SHORT,
+    INT,
+    FLOAT,
+    LONG,
+    DOUBLE,
+    REFERENCE,
+};
+
+// 该类型在局部变量表/操作数栈中占用的槽位数
+constexpr uint8_t value_slots(ValueKind kind) {
+    switch (kind) {
+        case ValueKind::VOID: return 0;
+        case ValueKind::LONG:
+        case ValueKind::DOUBLE: return 2;
+        default: return 1;
+    }
+}
+
+// 字段描述符的类型，只看首字符；非法描述符返回VOID
+constexpr ValueKind field_kind(std::string_view descriptor) {
+    if (descriptor.empty()) return ValueKind::VOID;
+    switch (descriptor[0]) {
+        case 'Z': return ValueKind::BOOLEAN;
+        case 'B': return ValueKind::BYTE;
+        case 'C': return ValueKind::CHAR;
+        case 'S': return ValueKind::SHORT;
+        case 'I': return ValueKind::INT;
+        case 'F': return ValueKind::FLOAT;
+        case 'J': return ValueKind::LONG;
+        case 'D': return ValueKind::DOUBLE;
+        case 'L':
+        case '[': return ValueKind::REFERENCE;
+        default: return ValueKind::VOID;
+    }
+}
+
+// 方法描述符解析后的紧凑形式：参数槽位数、引用槽位位图和返回值类型
+// 同一描述符只解析一次，通过intern()在全进程共享，调用点直接按槽位数整块拷贝参数
+class MethodSignature {
+public:
+    // JVMS 4.3.3：参数最多占255个槽位（实例方法还要算上this）
+    static const uint16_t MAX_ARG_SLOTS = 255;
+
+    // 解析描述符，非法时返回false，out的内容不确定
+    static bool parse(std::string_view descriptor, MethodSignature& out) {
+        out._descriptor.assign(descriptor.data(), descriptor.size());
+        out._arg_kinds.clear();
+        out._arg_slots = 0;
+        out._ref_bitmap.fill(0);
+
+        size_t pos = 0;
+        if (descriptor.empty() || descriptor[pos++] != '(') return false;
+        while (pos < descriptor.size() && descriptor[pos] != ')') {
+            ValueKind kind;
+            if (!parse_field_type(descriptor, pos, kind)) return false;
+            if (kind == ValueKind::REFERENCE) {
+                out._ref_bitmap[out._arg_slots / 64] |= uint64_t(1) << (out._arg_slots % 64);
+            }
+            out._arg_kinds.push_back(kind);
+            out._arg_slots += value_slots(kind);
+            if (out._arg_slots > MAX_ARG_SLOTS) return false;
+        }
+        if (pos >= descriptor.size()) return false;
+        pos++; // ')'
+
+        if (pos < descriptor.size() && descriptor[pos] == 'V') {
+            out._return_kind = ValueKind::VOID;
+            pos++;
+        } else if (!parse_field_type(descriptor, pos, out._return_kind)) {
+            return false;
+        }
+        return pos == descriptor.size();
+    }
+
+    // 驻留：相同描述符返回同一个对象，指针在进程生命周期内有效；描述符非法时返回nullptr
+    static const MethodSignature* intern(std::string_view descriptor) {
+        return table().intern(descriptor);
+    }
+
+    const std::string& descriptor() const { return _descriptor; }
+
+    uint16_t arg_count() const { return static_cast<uint16_t>(_arg_kinds.size()); }
+    ValueKind arg_kind(uint16_t i) const { return _arg_kinds[i]; }
+
+    // 参数占用的槽位数，不含this
+    uint16_t arg_slots() const { return _arg_slots; }
+    // 调用时需要从操作数栈传入局部变量表的槽位数，实例方法算上this
+    uint16_t param_slots(bool is_static) const { return _arg_slots + (is_static ? 0 : 1); }
+
+    ValueKind return_kind() const { return _return_kind; }
+    uint8_t return_slots() const { return value_slots(_return_kind); }
+
+    // 第slot个参数槽位（不含this，从0开始）是否存放引用，GC扫描参数时使用
+    bool is_reference_slot(uint16_t slot) const {
+        return slot < _arg_slots && ((_ref_bitmap[slot / 64] >> (slot % 64)) & 1) != 0;
+    }
+
+private:
+    static bool parse_field_type(std::string_view d, size_t& pos, ValueKind& kind) {
+        if (pos >= d.size()) return false;
+        switch (d[pos]) {
+            case 'Z': kind = ValueKind::BOOLEAN; pos++; return true;
+            case 'B': kind = ValueKind::BYTE; pos++; return true;
+            case 'C': kind = ValueKind::CHAR; pos++; return true;
+            case 'S': kind = ValueKind::SHORT; pos++; return true;
+            case 'I': kind = ValueKind::INT; pos++; return true;
+            case 'F': kind = ValueKind::FLOAT; pos++; return true;
+            case 'J': kind = ValueKind::LONG; pos++; return true;
+            case 'D': kind = ValueKind::DOUBLE; pos++; return true;
+            case 'L': {
+                size_t end = d.find(';', pos + 1);
+                if (end == std::string_view::npos || end == pos + 1) return false;
+                kind = ValueKind::REFERENCE;
+                pos = end + 1;
+                return true;
+            }
+            case '[': {
+                size_t dims = 0;
+                while (pos < d.size() && d[pos] == '[') {
+                    pos++;
+                    dims++;
+                }
+                ValueKind element;
+                if (dims > 255 || !parse_field_type(d, pos, element)) return false;
+                kind = ValueKind::REFERENCE;
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    // 分段加锁的驻留表：描述符 -> 签名，键指向签名对象自己持有的字符串
+    class Table {
+    public:
+        const MethodSignature* intern(std::string_view descriptor) {
+            Shard& shard = _shards[std::hash<std::string_view>{}(descriptor) % SHARD_COUNT];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.signatures.find(descriptor);
+            if (it != shard.signatures.end()) return it->second.get();
+
+            auto p_signature = std::make_unique<MethodSignature>();
+            if (!parse(descriptor, *p_signature)) return nullptr;
+            const MethodSignature* result = p_signature.get();
+            shard.signatures.emplace(result->descriptor(), std::move(p_signature));
+            return result;
+        }
+
+    private:
+        static const size_t SHARD_COUNT = 16;
+
+        struct Shard {
+            std::mutex mutex;
+            std::unordered_map<std::string_view, std::unique_ptr<MethodSignature>> signatures;
+        };
+
+        std::array<Shard, SHARD_COUNT> _shards;
+    };
+
+    static Table& table() {
+        static Table instance;
+        return instance;
+    }
+
+    std::string _descriptor;
+    std::vector<ValueKind> _arg_kinds;
+    uint16_t _arg_slots = 0;
+    ValueKind _return_kind = ValueKind::VOID;
+    std::array<uint64_t, 4> _ref_bitmap{};
+};
+
+} // namespace classfile
+} // namespace jvm
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../util.hpp"
+
+namespace jvm {
+namespace classfile {
+
+// 追加大端整数，解析缓存使用与类文件相同的字节序，读取时可直接复用ClassReader
+inline void put_uint8(std::string& out, uint8_t v) { out.push_back(static_cast<char>(v)); }
+inline void put_uint16(std::string& out, uint16_t v) {
+    out.push_back(static_cast<char>(v >> 8));
+    out.push_back(static_cast<char>(v));
+}
+inline void put_uint32(std::string& out, uint32_t v) {
+    put_uint16(out, static_cast<uint16_t>(v >> 16));
+    put_uint16(out, static_cast<uint16_t>(v));
+}
+
+// 按类文件内容哈希做键的磁盘解析缓存
+// 同一份类字节无论来自哪个jar、哪次运行都命中同一个条目；
+// 每个条目一个文件 <dir>/<16位十六进制哈希>.mjpc，写入先写临时文件再rename，多进程共享安全。
+// 条目内容的编解码由ClassFile负责，这里只管键和存取。
+class ParseCache {
+public:
+    explicit ParseCache(const std::string& dir) : _dir(dir) {
+        if (!_dir.empty() && (_dir.back() == '/' || _dir.back() == '\\')) {
+            _dir.pop_back();
+        }
+        mkdir(_dir.c_str(), 0755);
+    }
+
+    static uint64_t key(const uint8_t* data, size_t size) {
+        return util::util_hash::xxh64(data, size);
+    }
+
+    bool load(uint64_t key, std::string& blob) const noexcept {
+        FILE* fp = fopen(path_of(key).c_str(), "rb");
+        if (fp == nullptr) return false;
+        bool ok = false;
+        if (fseek(fp, 0, SEEK_END) == 0) {
+            long fsize = ftell(fp);
+            if (fsize > 0 && fseek(fp, 0, SEEK_SET) == 0) {
+                blob.resize(static_cast<size_t>(fsize));
+                ok = fread(&blob[0], 1, blob.size(), fp) == blob.size();
+            }
+        }
+        fclose(fp);
+        return ok;
+    }
+
+    bool store(uint64_t key, const std::string& blob) const noexcept {
+        std::string path = path_of(key);
+        std::string tmp = path + ".tmp." + std::to_string(getpid()) + "." +
+                          std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        FILE* fp = fopen(tmp.c_str(), "wb");
+        if (fp == nullptr) {
+            LOG(WARNING, "Parse cache: cannot write %s", tmp.c_str());
+            return false;
+        }
+        bool ok = fwrite(blob.data(), 1, blob.size(), fp) == blob.size();
+        ok = (fclose(fp) == 0) && ok;
+        if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+            unlink(tmp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    const std::string& dir() const { return _dir; }
+
+    // 进程级缓存，ClassFile::parse在安装后自动使用；应在启动解析线程前安装
+    static void install(std::shared_ptr<ParseCache> p_cache) { global() = std::move(p_cache); }
+    static ParseCache* instance() { return global().get(); }
+
+private:
+    std::string path_of(uint64_t key) const {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.mjpc", static_cast<unsigned long long>(key));
+        return _dir + "/" + name;
+    }
+
+    static std::shared_ptr<ParseCache>& global() {
+        static std::shared_ptr<ParseCache> p_cache;
+        return p_cache;
+    }
+
+    std::string _dir;
+};
+
+} // namespace classfile
+} // namespace jvm
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace jvm {
+namespace classfile {
+
+// 驻留字符串：内容相同的名字/描述符共享同一个条目，比较相等只需比较指针，
+// 哈希值在驻留时算好，按符号查表时不再遍历字符串
+class Symbol {
+public:
+    Symbol() = default; // 空符号
+
+    // 驻留，不存在时插入
+    static Symbol intern(std::string_view text) {
+        return Symbol(table().find(text, true));
+    }
+
+    // 只查找不插入，从未驻留过的字符串返回空符号（这样的名字不可能属于任何已链接的成员）
+    static Symbol lookup(std::string_view text) {
+        return Symbol(table().find(text, false));
+    }
+
+    explicit operator bool() const { return _p_entry != nullptr; }
+    const std::string& str() const { return _p_entry->text; }
+    size_t hash() const { return _p_entry ? _p_entry->hash : 0; }
+
+    bool operator==(Symbol other) const { return _p_entry == other._p_entry; }
+    bool operator!=(Symbol other) const { return _p_entry != other._p_entry; }
+
+private:
+    struct Entry {
+        std::string text;
+        size_t hash;
+    };
+
+    // 分段加锁的驻留表，键指向条目自己持有的字符串，条目在进程生命周期内不释放
+    class Table {
+    public:
+        const Entry* find(std::string_view text, bool insert) {
+            size_t hash = std::hash<std::string_view>{}(text);
+            Shard& shard = _shards[hash % SHARD_COUNT];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.entries.find(text);
+            if (it != shard.entries.end()) return it->second.get();
+            if (!insert) return nullptr;
+
+            auto p_entry = std::make_unique<Entry>(Entry{std::string(text), hash});
+            const Entry* result = p_entry.get();
+            shard.entries.emplace(result->text, std::move(p_entry));
+            return result;
+        }
+
+    private:
+        static const size_t SHARD_COUNT = 64;
+
+        struct Shard {
+            std::mutex mutex;
+            std::unordered_map<std::string_view, std::unique_ptr<Entry>> entries;
+        };
+
+        std::array<Shard, SHARD_COUNT> _shards;
+    };
+
+    static Table& table() {
+        static Table instance;
+        return instance;
+    }
+
+    explicit Symbol(const Entry* p_entry) : _p_entry(p_entry) {}
+
+    const Entry* _p_entry = nullptr;
+};
+
+} // namespace classfile
+} // namespace jvm
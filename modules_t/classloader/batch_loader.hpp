@@ -0,0 +1,173 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../log.hpp"
+#include "../thread_pool.hpp"
+#include "../classpath/class_path.hpp"
+#include "../classfile/class_file.hpp"
+
+namespace jvm {
+namespace classloader {
+
+using ClassFilePtr = std::shared_ptr<classfile::ClassFile>;
+
+// 分段加锁的并发哈希表：类名 -> 解析结果
+// 按类名哈希分到SHARD_COUNT个分段，不同分段的写入互不阻塞
+class ConcurrentClassMap {
+public:
+    static const size_t SHARD_COUNT = 64;
+
+    // 插入，类名已存在时保留先插入的结果并返回false
+    bool insert(const std::string& class_name, ClassFilePtr p_class_file) {
+        Shard& shard = shard_for(class_name);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.classes.emplace(class_name, std::move(p_class_file)).second;
+    }
+
+    ClassFilePtr find(const std::string& class_name) const {
+        const Shard& shard = shard_for(class_name);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.classes.find(class_name);
+        return it == shard.classes.end() ? nullptr : it->second;
+    }
+
+    size_t size() const {
+        size_t n = 0;
+        for (const auto& shard : _shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            n += shard.classes.size();
+        }
+        return n;
+    }
+
+    // 遍历所有条目，遍历期间逐个分段加锁
+    void for_each(const std::function<void(const std::string&, const ClassFilePtr&)>& fn) const {
+        for (const auto& shard : _shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const auto& [name, p_class_file] : shard.classes) {
+                fn(name, p_class_file);
+            }
+        }
+    }
+
+private:
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, ClassFilePtr> classes;
+    };
+
+    Shard& shard_for(const std::string& class_name) {
+        return _shards[std::hash<std::string>{}(class_name) % SHARD_COUNT];
+    }
+    const Shard& shard_for(const std::string& class_name) const {
+        return _shards[std::hash<std::string>{}(class_name) % SHARD_COUNT];
+    }
+
+    std::array<Shard, SHARD_COUNT> _shards;
+};
+
+// 批量类加载器
+// 把 读取(I/O) -> 解压 -> ClassFile::parse 作为一个任务投递到工作窃取线程池，
+// 不同类的各个阶段在多个核上交错执行，用于预热和离线分析大量jar
+class BatchLoader {
+public:
+    // 每个任务处理的jar条目数，按块处理可以复用同一个zip句柄
+    static const size_t JAR_CHUNK_SIZE = 64;
+
+    explicit BatchLoader(size_t thread_count = 0) : _pool(thread_count) {}
+
+    BatchLoader(const BatchLoader&) = delete;
+    BatchLoader& operator=(const BatchLoader&) = delete;
+
+    // 按类名（java/lang/Object形式）从类路径批量加载
+    std::shared_ptr<ConcurrentClassMap> load_classes(classpath::ClassPath& cp,
+                                                     const std::vector<std::string>& class_names) {
+        auto p_classes = std::make_shared<ConcurrentClassMap>();
+        _pool.parallel_for(class_names.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                auto [data, entry, success] = cp.read_class(class_names[i]);
+                if (!success) {
+                    LOG(ERROR, "Failed to read class data for %s", class_names[i].c_str());
+                    continue;
+                }
+                if (auto p_class_file = parse(data, class_names[i])) {
+                    p_classes->insert(class_names[i], std::move(p_class_file));
+                }
+            }
+        });
+        return p_classes;
+    }
+
+    // 加载整个jar中的全部.class条目
+    std::shared_ptr<ConcurrentClassMap> load_jar(const std::string& jar_path) {
+        auto p_classes = std::make_shared<ConcurrentClassMap>();
+        uint64_t entry_count = 0;
+        {
+            classpath::ZipArchive archive(jar_path);
+            if (!archive.is_open()) {
+                return p_classes;
+            }
+            entry_count = archive.entry_count();
+        }
+
+        _pool.parallel_for(entry_count, JAR_CHUNK_SIZE, [&](size_t begin, size_t end) {
+            // libzip句柄不能跨线程共享，每个任务自己打开
+            classpath::ZipArchive archive(jar_path);
+            if (!archive.is_open()) {
+                return;
+            }
+            std::string data;
+            for (size_t i = begin; i < end; ++i) {
+                std::string class_name = archive.entry_name(i);
+                if (!strip_class_suffix(class_name) || !archive.read(i, data)) {
+                    continue;
+                }
+                if (auto p_class_file = parse(data, class_name)) {
+                    p_classes->insert(class_name, std::move(p_class_file));
+                }
+            }
+        });
+        return p_classes;
+    }
+
+    util::ThreadPool& pool() { return _pool; }
+
+private:
+    static ClassFilePtr parse(const std::string& data, const std::string& class_name) {
+        if (data.empty()) {
+            LOG(ERROR, "Class data is empty for %s", class_name.c_str());
+            return nullptr;
+        }
+        std::vector<uint8_t> class_data(data.begin(), data.end());
+        auto [p_class_file, success] = classfile::ClassFile::parse(class_data);
+        if (!success) {
+            LOG(ERROR, "Failed to parse class file for %s", class_name.c_str());
+            return nullptr;
+        }
+        p_class_file->link();
+        return p_class_file;
+    }
+
+    // "a/b/C.class" -> "a/b/C"，不是.class条目时返回false
+    static bool strip_class_suffix(std::string& name) {
+        static const std::string SUFFIX = ".class";
+        if (name.size() <= SUFFIX.size() ||
+            name.compare(name.size() - SUFFIX.size(), SUFFIX.size(), SUFFIX) != 0) {
+            return false;
+        }
+        name.resize(name.size() - SUFFIX.size());
+        return true;
+    }
+
+    util::ThreadPool _pool;
+};
+
+} // namespace classloader
+} // namespace jvm
@@ -0,0 +1,495 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "../log.hpp"
+#include "../util.hpp"
+#include "../thread_pool.hpp"
+#include "../classpath/entry.hpp"
+#include "../classfile/class_visitor.hpp"
+
+namespace jvm {
+namespace classloader {
+
+enum class InspectFormat {
+    JSON,   // 每个类一行JSON
+    TABLE,  // 每个类一行的紧凑表格
+};
+
+// 一个类的检查结果，字符串都是类文件数据的视图（原始MUTF-8）
+struct ClassInspection {
+    struct Member {
+        std::string_view name;
+        std::string_view descriptor;
+        uint16_t access_flags = 0;
+        uint32_t attribute_bytes = 0;   // 所有属性（含6字节属性头）的总字节数
+        bool has_code = false;
+        uint16_t max_stack = 0;
+        uint16_t max_locals = 0;
+        uint32_t code_length = 0;
+    };
+    struct Attribute {
+        std::string_view name;
+        uint32_t length = 0;
+    };
+
+    uint16_t minor_version = 0;
+    uint16_t major_version = 0;
+    uint16_t constant_count = 0;
+    uint16_t access_flags = 0;
+    std::string_view this_class;
+    std::string_view super_class;
+    std::vector<std::string_view> interfaces;
+    std::vector<Member> fields;
+    std::vector<Member> methods;
+    std::vector<Attribute> attributes;
+
+    // 复用各个vector的容量
+    void clear() {
+        interfaces.clear();
+        fields.clear();
+        methods.clear();
+        attributes.clear();
+    }
+};
+
+// 只收集检查需要的信息，不构建ClassFile对象图
+class InspectVisitor : public classfile::ClassVisitor {
+public:
+    explicit InspectVisitor(ClassInspection& out) : _out(out) {}
+
+    bool visitHeader(uint16_t minor_version, uint16_t major_version, uint16_t constant_pool_count) override {
+        _out.minor_version = minor_version;
+        _out.major_version = major_version;
+        _out.constant_count = constant_pool_count;
+        return true;
+    }
+
+    bool visitConstantPool(const classfile::ConstantPoolView& pool) override {
+        _pool = &pool;
+        return true;
+    }
+
+    bool visitClass(uint16_t access_flags, uint16_t this_class, uint16_t super_class, uint16_t interfaces_count) override {
+        _out.access_flags = access_flags;
+        _out.this_class = _pool->class_name(this_class);
+        _out.super_class = _pool->class_name(super_class);
+        _out.interfaces.reserve(interfaces_count);
+        return true;
+    }
+
+    bool visitInterface(uint16_t class_index) override {
+        _out.interfaces.push_back(_pool->class_name(class_index));
+        return true;
+    }
+
+    bool visitMember(classfile::MemberKind kind, uint16_t access_flags, uint16_t name_index, uint16_t descriptor_index) override {
+        auto& members = kind == classfile::MemberKind::FIELD ? _out.fields : _out.methods;
+        members.emplace_back();
+        _member = &members.back();
+        _member->name = _pool->utf8(name_index);
+        _member->descriptor = _pool->utf8(descriptor_index);
+        _member->access_flags = access_flags;
+        return true;
+    }
+
+    bool visitAttribute(classfile::AttributeOwner owner, classfile::AttributeKind /*kind*/, uint16_t name_index,
+                        const uint8_t* /*info*/, uint32_t length) override {
+        switch (owner) {
+            case classfile::AttributeOwner::CLASS:
+                _out.attributes.push_back(ClassInspection::Attribute{_pool->utf8(name_index), length});
+                break;
+            case classfile::AttributeOwner::FIELD:
+            case classfile::AttributeOwner::METHOD:
+                _member->attribute_bytes += 6 + length;
+                break;
+            case classfile::AttributeOwner::CODE:
+                break;
+        }
+        return true;
+    }
+
+    bool visitCode(uint16_t max_stack, uint16_t max_locals, const uint8_t* /*code*/, uint32_t code_length,
+                   const uint8_t* /*exception_table*/, uint16_t /*exception_table_length*/) override {
+        _member->has_code = true;
+        _member->max_stack = max_stack;
+        _member->max_locals = max_locals;
+        _member->code_length = code_length;
+        return true;
+    }
+
+private:
+    ClassInspection& _out;
+    const classfile::ConstantPoolView* _pool = nullptr;
+    ClassInspection::Member* _member = nullptr;
+};
+
+// 批量检查（类似对每个类执行javap）：
+// 输入可以是jar/zip、目录（递归查找.class）、单个.class文件或 dir/* （目录下所有jar），
+// 所有类按 输入顺序 -> 条目名 排序后切块，在线程池上并行扫描；
+// 输出按块的顺序流式写出，前面的块完成后立即输出，结果与线程数无关
+class ClassInspector {
+public:
+    // 每个任务处理的类数，同一jar的一块复用一个zip句柄
+    static const size_t CHUNK_SIZE = 64;
+
+    explicit ClassInspector(InspectFormat format, size_t thread_count = 0)
+        : _format(format), _pool(thread_count) {}
+
+    ClassInspector(const ClassInspector&) = delete;
+    ClassInspector& operator=(const ClassInspector&) = delete;
+
+    // 检查所有输入并把结果写到out，全部成功返回true
+    bool inspect(const std::vector<std::string>& inputs, FILE* out) {
+        _sources.clear();
+        _items.clear();
+        bool ok = true;
+        for (const std::string& input : inputs) {
+            ok = add_input(input) && ok;
+        }
+
+        std::vector<Chunk> chunks = make_chunks();
+        std::vector<std::string> outputs(chunks.size());
+        std::vector<bool> done(chunks.size(), false);
+        size_t next = 0;
+        size_t failed = 0;
+        std::mutex mutex;
+
+        if (_format == InspectFormat::TABLE) {
+            fprintf(out, "%-8s %6s %6s %6s %7s %8s %8s %8s  %s\n",
+                    "VERSION", "CP", "FLAGS", "FIELDS", "METHODS", "CODE", "ATTRS", "SIZE", "CLASS");
+        }
+
+        _pool.parallel_for(chunks.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                std::string text;
+                size_t chunk_failed = run_chunk(chunks[c], text);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                failed += chunk_failed;
+                outputs[c] = std::move(text);
+                done[c] = true;
+                for (; next < chunks.size() && done[next]; ++next) {
+                    fwrite(outputs[next].data(), 1, outputs[next].size(), out);
+                    std::string().swap(outputs[next]);
+                }
+                fflush(out);
+            }
+        });
+        return ok && failed == 0;
+    }
+
+private:
+    struct Source {
+        std::string path;
+        bool is_jar;
+    };
+
+    struct Item {
+        size_t source;
+        std::string name;       // jar条目名或文件路径
+        uint64_t zip_index;
+    };
+
+    struct Chunk {
+        size_t begin;
+        size_t end;
+    };
+
+    bool add_input(const std::string& input) {
+        if (!input.empty() && input.back() == '*') {
+            return add_jar_dir(input.substr(0, input.size() - 1));
+        }
+        if (is_archive(input)) {
+            return add_jar(input);
+        }
+        struct stat st;
+        if (stat(input.c_str(), &st) != 0) {
+            fprintf(stderr, "inspect: cannot access %s\n", input.c_str());
+            return false;
+        }
+        _sources.push_back(Source{input, false});
+        if (S_ISDIR(st.st_mode)) {
+            std::vector<std::string> files;
+            walk_directory(input, files);
+            std::sort(files.begin(), files.end());
+            for (std::string& file : files) {
+                _items.push_back(Item{_sources.size() - 1, std::move(file), 0});
+            }
+        } else {
+            _items.push_back(Item{_sources.size() - 1, input, 0});
+        }
+        return true;
+    }
+
+    // dir/* ：目录下的所有jar，与类路径通配符的含义相同
+    bool add_jar_dir(const std::string& dir_path) {
+        DIR* dir = opendir(dir_path.empty() ? "." : dir_path.c_str());
+        if (!dir) {
+            fprintf(stderr, "inspect: cannot open directory %s\n", dir_path.c_str());
+            return false;
+        }
+        std::vector<std::string> jars;
+        while (struct dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (is_archive(name)) {
+                jars.push_back(dir_path + name);
+            }
+        }
+        closedir(dir);
+
+        std::sort(jars.begin(), jars.end());
+        bool ok = true;
+        for (const std::string& jar : jars) {
+            ok = add_jar(jar) && ok;
+        }
+        return ok;
+    }
+
+    bool add_jar(const std::string& jar_path) {
+        classpath::ZipArchive archive(jar_path);
+        if (!archive.is_open()) {
+            fprintf(stderr, "inspect: cannot open archive %s\n", jar_path.c_str());
+            return false;
+        }
+        _sources.push_back(Source{jar_path, true});
+        size_t first = _items.size();
+        uint64_t count = archive.entry_count();
+        for (uint64_t i = 0; i < count; ++i) {
+            std::string name = archive.entry_name(i);
+            if (ends_with(name, ".class")) {
+                _items.push_back(Item{_sources.size() - 1, std::move(name), i});
+            }
+        }
+        std::sort(_items.begin() + first, _items.end(),
+                  [](const Item& a, const Item& b) { return a.name < b.name; });
+        return true;
+    }
+
+    static void walk_directory(const std::string& dir_path, std::vector<std::string>& files) {
+        DIR* dir = opendir(dir_path.c_str());
+        if (!dir) {
+            fprintf(stderr, "inspect: cannot open directory %s\n", dir_path.c_str());
+            return;
+        }
+        while (struct dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name == "." || name == "..") continue;
+            std::string path = dir_path + "/" + name;
+            struct stat st;
+            if (stat(path.c_str(), &st) != 0) continue;
+            if (S_ISDIR(st.st_mode)) {
+                walk_directory(path, files);
+            } else if (ends_with(name, ".class")) {
+                files.push_back(std::move(path));
+            }
+        }
+        closedir(dir);
+    }
+
+    // 同一来源的连续条目切成CHUNK_SIZE大小的块
+    std::vector<Chunk> make_chunks() const {
+        std::vector<Chunk> chunks;
+        size_t begin = 0;
+        for (size_t i = 1; i <= _items.size(); ++i) {
+            if (i == _items.size() || i - begin == CHUNK_SIZE || _items[i].source != _items[begin].source) {
+                chunks.push_back(Chunk{begin, i});
+                begin = i;
+            }
+        }
+        return chunks;
+    }
+
+    // 返回本块中失败的类数
+    size_t run_chunk(const Chunk& chunk, std::string& text) const {
+        const Source& source = _sources[_items[chunk.begin].source];
+        std::unique_ptr<classpath::ZipArchive> p_archive;
+        if (source.is_jar) {
+            // libzip句柄不能跨线程共享，每个任务自己打开
+            p_archive = std::make_unique<classpath::ZipArchive>(source.path);
+        }
+
+        size_t failed = 0;
+        std::string data;
+        ClassInspection inspection;
+        for (size_t i = chunk.begin; i < chunk.end; ++i) {
+            const Item& item = _items[i];
+            bool read_ok = p_archive ? p_archive->is_open() && p_archive->read(item.zip_index, data)
+                                     : util::util_file::read(item.name, data);
+            if (!read_ok) {
+                classfile::ClassFormatError error;
+                format_error(source, item, 0, "cannot read class data", error, text);
+                failed++;
+                continue;
+            }
+
+            inspection.clear();
+            InspectVisitor visitor(inspection);
+            classfile::ClassFormatError error = classfile::ClassScanner::scan(
+                reinterpret_cast<const uint8_t*>(data.data()), data.size(), visitor);
+            if (error) {
+                format_error(source, item, data.size(), error.message(), error, text);
+                failed++;
+                continue;
+            }
+            format_class(source, item, data.size(), inspection, text);
+        }
+        return failed;
+    }
+
+    void format_error(const Source& source, const Item& item, size_t size, const char* message,
+                      const classfile::ClassFormatError& error, std::string& text) const {
+        if (_format == InspectFormat::TABLE) {
+            append_format(text, "%-8s %6s %6s %6s %7s %8s %8zu  %s (%s at offset %zu)\n",
+                          "ERROR", "-", "-", "-", "-", "-", size, item.name.c_str(), message, error.offset);
+            return;
+        }
+        text += "{\"source\":";
+        append_json_string(text, source.path);
+        text += ",\"entry\":";
+        append_json_string(text, item.name);
+        append_format(text, ",\"size\":%zu,\"error\":", size);
+        append_json_string(text, message);
+        append_format(text, ",\"offset\":%zu}\n", error.offset);
+    }
+
+    void format_class(const Source& source, const Item& item, size_t size,
+                      const ClassInspection& c, std::string& text) const {
+        if (_format == InspectFormat::TABLE) {
+            uint64_t code_bytes = 0;
+            for (const auto& m : c.methods) code_bytes += m.code_length;
+            uint64_t attribute_bytes = 0;
+            for (const auto& a : c.attributes) attribute_bytes += 6 + a.length;
+            for (const auto& m : c.fields) attribute_bytes += m.attribute_bytes;
+            for (const auto& m : c.methods) attribute_bytes += m.attribute_bytes;
+            char version[16];
+            snprintf(version, sizeof(version), "%u.%u", c.major_version, c.minor_version);
+            append_format(text, "%-8s %6u 0x%04X %6zu %7zu %8llu %8llu %8zu  %s\n",
+                          version, c.constant_count, c.access_flags, c.fields.size(), c.methods.size(),
+                          static_cast<unsigned long long>(code_bytes),
+                          static_cast<unsigned long long>(attribute_bytes), size,
+                          util::util_mutf8::decode(reinterpret_cast<const uint8_t*>(c.this_class.data()),
+                                                   c.this_class.size()).c_str());
+            return;
+        }
+
+        text += "{\"source\":";
+        append_json_string(text, source.path);
+        text += ",\"entry\":";
+        append_json_string(text, item.name);
+        append_format(text, ",\"size\":%zu,\"version\":\"%u.%u\",\"constants\":%u,\"access\":\"0x%04X\",\"class\":",
+                      size, c.major_version, c.minor_version, c.constant_count, c.access_flags);
+        append_json_mutf8(text, c.this_class);
+        text += ",\"super\":";
+        append_json_mutf8(text, c.super_class);
+        text += ",\"interfaces\":[";
+        for (size_t i = 0; i < c.interfaces.size(); ++i) {
+            if (i > 0) text += ',';
+            append_json_mutf8(text, c.interfaces[i]);
+        }
+        text += "],\"fields\":";
+        append_json_members(text, c.fields);
+        text += ",\"methods\":";
+        append_json_members(text, c.methods);
+        text += ",\"attributes\":[";
+        for (size_t i = 0; i < c.attributes.size(); ++i) {
+            if (i > 0) text += ',';
+            text += "{\"name\":";
+            append_json_mutf8(text, c.attributes[i].name);
+            append_format(text, ",\"length\":%u}", c.attributes[i].length);
+        }
+        text += "]}\n";
+    }
+
+    static void append_json_members(std::string& text, const std::vector<ClassInspection::Member>& members) {
+        text += '[';
+        for (size_t i = 0; i < members.size(); ++i) {
+            const ClassInspection::Member& m = members[i];
+            if (i > 0) text += ',';
+            text += "{\"name\":";
+            append_json_mutf8(text, m.name);
+            text += ",\"descriptor\":";
+            append_json_mutf8(text, m.descriptor);
+            append_format(text, ",\"access\":\"0x%04X\",\"attribute_bytes\":%u", m.access_flags, m.attribute_bytes);
+            if (m.has_code) {
+                append_format(text, ",\"max_stack\":%u,\"max_locals\":%u,\"code_length\":%u",
+                              m.max_stack, m.max_locals, m.code_length);
+            }
+            text += '}';
+        }
+        text += ']';
+    }
+
+    static void append_json_mutf8(std::string& text, std::string_view s) {
+        append_json_string(text, util::util_mutf8::decode(reinterpret_cast<const uint8_t*>(s.data()), s.size()));
+    }
+
+    static void append_json_string(std::string& text, std::string_view s) {
+        text += '"';
+        for (char ch : s) {
+            switch (ch) {
+                case '"':  text += "\\\""; break;
+                case '\\': text += "\\\\"; break;
+                case '\n': text += "\\n"; break;
+                case '\r': text += "\\r"; break;
+                case '\t': text += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(ch) < 0x20) {
+                        append_format(text, "\\u%04x", static_cast<unsigned>(ch));
+                    } else {
+                        text += ch;
+                    }
+            }
+        }
+        text += '"';
+    }
+
+    __attribute__((format(printf, 2, 3)))
+    static void append_format(std::string& text, const char* format, ...) {
+        char buf[512];
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        if (n < 0) return;
+        if (static_cast<size_t>(n) < sizeof(buf)) {
+            text.append(buf, n);
+            return;
+        }
+        size_t old_size = text.size();
+        text.resize(old_size + n + 1);
+        va_start(args, format);
+        vsnprintf(&text[old_size], n + 1, format, args);
+        va_end(args);
+        text.resize(old_size + n);
+    }
+
+    static bool ends_with(const std::string& s, const char* suffix) {
+        size_t n = strlen(suffix);
+        return s.size() > n && s.compare(s.size() - n, n, suffix) == 0;
+    }
+
+    static bool is_archive(const std::string& path) {
+        return ends_with(path, ".jar") || ends_with(path, ".JAR") ||
+               ends_with(path, ".zip") || ends_with(path, ".ZIP");
+    }
+
+    InspectFormat _format;
+    util::ThreadPool _pool;
+    std::vector<Source> _sources;
+    std::vector<Item> _items;
+};
+
+} // namespace classloader
+} // namespace jvm
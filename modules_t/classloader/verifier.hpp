@@ -0,0 +1,1801 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../log.hpp"
+#include "../thread_pool.hpp"
+#include "../classfile/class_file.hpp"
+#include "../instructions/base/opcode_info.hpp"
+
+namespace jvm {
+namespace classloader {
+
+// java.lang.VerifyError：出错指令的pc + 错误信息
+struct VerifyError {
+    const char* message = nullptr;
+    uint32_t pc = 0;
+
+    explicit operator bool() const noexcept { return message != nullptr; }
+};
+
+// 验证器内部的类型
+// long/double在局部变量表和操作数栈中都占两个槽位，第二个槽位是TOP
+enum class VKind : uint8_t {
+    TOP,
+    INT,            // boolean/byte/char/short/int
+    FLOAT,
+    LONG,
+    DOUBLE,
+    NULL_REF,
+    UNINIT_THIS,    // 构造函数中尚未调用super()/this()的this
+    UNINIT,         // data为对应new指令的pc
+    REF,            // data为类名（或数组描述符）在本方法内驻留后的编号
+    RETURN_ADDRESS, // jsr压入的返回地址，data为子程序入口pc；只能astore和ret，不是引用
+};
+
+struct VType {
+    VKind kind;
+    uint32_t data;
+
+    bool operator==(const VType& other) const { return kind == other.kind && data == other.data; }
+    bool operator!=(const VType& other) const { return !(*this == other); }
+};
+
+// 引用类型之间的可赋值关系（from是否是to的子类型），由已加载的类层次回答。
+// 未提供时除数组规则外一律放行，留到解析/链接符号引用时再检查
+using AssignableFn = std::function<bool(const std::string& from, const std::string& to)>;
+
+// protected检查（JVMS 4.10.1.8）用：从class_name沿超类链查找名字和描述符相同的字段或方法，
+// 找到的声明是protected时返回声明它的类名，否则返回空串。
+// 未提供时不做protected检查，和可赋值关系一样留到解析符号引用时再检查
+using ProtectedMemberFn = std::function<std::string(const std::string& class_name, const std::string& name,
+                                                    const std::string& descriptor)>;
+
+// 单个方法的类型检查验证器（JVMS 4.10.1）
+// 依赖StackMapTable：分支目标和异常处理器入口处的类型状态由栈映射帧给出，
+// 所以字节码只需从头到尾线性扫描一遍，不需要数据流迭代。
+// 50以前的类文件没有StackMapTable，改用类型推导（JVMS 4.10.2）：
+// 分支目标和异常处理器入口的状态由所有前驱合并得到，迭代到不再变化；
+// jsr/ret子程序按JVMS 4.10.2.4处理，见jsr()和ret()
+class MethodVerifier {
+public:
+    MethodVerifier(const classfile::ConstantPool& cp,
+                   const std::string& this_class,
+                   const classfile::MemberInfo& method,
+                   const classfile::CodeAttribute& code,
+                   const AssignableFn* p_assignable = nullptr,
+                   const ProtectedMemberFn* p_protected_member = nullptr)
+        : _cp(cp), _method(method), _code(code.getCode()),
+          _max_stack(code.getMaxStack()), _max_locals(code.getMaxLocals()),
+          _exception_table(code.getExceptionTable()), _p_stack_map(code.getStackMapTable()),
+          _p_assignable(p_assignable), _p_protected_member(p_protected_member) {
+        // 常用类名预先驻留，编号固定
+        intern("java/lang/Object");
+        intern("java/lang/String");
+        intern("java/lang/Class");
+        intern("java/lang/Throwable");
+        intern("java/lang/invoke/MethodType");
+        intern("java/lang/invoke/MethodHandle");
+        _this_class = intern(this_class);
+    }
+
+    VerifyError verify() { return run(); }
+
+    // 验证整个方法，同时给出每个可达GC点（见gc/reference_map.hpp）执行之前的引用位图，GC据此扫描解释器栈帧。
+    // maps按本方法的max_locals构造；infer为true时用类型推导验证（50以前的类文件）；验证失败时maps的内容无意义
+    VerifyError reference_maps(bool infer, classfile::ReferenceMaps& maps) {
+        _recording = true;
+        VerifyError error = infer ? run_inference() : run();
+        _recording = false;
+        if (error) return error;
+        for (uint32_t pc = 0; pc < _has_state.size(); pc++) {
+            if (!_has_state[pc] || !is_gc_point(pc)) continue;
+            const State& state = _states[pc];
+            size_t local_count = std::min<size_t>(state.locals.size(), _max_locals);
+            maps.add(pc, static_cast<uint16_t>(state.stack.size()), [&](size_t i) {
+                if (i < _max_locals) return i < local_count && is_reference(state.locals[i].kind);
+                return is_reference(state.stack[i - _max_locals].kind);
+            });
+            if (state.subroutine != NO_SUBROUTINE && !defer_to_callers(pc, state, maps)) return _error;
+        }
+        for (const auto& [entry, sub] : _subroutines) {
+            for (const SubroutineCall& call : sub.calls) maps.addCall(call.jsr_pc, call.return_pc);
+        }
+        maps.finish();
+        return error;
+    }
+
+    // 验证过程中实际达到的最大栈深度（槽位数）
+    uint16_t max_stack_depth() const { return _max_depth; }
+
+private:
+    VerifyError run() {
+        _pc = 0;
+        if (_code.empty() || _code.size() > UINT16_MAX) {
+            fail("invalid code length");
+            return _error;
+        }
+        if (!init_method_type() || !build_frames() || !build_handlers()) {
+            return _error;
+        }
+
+        std::vector<uint8_t> instruction_start(_code.size(), 0);
+        if (_recording) {
+            _states.assign(_code.size(), State{});
+            _has_state.assign(_code.size(), 0);
+            _polls.assign(_code.size(), 0);
+        }
+        _cur = _initial;
+        bool reachable = true;
+        for (_pc = 0; _pc < _code.size(); _pc = _next) {
+            if (const classfile::StackMapFrame* p_frame = frame_at(_pc)) {
+                const State& frame = _frames[p_frame - _p_stack_map->getFrames().data()];
+                if (reachable && !state_assignable(_cur, frame)) {
+                    fail("current frame is not assignable to stack map frame");
+                    return _error;
+                }
+                _cur = frame;
+                _max_depth = std::max<uint16_t>(_max_depth, static_cast<uint16_t>(_cur.stack.size()));
+            } else if (!reachable) {
+                fail("expecting a stack map frame after unconditional branch");
+                return _error;
+            }
+            instruction_start[_pc] = 1;
+            if (_recording) {
+                _states[_pc] = _cur;
+                _has_state[_pc] = 1;
+            }
+
+            if (!check_handlers(_cur.locals)) return _error;
+            _locals_changed = false;
+            if (!step(reachable)) return _error;
+            if (_locals_changed && !check_handlers(_cur.locals)) return _error;
+        }
+        if (reachable) {
+            _pc = static_cast<uint32_t>(_code.size());
+            fail("falling off the end of the code");
+            return _error;
+        }
+
+        // 栈映射帧和异常处理范围都必须落在指令边界上
+        if (_p_stack_map) {
+            for (const auto& frame : _p_stack_map->getFrames()) {
+                if (!instruction_start[frame.pc]) {
+                    _pc = frame.pc;
+                    fail("stack map frame is not at an instruction boundary");
+                    return _error;
+                }
+            }
+        }
+        for (const Handler& h : _handlers) {
+            if (!instruction_start[h.start] || (h.end < _code.size() && !instruction_start[h.end])) {
+                _pc = h.start;
+                fail("exception handler range is not at an instruction boundary");
+                return _error;
+            }
+        }
+        return _error;
+    }
+
+    // 类型推导：从方法入口开始，每条指令执行后的状态合并进后继指令（落到的下一条、分支目标、
+    // 覆盖它的异常处理器入口），状态有变化的指令重新处理，直到全部稳定
+    VerifyError run_inference() {
+        _pc = 0;
+        if (_code.empty() || _code.size() > UINT16_MAX) {
+            fail("invalid code length");
+            return _error;
+        }
+        _inferring = true;
+        if (!init_method_type() || !mark_instruction_starts() || !build_handlers()) {
+            return _error;
+        }
+        _states.assign(_code.size(), State{});
+        _has_state.assign(_code.size(), 0);
+        _changed.assign(_code.size(), 0);
+        _polls.assign(_code.size(), 0);
+        if (!merge_into(0, _initial)) return _error;
+
+        for (bool again = true; again;) {
+            again = false;
+            for (uint32_t pc = 0; pc < _code.size(); pc++) {
+                if (!_changed[pc]) continue;
+                _changed[pc] = 0;
+                again = true;
+                _pc = pc;
+                _cur = _states[pc];
+                if (!check_handlers(_cur.locals)) return _error;
+                _locals_changed = false;
+                bool falls_through;
+                if (!step(falls_through)) return _error;
+                if (_locals_changed && !check_handlers(_cur.locals)) return _error;
+                if (falls_through) {
+                    if (_next >= _code.size()) {
+                        _pc = static_cast<uint32_t>(_code.size());
+                        fail("falling off the end of the code");
+                        return _error;
+                    }
+                    if (!merge_into(_next, _cur)) return _error;
+                }
+            }
+        }
+        return _error;
+    }
+
+    static constexpr uint32_t NO_SUBROUTINE = UINT32_MAX;
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    struct State {
+        std::vector<VType> locals;
+        std::vector<VType> stack;
+        // 类型推导：所在子程序的入口pc（不在子程序里为NO_SUBROUTINE），
+        // 以及进入这个子程序之后写过的局部变量（不在子程序里时为空）
+        uint32_t subroutine = NO_SUBROUTINE;
+        std::vector<uint8_t> modified;
+    };
+
+    // 子程序：各调用点（jsr的pc和返回地址），以及已经处理过的ret
+    struct SubroutineCall {
+        uint32_t jsr_pc;
+        uint32_t return_pc;
+    };
+    struct Subroutine {
+        std::vector<SubroutineCall> calls;
+        std::vector<uint32_t> rets;
+    };
+
+    struct Handler {
+        uint16_t start;
+        uint16_t end;
+        const State* p_frame;   // 类型推导时为nullptr，入口状态由合并得到
+        uint16_t handler_pc;
+        VType catch_type;
+    };
+
+    static constexpr uint32_t OBJECT = 0;
+    static constexpr uint32_t STRING = 1;
+    static constexpr uint32_t CLASS = 2;
+    static constexpr uint32_t THROWABLE = 3;
+    static constexpr uint32_t METHOD_TYPE = 4;
+    static constexpr uint32_t METHOD_HANDLE = 5;
+
+    static VType make(VKind kind, uint32_t data = 0) { return VType{kind, data}; }
+    static bool is_cat2(VKind kind) { return kind == VKind::LONG || kind == VKind::DOUBLE; }
+    static bool is_reference(VKind kind) {
+        return kind == VKind::REF || kind == VKind::NULL_REF ||
+               kind == VKind::UNINIT || kind == VKind::UNINIT_THIS;
+    }
+
+    // GC可能发生时栈帧可能停在的指令：方法入口、可能抛出异常（要分配异常对象，调用、分配、返回也在其中）
+    // 的指令，以及轮询安全点的回边。jsr本身不会停下，但子程序里的GC点要借它的位图（见defer_to_callers()）
+    bool is_gc_point(uint32_t pc) const {
+        if (pc == 0 || _polls[pc]) return true;
+        auto op = static_cast<instructions::Opcode>(_code[pc]);
+        if (op == instructions::Opcode::JSR || op == instructions::Opcode::JSR_W) return true;
+        return instructions::opcode_info(op).has(instructions::opflag::CAN_THROW);
+    }
+
+    bool fail(const char* message) {
+        if (!_error) {
+            _error.message = message;
+            _error.pc = _pc;
+        }
+        return false;
+    }
+
+    ///////////////////// 类名驻留 /////////////////////
+
+    uint32_t intern(const std::string& name) {
+        auto it = _name_ids.find(name);
+        if (it != _name_ids.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(_names.size());
+        _names.push_back(name);
+        _name_ids.emplace(name, id);
+        return id;
+    }
+
+    ///////////////////// 可赋值关系 /////////////////////
+
+    bool ref_assignable(uint32_t from, uint32_t to) {
+        if (from == to || to == OBJECT) return true;
+        const std::string from_name = _names[from];
+        const std::string to_name = _names[to];
+        bool from_array = from_name[0] == '[';
+        bool to_array = to_name[0] == '[';
+        if (from_array && to_array) {
+            // 组件都是引用类型时按组件的可赋值关系，基本类型组件必须完全相同
+            char fc = from_name[1];
+            char tc = to_name[1];
+            if ((fc == 'L' || fc == '[') && (tc == 'L' || tc == '[')) {
+                return ref_assignable(intern(component_name(from_name)), intern(component_name(to_name)));
+            }
+            return false;
+        }
+        if (from_array) {
+            return to_name == "java/lang/Cloneable" || to_name == "java/io/Serializable";
+        }
+        if (to_array) {
+            return false;
+        }
+        return _p_assignable == nullptr || !*_p_assignable || (*_p_assignable)(from_name, to_name);
+    }
+
+    // "[Ljava/lang/String;" -> "java/lang/String"，"[[I" -> "[I"
+    static std::string component_name(const std::string& array) {
+        if (array[1] == 'L') {
+            return array.substr(2, array.size() - 3);
+        }
+        return array.substr(1);
+    }
+
+    bool assignable(const VType& from, const VType& to) {
+        if (to.kind == VKind::TOP) return true;
+        if (from.kind == to.kind) {
+            if (from.kind == VKind::REF) return ref_assignable(from.data, to.data);
+            if (from.kind == VKind::UNINIT) return from.data == to.data;
+            return true;
+        }
+        return from.kind == VKind::NULL_REF && to.kind == VKind::REF;
+    }
+
+    bool state_assignable(const State& from, const State& to) {
+        if (from.stack.size() != to.stack.size()) return false;
+        for (size_t i = 0; i < from.locals.size(); i++) {
+            if (!assignable(from.locals[i], to.locals[i])) return false;
+        }
+        for (size_t i = 0; i < from.stack.size(); i++) {
+            if (!assignable(from.stack[i], to.stack[i])) return false;
+        }
+        return true;
+    }
+
+    ///////////////////// 描述符和常量池 /////////////////////
+
+    // 解析一个字段类型描述符，i指向描述符起点，成功后指向下一个类型
+    bool parse_field_type(const std::string& desc, size_t& i, VType& type) {
+        if (i >= desc.size()) return false;
+        switch (desc[i]) {
+            case 'B': case 'C': case 'I': case 'S': case 'Z':
+                ++i; type = make(VKind::INT); return true;
+            case 'F': ++i; type = make(VKind::FLOAT); return true;
+            case 'J': ++i; type = make(VKind::LONG); return true;
+            case 'D': ++i; type = make(VKind::DOUBLE); return true;
+            case 'L': {
+                size_t end = desc.find(';', i);
+                if (end == std::string::npos || end == i + 1) return false;
+                type = make(VKind::REF, intern(desc.substr(i + 1, end - i - 1)));
+                i = end + 1;
+                return true;
+            }
+            case '[': {
+                size_t begin = i;
+                while (i < desc.size() && desc[i] == '[') ++i;
+                if (i - begin > 255) return false;
+                VType component;
+                if (!parse_field_type(desc, i, component)) return false;
+                type = make(VKind::REF, intern(desc.substr(begin, i - begin)));
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    bool parse_method_descriptor(const std::string& desc, std::vector<VType>& args, VType& ret, bool& is_void) {
+        if (desc.empty() || desc[0] != '(') return false;
+        size_t i = 1;
+        args.clear();
+        while (i < desc.size() && desc[i] != ')') {
+            VType arg;
+            if (!parse_field_type(desc, i, arg)) return false;
+            args.push_back(arg);
+        }
+        if (i >= desc.size()) return false;
+        ++i;
+        is_void = i < desc.size() && desc[i] == 'V';
+        if (is_void) return i + 1 == desc.size();
+        return parse_field_type(desc, i, ret) && i == desc.size();
+    }
+
+    bool cp_class_name(uint16_t index, const std::string*& p_name) {
+        auto* p_class = dynamic_cast<const classfile::ConstantClassInfo*>(_cp.find_constant_info(index));
+        p_name = p_class ? _cp.find_utf8(p_class->get_name_index()) : nullptr;
+        return p_name != nullptr || fail("invalid class constant");
+    }
+
+    // 类常量转为引用类型，数组类型的名字本身就是描述符
+    bool cp_class_type(uint16_t index, VType& type) {
+        const std::string* p_name;
+        if (!cp_class_name(index, p_name)) return false;
+        type = make(VKind::REF, intern(*p_name));
+        return true;
+    }
+
+    bool cp_name_and_type(uint16_t index, const std::string*& p_name, const std::string*& p_desc) {
+        auto* p_nt = dynamic_cast<const classfile::ConstantNameAndTypeInfo*>(_cp.find_constant_info(index));
+        if (p_nt == nullptr) return fail("invalid name and type constant");
+        p_name = _cp.find_utf8(p_nt->get_name_index());
+        p_desc = _cp.find_utf8(p_nt->get_descriptor_index());
+        return (p_name && p_desc) || fail("invalid name and type constant");
+    }
+
+    template <typename RefInfo>
+    bool cp_member_ref(uint16_t index, const RefInfo*& p_ref, const std::string*& p_class,
+                       const std::string*& p_name, const std::string*& p_desc) {
+        p_ref = dynamic_cast<const RefInfo*>(_cp.find_constant_info(index));
+        if (p_ref == nullptr) return fail("invalid member reference constant");
+        return cp_class_name(p_ref->_class_index, p_class) &&
+               cp_name_and_type(p_ref->_name_and_type_index, p_name, p_desc);
+    }
+
+    ///////////////////// 初始帧和栈映射帧 /////////////////////
+
+    bool init_method_type() {
+        const std::string* p_name = _cp.find_utf8(_method.name_index());
+        const std::string* p_desc = _cp.find_utf8(_method.descriptor_index());
+        if (!p_name || !p_desc) return fail("invalid method name or descriptor");
+        _is_init = *p_name == "<init>";
+
+        std::vector<VType> args;
+        if (!parse_method_descriptor(*p_desc, args, _return_type, _returns_void)) {
+            return fail("invalid method descriptor");
+        }
+
+        // 初始帧的局部变量（压缩形式，long/double只占一项）
+        std::vector<VType> locals;
+        if ((_method.access_flags() & 0x0008) == 0) {  // ACC_STATIC
+            bool uninit = _is_init && _names[_this_class] != "java/lang/Object";
+            locals.push_back(uninit ? make(VKind::UNINIT_THIS) : make(VKind::REF, _this_class));
+        }
+        locals.insert(locals.end(), args.begin(), args.end());
+        _initial_locals = locals;
+        return expand(locals, _max_locals, true, _initial.locals) || fail("arguments exceed max_locals");
+    }
+
+    // 压缩形式 -> 槽位形式，long/double后补一个TOP；局部变量表用TOP补足到max_locals
+    static bool expand(const std::vector<VType>& types, size_t limit, bool pad, std::vector<VType>& out) {
+        out.clear();
+        for (const VType& t : types) {
+            out.push_back(t);
+            if (is_cat2(t.kind)) out.push_back(make(VKind::TOP));
+        }
+        if (out.size() > limit) return false;
+        if (pad) out.resize(limit, make(VKind::TOP));
+        return true;
+    }
+
+    bool convert(const classfile::VerificationType& vt, VType& type) {
+        using classfile::VerificationTypeTag;
+        switch (vt.tag) {
+            case VerificationTypeTag::TOP: type = make(VKind::TOP); return true;
+            case VerificationTypeTag::INTEGER: type = make(VKind::INT); return true;
+            case VerificationTypeTag::FLOAT: type = make(VKind::FLOAT); return true;
+            case VerificationTypeTag::DOUBLE: type = make(VKind::DOUBLE); return true;
+            case VerificationTypeTag::LONG: type = make(VKind::LONG); return true;
+            case VerificationTypeTag::NULL_TYPE: type = make(VKind::NULL_REF); return true;
+            case VerificationTypeTag::UNINITIALIZED_THIS: type = make(VKind::UNINIT_THIS); return true;
+            case VerificationTypeTag::OBJECT: return cp_class_type(vt.data, type);
+            case VerificationTypeTag::UNINITIALIZED:
+                if (static_cast<size_t>(vt.data) + 3 > _code.size() ||
+                    _code[vt.data] != static_cast<uint8_t>(instructions::Opcode::NEW)) {
+                    return fail("uninitialized type does not refer to a new instruction");
+                }
+                type = make(VKind::UNINIT, vt.data);
+                return true;
+        }
+        return fail("bad verification type");
+    }
+
+    bool convert_all(const classfile::VerificationType* p_types, size_t count, std::vector<VType>& out) {
+        for (size_t i = 0; i < count; i++) {
+            VType t;
+            if (!convert(p_types[i], t)) return false;
+            out.push_back(t);
+        }
+        return true;
+    }
+
+    // 把增量编码的栈映射帧依次展开为完整的槽位形式
+    bool build_frames() {
+        if (_p_stack_map == nullptr) return true;
+        using classfile::StackMapFrameKind;
+        const auto& frames = _p_stack_map->getFrames();
+        _frames.resize(frames.size());
+        std::vector<VType> locals = _initial_locals;
+        std::vector<VType> stack;
+        for (size_t i = 0; i < frames.size(); i++) {
+            const classfile::StackMapFrame& f = frames[i];
+            _pc = f.pc;
+            stack.clear();
+            switch (f.kind) {
+                case StackMapFrameKind::SAME:
+                    break;
+                case StackMapFrameKind::SAME_LOCALS_1_STACK_ITEM:
+                    if (!convert_all(_p_stack_map->stackOf(f), 1, stack)) return false;
+                    break;
+                case StackMapFrameKind::CHOP:
+                    if (f.chopCount > locals.size()) return fail("chop frame removes too many locals");
+                    locals.resize(locals.size() - f.chopCount);
+                    break;
+                case StackMapFrameKind::APPEND:
+                    if (!convert_all(_p_stack_map->localsOf(f), f.localsCount, locals)) return false;
+                    break;
+                case StackMapFrameKind::FULL:
+                    locals.clear();
+                    if (!convert_all(_p_stack_map->localsOf(f), f.localsCount, locals) ||
+                        !convert_all(_p_stack_map->stackOf(f), f.stackCount, stack)) {
+                        return false;
+                    }
+                    break;
+            }
+            if (!expand(locals, _max_locals, true, _frames[i].locals)) {
+                return fail("stack map frame locals exceed max_locals");
+            }
+            if (!expand(stack, _max_stack, false, _frames[i].stack)) {
+                return fail("stack map frame stack exceeds max_stack");
+            }
+        }
+        return true;
+    }
+
+    const classfile::StackMapFrame* frame_at(uint32_t pc) const {
+        return _p_stack_map ? _p_stack_map->frameAt(pc) : nullptr;
+    }
+
+    const State* state_at(uint32_t pc) const {
+        const classfile::StackMapFrame* p_frame = frame_at(pc);
+        return p_frame ? &_frames[p_frame - _p_stack_map->getFrames().data()] : nullptr;
+    }
+
+    ///////////////////// 异常处理器 /////////////////////
+
+    bool build_handlers() {
+        _handlers.reserve(_exception_table.size());
+        for (const auto& p_entry : _exception_table) {
+            _pc = p_entry->getHandlerPc();
+            if (p_entry->getStartPc() >= p_entry->getEndPc() || p_entry->getEndPc() > _code.size() ||
+                p_entry->getHandlerPc() >= _code.size()) {
+                return fail("invalid exception handler range");
+            }
+            VType exception = make(VKind::REF, THROWABLE);
+            if (p_entry->getCatchType() != 0 && !cp_class_type(p_entry->getCatchType(), exception)) {
+                return false;
+            }
+            if (_inferring) {
+                if (!_instruction_start[p_entry->getStartPc()] ||
+                    (p_entry->getEndPc() < _code.size() && !_instruction_start[p_entry->getEndPc()])) {
+                    return fail("exception handler range is not at an instruction boundary");
+                }
+                _handlers.push_back(Handler{p_entry->getStartPc(), p_entry->getEndPc(), nullptr,
+                                            p_entry->getHandlerPc(), exception});
+                continue;
+            }
+
+            const State* p_frame = state_at(p_entry->getHandlerPc());
+            if (p_frame == nullptr) return fail("exception handler has no stack map frame");
+            if (p_frame->stack.size() != 1 || !assignable(exception, p_frame->stack[0])) {
+                return fail("exception handler frame does not match catch type");
+            }
+            _handlers.push_back(Handler{p_entry->getStartPc(), p_entry->getEndPc(), p_frame,
+                                        p_entry->getHandlerPc(), exception});
+        }
+        return true;
+    }
+
+    // 受保护范围内每条指令执行前后的局部变量都必须能赋值给处理器入口帧；
+    // 类型推导时改为合并进处理器入口的状态（操作数栈只有捕获的异常）
+    bool check_handlers(const std::vector<VType>& locals) {
+        for (const Handler& h : _handlers) {
+            if (_pc < h.start || _pc >= h.end) continue;
+            if (_inferring) {
+                State entry{locals, {h.catch_type}, _cur.subroutine, _cur.modified};
+                if (!merge_into(h.handler_pc, entry)) return false;
+                continue;
+            }
+            for (size_t i = 0; i < locals.size(); i++) {
+                if (!assignable(locals[i], h.p_frame->locals[i])) {
+                    return fail("locals are not assignable to exception handler frame");
+                }
+            }
+        }
+        return true;
+    }
+
+    ///////////////////// 类型推导 /////////////////////
+
+    // 按指令长度切分字节码，标出每条指令的起点：分支目标和异常处理范围都必须落在起点上
+    bool mark_instruction_starts() {
+        _instruction_start.assign(_code.size(), 0);
+        for (_pc = 0; _pc < _code.size(); _pc = _next) {
+            _instruction_start[_pc] = 1;
+            if (!instruction_length()) return false;
+        }
+        return true;
+    }
+
+    // 求_pc处指令的长度写入_next，变长指令按step()里的同样规则计算
+    bool instruction_length() {
+        using instructions::Opcode;
+        Opcode op = static_cast<Opcode>(_code[_pc]);
+        const instructions::OpcodeInfo& info = instructions::opcode_info(op);
+        if (!info.valid() || info.has(instructions::opflag::RESERVED)) return fail("invalid opcode");
+        if (info.length != 0) return length(info.length);
+        uint32_t base = (_pc + 4) & ~3u;
+        switch (op) {
+            case Opcode::TABLESWITCH: {
+                if (!length(base - _pc + 12)) return false;
+                int64_t count = static_cast<int64_t>(s4(base + 8)) - s4(base + 4) + 1;
+                if (count <= 0 || count > static_cast<int64_t>(_code.size())) return fail("tableswitch low > high");
+                return length(base - _pc + 12 + 4 * static_cast<uint32_t>(count));
+            }
+            case Opcode::LOOKUPSWITCH: {
+                if (!length(base - _pc + 8)) return false;
+                int32_t npairs = s4(base + 4);
+                if (npairs < 0 || npairs > static_cast<int64_t>(_code.size())) {
+                    return fail("invalid lookupswitch pair count");
+                }
+                return length(base - _pc + 8 + 8 * static_cast<uint32_t>(npairs));
+            }
+            case Opcode::WIDE:
+                if (!length(2)) return false;
+                return length(static_cast<Opcode>(u1(1)) == Opcode::IINC ? 6 : 4);
+            default:
+                return fail("invalid opcode");
+        }
+    }
+
+    // 把state合并进target处指令执行之前的状态，有变化时标记target待重新处理
+    bool merge_into(uint32_t target, const State& state) {
+        if (!_instruction_start[target]) return fail("branch target is not at an instruction boundary");
+        if (!_has_state[target]) {
+            _states[target] = state;
+            _has_state[target] = 1;
+            _changed[target] = 1;
+            return true;
+        }
+        State& merged = _states[target];
+        bool changed = false;
+        if (merged.subroutine != state.subroutine) {
+            // 不经过ret离开子程序（异常、跳到外层的goto）：按外层合并。子程序里没改过的局部变量
+            // 是各调用点合并来的，保守地当作都改过
+            if (is_ancestor(merged.subroutine, state.subroutine)) {
+                State lifted{state.locals, state.stack, merged.subroutine, all_modified(merged.subroutine)};
+                return merge_into(target, lifted);
+            }
+            if (!is_ancestor(state.subroutine, merged.subroutine)) return fail("instruction is shared by subroutines");
+            merged.subroutine = state.subroutine;
+            merged.modified = all_modified(state.subroutine);
+            changed = true;
+        }
+        if (merged.stack.size() != state.stack.size()) return fail("inconsistent stack height at branch target");
+        for (size_t i = 0; i < merged.modified.size(); i++) {
+            if (state.modified[i] && !merged.modified[i]) {
+                merged.modified[i] = 1;
+                changed = true;
+            }
+        }
+        for (size_t i = 0; i < merged.locals.size(); i++) {
+            VType t = merge_types(merged.locals[i], state.locals[i]);
+            if (t != merged.locals[i]) {
+                merged.locals[i] = t;
+                changed = true;
+            }
+        }
+        for (size_t i = 0; i < merged.stack.size(); i++) {
+            VType t = merge_types(merged.stack[i], state.stack[i]);
+            if (t.kind == VKind::TOP && merged.stack[i].kind != VKind::TOP) {
+                return fail("inconsistent operand stack types at branch target");
+            }
+            if (t != merged.stack[i]) {
+                merged.stack[i] = t;
+                changed = true;
+            }
+        }
+        if (changed) _changed[target] = 1;
+        return true;
+    }
+
+    ///////////////////// 子程序（JVMS 4.10.2.4） /////////////////////
+
+    // jsr：返回地址压栈后转到子程序入口。入口状态由各调用点合并，并从这里开始记录改过哪些局部变量；
+    // 这个调用点的状态变了，已经处理过的ret要重新合并到它的返回地址
+    bool jsr(int64_t offset) {
+        int64_t target = static_cast<int64_t>(_pc) + offset;
+        if (target < 0 || target >= static_cast<int64_t>(_code.size())) {
+            return fail("branch target out of range");
+        }
+        if (_next >= _code.size()) return fail("jsr at the end of the code");
+        uint32_t entry = static_cast<uint32_t>(target);
+        if (is_ancestor(entry, _cur.subroutine)) return fail("recursive subroutine call");
+
+        Subroutine& sub = _subroutines[entry];
+        auto same_call = [this](const SubroutineCall& call) { return call.jsr_pc == _pc; };
+        if (std::find_if(sub.calls.begin(), sub.calls.end(), same_call) == sub.calls.end()) {
+            sub.calls.push_back(SubroutineCall{_pc, _next});
+        }
+        for (uint32_t ret_pc : sub.rets) _changed[ret_pc] = 1;
+
+        if (!push(make(VKind::RETURN_ADDRESS, entry))) return false;
+        State state{_cur.locals, _cur.stack, entry, std::vector<uint8_t>(_max_locals, 0)};
+        return merge_into(entry, state);
+    }
+
+    // ret：回到子程序的每个调用点之后。子程序里改过的局部变量取ret处的类型，
+    // 没改过的取调用点jsr之前的类型，操作数栈取ret处的
+    bool ret(uint32_t index) {
+        if (!check_local(index, false)) return false;
+        const VType& address = _cur.locals[index];
+        if (address.kind != VKind::RETURN_ADDRESS) return fail("ret on a local that is not a return address");
+        if (address.data != _cur.subroutine) return fail("ret does not return from the current subroutine");
+
+        Subroutine& sub = _subroutines[address.data];
+        if (std::find(sub.rets.begin(), sub.rets.end(), _pc) == sub.rets.end()) sub.rets.push_back(_pc);
+        for (const SubroutineCall& call : sub.calls) {
+            const State& caller = _states[call.jsr_pc];
+            State back{caller.locals, _cur.stack, caller.subroutine, caller.modified};
+            for (size_t i = 0; i < _cur.modified.size(); i++) {
+                if (!_cur.modified[i]) continue;
+                back.locals[i] = _cur.locals[i];
+                if (!back.modified.empty()) back.modified[i] = 1;
+            }
+            if (!merge_into(call.return_pc, back)) return false;
+        }
+        return true;
+    }
+
+    // outer是否是inner本身或者（经由调用点）在它外层；主程序在所有子程序外层
+    bool is_ancestor(uint32_t outer, uint32_t inner) const {
+        if (outer == inner || outer == NO_SUBROUTINE) return true;
+        if (inner == NO_SUBROUTINE) return false;
+        auto it = _subroutines.find(inner);
+        if (it == _subroutines.end()) return false;
+        for (const SubroutineCall& call : it->second.calls) {
+            if (is_ancestor(outer, _states[call.jsr_pc].subroutine)) return true;
+        }
+        return false;
+    }
+
+    // 子程序里的GC点：没改过的局部变量的类型取决于从哪个调用点进来，合并后不是引用、
+    // 而某个调用点在那里放着引用时记为待定，GC读出返回地址到jsr处的位图里查（见gc/reference_map.hpp）
+    bool defer_to_callers(uint32_t pc, const State& state, classfile::ReferenceMaps& maps) {
+        std::vector<uint8_t> deferred = deferred_locals(state);
+        if (std::find(deferred.begin(), deferred.end(), 1) == deferred.end()) return true;
+        uint32_t slot = return_address_slot(state);
+        if (slot == NO_SLOT || !deferred_chain_intact(state.subroutine, deferred, state.modified)) {
+            _pc = pc;
+            return fail("subroutine return address is lost while caller references are live");
+        }
+        maps.defer(slot, [&](size_t i) { return deferred[i] != 0; });
+        return true;
+    }
+
+    std::vector<uint8_t> deferred_locals(const State& state) {
+        std::vector<uint8_t> deferred(_max_locals, 0);
+        if (state.subroutine == NO_SUBROUTINE) return deferred;
+        const std::vector<uint8_t>& refs = caller_references(state.subroutine);
+        for (size_t i = 0; i < state.locals.size() && i < _max_locals; i++) {
+            deferred[i] = !is_reference(state.locals[i].kind) && !state.modified[i] && refs[i];
+        }
+        return deferred;
+    }
+
+    // 子程序的某个调用点（逐层往外）在哪些局部变量里放着引用
+    const std::vector<uint8_t>& caller_references(uint32_t subroutine) {
+        auto it = _caller_references.find(subroutine);
+        if (it != _caller_references.end()) return it->second;
+        std::vector<uint8_t> refs(_max_locals, 0);
+        for (const SubroutineCall& call : _subroutines[subroutine].calls) {
+            const State& caller = _states[call.jsr_pc];
+            const std::vector<uint8_t>* p_outer =
+                caller.subroutine == NO_SUBROUTINE ? nullptr : &caller_references(caller.subroutine);
+            for (size_t i = 0; i < caller.locals.size() && i < _max_locals; i++) {
+                if (is_reference(caller.locals[i].kind) || (p_outer && !caller.modified[i] && (*p_outer)[i])) {
+                    refs[i] = 1;
+                }
+            }
+        }
+        return _caller_references.emplace(subroutine, std::move(refs)).first->second;
+    }
+
+    // 调用点自己也待定时GC要接着读外层子程序的返回地址：它必须在局部变量里，
+    // 并且从那个调用点到GC点之间没被改写过（changed累计沿途各层改过的局部变量）
+    bool deferred_chain_intact(uint32_t subroutine, const std::vector<uint8_t>& deferred,
+                               const std::vector<uint8_t>& changed) {
+        for (const SubroutineCall& call : _subroutines[subroutine].calls) {
+            const State& caller = _states[call.jsr_pc];
+            std::vector<uint8_t> outer = deferred_locals(caller);
+            bool any = false;
+            for (size_t i = 0; i < outer.size(); i++) {
+                outer[i] = outer[i] && deferred[i];
+                any = any || outer[i];
+            }
+            if (!any) continue;
+            uint32_t slot = return_address_slot(caller);
+            if (slot >= _max_locals || changed[slot]) return false;
+            std::vector<uint8_t> next = changed;
+            for (size_t i = 0; i < next.size(); i++) next[i] = next[i] || caller.modified[i];
+            if (!deferred_chain_intact(caller.subroutine, outer, next)) return false;
+        }
+        return true;
+    }
+
+    // 当前子程序的返回地址所在的槽位（局部变量在前，之后是操作数栈），找不到时为NO_SLOT
+    uint32_t return_address_slot(const State& state) const {
+        VType address = make(VKind::RETURN_ADDRESS, state.subroutine);
+        for (size_t i = 0; i < state.locals.size(); i++) {
+            if (state.locals[i] == address) return static_cast<uint32_t>(i);
+        }
+        for (size_t i = 0; i < state.stack.size(); i++) {
+            if (state.stack[i] == address) return static_cast<uint32_t>(_max_locals + i);
+        }
+        return NO_SLOT;
+    }
+
+    std::vector<uint8_t> all_modified(uint32_t subroutine) const {
+        return subroutine == NO_SUBROUTINE ? std::vector<uint8_t>() : std::vector<uint8_t>(_max_locals, 1);
+    }
+
+    void mark_modified(size_t index) {
+        if (!_cur.modified.empty()) _cur.modified[index] = 1;
+    }
+
+    // 两个类型的最小公共上界，合不起来的是TOP（之后不能再作为值使用）。
+    // 已有的类型能接收新来的就不变，保证迭代收敛
+    VType merge_types(const VType& current, const VType& incoming) {
+        if (current == incoming || current.kind == VKind::TOP) return current;
+        if (incoming.kind == VKind::NULL_REF && current.kind == VKind::REF) return current;
+        if (current.kind == VKind::NULL_REF && incoming.kind == VKind::REF) return incoming;
+        if (current.kind != VKind::REF || incoming.kind != VKind::REF) return make(VKind::TOP);
+        if (ref_assignable(incoming.data, current.data)) return current;
+        if (ref_assignable(current.data, incoming.data)) return incoming;
+        return make(VKind::REF, common_superclass(current.data, incoming.data));
+    }
+
+    // 没有完整的类层次，互不可赋值的两个类合并为Object；元素都是引用的数组按元素合并
+    uint32_t common_superclass(uint32_t a, uint32_t b) {
+        const std::string a_name = _names[a];
+        const std::string b_name = _names[b];
+        if (a_name[0] == '[' && b_name[0] == '[' && (a_name[1] == 'L' || a_name[1] == '[') &&
+            (b_name[1] == 'L' || b_name[1] == '[')) {
+            VType component = merge_types(make(VKind::REF, intern(component_name(a_name))),
+                                          make(VKind::REF, intern(component_name(b_name))));
+            const std::string& name = _names[component.data];
+            return intern(name[0] == '[' ? "[" + name : "[L" + name + ";");
+        }
+        return OBJECT;
+    }
+
+    ///////////////////// 操作数栈和局部变量 /////////////////////
+
+    bool push(VType type) {
+        size_t need = is_cat2(type.kind) ? 2 : 1;
+        if (_cur.stack.size() + need > _max_stack) return fail("operand stack overflow");
+        _cur.stack.push_back(type);
+        if (need == 2) _cur.stack.push_back(make(VKind::TOP));
+        _max_depth = std::max<uint16_t>(_max_depth, static_cast<uint16_t>(_cur.stack.size()));
+        return true;
+    }
+
+    bool pop(VType expected) {
+        auto& s = _cur.stack;
+        if (is_cat2(expected.kind)) {
+            if (s.size() < 2 || s.back().kind != VKind::TOP || s[s.size() - 2].kind != expected.kind) {
+                return fail("bad operand type (expected long/double)");
+            }
+            s.resize(s.size() - 2);
+            return true;
+        }
+        if (s.empty()) return fail("operand stack underflow");
+        if (s.back().kind == VKind::TOP || !assignable(s.back(), expected)) {
+            return fail("bad operand type");
+        }
+        s.pop_back();
+        return true;
+    }
+
+    bool pop(VKind kind) { return pop(make(kind)); }
+
+    bool pop_reference(VType& out) {
+        if (_cur.stack.empty()) return fail("operand stack underflow");
+        out = _cur.stack.back();
+        if (!is_reference(out.kind)) return fail("bad operand type (expected reference)");
+        _cur.stack.pop_back();
+        return true;
+    }
+
+    // 弹出一个已初始化的引用并检查它可赋值给type
+    bool pop_object(VType type) {
+        VType ref;
+        if (!pop_reference(ref)) return false;
+        if (ref.kind == VKind::UNINIT || ref.kind == VKind::UNINIT_THIS) {
+            return fail("using uninitialized object");
+        }
+        return assignable(ref, type) || fail("bad object reference type");
+    }
+
+    // JVMS 4.10.1.8：通过getfield/putfield/invokevirtual访问超类里声明的protected成员，
+    // 而声明它的类和当前类不在同一个包里时，栈顶的对象引用必须是当前类或其子类的实例
+    // （invokespecial的对象引用本来就必须是当前类的）。栈顶不是引用时留给随后的pop_object报错
+    bool protected_check(const std::string& member_class, const std::string& name, const std::string& desc) {
+        if (_p_protected_member == nullptr || !*_p_protected_member || _cur.stack.empty()) return true;
+        uint32_t member = intern(member_class);
+        if (member == _this_class || member_class[0] == '[' || !ref_assignable(_this_class, member)) return true;
+        std::string declaring = (*_p_protected_member)(member_class, name, desc);
+        if (declaring.empty() || package_of(declaring) == package_of(_names[_this_class])) return true;
+        const VType& receiver = _cur.stack.back();
+        if (receiver.kind != VKind::REF || ref_assignable(receiver.data, _this_class)) return true;
+        return fail("bad access to protected member");
+    }
+
+    static std::string package_of(const std::string& class_name) {
+        size_t slash = class_name.rfind('/');
+        return slash == std::string::npos ? std::string() : class_name.substr(0, slash);
+    }
+
+    bool check_local(uint32_t index, bool cat2) {
+        if (index + (cat2 ? 1u : 0u) >= _max_locals) return fail("local variable index out of range");
+        return true;
+    }
+
+    bool load(uint32_t index, VKind kind) {
+        if (!check_local(index, is_cat2(kind))) return false;
+        if (_cur.locals[index].kind != kind) return fail("bad local variable type");
+        return push(make(kind));
+    }
+
+    bool load_reference(uint32_t index) {
+        if (!check_local(index, false)) return false;
+        if (!is_reference(_cur.locals[index].kind)) return fail("bad local variable type (expected reference)");
+        return push(_cur.locals[index]);
+    }
+
+    bool store(uint32_t index, VType type) {
+        bool cat2 = is_cat2(type.kind);
+        if (!check_local(index, cat2)) return false;
+        auto& l = _cur.locals;
+        // 覆盖long/double的后半个槽位时前半个随之失效
+        if (index > 0 && is_cat2(l[index - 1].kind)) {
+            l[index - 1] = make(VKind::TOP);
+            mark_modified(index - 1);
+        }
+        l[index] = type;
+        mark_modified(index);
+        if (cat2) {
+            l[index + 1] = make(VKind::TOP);
+            mark_modified(index + 1);
+        }
+        _locals_changed = true;
+        return true;
+    }
+
+    bool store_kind(uint32_t index, VKind kind) {
+        return pop(kind) && store(index, make(kind));
+    }
+
+    // astore也可以存jsr压入的返回地址
+    bool store_reference(uint32_t index) {
+        if (!_cur.stack.empty() && _cur.stack.back().kind == VKind::RETURN_ADDRESS) {
+            VType address = _cur.stack.back();
+            _cur.stack.pop_back();
+            return store(index, address);
+        }
+        VType ref;
+        return pop_reference(ref) && store(index, ref);
+    }
+
+    // 栈顶n个槽位是否由完整的值组成（最下面的槽位不是long/double的后半）
+    bool whole_values(size_t n) {
+        const auto& s = _cur.stack;
+        if (s.size() < n) return fail("operand stack underflow");
+        return s[s.size() - n].kind != VKind::TOP || fail("splitting a long/double value");
+    }
+
+    // 把栈顶n个槽位复制一份插到深度depth（槽位数）之下
+    bool dup_slots(size_t n, size_t depth) {
+        auto& s = _cur.stack;
+        if (s.size() + n > _max_stack) return fail("operand stack overflow");
+        std::vector<VType> top(s.end() - n, s.end());
+        s.insert(s.end() - n - depth, top.begin(), top.end());
+        _max_depth = std::max<uint16_t>(_max_depth, static_cast<uint16_t>(s.size()));
+        return true;
+    }
+
+    ///////////////////// 字节码读取 /////////////////////
+
+    uint8_t u1(uint32_t offset) const { return _code[_pc + offset]; }
+    uint16_t u2(uint32_t offset) const {
+        return static_cast<uint16_t>((_code[_pc + offset] << 8) | _code[_pc + offset + 1]);
+    }
+    int16_t s2(uint32_t offset) const { return static_cast<int16_t>(u2(offset)); }
+    int32_t s4(uint32_t at) const {
+        return static_cast<int32_t>((static_cast<uint32_t>(_code[at]) << 24) | (_code[at + 1] << 16) |
+                                    (_code[at + 2] << 8) | _code[at + 3]);
+    }
+
+    bool length(uint32_t len) {
+        _next = _pc + len;
+        return _next <= _code.size() || fail("instruction runs past the end of the code");
+    }
+
+    bool branch(int64_t offset) {
+        int64_t target = static_cast<int64_t>(_pc) + offset;
+        if (target < 0 || target >= static_cast<int64_t>(_code.size())) {
+            return fail("branch target out of range");
+        }
+        if (_recording && target <= static_cast<int64_t>(_pc)) _polls[_pc] = 1;
+        if (_inferring) return merge_into(static_cast<uint32_t>(target), _cur);
+        const State* p_frame = state_at(static_cast<uint32_t>(target));
+        if (p_frame == nullptr) return fail("branch target has no stack map frame");
+        return state_assignable(_cur, *p_frame) || fail("current frame is not assignable to branch target frame");
+    }
+
+    ///////////////////// 指令 /////////////////////
+
+    bool binary(VKind kind) { return pop(kind) && pop(kind) && push(make(kind)); }
+    bool unary(VKind kind) { return pop(kind) && push(make(kind)); }
+    bool convert_op(VKind from, VKind to) { return pop(from) && push(make(to)); }
+
+    bool array_load(const char* desc, const char* alt_desc, VKind result) {
+        VType array;
+        if (!pop(VKind::INT) || !pop_reference(array)) return false;
+        if (array.kind == VKind::REF) {
+            const std::string& name = _names[array.data];
+            if (name != desc && (alt_desc == nullptr || name != alt_desc)) return fail("bad array type");
+        } else if (array.kind != VKind::NULL_REF) {
+            return fail("bad array reference");
+        }
+        return push(make(result));
+    }
+
+    bool array_store(const char* desc, const char* alt_desc, VKind value) {
+        VType array;
+        if (!pop(value) || !pop(VKind::INT) || !pop_reference(array)) return false;
+        if (array.kind == VKind::REF) {
+            const std::string& name = _names[array.data];
+            if (name != desc && (alt_desc == nullptr || name != alt_desc)) return fail("bad array type");
+            return true;
+        }
+        return array.kind == VKind::NULL_REF || fail("bad array reference");
+    }
+
+    bool is_reference_array(const VType& array) {
+        if (array.kind == VKind::NULL_REF) return true;
+        if (array.kind != VKind::REF) return false;
+        const std::string& name = _names[array.data];
+        return name.size() > 1 && name[0] == '[' && (name[1] == 'L' || name[1] == '[');
+    }
+
+    bool return_op(VKind kind) {
+        if (_returns_void || _return_type.kind != kind) {
+            return fail("return type mismatch");
+        }
+        return pop(kind);
+    }
+
+    bool ldc(uint16_t index, bool wide_value) {
+        const classfile::ConstantInfo* p_const = _cp.find_constant_info(index);
+        VType type;
+        if (dynamic_cast<const classfile::ConstantIntegerInfo*>(p_const)) {
+            type = make(VKind::INT);
+        } else if (dynamic_cast<const classfile::ConstantFloatInfo*>(p_const)) {
+            type = make(VKind::FLOAT);
+        } else if (dynamic_cast<const classfile::ConstantLongInfo*>(p_const)) {
+            type = make(VKind::LONG);
+        } else if (dynamic_cast<const classfile::ConstantDoubleInfo*>(p_const)) {
+            type = make(VKind::DOUBLE);
+        } else if (dynamic_cast<const classfile::ConstantStringInfo*>(p_const)) {
+            type = make(VKind::REF, STRING);
+        } else if (dynamic_cast<const classfile::ConstantClassInfo*>(p_const)) {
+            type = make(VKind::REF, CLASS);
+        } else if (dynamic_cast<const classfile::ConstantMethodTypeInfo*>(p_const)) {
+            type = make(VKind::REF, METHOD_TYPE);
+        } else if (dynamic_cast<const classfile::ConstantMethodHandleInfo*>(p_const)) {
+            type = make(VKind::REF, METHOD_HANDLE);
+        } else if (auto* p_dynamic = dynamic_cast<const classfile::ConstantDynamicInfo*>(p_const)) {
+            const std::string* p_name;
+            const std::string* p_desc;
+            if (!cp_name_and_type(p_dynamic->_name_and_type_index, p_name, p_desc)) return false;
+            size_t i = 0;
+            if (!parse_field_type(*p_desc, i, type) || i != p_desc->size()) {
+                return fail("invalid dynamic constant descriptor");
+            }
+        } else {
+            return fail("invalid ldc constant");
+        }
+        if (is_cat2(type.kind) != wide_value) return fail("ldc constant has wrong category");
+        return push(type);
+    }
+
+    bool field_op(instructions::Opcode op) {
+        const classfile::ConstantFieldRefInfo* p_ref;
+        const std::string* p_class;
+        const std::string* p_name;
+        const std::string* p_desc;
+        if (!cp_member_ref(u2(1), p_ref, p_class, p_name, p_desc)) return false;
+        VType field;
+        size_t i = 0;
+        if (!parse_field_type(*p_desc, i, field) || i != p_desc->size()) return fail("invalid field descriptor");
+        VType owner = make(VKind::REF, intern(*p_class));
+
+        switch (op) {
+            case instructions::Opcode::GETSTATIC:
+                return push(field);
+            case instructions::Opcode::PUTSTATIC:
+                return pop(field);
+            case instructions::Opcode::GETFIELD:
+                return protected_check(*p_class, *p_name, *p_desc) && pop_object(owner) && push(field);
+            default: {  // PUTFIELD
+                if (!pop(field)) return false;
+                // 构造函数在调用super()之前可以给本类声明的字段赋值
+                if (!_cur.stack.empty() && _cur.stack.back().kind == VKind::UNINIT_THIS &&
+                    owner.data == _this_class) {
+                    _cur.stack.pop_back();
+                    return true;
+                }
+                return protected_check(*p_class, *p_name, *p_desc) && pop_object(owner);
+            }
+        }
+    }
+
+    bool invoke(instructions::Opcode op) {
+        using instructions::Opcode;
+        const std::string* p_class;
+        const std::string* p_name;
+        const std::string* p_desc;
+        if (op == Opcode::INVOKEDYNAMIC) {
+            auto* p_indy = dynamic_cast<const classfile::ConstantInvokeDynamicInfo*>(_cp.find_constant_info(u2(1)));
+            if (p_indy == nullptr) return fail("invalid invokedynamic constant");
+            if (!cp_name_and_type(p_indy->_name_and_type_index, p_name, p_desc)) return false;
+            if (u1(3) != 0 || u1(4) != 0) return fail("invokedynamic reserved bytes must be zero");
+            p_class = nullptr;
+        } else {
+            const classfile::ConstantMemberRefInfo* p_ref;
+            if (!cp_member_ref(u2(1), p_ref, p_class, p_name, p_desc)) return false;
+            bool interface_ref = dynamic_cast<const classfile::ConstantInterfaceMethodRefInfo*>(p_ref) != nullptr;
+            bool class_ref = dynamic_cast<const classfile::ConstantMethodRefInfo*>(p_ref) != nullptr;
+            // invokespecial/invokestatic从52开始也可以引用接口方法
+            bool ok = op == Opcode::INVOKEINTERFACE ? interface_ref
+                    : op == Opcode::INVOKEVIRTUAL ? class_ref
+                    : (class_ref || interface_ref);
+            if (!ok) return fail("invalid method reference constant");
+        }
+
+        std::vector<VType> args;
+        VType ret;
+        bool is_void;
+        if (!parse_method_descriptor(*p_desc, args, ret, is_void)) return fail("invalid method descriptor");
+
+        bool is_init = *p_name == "<init>";
+        if ((*p_name)[0] == '<' && !(is_init && op == Opcode::INVOKESPECIAL)) {
+            return fail("invalid invocation of special method");
+        }
+        if (op == Opcode::INVOKEINTERFACE) {
+            size_t slots = 1;
+            for (const VType& a : args) slots += is_cat2(a.kind) ? 2 : 1;
+            if (u1(3) != slots || u1(4) != 0) return fail("inconsistent invokeinterface count");
+        }
+
+        for (size_t i = args.size(); i-- > 0;) {
+            if (!pop(args[i])) return false;
+        }
+
+        if (op == Opcode::INVOKESPECIAL && is_init) {
+            if (!is_void) return fail("constructor must return void");
+            VType ref;
+            if (!pop_reference(ref)) return false;
+            VType initialized;
+            if (ref.kind == VKind::UNINIT_THIS) {
+                initialized = make(VKind::REF, _this_class);
+            } else if (ref.kind == VKind::UNINIT) {
+                uint32_t saved_pc = _pc;
+                _pc = ref.data;
+                bool ok = cp_class_type(u2(1), initialized);
+                _pc = saved_pc;
+                if (!ok) return false;
+                if (initialized.data != intern(*p_class)) return fail("constructor class does not match new");
+            } else {
+                return fail("invokespecial <init> on initialized object");
+            }
+            // 同一个未初始化对象的所有副本一起变为已初始化
+            for (size_t i = 0; i < _cur.locals.size(); i++) {
+                if (_cur.locals[i] == ref) {
+                    _cur.locals[i] = initialized;
+                    mark_modified(i);
+                    _locals_changed = true;
+                }
+            }
+            for (auto& t : _cur.stack) {
+                if (t == ref) t = initialized;
+            }
+            return true;
+        }
+
+        if (op == Opcode::INVOKESPECIAL) {
+            // JVMS 4.10.1.9：引用的只能是当前类、它的超类或直接超接口，对象引用必须可赋值给当前类
+            if (!ref_assignable(_this_class, intern(*p_class))) {
+                return fail("invokespecial on a class that is not a superclass of the current class");
+            }
+            if (!pop_object(make(VKind::REF, _this_class))) return false;
+        } else if (op == Opcode::INVOKEVIRTUAL) {
+            if (!protected_check(*p_class, *p_name, *p_desc) ||
+                !pop_object(make(VKind::REF, intern(*p_class)))) {
+                return false;
+            }
+        } else if (op == Opcode::INVOKEINTERFACE) {
+            if (!pop_object(make(VKind::REF, intern(*p_class)))) return false;
+        }
+        return is_void || push(ret);
+    }
+
+    bool step(bool& falls_through) {
+        using instructions::Opcode;
+        Opcode op = static_cast<Opcode>(_code[_pc]);
+        // 定长指令的长度和是否落到下一条指令都由操作码元数据表决定，变长指令在各自的case里计算
+        const instructions::OpcodeInfo& info = instructions::opcode_info(op);
+        if (!info.valid() || info.has(instructions::opflag::RESERVED)) return fail("invalid opcode");
+        falls_through = !info.has(instructions::opflag::NO_FALLTHROUGH);
+        if (info.length != 0 && !length(info.length)) return false;
+
+        switch (op) {
+            case Opcode::NOP:
+                return true;
+            case Opcode::ACONST_NULL:
+                return push(make(VKind::NULL_REF));
+            case Opcode::ICONST_M1: case Opcode::ICONST_0: case Opcode::ICONST_1: case Opcode::ICONST_2:
+            case Opcode::ICONST_3: case Opcode::ICONST_4: case Opcode::ICONST_5:
+                return push(make(VKind::INT));
+            case Opcode::LCONST_0: case Opcode::LCONST_1:
+                return push(make(VKind::LONG));
+            case Opcode::FCONST_0: case Opcode::FCONST_1: case Opcode::FCONST_2:
+                return push(make(VKind::FLOAT));
+            case Opcode::DCONST_0: case Opcode::DCONST_1:
+                return push(make(VKind::DOUBLE));
+            case Opcode::BIPUSH:
+                return push(make(VKind::INT));
+            case Opcode::SIPUSH:
+                return push(make(VKind::INT));
+            case Opcode::LDC:
+                return ldc(u1(1), false);
+            case Opcode::LDC_W:
+                return ldc(u2(1), false);
+            case Opcode::LDC2_W:
+                return ldc(u2(1), true);
+
+            case Opcode::ILOAD: return load(u1(1), VKind::INT);
+            case Opcode::LLOAD: return load(u1(1), VKind::LONG);
+            case Opcode::FLOAD: return load(u1(1), VKind::FLOAT);
+            case Opcode::DLOAD: return load(u1(1), VKind::DOUBLE);
+            case Opcode::ALOAD: return load_reference(u1(1));
+            case Opcode::ILOAD_0: case Opcode::ILOAD_1: case Opcode::ILOAD_2: case Opcode::ILOAD_3:
+                return load(_code[_pc] - static_cast<uint8_t>(Opcode::ILOAD_0), VKind::INT);
+            case Opcode::LLOAD_0: case Opcode::LLOAD_1: case Opcode::LLOAD_2: case Opcode::LLOAD_3:
+                return load(_code[_pc] - static_cast<uint8_t>(Opcode::LLOAD_0), VKind::LONG);
+            case Opcode::FLOAD_0: case Opcode::FLOAD_1: case Opcode::FLOAD_2: case Opcode::FLOAD_3:
+                return load(_code[_pc] - static_cast<uint8_t>(Opcode::FLOAD_0), VKind::FLOAT);
+            case Opcode::DLOAD_0: case Opcode::DLOAD_1: case Opcode::DLOAD_2: case Opcode::DLOAD_3:
+                return load(_code[_pc] - static_cast<uint8_t>(Opcode::DLOAD_0), VKind::DOUBLE);
+            case Opcode::ALOAD_0: case Opcode::ALOAD_1: case Opcode::ALOAD_2: case Opcode::ALOAD_3:
+                return load_reference(_code[_pc] - static_cast<uint8_t>(Opcode::ALOAD_0));
+
+            case Opcode::IALOAD: return array_load("[I", nullptr, VKind::INT);
+            case Opcode::LALOAD: return array_load("[J", nullptr, VKind::LONG);
+            case Opcode::FALOAD: return array_load("[F", nullptr, VKind::FLOAT);
+            case Opcode::DALOAD: return array_load("[D", nullptr, VKind::DOUBLE);
+            case Opcode::BALOAD: return array_load("[B", "[Z", VKind::INT);
+            case Opcode::CALOAD: return array_load("[C", nullptr, VKind::INT);
+            case Opcode::SALOAD: return array_load("[S", nullptr, VKind::INT);
+            case Opcode::AALOAD: {
+                VType array;
+                if (!pop(VKind::INT) || !pop_reference(array)) return false;
+                if (!is_reference_array(array)) return fail("aaload on non-reference array");
+                if (array.kind == VKind::NULL_REF) return push(array);
+                return push(make(VKind::REF, intern(component_name(_names[array.data]))));
+            }
+
+            case Opcode::ISTORE: return store_kind(u1(1), VKind::INT);
+            case Opcode::LSTORE: return store_kind(u1(1), VKind::LONG);
+            case Opcode::FSTORE: return store_kind(u1(1), VKind::FLOAT);
+            case Opcode::DSTORE: return store_kind(u1(1), VKind::DOUBLE);
+            case Opcode::ASTORE: return store_reference(u1(1));
+            case Opcode::ISTORE_0: case Opcode::ISTORE_1: case Opcode::ISTORE_2: case Opcode::ISTORE_3:
+                return store_kind(_code[_pc] - static_cast<uint8_t>(Opcode::ISTORE_0), VKind::INT);
+            case Opcode::LSTORE_0: case Opcode::LSTORE_1: case Opcode::LSTORE_2: case Opcode::LSTORE_3:
+                return store_kind(_code[_pc] - static_cast<uint8_t>(Opcode::LSTORE_0), VKind::LONG);
+            case Opcode::FSTORE_0: case Opcode::FSTORE_1: case Opcode::FSTORE_2: case Opcode::FSTORE_3:
+                return store_kind(_code[_pc] - static_cast<uint8_t>(Opcode::FSTORE_0), VKind::FLOAT);
+            case Opcode::DSTORE_0: case Opcode::DSTORE_1: case Opcode::DSTORE_2: case Opcode::DSTORE_3:
+                return store_kind(_code[_pc] - static_cast<uint8_t>(Opcode::DSTORE_0), VKind::DOUBLE);
+            case Opcode::ASTORE_0: case Opcode::ASTORE_1: case Opcode::ASTORE_2: case Opcode::ASTORE_3:
+                return store_reference(_code[_pc] - static_cast<uint8_t>(Opcode::ASTORE_0));
+
+            case Opcode::IASTORE: return array_store("[I", nullptr, VKind::INT);
+            case Opcode::LASTORE: return array_store("[J", nullptr, VKind::LONG);
+            case Opcode::FASTORE: return array_store("[F", nullptr, VKind::FLOAT);
+            case Opcode::DASTORE: return array_store("[D", nullptr, VKind::DOUBLE);
+            case Opcode::BASTORE: return array_store("[B", "[Z", VKind::INT);
+            case Opcode::CASTORE: return array_store("[C", nullptr, VKind::INT);
+            case Opcode::SASTORE: return array_store("[S", nullptr, VKind::INT);
+            case Opcode::AASTORE: {
+                // 元素类型与数组组件类型的兼容性在运行时检查（ArrayStoreException）
+                VType array;
+                if (!pop_object(make(VKind::REF, OBJECT)) || !pop(VKind::INT) ||
+                    !pop_reference(array)) {
+                    return false;
+                }
+                return is_reference_array(array) || fail("aastore on non-reference array");
+            }
+
+            case Opcode::POP:
+                if (!whole_values(1)) return false;
+                _cur.stack.pop_back();
+                return true;
+            case Opcode::POP2:
+                if (!whole_values(2)) return false;
+                _cur.stack.resize(_cur.stack.size() - 2);
+                return true;
+            case Opcode::DUP:
+                return whole_values(1) && dup_slots(1, 0);
+            case Opcode::DUP_X1:
+                return whole_values(1) && whole_values(2) && dup_slots(1, 1);
+            case Opcode::DUP_X2:
+                return whole_values(1) && whole_values(3) && dup_slots(1, 2);
+            case Opcode::DUP2:
+                return whole_values(2) && dup_slots(2, 0);
+            case Opcode::DUP2_X1:
+                return whole_values(2) && whole_values(3) && dup_slots(2, 1);
+            case Opcode::DUP2_X2:
+                return whole_values(2) && whole_values(4) && dup_slots(2, 2);
+            case Opcode::SWAP: {
+                if (!whole_values(1) || !whole_values(2)) return false;
+                auto& s = _cur.stack;
+                std::swap(s[s.size() - 1], s[s.size() - 2]);
+                return true;
+            }
+
+            case Opcode::IADD: case Opcode::ISUB: case Opcode::IMUL: case Opcode::IDIV: case Opcode::IREM:
+            case Opcode::ISHL: case Opcode::ISHR: case Opcode::IUSHR:
+            case Opcode::IAND: case Opcode::IOR: case Opcode::IXOR:
+                return binary(VKind::INT);
+            case Opcode::LADD: case Opcode::LSUB: case Opcode::LMUL: case Opcode::LDIV: case Opcode::LREM:
+            case Opcode::LAND: case Opcode::LOR: case Opcode::LXOR:
+                return binary(VKind::LONG);
+            case Opcode::FADD: case Opcode::FSUB: case Opcode::FMUL: case Opcode::FDIV: case Opcode::FREM:
+                return binary(VKind::FLOAT);
+            case Opcode::DADD: case Opcode::DSUB: case Opcode::DMUL: case Opcode::DDIV: case Opcode::DREM:
+                return binary(VKind::DOUBLE);
+            case Opcode::LSHL: case Opcode::LSHR: case Opcode::LUSHR:
+                return pop(VKind::INT) && unary(VKind::LONG);
+            case Opcode::INEG: return unary(VKind::INT);
+            case Opcode::LNEG: return unary(VKind::LONG);
+            case Opcode::FNEG: return unary(VKind::FLOAT);
+            case Opcode::DNEG: return unary(VKind::DOUBLE);
+            case Opcode::IINC:
+                if (!check_local(u1(1), false)) return false;
+                return _cur.locals[u1(1)].kind == VKind::INT || fail("iinc on non-int local");
+
+            case Opcode::I2L: return convert_op(VKind::INT, VKind::LONG);
+            case Opcode::I2F: return convert_op(VKind::INT, VKind::FLOAT);
+            case Opcode::I2D: return convert_op(VKind::INT, VKind::DOUBLE);
+            case Opcode::L2I: return convert_op(VKind::LONG, VKind::INT);
+            case Opcode::L2F: return convert_op(VKind::LONG, VKind::FLOAT);
+            case Opcode::L2D: return convert_op(VKind::LONG, VKind::DOUBLE);
+            case Opcode::F2I: return convert_op(VKind::FLOAT, VKind::INT);
+            case Opcode::F2L: return convert_op(VKind::FLOAT, VKind::LONG);
+            case Opcode::F2D: return convert_op(VKind::FLOAT, VKind::DOUBLE);
+            case Opcode::D2I: return convert_op(VKind::DOUBLE, VKind::INT);
+            case Opcode::D2L: return convert_op(VKind::DOUBLE, VKind::LONG);
+            case Opcode::D2F: return convert_op(VKind::DOUBLE, VKind::FLOAT);
+            case Opcode::I2B: case Opcode::I2C: case Opcode::I2S:
+                return unary(VKind::INT);
+
+            case Opcode::LCMP:
+                return pop(VKind::LONG) && pop(VKind::LONG) && push(make(VKind::INT));
+            case Opcode::FCMPL: case Opcode::FCMPG:
+                return pop(VKind::FLOAT) && pop(VKind::FLOAT) && push(make(VKind::INT));
+            case Opcode::DCMPL: case Opcode::DCMPG:
+                return pop(VKind::DOUBLE) && pop(VKind::DOUBLE) && push(make(VKind::INT));
+
+            case Opcode::IFEQ: case Opcode::IFNE: case Opcode::IFLT:
+            case Opcode::IFGE: case Opcode::IFGT: case Opcode::IFLE:
+                return pop(VKind::INT) && branch(s2(1));
+            case Opcode::IF_ICMPEQ: case Opcode::IF_ICMPNE: case Opcode::IF_ICMPLT:
+            case Opcode::IF_ICMPGE: case Opcode::IF_ICMPGT: case Opcode::IF_ICMPLE:
+                return pop(VKind::INT) && pop(VKind::INT) && branch(s2(1));
+            case Opcode::IF_ACMPEQ: case Opcode::IF_ACMPNE: {
+                VType a, b;
+                return pop_reference(a) && pop_reference(b) && branch(s2(1));
+            }
+            case Opcode::IFNULL: case Opcode::IFNONNULL: {
+                VType a;
+                return pop_reference(a) && branch(s2(1));
+            }
+            case Opcode::GOTO:
+                return branch(s2(1));
+            case Opcode::GOTO_W:
+                return branch(s4(_pc + 1));
+
+            case Opcode::TABLESWITCH: {
+                uint32_t base = (_pc + 4) & ~3u;
+                if (!length(base - _pc + 12) || !pop(VKind::INT)) return false;
+                int32_t low = s4(base + 4);
+                int32_t high = s4(base + 8);
+                if (low > high) return fail("tableswitch low > high");
+                int64_t count = static_cast<int64_t>(high) - low + 1;
+                if (count > static_cast<int64_t>(_code.size()) || !length(base - _pc + 12 + 4 * static_cast<uint32_t>(count))) {
+                    return fail("tableswitch runs past the end of the code");
+                }
+                if (!branch(s4(base))) return false;
+                for (int64_t i = 0; i < count; i++) {
+                    if (!branch(s4(base + 12 + 4 * static_cast<uint32_t>(i)))) return false;
+                }
+                return true;
+            }
+            case Opcode::LOOKUPSWITCH: {
+                uint32_t base = (_pc + 4) & ~3u;
+                if (!length(base - _pc + 8) || !pop(VKind::INT)) return false;
+                int32_t npairs = s4(base + 4);
+                if (npairs < 0 || npairs > static_cast<int64_t>(_code.size()) ||
+                    !length(base - _pc + 8 + 8 * static_cast<uint32_t>(npairs))) {
+                    return fail("invalid lookupswitch pair count");
+                }
+                if (!branch(s4(base))) return false;
+                for (int32_t i = 0; i < npairs; i++) {
+                    uint32_t at = base + 8 + 8 * static_cast<uint32_t>(i);
+                    if (i > 0 && s4(at) <= s4(at - 8)) return fail("lookupswitch keys are not sorted");
+                    if (!branch(s4(at + 4))) return false;
+                }
+                return true;
+            }
+
+            case Opcode::IRETURN: return return_op(VKind::INT);
+            case Opcode::LRETURN: return return_op(VKind::LONG);
+            case Opcode::FRETURN: return return_op(VKind::FLOAT);
+            case Opcode::DRETURN: return return_op(VKind::DOUBLE);
+            case Opcode::ARETURN:
+                if (_returns_void || _return_type.kind != VKind::REF) return fail("return type mismatch");
+                return pop_object(_return_type);
+            case Opcode::RETURN:
+                if (!_returns_void) return fail("return type mismatch");
+                for (const VType& t : _cur.locals) {
+                    if (t.kind == VKind::UNINIT_THIS) return fail("constructor returns before calling super()");
+                }
+                return true;
+
+            case Opcode::GETSTATIC: case Opcode::PUTSTATIC: case Opcode::GETFIELD: case Opcode::PUTFIELD:
+                return field_op(op);
+            case Opcode::INVOKEVIRTUAL: case Opcode::INVOKESPECIAL: case Opcode::INVOKESTATIC:
+                return invoke(op);
+            case Opcode::INVOKEINTERFACE: case Opcode::INVOKEDYNAMIC:
+                return invoke(op);
+
+            case Opcode::NEW: {
+                VType type;
+                if (!cp_class_type(u2(1), type)) return false;
+                if (_names[type.data][0] == '[') return fail("new of array class");
+                // 同一条new指令产生的旧的未初始化对象不能还留在帧里
+                VType uninit = make(VKind::UNINIT, _pc);
+                for (const VType& t : _cur.stack) {
+                    if (t == uninit) return fail("uninitialized object from this new is still on the stack");
+                }
+                for (size_t i = 0; i < _cur.locals.size(); i++) {
+                    if (_cur.locals[i] == uninit) {
+                        _cur.locals[i] = make(VKind::TOP);
+                        mark_modified(i);
+                        _locals_changed = true;
+                    }
+                }
+                return push(uninit);
+            }
+            case Opcode::NEWARRAY: {
+                static const char* const ARRAY_TYPES[] = {"[Z", "[C", "[F", "[D", "[B", "[S", "[I", "[J"};
+                uint8_t atype = u1(1);
+                if (atype < 4 || atype > 11) return fail("invalid newarray type");
+                return pop(VKind::INT) && push(make(VKind::REF, intern(ARRAY_TYPES[atype - 4])));
+            }
+            case Opcode::ANEWARRAY: {
+                const std::string* p_name;
+                if (!cp_class_name(u2(1), p_name) || !pop(VKind::INT)) return false;
+                std::string array = (*p_name)[0] == '[' ? "[" + *p_name : "[L" + *p_name + ";";
+                return push(make(VKind::REF, intern(array)));
+            }
+            case Opcode::MULTIANEWARRAY: {
+                VType type;
+                if (!cp_class_type(u2(1), type)) return false;
+                uint8_t dims = u1(3);
+                const std::string& name = _names[type.data];
+                size_t depth = name.find_first_not_of('[');
+                if (dims == 0 || depth == std::string::npos || depth < dims) return fail("invalid multianewarray dimensions");
+                for (uint8_t i = 0; i < dims; i++) {
+                    if (!pop(VKind::INT)) return false;
+                }
+                return push(type);
+            }
+            case Opcode::ARRAYLENGTH: {
+                VType array;
+                if (!pop_reference(array)) return false;
+                bool ok = array.kind == VKind::NULL_REF ||
+                          (array.kind == VKind::REF && _names[array.data][0] == '[');
+                return (ok || fail("arraylength on non-array")) && push(make(VKind::INT));
+            }
+            case Opcode::ATHROW:
+                return pop_object(make(VKind::REF, THROWABLE));
+            case Opcode::CHECKCAST: {
+                VType type;
+                return cp_class_type(u2(1), type) && pop_object(make(VKind::REF, OBJECT)) && push(type);
+            }
+            case Opcode::INSTANCEOF: {
+                VType type;
+                return cp_class_type(u2(1), type) && pop_object(make(VKind::REF, OBJECT)) &&
+                       push(make(VKind::INT));
+            }
+            case Opcode::MONITORENTER: case Opcode::MONITOREXIT:
+                return pop_object(make(VKind::REF, OBJECT));
+
+            case Opcode::WIDE: {
+                if (!length(2)) return false;
+                Opcode wide_op = static_cast<Opcode>(u1(1));
+                if (wide_op == Opcode::IINC) {
+                    if (!length(6) || !check_local(u2(2), false)) return false;
+                    return _cur.locals[u2(2)].kind == VKind::INT || fail("iinc on non-int local");
+                }
+                if (!length(4)) return false;
+                uint16_t index = u2(2);
+                switch (wide_op) {
+                    case Opcode::ILOAD: return load(index, VKind::INT);
+                    case Opcode::LLOAD: return load(index, VKind::LONG);
+                    case Opcode::FLOAD: return load(index, VKind::FLOAT);
+                    case Opcode::DLOAD: return load(index, VKind::DOUBLE);
+                    case Opcode::ALOAD: return load_reference(index);
+                    case Opcode::ISTORE: return store_kind(index, VKind::INT);
+                    case Opcode::LSTORE: return store_kind(index, VKind::LONG);
+                    case Opcode::FSTORE: return store_kind(index, VKind::FLOAT);
+                    case Opcode::DSTORE: return store_kind(index, VKind::DOUBLE);
+                    case Opcode::ASTORE: return store_reference(index);
+                    case Opcode::RET:
+                        if (!_inferring) return fail("jsr/ret are not allowed in type-checked class files");
+                        falls_through = false;
+                        return ret(index);
+                    default: return fail("invalid wide instruction");
+                }
+            }
+
+            case Opcode::JSR: case Opcode::JSR_W:
+                if (!_inferring) return fail("jsr/ret are not allowed in type-checked class files");
+                falls_through = false;
+                return jsr(op == Opcode::JSR ? s2(1) : s4(_pc + 1));
+            case Opcode::RET:
+                if (!_inferring) return fail("jsr/ret are not allowed in type-checked class files");
+                return ret(u1(1));
+            default:
+                return fail("invalid opcode");
+        }
+    }
+
+private:
+    const classfile::ConstantPool& _cp;
+    const classfile::MemberInfo& _method;
+    const std::vector<uint8_t>& _code;
+    uint16_t _max_stack;
+    uint16_t _max_locals;
+    const std::vector<std::unique_ptr<classfile::ExceptionTableEntry>>& _exception_table;
+    const classfile::StackMapTableAttribute* _p_stack_map;
+    const AssignableFn* _p_assignable;
+    const ProtectedMemberFn* _p_protected_member;
+
+    std::vector<std::string> _names;
+    std::unordered_map<std::string, uint32_t> _name_ids;
+    uint32_t _this_class = 0;
+
+    bool _is_init = false;
+    bool _returns_void = true;
+    VType _return_type{VKind::TOP, 0};
+    std::vector<VType> _initial_locals;
+    State _initial;
+    std::vector<State> _frames;         // 与StackMapTable的帧一一对应的展开形式
+    std::vector<Handler> _handlers;
+
+    State _cur;
+    uint32_t _pc = 0;
+    uint32_t _next = 0;
+    bool _locals_changed = false;
+    uint16_t _max_depth = 0;
+    VerifyError _error;
+
+    bool _inferring = false;
+    bool _recording = false;                // reference_maps()：记下每条指令之前的状态
+    std::vector<State> _states;             // pc -> 该指令执行之前的状态
+    std::vector<uint8_t> _has_state;
+    std::vector<uint8_t> _changed;          // 类型推导中待重新处理的指令
+    std::vector<uint8_t> _polls;            // reference_maps()：回边（轮询安全点的跳转指令）
+    std::unordered_map<uint32_t, Subroutine> _subroutines;  // 子程序入口pc -> 调用点和ret
+    std::unordered_map<uint32_t, std::vector<uint8_t>> _caller_references;
+    std::vector<uint8_t> _instruction_start;
+};
+
+// 类层次：回答验证时的可赋值关系和protected成员查找，每个定义类的类加载器一个。
+// 同样的类字节在不同类层次下验证结果可能不同，验证缓存按(类层次, 类内容)区分，
+// 编号在进程内唯一，类层次销毁后也不会被新的类层次复用
+class ClassHierarchy {
+public:
+    explicit ClassHierarchy(AssignableFn is_assignable = nullptr, ProtectedMemberFn protected_member = nullptr)
+        : _is_assignable(std::move(is_assignable)), _protected_member(std::move(protected_member)),
+          _id(next_id()) {}
+
+    ClassHierarchy(const ClassHierarchy&) = delete;
+    ClassHierarchy& operator=(const ClassHierarchy&) = delete;
+
+    const AssignableFn& is_assignable() const { return _is_assignable; }
+    const ProtectedMemberFn& protected_member() const { return _protected_member; }
+    uint64_t id() const { return _id; }
+
+    // 启动类加载器的类层次：不提供查询，可赋值关系和protected检查都留到解析符号引用时
+    static const ClassHierarchy& bootstrap() {
+        static const ClassHierarchy hierarchy;
+        return hierarchy;
+    }
+
+private:
+    static uint64_t next_id() {
+        static std::atomic<uint64_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    AssignableFn _is_assignable;
+    ProtectedMemberFn _protected_member;
+    uint64_t _id;
+};
+
+// 类的验证结果，失败时method是出错方法的 名字+描述符
+struct ClassVerifyResult {
+    bool verified = false;
+    std::string method;
+    VerifyError error;
+};
+
+// 类验证器，进程内一个，类链接时（rtda::Class::link）调用
+// 同一个类的各个方法互不依赖，投递到线程池并行验证；全部通过后才给每个Code属性写入
+// verified位、最大栈深度和GC用的引用位图。50以前的类文件没有StackMapTable，用类型推导验证。
+// 已验证过的类按(类层次, 内容哈希)缓存，相同的类字节（不同jar里的同一个类、
+// 再次运行时从解析缓存恢复的类）不会重复验证，位图也直接共用
+class Verifier {
+public:
+    // 低于50的类文件没有StackMapTable，只能用类型推导验证器
+    static const uint16_t MIN_TYPE_CHECKING_VERSION = 50;
+
+    // 自带线程池，thread_count为0时取硬件线程数
+    explicit Verifier(size_t thread_count = 0)
+        : _p_own_pool(std::make_unique<util::ThreadPool>(thread_count)), _pool(*_p_own_pool) {}
+    // 借用已有的线程池（如BatchLoader的）
+    explicit Verifier(util::ThreadPool& pool) : _pool(pool) {}
+
+    Verifier(const Verifier&) = delete;
+    Verifier& operator=(const Verifier&) = delete;
+
+    ClassVerifyResult verify_class(const classfile::ClassFile& cf,
+                                   const ClassHierarchy& hierarchy = ClassHierarchy::bootstrap()) {
+        ClassVerifyResult result;
+        std::vector<classfile::MemberInfo*> methods;
+        std::vector<classfile::CodeAttribute*> codes;
+        for (const auto& p_method : cf.methods()) {
+            if (classfile::CodeAttribute* p_code = p_method->code_attribute()) {
+                methods.push_back(p_method.get());
+                codes.push_back(p_code);
+            }
+        }
+
+        const CacheKey key{hierarchy.id(), cf.content_hash()};
+        std::vector<MethodResult> results;
+        if (lookup(key, results) && results.size() == codes.size()) {
+            apply(codes, results);
+            result.verified = true;
+            return result;
+        }
+
+        std::string this_class;
+        try {
+            this_class = cf.class_name();
+        } catch (const std::exception&) {
+            result.error.message = "invalid this_class";
+            return result;
+        }
+
+        bool infer = cf.major_version() < MIN_TYPE_CHECKING_VERSION;
+        std::vector<VerifyError> errors(codes.size());
+        results.assign(codes.size(), MethodResult{});
+        _pool.parallel_for(codes.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                MethodVerifier verifier(cf.constant_pool(), this_class, *methods[i], *codes[i],
+                                        &hierarchy.is_assignable(), &hierarchy.protected_member());
+                auto p_maps = std::make_shared<classfile::ReferenceMaps>(codes[i]->getMaxLocals());
+                errors[i] = verifier.reference_maps(infer, *p_maps);
+                results[i].max_stack = verifier.max_stack_depth();
+                results[i].p_maps = std::move(p_maps);
+            }
+        });
+
+        // 按方法顺序报告第一个错误，结果与线程调度无关
+        for (size_t i = 0; i < errors.size(); i++) {
+            if (errors[i]) {
+                const std::string* p_name = cf.constant_pool().find_utf8(methods[i]->name_index());
+                const std::string* p_desc = cf.constant_pool().find_utf8(methods[i]->descriptor_index());
+                if (p_name && p_desc) result.method = *p_name + *p_desc;
+                result.error = errors[i];
+                LOG(ERROR, "java.lang.VerifyError: %s.%s at pc %u: %s", this_class.c_str(),
+                    result.method.c_str(), errors[i].pc, errors[i].message);
+                return result;
+            }
+        }
+
+        apply(codes, results);
+        store(key, std::move(results));
+        result.verified = true;
+        return result;
+    }
+
+    // 进程级的验证器，启动时安装
+    static void install(std::shared_ptr<Verifier> p_verifier) { global() = std::move(p_verifier); }
+    static Verifier* instance() { return global().get(); }
+
+private:
+    struct CacheKey {
+        uint64_t hierarchy;
+        uint64_t content_hash;
+
+        bool operator==(const CacheKey& other) const {
+            return hierarchy == other.hierarchy && content_hash == other.content_hash;
+        }
+    };
+
+    struct CacheKeyHash {
+        size_t operator()(const CacheKey& key) const {
+            return std::hash<uint64_t>{}(key.content_hash ^ (key.hierarchy * 0x9e3779b97f4a7c15ULL));
+        }
+    };
+
+    // 一个方法的验证结果，位图只读，缓存命中的类直接共用
+    struct MethodResult {
+        uint16_t max_stack = 0;
+        std::shared_ptr<const classfile::ReferenceMaps> p_maps;
+    };
+
+    static void apply(const std::vector<classfile::CodeAttribute*>& codes, const std::vector<MethodResult>& results) {
+        for (size_t i = 0; i < codes.size(); i++) {
+            codes[i]->setReferenceMaps(results[i].p_maps);
+            codes[i]->markVerified(results[i].max_stack);
+        }
+    }
+
+    bool lookup(const CacheKey& key, std::vector<MethodResult>& results) const {
+        std::lock_guard<std::mutex> lock(_cache_mutex);
+        auto it = _verified.find(key);
+        if (it == _verified.end()) return false;
+        results = it->second;
+        return true;
+    }
+
+    void store(const CacheKey& key, std::vector<MethodResult> results) {
+        std::lock_guard<std::mutex> lock(_cache_mutex);
+        _verified.emplace(key, std::move(results));
+    }
+
+    static std::shared_ptr<Verifier>& global() {
+        static std::shared_ptr<Verifier> p_verifier;
+        return p_verifier;
+    }
+
+    std::unique_ptr<util::ThreadPool> _p_own_pool;
+    util::ThreadPool& _pool;
+
+    // (类层次, 类内容哈希) -> 各方法（有Code属性的，按声明顺序）的验证结果
+    mutable std::mutex _cache_mutex;
+    std::unordered_map<CacheKey, std::vector<MethodResult>, CacheKeyHash> _verified;
+};
+
+} // namespace classloader
+} // namespace jvm
@@ -88,6 +88,78 @@ public:
     std::string to_string() const override { return _abs_dir; }
 };
 
+// libzip归档的RAII封装
+// libzip的句柄不是线程安全的，多线程读取时每个线程各自打开一个ZipArchive
+class ZipArchive {
+public:
+    explicit ZipArchive(const std::string& path) : _archive(nullptr, zip_close) {
+        int err = 0;
+        zip* archive = zip_open(path.c_str(), ZIP_RDONLY, &err);
+        if (!archive) {
+            char errStr[128];
+            zip_error_to_str(errStr, sizeof(errStr), err, errno);
+            LOG(ERROR, "Failed to open zip file %s: %s", path.c_str(), errStr);
+            return;
+        }
+        _archive.reset(archive);
+    }
+
+    bool is_open() const { return _archive != nullptr; }
+
+    // 归档中的条目数
+    uint64_t entry_count() const {
+        zip_int64_t n = zip_get_num_entries(_archive.get(), 0);
+        return n < 0 ? 0 : static_cast<uint64_t>(n);
+    }
+
+    // 条目名称，失败返回空串
+    std::string entry_name(uint64_t index) const {
+        const char* name = zip_get_name(_archive.get(), index, 0);
+        return name ? std::string(name) : std::string();
+    }
+
+    // 按名称读取（解压）条目内容
+    bool read(const std::string& name, std::string& data) const {
+        struct zip_stat st;
+        zip_stat_init(&st);
+        if (zip_stat(_archive.get(), name.c_str(), 0, &st) != 0) {
+            return false;
+        }
+        return read_file(zip_fopen(_archive.get(), name.c_str(), 0), st.size, name, data);
+    }
+
+    // 按下标读取（解压）条目内容，批量遍历时避免按名称查找
+    bool read(uint64_t index, std::string& data) const {
+        struct zip_stat st;
+        zip_stat_init(&st);
+        if (zip_stat_index(_archive.get(), index, 0, &st) != 0) {
+            return false;
+        }
+        return read_file(zip_fopen_index(_archive.get(), index, 0), st.size, st.name, data);
+    }
+
+private:
+    static bool read_file(zip_file* file, zip_uint64_t size, const std::string& name, std::string& data) {
+        if (!file) {
+            LOG(ERROR, "Failed to open file %s in zip", name.c_str());
+            return false;
+        }
+
+        std::unique_ptr<zip_file, decltype(&zip_fclose)> 
+            file_guard(file, zip_fclose);
+
+        data.resize(size);
+        zip_int64_t readSize = zip_fread(file, &data[0], size);
+        if (readSize == -1 || static_cast<zip_uint64_t>(readSize) != size) {
+            LOG(ERROR, "Failed to read file %s from zip", name.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    std::unique_ptr<zip, decltype(&zip_close)> _archive;
+};
+
 class ZipEntry : public Entry, public std::enable_shared_from_this<ZipEntry> {
 private:
     // 将构造函数设为私有
@@ -109,39 +181,13 @@ private:
 public:
     std::tuple<std::string, EntryPtr, bool> 
     read_class(const std::string& className) override {
-        int err = 0;
-        zip* archive = zip_open(_abs_path.c_str(), ZIP_RDONLY, &err);
-        if (!archive) {
-            char errStr[128];
-            zip_error_to_str(errStr, sizeof(errStr), err, errno);
-            LOG(ERROR, "Failed to open zip file %s: %s", _abs_path.c_str(), errStr);
+        ZipArchive archive(_abs_path);
+        if (!archive.is_open()) {
             return std::make_tuple("", nullptr, false);
         }
 
-        std::unique_ptr<zip, decltype(&zip_close)> zip_guard(archive, zip_close);
-
-        struct zip_stat st;
-        zip_stat_init(&st);
-        
-        if (zip_stat(archive, className.c_str(), 0, &st) == 0) {
-            std::string data;
-            data.resize(st.size);
-            
-            zip_file* file = zip_fopen(archive, className.c_str(), 0);
-            if (!file) {
-                LOG(ERROR, "Failed to open file %s in zip", className.c_str());
-                return std::make_tuple("", nullptr, false);
-            }
-
-            std::unique_ptr<zip_file, decltype(&zip_fclose)> 
-                file_guard(file, zip_fclose);
-
-            zip_int64_t readSize = zip_fread(file, &data[0], st.size);
-            if (readSize == -1 || static_cast<zip_uint64_t>(readSize) != st.size) {
-                LOG(ERROR, "Failed to read file %s from zip", className.c_str());
-                return std::make_tuple("", nullptr, false);
-            }
-
+        std::string data;
+        if (archive.read(className, data)) {
             return std::make_tuple(data, shared_from_this(), true);
         }
 
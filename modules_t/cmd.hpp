@@ -3,6 +3,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <stdexcept>
 
 // Enum for different option types
 enum class OptionType {
@@ -10,6 +11,8 @@ enum class OptionType {
     VERSION,
     CP,
     XJR,
+    XPARSECACHE,
+    XINSPECT,
     UNKNOWN
 };
 
@@ -19,6 +22,8 @@ enum class ParseState {
     EXPECT_CP_VALUE,
     EXPECT_CLASS_NAME,
     EXPECT_XJR_VALUE,
+    EXPECT_XPARSECACHE_VALUE,
+    EXPECT_INSPECT_PATHS,
     EXPECT_ARGS
 };
 
@@ -75,6 +80,32 @@ public:
                         cmd._Xjre_option = arg;
                         state = ParseState::EXPECT_XJR_VALUE;
                     } 
+                    else if (arg == "-Xparsecache") {
+                        state = ParseState::EXPECT_XPARSECACHE_VALUE;
+                    } 
+                    else if (arg.compare(0, 4, "-Xms") == 0 || arg.compare(0, 4, "-Xmx") == 0) {
+                        // 值直接跟在选项后面：-Xms64m、-Xmx2g
+                        size_t& size = (arg[3] == 's') ? cmd._Xms_bytes : cmd._Xmx_bytes;
+                        if (!parse_size(arg.substr(4), size)) {
+                            cmd._parse_sucess = false;
+                            cmd._error_msg = "Invalid heap size: " + arg;
+                            return cmd;
+                        }
+                    } 
+                    else if (arg.compare(0, 4, "-XX:") == 0) {
+                        // -XX:<名字>=<值>
+                        if (!parse_xx_option(arg.substr(4), cmd)) {
+                            cmd._parse_sucess = false;
+                            cmd._error_msg = "Unrecognized VM option: " + arg;
+                            return cmd;
+                        }
+                    } 
+                    else if (arg == "-Xinspect" || arg == "-Xinspect:json" || arg == "-Xinspect:table") {
+                        // 之后的参数都是要检查的jar、目录或通配符
+                        cmd._inspect_flag = true;
+                        cmd._inspect_table = (arg == "-Xinspect:table");
+                        state = ParseState::EXPECT_INSPECT_PATHS;
+                    } 
                     else if (arg[0] != '-') {
                         // Treat non-option argument as class name
                         cmd._java_class = arg;
@@ -106,6 +137,17 @@ public:
                     state = ParseState::EXPECT_OPTION;
                     break;
                 }
+                case ParseState::EXPECT_XPARSECACHE_VALUE:
+                {
+                    cmd._Xparsecache_dir = arg;
+                    state = ParseState::EXPECT_OPTION;
+                    break;
+                }
+                case ParseState::EXPECT_INSPECT_PATHS:
+                {
+                    cmd._inspect_paths.push_back(arg);
+                    break;
+                }
                 case ParseState::EXPECT_CLASS_NAME:
                 {
                     cmd._java_class = arg;
@@ -128,7 +170,19 @@ public:
 
         // Step 4: Final validation
         
-        if (cmd._java_class.empty()) {
+        if (cmd._Xms_bytes != 0 && cmd._Xmx_bytes != 0 && cmd._Xms_bytes > cmd._Xmx_bytes) {
+            cmd._parse_sucess = false;
+            cmd._error_msg = "Initial heap size (-Xms) is larger than the maximum heap size (-Xmx)";
+            return cmd;
+        }
+
+        if (cmd._inspect_flag) {
+            if (cmd._inspect_paths.empty()) {
+                cmd._parse_sucess = false;
+                cmd._error_msg = "Missing jar or directory for -Xinspect";
+            }
+        }
+        else if (cmd._java_class.empty()) {
             cmd._parse_sucess = false;
             cmd._error_msg = "Missing main class name";
         }
@@ -140,6 +194,7 @@ public:
     void print_usage()
     {
         std::cout << "Usage: " << _pname << " [-options] class [_args...]" << std::endl;
+        std::cout << "   or: " << _pname << " -Xinspect[:json|:table] <jar|dir|dir/*>..." << std::endl;
         generate_help();
     }
 
@@ -177,17 +232,106 @@ public:
     const std::string& get_error_msg() const { return _error_msg; }
     const std::string& get_jre_path() const { return _Xjre_path; }
     const std::string& get_class_path() const { return _class_path; }
+    const std::string& get_parse_cache_dir() const { return _Xparsecache_dir; }
+    // 堆的初始/最大字节数，0表示未指定，用默认值
+    size_t get_initial_heap_size() const { return _Xms_bytes; }
+    size_t get_max_heap_size() const { return _Xmx_bytes; }
+    // GC工作线程数，0表示未指定，按CPU数取默认值
+    size_t get_parallel_gc_threads() const { return _parallel_gc_threads; }
+    // 老年代占用达到这个百分比时开始并发标记
+    size_t get_initiating_heap_occupancy_percent() const { return _initiating_heap_occupancy_percent; }
+    // 停顿时间目标（毫秒），决定混合回收每次带上多少老年代区域
+    size_t get_max_gc_pause_millis() const { return _max_gc_pause_millis; }
     const std::string& get_java_class() const { return _java_class; }
+    bool is_inspect() const { return _inspect_flag; }
+    bool is_inspect_table() const { return _inspect_table; }
+    const std::vector<std::string>& get_inspect_paths() const { return _inspect_paths; }
     const std::vector<std::string>& get_args() const { return _args; }
 
 private:
+    // 解析带单位的字节数：数字后可跟k/m/g（不区分大小写），不带单位为字节
+    static bool parse_size(const std::string& text, size_t& bytes)
+    {
+        if (text.empty() || text[0] < '0' || text[0] > '9') return false;
+        size_t pos = 0;
+        unsigned long long value;
+        try {
+            value = std::stoull(text, &pos);
+        } catch (const std::exception&) {
+            return false;
+        }
+        int shift = 0;
+        if (pos < text.size()) {
+            switch (text[pos]) {
+                case 'k': case 'K': shift = 10; break;
+                case 'm': case 'M': shift = 20; break;
+                case 'g': case 'G': shift = 30; break;
+                default: return false;
+            }
+            if (++pos != text.size()) return false;
+        }
+        if (value == 0 || value > (~0ull >> shift)) return false;
+        bytes = static_cast<size_t>(value << shift);
+        return true;
+    }
+
+    // 正整数，不带单位
+    static bool parse_count(const std::string& text, size_t& count)
+    {
+        if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) return false;
+        unsigned long long value;
+        try {
+            value = std::stoull(text);
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (value == 0) return false;
+        count = static_cast<size_t>(value);
+        return true;
+    }
+
+    // 百分比，0到100
+    static bool parse_percent(const std::string& text, size_t& percent)
+    {
+        if (text.empty() || text.size() > 3 || text.find_first_not_of("0123456789") != std::string::npos) return false;
+        size_t value = static_cast<size_t>(std::stoul(text));
+        if (value > 100) return false;
+        percent = value;
+        return true;
+    }
+
+    // -XX:之后的部分，名字=值
+    static bool parse_xx_option(const std::string& option, Cmd& cmd)
+    {
+        size_t eq = option.find('=');
+        if (eq == std::string::npos) return false;
+        std::string name = option.substr(0, eq);
+        std::string value = option.substr(eq + 1);
+        if (name == "ParallelGCThreads") return parse_count(value, cmd._parallel_gc_threads);
+        if (name == "InitiatingHeapOccupancyPercent") return parse_percent(value, cmd._initiating_heap_occupancy_percent);
+        if (name == "MaxGCPauseMillis") return parse_count(value, cmd._max_gc_pause_millis);
+        return false;
+    }
+
     void generate_help() 
     {
         std::cout << "Available options:\n"
                 << "  -h|--help         Show this help\n"
                 << "  -v|--version      Show version\n"
                 << "  -cp <path>        Set classpath\n"
-                << "  -Xjre <path>      Specify JRE path\n";
+                << "  -Xjre <path>      Specify JRE path\n"
+                << "  -Xms<size>        Set initial Java heap size (e.g. -Xms64m)\n"
+                << "  -Xmx<size>        Set maximum Java heap size (e.g. -Xmx1g)\n"
+                << "  -XX:ParallelGCThreads=<n>\n"
+                << "                    Number of garbage collector worker threads\n"
+                << "  -XX:InitiatingHeapOccupancyPercent=<n>\n"
+                << "                    Old generation occupancy (0-100) that starts a concurrent mark\n"
+                << "  -XX:MaxGCPauseMillis=<n>\n"
+                << "                    Pause time target that limits the old regions collected per pause\n"
+                << "  -Xparsecache <dir> Cache parsed class metadata in <dir>\n"
+                << "  -Xinspect[:json|:table] <path>...\n"
+                << "                    Parse every class in the given jars, directories or dir/*\n"
+                << "                    in parallel and print a summary per class (JSON lines by default)\n";
     }
 
     // Private member variables
@@ -202,6 +346,8 @@ private:
     bool _parse_sucess;
     bool _help_flag;
     bool _version_flag;
+    bool _inspect_flag;
+    bool _inspect_table;
     
     std::string _pname; // 程序名
     
@@ -210,9 +356,16 @@ private:
 
     std::string _Xjre_path; // JRE path
     std::string _class_path; // Classpath
+    std::string _Xparsecache_dir; // 解析缓存目录，为空表示不启用
+    size_t _Xms_bytes; // -Xms，0表示默认
+    size_t _Xmx_bytes; // -Xmx，0表示默认
+    size_t _parallel_gc_threads; // -XX:ParallelGCThreads，0表示默认
+    size_t _initiating_heap_occupancy_percent; // -XX:InitiatingHeapOccupancyPercent
+    size_t _max_gc_pause_millis; // -XX:MaxGCPauseMillis
     
     std::string _java_class; // Main class name (e.g., HelloWorld.class)
     std::vector<std::string> _args;
+    std::vector<std::string> _inspect_paths; // -Xinspect的输入
 
     std::string _error_msg;
 
@@ -220,7 +373,14 @@ private:
     explicit Cmd() :_parse_sucess(true),
                     _help_flag(false),
                     _version_flag(false),
-                    _Xjre_path(DEFAULT_JRE_PATH) {}
+                    _inspect_flag(false),
+                    _inspect_table(false),
+                    _Xjre_path(DEFAULT_JRE_PATH),
+                    _Xms_bytes(0),
+                    _Xmx_bytes(0),
+                    _parallel_gc_threads(0),
+                    _initiating_heap_occupancy_percent(45),
+                    _max_gc_pause_millis(200) {}
     ~Cmd() = default;
     Cmd(const Cmd&) = delete;
     Cmd& operator=(const Cmd&) = delete;
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace jvm {
+namespace gc {
+
+// 卡表：老年代每512字节（一张卡）对应一个字节。写屏障在老年代对象的引用字段被写入后把所在的卡标脏，
+// 年轻代回收时只需扫描脏卡上的对象就能找到老年代指向年轻代的引用，不用遍历整个老年代。
+// 屏障通过全局的偏置基址定位卡字节：card = s_byte_map_base[addr >> CARD_SHIFT]，
+// 先用一次无符号比较过滤掉不在老年代的地址（年轻代对象、堆外对象）
+class CardTable {
+public:
+    static constexpr int CARD_SHIFT = 9;
+    static constexpr size_t CARD_SIZE = size_t(1) << CARD_SHIFT;
+    static constexpr uint8_t CLEAN = 0xFF;
+    static constexpr uint8_t DIRTY = 0;
+
+    CardTable() = default;
+    CardTable(const CardTable&) = delete;
+    CardTable& operator=(const CardTable&) = delete;
+
+    ~CardTable() {
+        if (s_covered_start == reinterpret_cast<uintptr_t>(_start)) {
+            s_byte_map_base = nullptr;
+            s_covered_start = 0;
+            s_covered_size = 0;
+        }
+    }
+
+    // 覆盖[start, start + size)，start按CARD_SIZE对齐；装为写屏障使用的全局卡表
+    void initialize(char* start, size_t size) {
+        _start = start;
+        _count = (size + CARD_SIZE - 1) >> CARD_SHIFT;
+        _p_cards.reset(new uint8_t[_count]);
+        std::memset(_p_cards.get(), CLEAN, _count);
+        s_byte_map_base = _p_cards.get() - (reinterpret_cast<uintptr_t>(start) >> CARD_SHIFT);
+        s_covered_start = reinterpret_cast<uintptr_t>(start);
+        s_covered_size = _count << CARD_SHIFT;
+    }
+
+    size_t indexFor(const void* addr) const {
+        return static_cast<size_t>(static_cast<const char*>(addr) - _start) >> CARD_SHIFT;
+    }
+    char* cardStart(size_t index) const { return _start + (index << CARD_SHIFT); }
+
+    bool isDirty(size_t index) const { return _p_cards[index] == DIRTY; }
+    // 并行回收时多个线程可能同时标脏同一张卡，写的是同一个值
+    void dirty(const void* addr) { __atomic_store_n(&_p_cards[indexFor(addr)], DIRTY, __ATOMIC_RELAXED); }
+    void clear(size_t index) { _p_cards[index] = CLEAN; }
+    // 清除[lo, hi)上的卡，lo和hi按CARD_SIZE对齐
+    void clear(const char* lo, const char* hi) {
+        std::memset(&_p_cards[indexFor(lo)], CLEAN, static_cast<size_t>(hi - lo) >> CARD_SHIFT);
+    }
+    void clearAll() { std::memset(_p_cards.get(), CLEAN, _count); }
+
+    // 依次处理[lo, hi)内的脏卡：先清除再回调fn(卡首, 卡尾)，回调里可以重新标脏
+    template <typename F>
+    void forEachDirtyCard(char* lo, char* hi, F&& fn) {
+        if (lo >= hi) return;
+        size_t end = indexFor(hi - 1) + 1;
+        for (size_t i = indexFor(lo); i < end; i++) {
+            if (_p_cards[i] == DIRTY) {
+                _p_cards[i] = CLEAN;
+                fn(cardStart(i), cardStart(i + 1));
+            }
+        }
+    }
+
+    // 写屏障使用的全局状态，只有一个堆
+    static inline uint8_t* s_byte_map_base = nullptr;
+    static inline uintptr_t s_covered_start = 0;
+    static inline uintptr_t s_covered_size = 0;
+
+private:
+    char* _start = nullptr;
+    size_t _count = 0;
+    std::unique_ptr<uint8_t[]> _p_cards;
+};
+
+// 引用写入后的屏障：field是被写入的引用字段（或数组元素）的地址。
+// 多个线程可能同时标脏同一张卡，并发清扫也在清除别的卡，按字节原子写（与普通写入同样是一条指令）
+inline void post_write_barrier(const void* field) {
+    uintptr_t addr = reinterpret_cast<uintptr_t>(field);
+    if (addr - CardTable::s_covered_start < CardTable::s_covered_size) {
+        __atomic_store_n(&CardTable::s_byte_map_base[addr >> CardTable::CARD_SHIFT], CardTable::DIRTY,
+                         __ATOMIC_RELAXED);
+    }
+}
+
+// 一段连续引用（arraycopy）写入后的屏障
+inline void post_write_barrier_range(const void* start, size_t bytes) {
+    if (bytes == 0) return;
+    const char* lo = static_cast<const char*>(start);
+    const char* hi = lo + bytes - 1;
+    for (const char* p = lo; p <= hi; p += CardTable::CARD_SIZE) {
+        post_write_barrier(p);
+    }
+    post_write_barrier(hi);
+}
+
+// 块偏移表：老年代每张卡记录从卡首往回到覆盖卡首的那个块（对象或填充）起点的距离（8字节为单位），
+// 扫描脏卡时由它找到第一个需要看的对象
+class BlockOffsetTable {
+public:
+    void initialize(char* start, size_t size) {
+        _start = start;
+        _count = (size + CardTable::CARD_SIZE - 1) >> CardTable::CARD_SHIFT;
+        _p_offsets.reset(new uint32_t[_count]());
+    }
+
+    // 记录新分配的块[start, end)：卡首落在块内的卡都指回start
+    void record(char* start, char* end) {
+        size_t first = (static_cast<size_t>(start - _start) + CardTable::CARD_SIZE - 1) >> CardTable::CARD_SHIFT;
+        for (size_t i = first; i < _count; i++) {
+            char* card = _start + (i << CardTable::CARD_SHIFT);
+            if (card >= end) break;
+            _p_offsets[i] = static_cast<uint32_t>((card - start) >> 3);
+        }
+    }
+
+    // 覆盖addr所在卡卡首的块的起点；addr必须在已分配区内
+    char* blockStart(const char* addr) const {
+        size_t index = static_cast<size_t>(addr - _start) >> CardTable::CARD_SHIFT;
+        char* card = _start + (index << CardTable::CARD_SHIFT);
+        return card - (static_cast<size_t>(_p_offsets[index]) << 3);
+    }
+
+private:
+    char* _start = nullptr;
+    size_t _count = 0;
+    std::unique_ptr<uint32_t[]> _p_offsets;
+};
+
+} // namespace gc
+} // namespace jvm
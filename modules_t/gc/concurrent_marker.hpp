@@ -0,0 +1,373 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../log.hpp"
+#include "generations.hpp"
+#include "references.hpp"
+#include "safepoint.hpp"
+#include "satb_queue.hpp"
+#include "../rtda/tlab.hpp"
+
+namespace jvm {
+namespace gc {
+
+// 老年代并发标记-清扫（SATB）。一个周期：
+//   1. 初始标记：搭在一次年轻代回收的停顿末尾。记下老年代的top作为TAMS（top at mark start），
+//      打开写前屏障，把根和根区域（survivor里的对象）直接引用的老年代对象标记上，这一刻的可达对象就是快照；
+//   2. 并发标记：标记线程与mutator同时运行，从已标记的对象出发标记TAMS以下可达的对象；
+//      mutator覆盖引用前写前屏障把旧值记进SATB日志，标记线程取来接着标记；
+//   3. 重新标记：短暂停顿，收上各线程剩下的日志并标记完，关掉写前屏障，按各区域的存活字节选出混合回收的候选区域；
+//   4. 并发清扫：TAMS以下没有标记的对象连成的空隙做成填充，候选区域以外按卡对齐的部分放进空闲块表；
+//      同时把存活对象里指向候选区域的引用记进记忆集；
+//   5. 清理：短暂停顿，结束标记状态，排好候选区域供之后的混合回收使用（见heap_region.hpp），最后清空位图。
+// 只标记TAMS以下的老年代对象：快照里的年轻代对象在初始标记时都在根区域里扫过，
+// 之后新建的对象只可能引用快照里的对象或新对象；之后进入老年代的对象（晋升、大对象）都算活的：
+// 在TAMS之上的不用管，在TAMS以下空闲块里的分配时直接标记（Generations::markAllocated）。
+// 年轻代回收照常穿插进来（标记线程在安全点停下），它不移动TAMS以下的对象。
+// 重新标记时清空空闲块表，之后只有清扫走过的部分才重新放进去。整堆回收会移动对象，中止正在进行的周期。
+// 每次年轻代回收结束时看老年代占用（不算空闲块）加上下次晋升的预留，达到-XX:InitiatingHeapOccupancyPercent
+// 并且上个周期的候选区域都已回收，就在同一个停顿里做初始标记
+class ConcurrentMarker {
+public:
+    static constexpr size_t DEFAULT_INITIATING_OCCUPANCY = 45;
+    // 标记和清扫每处理这么多个对象响应一次安全点
+    static constexpr size_t POLL_INTERVAL = 1024;
+
+    // 重新标记和清理的停顿计入堆的停顿统计
+    using PauseRecorder = std::function<void(uint64_t nanos)>;
+
+    ConcurrentMarker(Generations& generations, size_t initiating_occupancy, PauseRecorder record_pause)
+        : _g(generations), _initiating_occupancy(initiating_occupancy), _record_pause(std::move(record_pause)) {}
+
+    ConcurrentMarker(const ConcurrentMarker&) = delete;
+    ConcurrentMarker& operator=(const ConcurrentMarker&) = delete;
+
+    ~ConcurrentMarker() { stop(); }
+
+    void start() {
+        _thread = std::thread([this] { run(); });
+    }
+
+    // 停止标记线程。调用时不能有登记的Java线程（重新标记要等它们到安全点）
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _shutdown.store(true, std::memory_order_relaxed);
+        }
+        _wakeup.notify_all();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    // 安全点内：没有周期在进行、没有等着混合回收的候选区域，并且老年代占用加上下次晋升的预留达到阈值。
+    // 只看占用时，预留不够引起的整堆回收可能在占用达到阈值之前就发生，周期一直启动不了
+    bool shouldStartCycle(size_t promotion_reserve) {
+        return _phase.load(std::memory_order_relaxed) == Phase::IDLE && !_g.regions.hasCandidates() &&
+               _initiating_occupancy <= 100 &&
+               (_g.oldOccupied() + promotion_reserve) * 100 >= _initiating_occupancy * _g.old.capacity();
+    }
+
+    // 安全点内、年轻代回收后：记下TAMS，打开写前屏障，标记根和根区域直接引用的对象，唤醒标记线程。
+    // roots的约定见YoungCollector::collect，这里由一个线程领取全部根任务
+    template <typename Roots>
+    void initialMark(Roots&& roots) {
+        _tams = _g.old.top();
+        _g.marking_tams = _tams;
+        _g.regions.resetLiveBytes();
+        SatbMarkQueueSet::setActive(true);
+        auto mark = [this](rtda::Object** p_ref) { markAndPush(*p_ref); };
+        std::atomic<size_t> next_root{0};
+        roots(next_root, mark);
+        auto scan = [&mark](rtda::Object* p_object) { for_each_reference(p_object, mark); };
+        _g.from().forEachObject(scan);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _phase.store(Phase::MARKING, std::memory_order_relaxed);
+        }
+        _wakeup.notify_all();
+    }
+
+    // 安全点内、整堆回收前：中止正在进行的周期，丢掉SATB日志
+    void abort() {
+        if (_phase.load(std::memory_order_relaxed) == Phase::IDLE) return;
+        _aborted.store(true, std::memory_order_relaxed);
+        _g.marking_tams = nullptr;
+        _g.sweeping_tams = nullptr;
+        SatbMarkQueueSet::setActive(false);
+        SatbMarkQueueSet::abandon();
+    }
+
+    bool isActive() const { return _phase.load(std::memory_order_relaxed) != Phase::IDLE; }
+    uint64_t cycleCount() const { return _cycles.load(std::memory_order_relaxed); }
+    uint64_t abortedCount() const { return _aborted_cycles.load(std::memory_order_relaxed); }
+    // 最近一次完成的周期里TAMS以下的存活字节数和清扫出的空闲块字节数
+    size_t lastLiveBytes() const { return _live_bytes.load(std::memory_order_relaxed); }
+    size_t lastFreeBytes() const { return _free_bytes.load(std::memory_order_relaxed); }
+
+private:
+    enum class Phase { IDLE, MARKING, SWEEPING };
+
+    // 标记线程：空闲时不访问堆（Blocked），被初始标记唤醒后依次做并发标记、重新标记、并发清扫、清理
+    void run() {
+        Safepoint::attachConcurrentThread();
+        for (;;) {
+            {
+                Safepoint::Blocked blocked;
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wakeup.wait(lock, [this] {
+                    return _shutdown.load(std::memory_order_relaxed) ||
+                           _phase.load(std::memory_order_relaxed) == Phase::MARKING;
+                });
+                if (_shutdown.load(std::memory_order_relaxed)) break;
+            }
+            if (concurrentMark() && remark() && sweep() && cleanup()) {
+                _cycles.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                _aborted_cycles.fetch_add(1, std::memory_order_relaxed);
+            }
+            finish();
+        }
+        Safepoint::detachConcurrentThread();
+    }
+
+    bool stopped() const {
+        return _aborted.load(std::memory_order_relaxed) || _shutdown.load(std::memory_order_relaxed);
+    }
+
+    // TAMS以下还没标记的对象：标记并压栈，计入区域的存活字节
+    void markAndPush(rtda::Object* p_object) {
+        char* p = reinterpret_cast<char*>(p_object);
+        if (p >= _g.old.bottom() && p < _tams && _g.marks.parMark(p)) {
+            _g.regions.addLiveBytes(p, rtda::object_size(p_object));
+            _mark_stack.push_back(p_object);
+        }
+    }
+
+    // mutator可能同时在改字段，原子地读
+    void scan(rtda::Object* p_object) {
+        for_each_reference(p_object, [this](rtda::Object** p_ref) {
+            markAndPush(__atomic_load_n(p_ref, __ATOMIC_RELAXED));
+        });
+    }
+
+    // 处理一个已满的SATB缓冲区，没有时返回false
+    bool drainSatbBuffer() {
+        if (!SatbMarkQueueSet::claimCompleted(_satb_buffer)) return false;
+        for (rtda::Object* p_object : _satb_buffer) {
+            markAndPush(p_object);
+        }
+        _satb_buffer.clear();
+        return true;
+    }
+
+    // 标记栈和已满的SATB缓冲区都处理完时返回true，周期被中止时返回false
+    bool concurrentMark() {
+        size_t work = 0;
+        do {
+            while (!_mark_stack.empty()) {
+                if (++work >= POLL_INTERVAL) {
+                    work = 0;
+                    Safepoint::poll();
+                }
+                if (stopped()) return false;
+                rtda::Object* p_object = _mark_stack.back();
+                _mark_stack.pop_back();
+                scan(p_object);
+            }
+            Safepoint::poll();
+            if (stopped()) return false;
+        } while (drainSatbBuffer());
+        return true;
+    }
+
+    // 开始一次停顿，周期被中止时返回false
+    bool beginPause() {
+        for (;;) {
+            if (stopped()) return false;
+            if (Safepoint::begin()) return true;
+            // 别的线程发起了回收，等它结束后再试
+        }
+    }
+
+    uint64_t endPause(std::chrono::steady_clock::time_point start) {
+        uint64_t nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        _record_pause(nanos);
+        return nanos;
+    }
+
+    // 停顿里收上各线程剩下的日志并标记完，选出候选区域
+    bool remark() {
+        if (!beginPause()) return false;
+        auto start = std::chrono::steady_clock::now();
+        SatbMarkQueueSet::flushAll();
+        do {
+            while (!_mark_stack.empty()) {
+                rtda::Object* p_object = _mark_stack.back();
+                _mark_stack.pop_back();
+                scan(p_object);
+            }
+        } while (drainSatbBuffer());
+        SatbMarkQueueSet::setActive(false);
+        // marking_tams留到清扫结束：清扫出的空闲块里新分配的对象照样标记，不会被当成死对象
+        _g.sweeping_tams = _tams;
+        _remark_top = _g.old.top();
+        size_t candidates = _g.regions.selectCandidates(_tams);
+        // 表里的块可能在清扫还没走到的地方，先忘掉，清扫时重新发现
+        _g.free_list.clear();
+        _phase.store(Phase::SWEEPING, std::memory_order_relaxed);
+        uint64_t nanos = endPause(start);
+        LOG(DEBUG, "GC(remark): tams %zuK, %zu candidate regions, pause %.3fms",
+            static_cast<size_t>(_tams - _g.old.bottom()) >> 10, candidates, nanos / 1e6);
+        Safepoint::end();
+        return true;
+    }
+
+    // 清扫结束后的停顿：结束标记状态，排好候选区域，之后的年轻代回收开始带上它们
+    bool cleanup() {
+        if (!beginPause()) return false;
+        auto start = std::chrono::steady_clock::now();
+        _g.marking_tams = nullptr;
+        _g.sweeping_tams = nullptr;
+        size_t candidates = _g.regions.publishCandidates(_g.old.capacity());
+        uint64_t nanos = endPause(start);
+        LOG(DEBUG, "GC(cleanup): %zu regions for mixed collections, pause %.3fms", candidates, nanos / 1e6);
+        Safepoint::end();
+        return true;
+    }
+
+    // 按地址顺序走过TAMS以下的老年代，把连续的死对象和填充合成一段回收掉，存活对象的引用记进记忆集。
+    // 空闲块表里只有已经走过的块，穿插进来的年轻代回收和大对象分配不会改动还没走到的部分。
+    // 最后把重新标记时TAMS和top之间的对象（都算活的）的引用也记进记忆集
+    bool sweep() {
+        char* bottom = _g.old.bottom();
+        char* dead = nullptr;
+        size_t live_bytes = 0;
+        size_t free_bytes = 0;
+        size_t work = 0;
+        for (char* p = bottom; p < _tams;) {
+            if (++work >= POLL_INTERVAL) {
+                work = 0;
+                Safepoint::poll();
+                if (stopped()) return false;
+            }
+            if (*reinterpret_cast<const uint64_t*>(p) == rtda::markword::FILLER_WORD) {
+                if (dead == nullptr) dead = p;
+                p += sizeof(uint64_t);
+                continue;
+            }
+            size_t size = rtda::object_size(reinterpret_cast<rtda::Object*>(p));
+            if (_g.marks.isMarked(p)) {
+                if (dead != nullptr) {
+                    free_bytes += reclaim(dead, p);
+                    dead = nullptr;
+                }
+                live_bytes += size;
+                rememberReferences(reinterpret_cast<rtda::Object*>(p));
+            } else if (dead == nullptr) {
+                dead = p;
+            }
+            p += size;
+        }
+        if (dead != nullptr) {
+            free_bytes += reclaim(dead, _tams);
+        }
+        if (_g.regions.isTracking()) {
+            for (char* p = _tams; p < _remark_top;) {
+                if (++work >= POLL_INTERVAL) {
+                    work = 0;
+                    Safepoint::poll();
+                    if (stopped()) return false;
+                }
+                if (*reinterpret_cast<const uint64_t*>(p) == rtda::markword::FILLER_WORD) {
+                    p += sizeof(uint64_t);
+                    continue;
+                }
+                rtda::Object* p_object = reinterpret_cast<rtda::Object*>(p);
+                p += rtda::object_size(p_object);
+                rememberReferences(p_object);
+            }
+        }
+        _live_bytes.store(live_bytes, std::memory_order_relaxed);
+        _free_bytes.store(free_bytes, std::memory_order_relaxed);
+        LOG(DEBUG, "GC(concurrent): old below tams %zuK, live %zuK, free chunks %zuK",
+            static_cast<size_t>(_tams - bottom) >> 10, live_bytes >> 10, free_bytes >> 10);
+        return true;
+    }
+
+    // [start, end)全是死对象和填充：按区域切开，候选区域里的只做成填充（整个区域以后复制回收），
+    // 其余的回收进空闲块表（见Generations::reclaimOld），空闲块不跨区域。返回放进空闲块表的字节数
+    size_t reclaim(char* start, char* end) {
+        size_t freed = 0;
+        while (start < end) {
+            HeapRegion& r = _g.regions.regionFor(start);
+            char* piece_end = std::min(end, r.end);
+            if (r.candidate) {
+                _g.formatOld(start, piece_end);
+            } else {
+                freed += _g.reclaimOld(start, piece_end);
+            }
+            start = piece_end;
+        }
+        return freed;
+    }
+
+    // 对象里指向候选区域的引用记进记忆集；mutator可能同时在改字段，原子地读
+    void rememberReferences(rtda::Object* p_object) {
+        if (!_g.regions.isTracking()) return;
+        for_each_reference(p_object, [this, p_object](rtda::Object** p_ref) {
+            rtda::Object* p_target = __atomic_load_n(p_ref, __ATOMIC_RELAXED);
+            if (p_target != nullptr) {
+                _g.regions.remember(p_object, p_ref, p_target);
+            }
+        });
+    }
+
+    // 周期结束（完成或中止）：清空位图和标记栈，回到空闲
+    void finish() {
+        {
+            Safepoint::Blocked blocked;
+            _g.marks.clear(_tams);
+        }
+        _mark_stack.clear();
+        _satb_buffer.clear();
+        // 这里到下一次poll()之间不会有停顿，与abort()不会交错
+        _aborted.store(false, std::memory_order_relaxed);
+        _phase.store(Phase::IDLE, std::memory_order_relaxed);
+    }
+
+    Generations& _g;
+    const size_t _initiating_occupancy;
+    PauseRecorder _record_pause;
+
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _wakeup;
+    std::atomic<bool> _shutdown{false};
+    std::atomic<bool> _aborted{false};
+    std::atomic<Phase> _phase{Phase::IDLE};
+
+    char* _tams = nullptr;
+    char* _remark_top = nullptr;    // 重新标记时老年代的top
+    std::vector<rtda::Object*> _mark_stack;
+    SatbMarkQueueSet::Buffer _satb_buffer;
+
+    std::atomic<uint64_t> _cycles{0};
+    std::atomic<uint64_t> _aborted_cycles{0};
+    std::atomic<size_t> _live_bytes{0};
+    std::atomic<size_t> _free_bytes{0};
+};
+
+} // namespace gc
+} // namespace jvm
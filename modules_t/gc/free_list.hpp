@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <mutex>
+
+namespace jvm {
+namespace gc {
+
+// 老年代空闲块表：并发清扫把死对象连成的空隙放进来，老年代分配（晋升的PLAB、大对象）先在这里找，
+// 找不到再推进老年代的top。块的首尾都按卡对齐，块上的卡都是干净的：
+// 块里分配出去的对象不会和回收前就有的对象共用一张卡，年轻代回收扫描脏卡时不会碰到正在写入的块。
+// 块在堆里格式化成填充（见Tlab::fill），堆照样可以逐个对象遍历。
+// 按大小排序，取能放下的最小块；由Generations负责把多出来的部分切下来放回
+class FreeList {
+public:
+    // 比最小的PLAB还小的空隙不值得记
+    static constexpr size_t MIN_CHUNK_SIZE = size_t(4) << 10;
+
+    void add(char* start, char* end) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        size_t size = static_cast<size_t>(end - start);
+        _chunks.emplace(size, start);
+        _free_bytes += size;
+    }
+
+    // 取出一块不小于size的块，[*p_start, *p_end)；没有时退而取最大的一块，但不能小于min_size
+    bool take(size_t size, size_t min_size, char** p_start, char** p_end) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _chunks.lower_bound(size);
+        if (it == _chunks.end()) {
+            if (_chunks.empty() || std::prev(it)->first < min_size) return false;
+            --it;
+        }
+        *p_start = it->second;
+        *p_end = it->second + it->first;
+        _free_bytes -= it->first;
+        _chunks.erase(it);
+        return true;
+    }
+
+    // 忘掉所有块（块本身仍是填充，之后由清扫重新发现）
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _chunks.clear();
+        _free_bytes = 0;
+    }
+
+    size_t freeBytes() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _free_bytes;
+    }
+
+    // 不小于min_size的块一共多少字节
+    size_t freeBytesInChunksOf(size_t min_size) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        size_t bytes = 0;
+        for (auto it = _chunks.lower_bound(min_size); it != _chunks.end(); ++it) {
+            bytes += it->first;
+        }
+        return bytes;
+    }
+
+private:
+    std::mutex _mutex;
+    std::multimap<size_t, char*> _chunks;   // 大小 -> 起点
+    size_t _free_bytes = 0;
+};
+
+} // namespace gc
+} // namespace jvm
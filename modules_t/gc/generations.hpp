@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "space.hpp"
+#include "card_table.hpp"
+#include "free_list.hpp"
+#include "heap_region.hpp"
+#include "mark_bitmap.hpp"
+#include "../rtda/tlab.hpp"
+
+namespace jvm {
+namespace gc {
+
+// 分代堆的空间划分，整段保留区按地址从低到高为 [老年代 | eden | survivor0 | survivor1]：
+// 新对象在eden分配，年轻代回收把存活对象复制到空的survivor（to），熬过若干次后晋升到老年代；
+// 老年代放晋升对象和大对象，由卡表记录其中指向年轻代的引用。
+// 老年代在最低地址，整堆压缩时所有存活对象都能向低地址滑动。
+// 并发清扫回收的老年代空隙记在空闲块表里，老年代分配先用空闲块，再推进top；
+// 并发标记期间在TAMS以下（空闲块里）分配的对象直接标记（allocate black），清扫时当作活的。
+// 老年代同时划分成等大小的区域（见heap_region.hpp），混合回收时部分区域和年轻代一起复制
+struct Generations {
+    ContiguousSpace old;
+    ContiguousSpace eden;
+    ContiguousSpace survivors[2];
+    int from_index = 0;
+
+    CardTable cards;            // 覆盖老年代
+    BlockOffsetTable offsets;   // 覆盖老年代
+    MarkBitmap marks;           // 覆盖老年代，并发标记用
+    FreeList free_list;         // 老年代里的空闲块
+    HeapRegionTable regions;    // 覆盖老年代
+    // 从初始标记到清扫结束的TAMS，其余时候为nullptr；只在安全点内修改
+    char* marking_tams = nullptr;
+    // 从重新标记到清扫结束的TAMS：这期间TAMS以下没有标记的对象都是死的，只是还没清扫
+    char* sweeping_tams = nullptr;
+
+    ContiguousSpace& from() { return survivors[from_index]; }
+    ContiguousSpace& to() { return survivors[1 - from_index]; }
+    void flip() { from_index = 1 - from_index; }
+
+    bool inYoung(const void* p) const { return p >= eden.bottom() && p < survivors[1].limit(); }
+    bool contains(const void* p) const { return p >= old.bottom() && p < survivors[1].limit(); }
+    // 年轻代回收要移动的对象：eden和from里的，混合回收时还有回收集合里的老年代区域
+    bool inCollectionSet(const void* p) {
+        return eden.contains(p) || from().contains(p) ||
+               (regions.hasOldCollectionSet() && old.contains(p) && regions.inCollectionSet(p));
+    }
+
+    // 已经知道死了、等着清扫的老年代对象，扫描卡时跳过
+    bool isDead(const void* p) const { return p < sweeping_tams && !marks.isMarked(p); }
+
+    size_t youngUsed() { return eden.used() + from().used(); }
+    // 老年代里对象（包括还没清扫的死对象）占用的字节数
+    size_t oldOccupied() { return old.used() - free_list.freeBytes(); }
+
+    // 新分配到老年代的对象：并发标记期间落在TAMS以下时直接标记，计入区域的存活字节
+    void markAllocated(char* p, size_t size) {
+        if (p < marking_tams) {
+            marks.parMark(p);
+            regions.addLiveBytes(p, size);
+        }
+    }
+
+    // 在老年代分配并记录块偏移表，失败返回nullptr。空闲块的起点按卡对齐，满足任何对象的对齐要求
+    char* allocateOld(size_t size, size_t alignment) {
+        char* chunk_end = nullptr;
+        char* p = takeFreeChunk(size, size, &chunk_end);
+        if (p != nullptr) {
+            markAllocated(p, size);
+            offsets.record(p, p + size);
+            if (p + size < chunk_end) {
+                rtda::Tlab::fill(p + size, chunk_end);
+                offsets.record(p + size, chunk_end);
+            }
+            return p;
+        }
+        char* p_block = nullptr;
+        p = old.allocateAligned(size, alignment, &p_block);
+        if (p != nullptr) {
+            offsets.record(p_block, p + size);
+        }
+        return p;
+    }
+
+    // 在老年代取一块内存做PLAB：空闲块表里没有size字节的块时也接受小一些的，*p_end得到块尾。
+    // 由调用者记录块偏移表、标记新对象
+    char* allocateOldChunk(size_t size, char** p_end) {
+        char* p = takeFreeChunk(size, FreeList::MIN_CHUNK_SIZE, p_end);
+        if (p == nullptr) {
+            p = old.allocate(size);
+            *p_end = p != nullptr ? p + size : nullptr;
+        }
+        return p;
+    }
+
+    // [start, end)全是死对象和填充：做成填充，中间按卡对齐的部分足够大时单独成块、清除卡、放进空闲块表。
+    // 返回放进空闲块表的字节数
+    size_t reclaimOld(char* start, char* end) {
+        char* lo = alignCardUp(start);
+        char* hi = alignCardDown(end);
+        if (hi <= lo || static_cast<size_t>(hi - lo) < FreeList::MIN_CHUNK_SIZE) {
+            formatOld(start, end);
+            return 0;
+        }
+        formatOld(start, lo);
+        formatOld(lo, hi);
+        formatOld(hi, end);
+        cards.clear(lo, hi);
+        free_list.add(lo, hi);
+        return static_cast<size_t>(hi - lo);
+    }
+
+    void formatOld(char* start, char* end) {
+        if (start < end) {
+            rtda::Tlab::fill(start, end);
+            offsets.record(start, end);
+        }
+    }
+
+    // 混合回收前（安全点内）：把区域加入回收集合，算好回收范围。
+    // 区域里的对象都在TAMS以下、已经清扫过，跨区域边界的只有存活对象
+    void addToCollectionSet(HeapRegion& r) {
+        char* p = offsets.blockStart(r.bottom);
+        while (p < r.bottom) p += blockSize(p);
+        r.span_start = p;
+        r.span_end = std::max(r.end, p);
+        if (r.end < old.top()) {
+            for (p = std::max(offsets.blockStart(r.end), r.span_start); p < r.end;) {
+                p += blockSize(p);
+            }
+            r.span_end = std::max(p, r.span_start);
+        }
+        regions.addToCollectionSet(r);
+    }
+
+    // 混合回收后（安全点内）：回收集合里区域的存活对象都已复制出去，整段回收。
+    // 跨进下一个区域的部分只做成填充，空闲块不跨出区域（下一个区域可能还是候选）。返回放进空闲块表的字节数
+    size_t freeCollectionSet() {
+        size_t freed = 0;
+        for (HeapRegion* p_region : regions.collectionSet()) {
+            char* end = std::min(p_region->span_end, p_region->end);
+            if (p_region->span_start < end) {
+                regions.forget(alignCardUp(p_region->span_start), alignCardDown(end));
+                freed += reclaimOld(p_region->span_start, end);
+            }
+            formatOld(std::max(p_region->span_start, p_region->end), p_region->span_end);
+        }
+        regions.clearCollectionSet(old.capacity());
+        return freed;
+    }
+
+    // 按地址顺序访问所有对象：老年代、eden、两个survivor。to平时是空的，
+    // 只在晋升失败后、紧接着的整堆回收之前有对象。调用时所有TLAB都必须已经交回
+    template <typename F>
+    void forEachObject(F&& fn) {
+        old.forEachObject(fn);
+        eden.forEachObject(fn);
+        survivors[0].forEachObject(fn);
+        survivors[1].forEachObject(fn);
+    }
+
+private:
+    static char* alignCardUp(char* p) {
+        uintptr_t mask = CardTable::CARD_SIZE - 1;
+        return reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(p) + mask) & ~mask);
+    }
+
+    static char* alignCardDown(char* p) {
+        return reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(p) & ~(CardTable::CARD_SIZE - 1));
+    }
+
+    // 填充字或对象（包括填充数组）的大小
+    static size_t blockSize(char* p) {
+        if (*reinterpret_cast<const uint64_t*>(p) == rtda::markword::FILLER_WORD) return sizeof(uint64_t);
+        return rtda::object_size(reinterpret_cast<rtda::Object*>(p));
+    }
+
+    // 从空闲块表取一块size字节（至少min_size）的块，按卡取整后剩下的部分够大就切下来放回
+    char* takeFreeChunk(size_t size, size_t min_size, char** p_end) {
+        size_t rounded = (size + CardTable::CARD_SIZE - 1) & ~(CardTable::CARD_SIZE - 1);
+        char* start = nullptr;
+        if (!free_list.take(rounded, min_size, &start, p_end)) {
+            return nullptr;
+        }
+        char* rest = start + rounded;
+        if (rest < *p_end && static_cast<size_t>(*p_end - rest) >= FreeList::MIN_CHUNK_SIZE) {
+            rtda::Tlab::fill(rest, *p_end);
+            offsets.record(rest, *p_end);
+            free_list.add(rest, *p_end);
+            *p_end = rest;
+        }
+        return start;
+    }
+};
+
+} // namespace gc
+} // namespace jvm
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "card_table.hpp"
+
+namespace jvm {
+namespace gc {
+
+// 老年代的一个区域：等大小的一段地址。对象不按区域对齐，起点在区域里的对象就算这个区域的，可能跨到下一个区域
+struct HeapRegion {
+    size_t index = 0;
+    char* bottom = nullptr;
+    char* end = nullptr;
+    // 最近一次并发标记里，起点在这个区域、标记为活的对象的字节数
+    std::atomic<size_t> live_bytes{0};
+    // 混合回收的候选区域：记忆集在维护，清扫不把这里的空隙放进空闲块表
+    bool candidate = false;
+    // 在这次停顿的回收集合里，对象要复制出去
+    bool in_cset = false;
+    // 记忆集：别的区域里可能有引用指向这里的卡（卡号）。只有候选区域维护
+    std::set<size_t> remembered_set;
+    // 加入回收集合时算好的回收范围：去掉从前一个区域跨进来的对象，算上从这里跨出去的对象
+    char* span_start = nullptr;
+    char* span_end = nullptr;
+
+    size_t size() const { return static_cast<size_t>(end - bottom); }
+};
+
+// 老年代按区域划分（G1的做法），混合回收用：
+//   1. 并发标记统计每个区域的存活字节数（Generations::markAllocated和标记线程）；
+//   2. 重新标记时，存活不到MIXED_LIVE_THRESHOLD_PERCENT、整个在TAMS以下的区域成为候选，开始维护记忆集：
+//      年轻代回收扫描脏卡、晋升对象时，把指向候选区域的引用所在的卡记下来，清扫时补上已有的引用；
+//   3. 清扫结束时按回收效率排好候选区域，之后的年轻代回收每次带上一部分（见PausePolicy），
+//      复制出其中的存活对象后整个区域回收，老年代就这样一点点被压缩。
+// 候选区域之外的空隙照旧由清扫放进空闲块表。区域大小按堆的最大容量取，区域数在2048左右
+class HeapRegionTable {
+public:
+    static constexpr size_t MIN_REGION_SIZE = size_t(1) << 20;
+    static constexpr size_t MAX_REGION_SIZE = size_t(32) << 20;
+    static constexpr size_t TARGET_REGION_COUNT = 2048;
+    // 存活字节不到区域大小的这个百分比才值得复制
+    static constexpr size_t MIXED_LIVE_THRESHOLD_PERCENT = 85;
+    // 候选区域里能回收的总量不到老年代容量的这个百分比时，不再做混合回收
+    static constexpr size_t HEAP_WASTE_PERCENT = 5;
+
+    // 不小于MIN_REGION_SIZE、不大于MAX_REGION_SIZE的2的幂，使区域数接近TARGET_REGION_COUNT
+    static size_t regionSizeFor(size_t heap_size) {
+        size_t size = MIN_REGION_SIZE;
+        while (size < MAX_REGION_SIZE && size * 2 * TARGET_REGION_COUNT <= heap_size) {
+            size *= 2;
+        }
+        return size;
+    }
+
+    // 覆盖[start, start + size)，start按CARD_SIZE对齐；最后一个区域可能不满
+    void initialize(char* start, size_t size, size_t region_size) {
+        _start = start;
+        _region_shift = 0;
+        while ((size_t(1) << _region_shift) < region_size) _region_shift++;
+        _count = std::max<size_t>(1, (size + region_size - 1) >> _region_shift);
+        _p_regions.reset(new HeapRegion[_count]);
+        for (size_t i = 0; i < _count; i++) {
+            HeapRegion& r = _p_regions[i];
+            r.index = i;
+            r.bottom = start + (i << _region_shift);
+            r.end = std::min(r.bottom + region_size, start + size);
+        }
+        _max_remembered_cards = region_size >> CardTable::CARD_SHIFT;
+    }
+
+    size_t regionSize() const { return size_t(1) << _region_shift; }
+    size_t count() const { return _count; }
+    HeapRegion& at(size_t index) { return _p_regions[index]; }
+    // p必须在老年代里
+    HeapRegion& regionFor(const void* p) { return _p_regions[indexFor(p)]; }
+
+    // 初始标记：各区域的存活字节从零算起
+    void resetLiveBytes() {
+        for (size_t i = 0; i < _count; i++) {
+            _p_regions[i].live_bytes.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // 对象整个算在起点所在的区域（回收那个区域时要复制它）；跨出去的部分也算进后面的区域，
+    // 回收后面的区域腾不出这部分，整个被盖住的区域不会成为候选
+    void addLiveBytes(const void* p, size_t size) {
+        size_t index = indexFor(p);
+        _p_regions[index].live_bytes.fetch_add(size, std::memory_order_relaxed);
+        const char* end = static_cast<const char*>(p) + size;
+        for (index++; index < _count && _p_regions[index].bottom < end; index++) {
+            HeapRegion& r = _p_regions[index];
+            r.live_bytes.fetch_add(static_cast<size_t>(std::min<const char*>(end, r.end) - r.bottom),
+                                   std::memory_order_relaxed);
+        }
+    }
+
+    // 重新标记（安全点内）：选出候选区域，返回个数。只看整个在TAMS以下的区域，这之后它们里面不会再分配对象
+    size_t selectCandidates(const char* tams) {
+        clearCandidates();
+        size_t selected = 0;
+        for (size_t i = 0; i < _count; i++) {
+            HeapRegion& r = _p_regions[i];
+            if (r.end > tams) break;
+            if (r.live_bytes.load(std::memory_order_relaxed) * 100 < r.size() * MIXED_LIVE_THRESHOLD_PERCENT) {
+                r.candidate = true;
+                selected++;
+            }
+        }
+        _tracking = selected != 0;
+        return selected;
+    }
+
+    // 有没有候选区域（在维护记忆集）
+    bool isTracking() const { return _tracking; }
+
+    // 是否在维护记忆集的区域里（p为nullptr或不在老年代时返回false）
+    bool isCandidate(const void* p) const {
+        if (!_tracking) return false;
+        size_t offset = static_cast<size_t>(static_cast<const char*>(p) - _start);
+        return (offset >> _region_shift) < _count && _p_regions[offset >> _region_shift].candidate;
+    }
+
+    // 老年代对象p_holder里的槽位p_slot指向p_target：p_target在别的候选区域时，把p_slot所在的卡记进那个区域的记忆集。
+    // 按p_holder的起点判断是不是同一个区域：从前一个区域跨进来的对象不随这个区域复制，里面的槽位也要记。
+    // 记忆集太大（比区域本身的卡还多）的区域复制起来不划算，不再作为候选
+    void remember(const void* p_holder, const void* p_slot, const void* p_target) {
+        if (!isCandidate(p_target)) return;
+        HeapRegion& r = regionFor(p_target);
+        if (r.in_cset || indexFor(p_holder) == r.index) return;
+        r.remembered_set.insert(cardIndex(p_slot));
+        if (r.remembered_set.size() > _max_remembered_cards) {
+            dropCandidate(r);
+        }
+    }
+
+    // [lo, hi)（按卡对齐）成了空闲块：从所有记忆集里去掉这些卡，以后它们上面可能正在分配
+    void forget(const char* lo, const char* hi) {
+        if (!_tracking) return;
+        size_t first = cardIndex(lo);
+        size_t last = cardIndex(hi);
+        for (size_t i = 0; i < _count; i++) {
+            std::set<size_t>& cards = _p_regions[i].remembered_set;
+            if (!cards.empty()) {
+                cards.erase(cards.lower_bound(first), cards.lower_bound(last));
+            }
+        }
+    }
+
+    // 清扫结束（安全点内）：按回收效率排好候选区域，可回收的总量太少时全部放弃。返回排好的个数
+    size_t publishCandidates(size_t old_capacity) {
+        _candidates.clear();
+        size_t reclaimable = 0;
+        for (size_t i = 0; i < _count; i++) {
+            HeapRegion& r = _p_regions[i];
+            if (r.candidate) {
+                _candidates.push_back(&r);
+                reclaimable += reclaimableBytes(r);
+            }
+        }
+        if (reclaimable * 100 < old_capacity * HEAP_WASTE_PERCENT) {
+            clearCandidates();
+            return 0;
+        }
+        // 回收效率：腾出的字节 / 要复制的字节和要扫描的卡
+        auto cost = [](const HeapRegion& r) {
+            return r.live_bytes.load(std::memory_order_relaxed) + r.remembered_set.size() * CardTable::CARD_SIZE + 1;
+        };
+        std::sort(_candidates.begin(), _candidates.end(), [&](const HeapRegion* a, const HeapRegion* b) {
+            return static_cast<double>(reclaimableBytes(*a)) / cost(*a) >
+                   static_cast<double>(reclaimableBytes(*b)) / cost(*b);
+        });
+        _published_count = _candidates.size();
+        return _published_count;
+    }
+
+    // 排好的候选区域，效率高的在前
+    const std::vector<HeapRegion*>& candidates() const { return _candidates; }
+    bool hasCandidates() const { return !_candidates.empty(); }
+    // 清扫结束时排好的候选区域个数，混合回收按它分几次做完
+    size_t publishedCount() const { return _published_count; }
+
+    static size_t reclaimableBytes(const HeapRegion& r) {
+        size_t live = r.live_bytes.load(std::memory_order_relaxed);
+        return live < r.size() ? r.size() - live : 0;
+    }
+
+    // 年轻代回收前（安全点内）：排在最前面的候选区域加入回收集合，从候选列表里拿掉
+    void addToCollectionSet(HeapRegion& r) {
+        r.in_cset = true;
+        _cset.push_back(&r);
+        _candidates.erase(std::find(_candidates.begin(), _candidates.end(), &r));
+    }
+
+    const std::vector<HeapRegion*>& collectionSet() const { return _cset; }
+    bool hasOldCollectionSet() const { return !_cset.empty(); }
+
+    // p在这次回收集合的老年代区域里（p必须在老年代里）
+    bool inCollectionSet(const void* p) { return regionFor(p).in_cset; }
+
+    // 回收集合里的区域回收完：不再是候选，忘掉记忆集。剩下的候选区域能回收的太少时一起放弃
+    void clearCollectionSet(size_t old_capacity) {
+        for (HeapRegion* p_region : _cset) {
+            p_region->in_cset = false;
+            p_region->candidate = false;
+            p_region->remembered_set.clear();
+        }
+        _cset.clear();
+        size_t reclaimable = 0;
+        for (HeapRegion* p_region : _candidates) {
+            reclaimable += reclaimableBytes(*p_region);
+        }
+        if (_candidates.empty() || reclaimable * 100 < old_capacity * HEAP_WASTE_PERCENT) {
+            clearCandidates();
+        }
+    }
+
+    // 放弃所有候选区域（整堆回收移动了对象，或者候选区域已经不值得回收）
+    void clearCandidates() {
+        for (size_t i = 0; i < _count; i++) {
+            HeapRegion& r = _p_regions[i];
+            r.candidate = false;
+            r.in_cset = false;
+            r.remembered_set.clear();
+        }
+        _candidates.clear();
+        _cset.clear();
+        _published_count = 0;
+        _tracking = false;
+    }
+
+private:
+    size_t indexFor(const void* p) const {
+        return static_cast<size_t>(static_cast<const char*>(p) - _start) >> _region_shift;
+    }
+
+    size_t cardIndex(const void* p) const {
+        return static_cast<size_t>(static_cast<const char*>(p) - _start) >> CardTable::CARD_SHIFT;
+    }
+
+    void dropCandidate(HeapRegion& r) {
+        r.candidate = false;
+        r.remembered_set.clear();
+        auto it = std::find(_candidates.begin(), _candidates.end(), &r);
+        if (it != _candidates.end()) {
+            _candidates.erase(it);
+        }
+    }
+
+    char* _start = nullptr;
+    int _region_shift = 0;
+    size_t _count = 0;
+    std::unique_ptr<HeapRegion[]> _p_regions;
+    size_t _max_remembered_cards = 0;
+    bool _tracking = false;     // 有候选区域时才需要维护记忆集
+    std::vector<HeapRegion*> _candidates;
+    std::vector<HeapRegion*> _cset;
+    size_t _published_count = 0;
+};
+
+} // namespace gc
+} // namespace jvm
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/mman.h>
+
+namespace jvm {
+namespace gc {
+
+// 标记位图：老年代每8字节（一个可能的对象起点）一位，并发标记用。
+// 标记位不放在对象头里，标记线程和mutator（加锁、生成哈希）不会争同一个标记字，清扫时也不用改对象。
+// 位图按保留区大小映射，只有用到的部分才占物理内存
+class MarkBitmap {
+public:
+    MarkBitmap() = default;
+    MarkBitmap(const MarkBitmap&) = delete;
+    MarkBitmap& operator=(const MarkBitmap&) = delete;
+
+    ~MarkBitmap() {
+        if (_p_words != nullptr) {
+            munmap(_p_words, _word_count * sizeof(uint64_t));
+        }
+    }
+
+    // 覆盖[start, start + size)
+    void initialize(char* start, size_t size) {
+        _start = start;
+        _word_count = (size / sizeof(uint64_t) + 63) / 64;
+        void* p = mmap(nullptr, _word_count * sizeof(uint64_t), PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::runtime_error("Cannot reserve mark bitmap");
+        }
+        _p_words = static_cast<std::atomic<uint64_t>*>(p);
+    }
+
+    // 设置addr的标记位，已经标记过时返回false
+    bool parMark(const void* addr) {
+        size_t bit = bitIndex(addr);
+        uint64_t mask = uint64_t(1) << (bit & 63);
+        return (_p_words[bit >> 6].fetch_or(mask, std::memory_order_relaxed) & mask) == 0;
+    }
+
+    bool isMarked(const void* addr) const {
+        size_t bit = bitIndex(addr);
+        return (_p_words[bit >> 6].load(std::memory_order_relaxed) & (uint64_t(1) << (bit & 63))) != 0;
+    }
+
+    // 清除[start, to)的标记，按一个字覆盖的512字节向上取整
+    void clear(const char* to) {
+        size_t words = (bitIndex(to) + 63) / 64;
+        std::memset(static_cast<void*>(_p_words), 0, words * sizeof(uint64_t));
+    }
+
+private:
+    size_t bitIndex(const void* addr) const {
+        return static_cast<size_t>(static_cast<const char*>(addr) - _start) / sizeof(uint64_t);
+    }
+
+    char* _start = nullptr;
+    size_t _word_count = 0;
+    std::atomic<uint64_t>* _p_words = nullptr;
+};
+
+} // namespace gc
+} // namespace jvm
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "generations.hpp"
+#include "references.hpp"
+#include "task_queue.hpp"
+#include "work_gang.hpp"
+
+namespace jvm {
+namespace gc {
+
+// 整堆标记-压缩（老年代放不下时使用）：
+//   1. 从根标记所有可达对象（工作线程组并行，用工作窃取队列分摊）；
+//   2. 按地址顺序（老年代、eden、两个survivor）给存活对象分配新地址，依次紧挨着排在老年代开头，
+//      新地址写进标记字（转发）；带哈希或锁状态的标记字先另存起来；
+//   3. 把根和存活对象里的引用改成新地址；
+//   4. 按地址顺序把对象滑动到新地址，重建块偏移表。
+// 因为老年代在最低地址、新地址总不高于旧地址，按地址顺序搬动不会覆盖还没搬的对象。
+// 第2~4步按地址顺序串行进行。结束后年轻代为空，卡表全部清除
+class MarkCompactCollector {
+public:
+    MarkCompactCollector(Generations& generations, WorkGang& gang)
+        : _g(generations), _gang(gang), _queues(gang.size()) {}
+
+    // roots的约定见YoungCollector::collect。
+    // 存活对象超过老年代容量（或无法提交）时不做压缩，清除标记后返回false（调用者抛OutOfMemoryError）
+    template <typename Roots>
+    bool collect(Roots&& roots) {
+        // 1. 并行标记。live_bytes按最坏情况计入数组的对齐空隙
+        std::atomic<size_t> next_root{0};
+        std::atomic<size_t> total_live{0};
+        TaskTerminator terminator(_gang.size());
+        _gang.run([&](size_t id) {
+            TaskQueue<rtda::Object*>& queue = _queues.queue(id);
+            uint32_t seed = static_cast<uint32_t>(id) * 2654435761u + 1;
+            size_t live = 0;
+            auto mark = [this, &queue](rtda::Object** p_ref) {
+                rtda::Object* p_object = *p_ref;
+                if (p_object != nullptr && _g.contains(p_object) && p_object->tryMark()) {
+                    queue.push(p_object);
+                }
+            };
+            try {
+                roots(next_root, mark);
+                rtda::Object* p_object;
+                do {
+                    while (queue.pop(p_object) || _queues.steal(id, seed, p_object)) {
+                        live += rtda::object_size(p_object);
+                        if (p_object->getClass()->isArray()) {
+                            live += rtda::ArrayObject::ALIGNMENT - sizeof(uint64_t);
+                        }
+                        for_each_reference(p_object, mark);
+                    }
+                } while (!terminator.offerTermination(_queues));
+            } catch (...) {
+                terminator.abort();
+                throw;
+            }
+            total_live.fetch_add(live, std::memory_order_relaxed);
+        });
+        size_t live_bytes = total_live.load(std::memory_order_relaxed);
+        if (live_bytes > _g.old.capacity() || !_g.old.expandTo(_g.old.bottom() + live_bytes)) {
+            _g.forEachObject([](rtda::Object* p_object) { p_object->clearMark(); });
+            return false;
+        }
+
+        // 2. 计算新地址。压缩后老年代是连续的，空闲块和混合回收的候选区域都作废
+        _g.free_list.clear();
+        _g.regions.clearCandidates();
+        _preserved.clear();
+        char* dest = _g.old.bottom();
+        size_t young_live = 0;
+        _g.forEachObject([&](rtda::Object* p_object) {
+            if (!p_object->isMarked()) return;
+            if (!_g.old.contains(p_object)) young_live += rtda::object_size(p_object);
+            char* p_new = align_for(dest, p_object);
+            dest = p_new + rtda::object_size(p_object);
+            uint64_t mark = p_object->markWord().load(std::memory_order_relaxed) &
+                            ~(rtda::markword::MARK_BIT | rtda::markword::AGE_MASK);
+            if (mark != rtda::markword::UNLOCKED) {
+                _preserved.emplace_back(reinterpret_cast<rtda::Object*>(p_new), mark);
+            }
+            p_object->forwardTo(reinterpret_cast<rtda::Object*>(p_new));
+        });
+        // 3. 更新引用
+        auto adjust = [this](rtda::Object** p_ref) {
+            rtda::Object* p_object = *p_ref;
+            if (p_object != nullptr && _g.contains(p_object)) {
+                *p_ref = p_object->forwardee();
+            }
+        };
+        std::atomic<size_t> next_adjust{0};
+        roots(next_adjust, adjust);
+        _g.forEachObject([&](rtda::Object* p_object) {
+            if (p_object->isForwarded()) {
+                for_each_reference(p_object, adjust);
+            }
+        });
+
+        // 4. 滑动
+        char* prev_end = _g.old.bottom();
+        _g.forEachObject([&](rtda::Object* p_object) {
+            if (!p_object->isForwarded()) return;
+            char* p_new = reinterpret_cast<char*>(p_object->forwardee());
+            size_t size = rtda::object_size(p_object);
+            for (char* gap = prev_end; gap < p_new; gap += sizeof(uint64_t)) {
+                *reinterpret_cast<uint64_t*>(gap) = rtda::markword::FILLER_WORD;
+            }
+            std::memmove(p_new, p_object, size);
+            reinterpret_cast<rtda::Object*>(p_new)->markWord().store(rtda::markword::UNLOCKED, std::memory_order_relaxed);
+            _g.offsets.record(prev_end, p_new + size);
+            prev_end = p_new + size;
+        });
+        for (const auto& [p_object, mark] : _preserved) {
+            p_object->markWord().store(mark, std::memory_order_relaxed);
+        }
+        _preserved.clear();
+
+        _g.old.setTop(prev_end);
+        _g.eden.reset();
+        _g.from().reset();
+        _g.to().reset();
+        _g.cards.clearAll();
+        _live_bytes = static_cast<size_t>(prev_end - _g.old.bottom());
+        _young_live_bytes = young_live;
+        return true;
+    }
+
+    size_t liveBytes() const { return _live_bytes; }
+    // 其中原来在年轻代的字节：它们都进了老年代，相当于一次全部晋升
+    size_t youngLiveBytes() const { return _young_live_bytes; }
+
+private:
+    static char* align_for(char* p, const rtda::Object* p_object) {
+        if (!p_object->getClass()->isArray()) return p;
+        uintptr_t alignment = rtda::ArrayObject::ALIGNMENT;
+        return reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(p) + alignment - 1) & ~(alignment - 1));
+    }
+
+    Generations& _g;
+    WorkGang& _gang;
+    TaskQueueSet<rtda::Object*> _queues;
+    std::vector<std::pair<rtda::Object*, uint64_t>> _preserved;    // 新地址 -> 需要恢复的标记字
+    size_t _live_bytes = 0;
+    size_t _young_live_bytes = 0;
+};
+
+} // namespace gc
+} // namespace jvm
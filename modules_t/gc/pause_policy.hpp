@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "card_table.hpp"
+#include "heap_region.hpp"
+
+namespace jvm {
+namespace gc {
+
+// 停顿时间目标（-XX:MaxGCPauseMillis）：按最近几次回收的实际停顿估计复制和扫描的速度，
+// 决定每次混合回收带上多少个候选区域。
+// 停顿按线性模型预测：纳秒 = 速度 × 工作量，工作量是要复制的字节加上要扫描的记忆集卡（每张按CARD_SIZE字节算）；
+// 速度和年轻代的存活字节都取衰减平均，新样本占DECAY。
+// 晋升的字节也取衰减平均，加上几倍的平均偏差作为下次回收的晋升预测（见predictPromotedBytes）。
+// 每次至少带上候选总数的1/MIXED_GC_COUNT_TARGET（保证候选区域在几次回收内处理完），
+// 之后按效率顺序一直加到预测的停顿超过目标，或者老年代放不下要复制的对象为止
+class PausePolicy {
+public:
+    static constexpr uint64_t DEFAULT_MAX_PAUSE_MILLIS = 200;
+    static constexpr size_t MIXED_GC_COUNT_TARGET = 8;
+    static constexpr double DECAY = 0.3;
+    // 还没有样本时假定每纳秒复制1字节
+    static constexpr double INITIAL_NANOS_PER_BYTE = 1.0;
+    // 预测晋升时在平均值上加这么多倍的平均偏差
+    static constexpr double PROMOTION_PADDING = 3.0;
+
+    explicit PausePolicy(uint64_t max_pause_millis)
+        : _target_nanos(max_pause_millis * 1000000) {}
+
+    uint64_t targetNanos() const { return _target_nanos; }
+
+    // 一次年轻代（或混合）回收的停顿：young_bytes是年轻代复制和晋升的字节，
+    // old_bytes是从老年代区域复制出去的字节，cards是扫描的记忆集卡数
+    void recordCollection(uint64_t nanos, size_t young_bytes, size_t old_bytes, size_t cards) {
+        double work = static_cast<double>(young_bytes + old_bytes + cards * CardTable::CARD_SIZE);
+        if (work > 0) {
+            double rate = static_cast<double>(nanos) / work;
+            _nanos_per_byte = _samples == 0 ? rate : decay(_nanos_per_byte, rate);
+            _young_bytes = _samples == 0 ? young_bytes : decay(_young_bytes, young_bytes);
+            _samples++;
+        }
+    }
+
+    // 一次年轻代（或混合）回收晋升到老年代的字节；代替它的整堆回收按年轻代里的存活字节算
+    void recordPromotion(size_t promoted_bytes) {
+        double bytes = static_cast<double>(promoted_bytes);
+        _promoted_deviation = _promotion_samples == 0 ? 0 : decay(_promoted_deviation, std::abs(bytes - _promoted_bytes));
+        _promoted_bytes = _promotion_samples == 0 ? bytes : decay(_promoted_bytes, bytes);
+        _promotion_samples++;
+    }
+
+    // 年轻代用了young_used字节时，下一次回收预计晋升的字节，不超过young_used。还没有样本时按全部晋升算
+    size_t predictPromotedBytes(size_t young_used) const {
+        if (_promotion_samples == 0) return young_used;
+        double padded = _promoted_bytes + PROMOTION_PADDING * _promoted_deviation;
+        return std::min(young_used, static_cast<size_t>(padded));
+    }
+
+    uint64_t predictYoungNanos() const { return static_cast<uint64_t>(_nanos_per_byte * _young_bytes); }
+
+    uint64_t predictRegionNanos(const HeapRegion& r) const {
+        double work = static_cast<double>(r.live_bytes.load(std::memory_order_relaxed) +
+                                          r.remembered_set.size() * CardTable::CARD_SIZE);
+        return static_cast<uint64_t>(_nanos_per_byte * work);
+    }
+
+    // 年轻代回收前（安全点内）：选出这次要带上的候选区域，按效率顺序放进cset，返回预测的停顿。
+    // old_free是老年代里能用来复制候选区域的字节（一般是晋升预留之外的部分），
+    // reserve_for(存活字节)给出复制一个区域要预留多少（Heap传入YoungCollector::copyReserve）
+    template <typename ReserveFor>
+    uint64_t chooseCollectionSet(const HeapRegionTable& regions, size_t old_free, ReserveFor&& reserve_for,
+                                 std::vector<HeapRegion*>& cset) const {
+        size_t min_regions = (regions.publishedCount() + MIXED_GC_COUNT_TARGET - 1) / MIXED_GC_COUNT_TARGET;
+        uint64_t predicted = predictYoungNanos();
+        for (HeapRegion* p_region : regions.candidates()) {
+            uint64_t region_nanos = predictRegionNanos(*p_region);
+            if (cset.size() >= min_regions && predicted + region_nanos > _target_nanos) break;
+            size_t reserve = reserve_for(p_region->live_bytes.load(std::memory_order_relaxed));
+            if (reserve > old_free) break;
+            old_free -= reserve;
+            predicted += region_nanos;
+            cset.push_back(p_region);
+        }
+        return predicted;
+    }
+
+private:
+    static double decay(double average, double sample) { return average * (1 - DECAY) + sample * DECAY; }
+
+    const uint64_t _target_nanos;
+    double _nanos_per_byte = INITIAL_NANOS_PER_BYTE;
+    double _young_bytes = 0;
+    uint64_t _samples = 0;
+    double _promoted_bytes = 0;
+    double _promoted_deviation = 0;
+    uint64_t _promotion_samples = 0;
+};
+
+} // namespace gc
+} // namespace jvm
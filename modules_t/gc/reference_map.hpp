@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#include "../log.hpp"
+#include "../classfile/member_info.h"
+#include "../rtda/frame.hpp"
+
+namespace jvm {
+namespace gc {
+
+// 解释器栈帧的引用位图：方法执行到pc处的指令之前，哪些局部变量和操作数栈槽位存放引用。
+// 槽位本身不带类型（见rtda/slot.hpp），类型由字节码决定：类链接时（rtda::Class::link）
+// 验证器（classloader::Verifier）验证每个方法的同时记下GC点的类型状态，存进方法的Code属性。
+// GC点是GC可能发生时栈帧可能停在的指令：
+//   - 方法入口（pc 0）
+//   - 可能抛出异常的指令：调用、分配（new/newarray/anewarray/multianewarray）、ldc、返回，
+//     以及隐式异常（空指针、数组越界、除零、类型转换等）要分配异常对象的指令
+//   - 回边（目标不在后面的跳转），解释器在这里轮询安全点（Safepoint::poll），轮询时pc仍是跳转指令
+//   - jsr：不会停下，子程序里的GC点要借它的位图。jsr压入的返回地址在槽位里是int形式的返回pc
+// 其他指令不分配也不轮询，执行期间不会有GC，不需要位图。
+// 验证失败的类不能链接，它的方法不会执行，所以GC扫描时不用加锁，也不会缺位图
+
+// 子程序里待定的局部变量index（见classfile::ReferenceMaps）：返回地址槽位里是int形式的返回pc，
+// 按它找到调用子程序的jsr处的位图，那里还是待定就接着往外层找
+inline bool deferred_reference(rtda::Frame& frame, const classfile::ReferenceMaps& maps,
+                               classfile::ReferenceMaps::Map map, size_t index) {
+    rtda::LocalVars& locals = frame.getLoaclVars();
+    rtda::OperandStack& stack = frame.getOperandStack();
+    for (;;) {
+        uint32_t slot = map.returnAddressSlot();
+        int32_t return_pc = slot < map.localCount() ? locals.slots()[slot].getNum()
+                                                    : stack.slots()[slot - map.localCount()].getNum();
+        uint32_t jsr_pc;
+        if (return_pc < 0 || !maps.findCall(static_cast<uint32_t>(return_pc), jsr_pc) || !maps.find(jsr_pc, map)) {
+            LOG(FATAL, "GC: bad subroutine return address %d in %s%s at pc %u", return_pc,
+                frame.getMethod()->name().c_str(), frame.getMethod()->descriptor().c_str(), frame.getPC());
+            std::abort();
+        }
+        if (map.local(index)) return true;
+        if (!map.deferred(index)) return false;
+    }
+}
+
+// 访问栈帧中存放引用的槽位（Object**）。操作数栈只看实际深度以内的部分：
+// 调用时参数已经弹出、成为被调帧的局部变量，分配指令的操作数也先弹出再分配
+template <typename F>
+void for_each_frame_reference(rtda::Frame& frame, F&& fn) {
+    const classfile::MemberInfo* p_method = frame.getMethod();
+    if (p_method == nullptr || frame.getClass() == nullptr) return;
+    const classfile::CodeAttribute* p_code = p_method->code_attribute();
+    if (p_code == nullptr) return;  // native方法的引用都在本地句柄里
+    const classfile::ReferenceMaps* p_maps = p_code->getReferenceMaps();
+    classfile::ReferenceMaps::Map map;
+    if (p_maps == nullptr || !p_maps->find(frame.getPC(), map)) {
+        // 类没有链接，或者帧停在了GC点以外的地方：帧里哪些槽位是引用无从得知，
+        // 跳过会让它们引用的对象被回收或移走，只能终止
+        LOG(FATAL, "GC: no reference map for %s%s at pc %u", p_method->name().c_str(),
+            p_method->descriptor().c_str(), frame.getPC());
+        std::abort();
+    }
+
+    rtda::LocalVars& locals = frame.getLoaclVars();
+    size_t local_count = std::min<size_t>(map.localCount(), locals.maxLocals());
+    for (size_t i = 0; i < local_count; i++) {
+        if (map.local(i) || (map.deferred(i) && deferred_reference(frame, *p_maps, map, i))) {
+            fn(locals.slots()[i].refAddress());
+        }
+    }
+    rtda::OperandStack& stack = frame.getOperandStack();
+    size_t depth = std::min<size_t>(map.stackDepth(), stack.size());
+    for (size_t i = 0; i < depth; i++) {
+        if (map.stack(i)) fn(stack.slots()[i].refAddress());
+    }
+}
+
+} // namespace gc
+} // namespace jvm
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "../rtda/object.hpp"
+#include "../rtda/array_object.hpp"
+#include "../rtda/class.hpp"
+
+namespace jvm {
+namespace gc {
+
+// 依次访问对象的每个引用字段（Object**）：普通对象按类的引用区间，引用数组按元素
+template <typename F>
+void for_each_reference(rtda::Object* p_object, F&& fn) {
+    const rtda::Class* p_class = p_object->getClass();
+    if (p_class->isArray()) {
+        if (p_class->elementType() != rtda::ArrayType::REFERENCE) return;
+        rtda::ArrayObject* p_array = static_cast<rtda::ArrayObject*>(p_object);
+        rtda::Object** p_elements = p_array->elements<rtda::Object*>();
+        for (int32_t i = 0, n = p_array->length(); i < n; i++) {
+            fn(&p_elements[i]);
+        }
+        return;
+    }
+    for (const rtda::ReferenceRange& range : p_class->referenceRanges()) {
+        rtda::Object** p_refs = p_object->refFieldAddress(range.offset);
+        for (uint32_t i = 0; i < range.count; i++) {
+            fn(&p_refs[i]);
+        }
+    }
+}
+
+// 只访问地址落在[lo, hi)内的引用字段，扫描脏卡时用，大数组只看卡内的那一段
+template <typename F>
+void for_each_reference_in(rtda::Object* p_object, const char* lo, const char* hi, F&& fn) {
+    auto visit_range = [&](rtda::Object** p_first, rtda::Object** p_last) {
+        rtda::Object** p_begin = std::max(p_first, reinterpret_cast<rtda::Object**>(const_cast<char*>(lo)));
+        rtda::Object** p_end = std::min(p_last, reinterpret_cast<rtda::Object**>(const_cast<char*>(hi)));
+        for (rtda::Object** p = p_begin; p < p_end; p++) {
+            fn(p);
+        }
+    };
+    const rtda::Class* p_class = p_object->getClass();
+    if (p_class->isArray()) {
+        if (p_class->elementType() != rtda::ArrayType::REFERENCE) return;
+        rtda::ArrayObject* p_array = static_cast<rtda::ArrayObject*>(p_object);
+        rtda::Object** p_elements = p_array->elements<rtda::Object*>();
+        visit_range(p_elements, p_elements + p_array->length());
+        return;
+    }
+    for (const rtda::ReferenceRange& range : p_class->referenceRanges()) {
+        rtda::Object** p_refs = p_object->refFieldAddress(range.offset);
+        visit_range(p_refs, p_refs + range.count);
+    }
+}
+
+} // namespace gc
+} // namespace jvm
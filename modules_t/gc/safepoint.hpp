@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace jvm {
+namespace rtda {
+class Thread;
+}
+
+namespace gc {
+
+// 安全点：GC需要所有Java线程都停在已知状态（栈帧的pc和操作数栈已写回、TLAB不再使用）。
+// Java线程构造时登记、析构时注销；发起GC的线程请求安全点后等到其他线程都停下，
+// 其他线程在poll()（分配慢速路径、解释器的回边和调用）里看到请求就停下等待。
+// 可能长时间阻塞的线程（等锁、I/O、join）用Blocked标明自己不会访问堆，GC不必等它。
+// 并发标记线程也按同样的规则参与安全点。没有登记的线程（比如直接调用Heap::collect()的宿主线程）
+// 也可以发起GC，这时要等所有登记的线程都停下。登记按线程记录，Thread必须在构造它的线程里析构
+class Safepoint {
+public:
+    static void attach(rtda::Thread* p_thread) {
+        State& s = state();
+        std::unique_lock<std::mutex> lock(s.mutex);
+        s.resumed.wait(lock, [&s] { return !s.requested; });
+        s.threads.push_back(p_thread);
+        s.running++;
+        running_here()++;
+    }
+
+    static void detach(rtda::Thread* p_thread) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.threads.erase(std::remove(s.threads.begin(), s.threads.end(), p_thread), s.threads.end());
+        s.running--;
+        running_here()--;
+        s.stopped.notify_all();
+    }
+
+    // 并发GC线程（不是Java线程，没有栈帧，不提供根）也要在安全点停下：计入running，
+    // 工作时定期poll()，空闲等待时用Blocked。它同样可以begin()发起停顿
+    static void attachConcurrentThread() {
+        State& s = state();
+        std::unique_lock<std::mutex> lock(s.mutex);
+        s.resumed.wait(lock, [&s] { return !s.requested; });
+        s.running++;
+        running_here()++;
+    }
+
+    static void detachConcurrentThread() {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.running--;
+        running_here()--;
+        s.stopped.notify_all();
+    }
+
+    static bool requested() { return state().requested_flag.load(std::memory_order_acquire); }
+
+    static void poll() {
+        if (requested()) {
+            park();
+        }
+    }
+
+    // 发起GC：成功时返回true，此时其他线程都已停下，调用者完成GC后必须调用end()。
+    // 已经有别的线程在发起时本线程直接停下，等那次GC结束后返回false
+    static bool begin() {
+        State& s = state();
+        std::unique_lock<std::mutex> lock(s.mutex);
+        if (s.requested) {
+            wait_for_end(s, lock);
+            return false;
+        }
+        s.requested = true;
+        s.requested_flag.store(true, std::memory_order_release);
+        // 只剩发起者自己还计入running（没有登记时是0）
+        int self = running_here();
+        s.stopped.wait(lock, [&s, self] { return s.running <= self; });
+        return true;
+    }
+
+    static void end() {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.requested = false;
+        s.requested_flag.store(false, std::memory_order_release);
+        s.resumed.notify_all();
+    }
+
+    // 安全点内（begin()和end()之间）访问所有Java线程
+    template <typename F>
+    static void forEachThread(F&& fn) {
+        for (rtda::Thread* p_thread : state().threads) {
+            fn(*p_thread);
+        }
+    }
+
+    // 作用域内本线程不访问堆，视为已到达安全点
+    class Blocked {
+    public:
+        Blocked() {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            _count = running_here();
+            s.running -= _count;
+            running_here() = 0;
+            s.stopped.notify_all();
+        }
+        ~Blocked() {
+            State& s = state();
+            std::unique_lock<std::mutex> lock(s.mutex);
+            s.resumed.wait(lock, [&s] { return !s.requested; });
+            s.running += _count;
+            running_here() = _count;
+        }
+        Blocked(const Blocked&) = delete;
+        Blocked& operator=(const Blocked&) = delete;
+
+    private:
+        int _count;
+    };
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::condition_variable stopped;    // 有线程停下或注销，发起者重新检查
+        std::condition_variable resumed;    // GC结束
+        std::vector<rtda::Thread*> threads;
+        int running = 0;                    // 已登记且没有停下的线程数
+        bool requested = false;
+        std::atomic<bool> requested_flag{false};    // poll()不加锁读取
+    };
+
+    static State& state() {
+        static State s;
+        return s;
+    }
+
+    // 本线程计入running的次数：登记过（Java线程或并发GC线程）且没有停下时为1，没有登记时为0
+    static int& running_here() {
+        static thread_local int count = 0;
+        return count;
+    }
+
+    static void park() {
+        State& s = state();
+        std::unique_lock<std::mutex> lock(s.mutex);
+        if (s.requested) {
+            wait_for_end(s, lock);
+        }
+    }
+
+    static void wait_for_end(State& s, std::unique_lock<std::mutex>& lock) {
+        int self = running_here();
+        s.running -= self;
+        running_here() = 0;
+        s.stopped.notify_all();
+        s.resumed.wait(lock, [&s] { return !s.requested; });
+        s.running += self;
+        running_here() = self;
+    }
+};
+
+} // namespace gc
+} // namespace jvm
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace jvm {
+namespace rtda {
+class Object;
+}
+
+namespace gc {
+
+// SATB（snapshot-at-the-beginning）日志：并发标记期间，引用字段被覆盖前写前屏障把原来的引用记下来。
+// 标记开始那一刻可达的对象，要么被标记线程沿引用找到，要么在引用被改掉时进了日志，不会漏标。
+// 每个线程记在自己的缓冲区里（thread_local，不加锁），满BUFFER_SIZE个交到全局的已满列表，
+// 标记线程并发取走处理；重新标记（remark）时在安全点里把各线程没满的缓冲区也收上来
+class SatbMarkQueueSet {
+public:
+    static constexpr size_t BUFFER_SIZE = 256;
+    using Buffer = std::vector<rtda::Object*>;
+
+    // 写前屏障只在标记期间记录，开关只在安全点内切换
+    static bool isActive() { return s_active.load(std::memory_order_relaxed); }
+    static void setActive(bool active) { s_active.store(active, std::memory_order_relaxed); }
+
+    static void enqueue(rtda::Object* p_object) {
+        ThreadQueue& queue = local();
+        queue.buffer.push_back(p_object);
+        if (queue.buffer.size() >= BUFFER_SIZE) {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.completed.push_back(std::move(queue.buffer));
+            queue.buffer = Buffer();
+            queue.buffer.reserve(BUFFER_SIZE);
+        }
+    }
+
+    // 标记线程取走一个已满的缓冲区，没有时返回false
+    static bool claimCompleted(Buffer& out) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.completed.empty()) return false;
+        out = std::move(s.completed.back());
+        s.completed.pop_back();
+        return true;
+    }
+
+    // 安全点内：各线程没满的缓冲区也交到已满列表
+    static void flushAll() {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (ThreadQueue* p_queue : s.queues) {
+            if (!p_queue->buffer.empty()) {
+                s.completed.push_back(std::move(p_queue->buffer));
+                p_queue->buffer = Buffer();
+            }
+        }
+    }
+
+    // 安全点内：丢掉所有记录（标记中止时）
+    static void abandon() {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.completed.clear();
+        for (ThreadQueue* p_queue : s.queues) {
+            p_queue->buffer.clear();
+        }
+    }
+
+private:
+    // 线程第一次记录时登记，线程结束时把剩下的记录交出去
+    struct ThreadQueue {
+        Buffer buffer;
+
+        ThreadQueue() {
+            buffer.reserve(BUFFER_SIZE);
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.queues.push_back(this);
+        }
+        ~ThreadQueue() {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.queues.erase(std::remove(s.queues.begin(), s.queues.end(), this), s.queues.end());
+            if (!buffer.empty() && isActive()) {
+                s.completed.push_back(std::move(buffer));
+            }
+        }
+    };
+
+    struct State {
+        std::mutex mutex;
+        std::vector<Buffer> completed;
+        std::vector<ThreadQueue*> queues;
+    };
+
+    static State& state() {
+        static State s;
+        return s;
+    }
+
+    static ThreadQueue& local() {
+        thread_local ThreadQueue queue;
+        return queue;
+    }
+
+    static inline std::atomic<bool> s_active{false};
+};
+
+// 引用写入前的屏障：field是将被覆盖的引用字段（或数组元素）
+inline void pre_write_barrier(rtda::Object* const* field) {
+    if (__builtin_expect(SatbMarkQueueSet::isActive(), 0)) {
+        rtda::Object* p_prev = __atomic_load_n(field, __ATOMIC_RELAXED);
+        if (p_prev != nullptr) {
+            SatbMarkQueueSet::enqueue(p_prev);
+        }
+    }
+}
+
+// 一段连续引用（arraycopy的目标区间）被覆盖前的屏障
+inline void pre_write_barrier_range(rtda::Object* const* start, size_t count) {
+    if (__builtin_expect(SatbMarkQueueSet::isActive(), 0)) {
+        for (size_t i = 0; i < count; i++) {
+            rtda::Object* p_prev = __atomic_load_n(start + i, __ATOMIC_RELAXED);
+            if (p_prev != nullptr) {
+                SatbMarkQueueSet::enqueue(p_prev);
+            }
+        }
+    }
+}
+
+} // namespace gc
+} // namespace jvm
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include <sys/mman.h>
+
+#include "../rtda/object.hpp"
+#include "../rtda/array_object.hpp"
+
+namespace jvm {
+namespace gc {
+
+// 一段连续的堆空间：[bottom, top)已分配，[top, end)已提交可用，[end, limit)只保留了地址。
+// 分配用CAS推进top，多个线程可以同时分配；只有提交新内存（mprotect）时加锁。
+// 空间内的对象和填充首尾相接，可以从bottom逐个遍历到top
+class ContiguousSpace {
+public:
+    ContiguousSpace() = default;
+    ContiguousSpace(const ContiguousSpace&) = delete;
+    ContiguousSpace& operator=(const ContiguousSpace&) = delete;
+
+    // [bottom, limit)是保留区，其中前committed字节先提交
+    bool initialize(char* bottom, char* limit, size_t committed, size_t page_size) {
+        _bottom = bottom;
+        _limit = limit;
+        _page_size = page_size;
+        _top.store(bottom, std::memory_order_relaxed);
+        _end.store(bottom, std::memory_order_relaxed);
+        return committed == 0 || commit(bottom + committed);
+    }
+
+    char* bottom() const { return _bottom; }
+    char* top() const { return _top.load(std::memory_order_relaxed); }
+    char* end() const { return _end.load(std::memory_order_relaxed); }
+    char* limit() const { return _limit; }
+
+    bool contains(const void* p) const { return p >= _bottom && p < _limit; }
+    size_t used() const { return static_cast<size_t>(top() - _bottom); }
+    size_t committed() const { return static_cast<size_t>(end() - _bottom); }
+    size_t capacity() const { return static_cast<size_t>(_limit - _bottom); }
+    // 算上还能提交的部分一共还能分配多少
+    size_t reservedFree() const { return static_cast<size_t>(_limit - top()); }
+
+    // 无锁分配size字节（8的倍数），超出保留区时返回nullptr
+    char* allocate(size_t size) {
+        char* top = _top.load(std::memory_order_relaxed);
+        for (;;) {
+            if (size > static_cast<size_t>(_limit - top)) {
+                return nullptr;
+            }
+            char* new_top = top + size;
+            if (new_top > _end.load(std::memory_order_acquire) && !commit(new_top)) {
+                return nullptr;
+            }
+            if (_top.compare_exchange_weak(top, new_top, std::memory_order_relaxed)) {
+                return top;
+            }
+        }
+    }
+
+    // 按alignment对齐分配，对齐空隙写填充字；*p_block得到含空隙的块起点（记录块偏移表用）
+    char* allocateAligned(size_t size, size_t alignment, char** p_block) {
+        char* top = _top.load(std::memory_order_relaxed);
+        for (;;) {
+            char* p = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(top) + alignment - 1) & ~(alignment - 1));
+            if (p > _limit || size > static_cast<size_t>(_limit - p)) {
+                return nullptr;
+            }
+            char* new_top = p + size;
+            if (new_top > _end.load(std::memory_order_acquire) && !commit(new_top)) {
+                return nullptr;
+            }
+            if (_top.compare_exchange_weak(top, new_top, std::memory_order_relaxed)) {
+                for (char* gap = top; gap < p; gap += sizeof(uint64_t)) {
+                    *reinterpret_cast<uint64_t*>(gap) = rtda::markword::FILLER_WORD;
+                }
+                *p_block = top;
+                return p;
+            }
+        }
+    }
+
+    // 确保[bottom, needed)已提交，压缩前使用
+    bool expandTo(char* needed) {
+        return needed <= _limit && (needed <= end() || commit(needed));
+    }
+
+    // 回收后重置：整个空间变空，或者压缩后把top设在最后一个存活对象之后
+    void reset() { _top.store(_bottom, std::memory_order_relaxed); }
+    void setTop(char* top) { _top.store(top, std::memory_order_relaxed); }
+
+    // 按地址顺序访问[from, to)内的对象，跳过填充字；期间不能有线程在这段里分配
+    template <typename F>
+    static void forEachObject(char* from, char* to, F&& fn) {
+        for (char* p = from; p < to;) {
+            if (*reinterpret_cast<const uint64_t*>(p) == rtda::markword::FILLER_WORD) {
+                p += sizeof(uint64_t);
+                continue;
+            }
+            rtda::Object* p_object = reinterpret_cast<rtda::Object*>(p);
+            p += rtda::object_size(p_object);
+            fn(p_object);
+        }
+    }
+
+    template <typename F>
+    void forEachObject(F&& fn) const {
+        forEachObject(_bottom, top(), std::forward<F>(fn));
+    }
+
+private:
+    // 把已提交区扩展到至少needed：每次至少翻倍，不超过保留区
+    bool commit(char* needed) {
+        std::lock_guard<std::mutex> lock(_commit_mutex);
+        char* end = _end.load(std::memory_order_relaxed);
+        if (needed <= end) {
+            return true;
+        }
+        size_t capacity = static_cast<size_t>(_limit - _bottom);
+        size_t target = static_cast<size_t>(needed - _bottom);
+        target = (target + _page_size - 1) & ~(_page_size - 1);
+        target = std::min(std::max(target, 2 * static_cast<size_t>(end - _bottom)), capacity);
+        if (_bottom + target < needed ||
+            mprotect(end, static_cast<size_t>(_bottom + target - end), PROT_READ | PROT_WRITE) != 0) {
+            return false;
+        }
+        _end.store(_bottom + target, std::memory_order_release);
+        return true;
+    }
+
+    char* _bottom = nullptr;
+    char* _limit = nullptr;
+    size_t _page_size = 4096;
+    std::atomic<char*> _top{nullptr};
+    std::atomic<char*> _end{nullptr};
+    std::mutex _commit_mutex;
+};
+
+} // namespace gc
+} // namespace jvm
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace jvm {
+namespace gc {
+
+// GC工作线程的任务队列（Chase-Lev工作窃取双端队列）：
+// 所属线程在底部push/pop（LIFO，深度优先，刚复制的对象还在缓存里），其他线程从顶部steal。
+// 所属线程的push/pop在没有竞争时不需要原子读改写，只有取最后一个元素时才与窃取者CAS。
+// 数组大小固定，满了之后溢出到只有所属线程访问的栈里，不会丢任务
+template <typename E>
+class TaskQueue {
+public:
+    static constexpr size_t CAPACITY = size_t(1) << 14;
+
+    TaskQueue() : _p_elements(new std::atomic<E>[CAPACITY]) {}
+
+    TaskQueue(const TaskQueue&) = delete;
+    TaskQueue& operator=(const TaskQueue&) = delete;
+
+    // 以下三个只能由所属线程调用
+    void push(E e) {
+        int64_t b = _bottom.load(std::memory_order_relaxed);
+        int64_t t = _top.load(std::memory_order_acquire);
+        if (b - t >= static_cast<int64_t>(CAPACITY)) {
+            _overflow.push_back(e);
+            return;
+        }
+        _p_elements[b & (CAPACITY - 1)].store(e, std::memory_order_relaxed);
+        // release：窃取者看到新的bottom时，也能看到元素以及压栈前对它指向的对象的写入
+        _bottom.store(b + 1, std::memory_order_release);
+    }
+
+    bool pop(E& e) {
+        if (!_overflow.empty()) {
+            e = _overflow.back();
+            _overflow.pop_back();
+            return true;
+        }
+        int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+        _bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = _top.load(std::memory_order_relaxed);
+        if (t > b) {
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        e = _p_elements[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (t == b) {
+            // 最后一个元素，与窃取者竞争
+            bool won = _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    bool isEmpty() const { return _overflow.empty() && size() == 0; }
+
+    // 其他线程调用
+    bool steal(E& e) {
+        int64_t t = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = _bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        e = _p_elements[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        return _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    // 可窃取部分的近似大小，终止检测用
+    size_t size() const {
+        int64_t n = _bottom.load(std::memory_order_relaxed) - _top.load(std::memory_order_relaxed);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> _top{0};
+    alignas(64) std::atomic<int64_t> _bottom{0};
+    std::unique_ptr<std::atomic<E>[]> _p_elements;
+    std::vector<E> _overflow;
+};
+
+// 一组工作线程的队列：自己的队列空了就随机挑别人的偷
+template <typename E>
+class TaskQueueSet {
+public:
+    explicit TaskQueueSet(size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            _queues.push_back(std::make_unique<TaskQueue<E>>());
+        }
+    }
+
+    size_t size() const { return _queues.size(); }
+    TaskQueue<E>& queue(size_t worker) { return *_queues[worker]; }
+
+    // 随机挑2*size()次受害者，偷到一个就返回
+    bool steal(size_t worker, uint32_t& seed, E& e) {
+        size_t n = _queues.size();
+        if (n <= 1) return false;
+        for (size_t attempt = 0; attempt < 2 * n; attempt++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            size_t victim = seed % n;
+            if (victim != worker && _queues[victim]->steal(e)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool peekAny() const {
+        for (const auto& p_queue : _queues) {
+            if (p_queue->size() > 0) return true;
+        }
+        return false;
+    }
+
+private:
+    std::vector<std::unique_ptr<TaskQueue<E>>> _queues;
+};
+
+// 终止检测：自己的队列和窃取都落空的线程在这里报到。
+// 全部线程都报到时说明没有任何任务了，所有线程一起结束；
+// 等待期间发现还有队列不空就退出报到，回去继续偷。abort()让所有线程立即结束（出错时用）
+class TaskTerminator {
+public:
+    explicit TaskTerminator(size_t worker_count) : _worker_count(worker_count) {}
+
+    template <typename QueueSet>
+    bool offerTermination(const QueueSet& queues) {
+        if (_offered.fetch_add(1, std::memory_order_acq_rel) + 1 == _worker_count) {
+            return true;
+        }
+        for (uint32_t spin = 0;; spin++) {
+            if (_offered.load(std::memory_order_acquire) == _worker_count ||
+                _aborted.load(std::memory_order_relaxed)) {
+                return true;
+            }
+            if (queues.peekAny()) {
+                // 可能有线程在这之前已经看到全部报到并结束；那时队列必然全空，
+                // peekAny()只会是过时的读，撤回后再报到一次就又满了
+                _offered.fetch_sub(1, std::memory_order_acq_rel);
+                return false;
+            }
+            if (spin < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    }
+
+    void abort() { _aborted.store(true, std::memory_order_relaxed); }
+    bool aborted() const { return _aborted.load(std::memory_order_relaxed); }
+
+private:
+    const size_t _worker_count;
+    std::atomic<size_t> _offered{0};
+    std::atomic<bool> _aborted{false};
+};
+
+} // namespace gc
+} // namespace jvm
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+#include "../thread_pool.hpp"
+
+namespace jvm {
+namespace gc {
+
+// GC工作线程组：run(fn)让每个工作线程各执行一次fn(worker_id)，全部结束后返回。
+// 各worker_id的任务同时运行、彼此等待（终止检测），所以线程池专供GC使用，线程数就是worker数；
+// 只有一个worker时直接在调用线程里执行
+class WorkGang {
+public:
+    explicit WorkGang(size_t worker_count) : _worker_count(std::max<size_t>(1, worker_count)) {
+        if (_worker_count > 1) {
+            _p_pool = std::make_unique<util::ThreadPool>(_worker_count);
+        }
+    }
+
+    size_t size() const { return _worker_count; }
+
+    // fn里抛出的异常在全部worker结束后重新抛出
+    template <typename F>
+    void run(F&& fn) {
+        if (!_p_pool) {
+            fn(size_t(0));
+            return;
+        }
+        _p_pool->parallel_for(_worker_count, 1, [&fn](size_t begin, size_t) { fn(begin); });
+    }
+
+    // -XX:ParallelGCThreads的默认值（与HotSpot相同）：8核以内每核一个，超出部分每8核加5个
+    static size_t defaultWorkerCount() {
+        size_t cpus = std::max(1u, std::thread::hardware_concurrency());
+        return cpus <= 8 ? cpus : 8 + (cpus - 8) * 5 / 8;
+    }
+
+private:
+    size_t _worker_count;
+    std::unique_ptr<util::ThreadPool> _p_pool;
+};
+
+} // namespace gc
+} // namespace jvm
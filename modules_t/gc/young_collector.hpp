@@ -0,0 +1,433 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <utility>
+
+#include "generations.hpp"
+#include "references.hpp"
+#include "task_queue.hpp"
+#include "work_gang.hpp"
+#include "../rtda/tlab.hpp"
+
+namespace jvm {
+namespace gc {
+
+// 年轻代并行复制回收：工作线程组一起从根（线程栈、静态字段）和老年代脏卡出发，
+// 把eden和from中可达的对象复制到to或晋升到老年代。
+// 每个工作线程复制一个对象后，把它里面指向回收集合的引用字段（Object**）压进自己的任务队列，
+// 深度优先处理，队列空了就去偷别人的；谁先用CAS把转发指针装进旧对象的标记字，谁的副本生效。
+// 复制目标从各线程私有的PLAB（to和老年代各一块，用Tlab实现）里分配，不用同步。
+// 老年代PLAB可能取自空闲块表、落在回收前的老年代中间，所以晋升对象所在的卡等所有线程结束后才标脏，
+// 扫描脏卡的线程不会读到正在写入的晋升对象。
+// 混合回收时回收集合里还有老年代区域（见heap_region.hpp）：其中可达的对象复制到老年代PLAB，
+// 根以外指向它们的引用从脏卡和这些区域的记忆集（别处指向它们的卡）里找，回收后整个区域放回空闲块表。
+// 扫描卡时跳过回收集合里的对象（它们被复制时会整个扫描）和已知死了、等着清扫的对象。
+// 槽位在老年代、指向候选区域的引用顺便记进记忆集（各线程先记下槽位，结束后合并）。
+// 老年代放不下要晋升的对象时（晋升失败），对象留在原地、转发指针指向自己，回收照常做完，
+// 之后撤销转发，由调用者紧接着做整堆回收（见promotionFailed()）。
+// 只访问存活对象和脏卡，停顿时间与存活对象的多少成正比，随工作线程数下降
+class YoungCollector {
+public:
+    // 熬过这么多次年轻代回收的对象晋升到老年代
+    static constexpr uint32_t TENURING_THRESHOLD = 6;
+    // PLAB大小按空间容量和线程数取，限制在这个范围内；超过PLAB四分之一的对象直接在空间里分配
+    static constexpr size_t MIN_PLAB_SIZE = size_t(4) << 10;
+    static constexpr size_t MAX_PLAB_SIZE = size_t(64) << 10;
+    // 扫描脏卡时每次领取的卡数
+    static constexpr size_t CARDS_PER_CHUNK = 128;
+
+    YoungCollector(Generations& generations, WorkGang& gang)
+        : _g(generations), _gang(gang), _queues(gang.size()), _workers(gang.size()) {}
+
+    // 把bytes字节的对象复制进老年代最多占用的空间：数组对齐空隙（数组至少32字节，空隙至多24字节）
+    static size_t copyReserve(size_t bytes) { return bytes / 4 * 7; }
+
+    // 回收前老年代要留出的空间：预计晋升的promoted_bytes字节，以及每个线程一块PLAB的尾部。
+    // 预计偏少时会晋升失败，由整堆回收兜底
+    size_t promotionReserve(size_t promoted_bytes) const {
+        return copyReserve(promoted_bytes) + _gang.size() * MAX_PLAB_SIZE;
+    }
+
+    // roots(next, visit)：各工作线程用共享的next领取根任务，对领到的每个根（Object**）调用visit。
+    // 必须在安全点内、所有TLAB交回之后调用
+    // 混合回收时回收集合里的老年代区域事先由Generations::addToCollectionSet加入
+    template <typename Roots>
+    void collect(Roots&& roots) {
+        ContiguousSpace& to = _g.to();
+        to.reset();
+        char* old_top = _g.old.top();
+        _to_plab_size = plab_size(to.capacity());
+        _old_plab_size = plab_size(_g.eden.capacity());
+        collectRememberedCards();
+
+        std::atomic<size_t> next_root{0};
+        std::atomic<size_t> next_chunk{0};
+        std::atomic<size_t> next_remembered{0};
+        TaskTerminator terminator(_gang.size());
+        _gang.run([&](size_t id) {
+            Worker& w = _workers[id];
+            w.reset(id);
+            try {
+                roots(next_root, [this, &w](rtda::Object** p_ref) { process(w, p_ref); });
+                scanCards(w, old_top, next_chunk);
+                scanRememberedCards(w, old_top, next_remembered);
+                drain(w, terminator);
+            } catch (...) {
+                terminator.abort();
+                throw;
+            }
+            w.to_plab.retire();
+            retireOldPlab(w);
+        });
+
+        _copied_bytes = 0;
+        _promoted_bytes = 0;
+        _evacuated_bytes = 0;
+        _promotion_failed = false;
+        for (Worker& w : _workers) {
+            _copied_bytes += w.copied_bytes;
+            _promoted_bytes += w.promoted_bytes;
+            _evacuated_bytes += w.evacuated_bytes;
+            _promotion_failed = _promotion_failed || w.promotion_failed;
+            for (rtda::Object** p_ref : w.deferred_cards) {
+                _g.cards.dirty(p_ref);
+            }
+            w.deferred_cards.clear();
+            for (const auto& slot : w.remembered) {
+                _g.regions.remember(slot.first, slot.second, *slot.second);
+            }
+            w.remembered.clear();
+        }
+        if (_promotion_failed) {
+            undoForwarding();
+            _freed_old_bytes = 0;
+            return;
+        }
+        _g.eden.reset();
+        _g.from().reset();
+        _g.flip();
+        _freed_old_bytes = _g.regions.hasOldCollectionSet() ? _g.freeCollectionSet() : 0;
+    }
+
+    // 这次回收晋升失败：eden、from和回收集合里的老年代区域还有留在原地的存活对象，to里是复制出去的，
+    // 这些空间都没有重置。调用者必须在同一个安全点里接着做整堆回收
+    bool promotionFailed() const { return _promotion_failed; }
+
+    size_t copiedBytes() const { return _copied_bytes; }
+    size_t promotedBytes() const { return _promoted_bytes; }
+    // 混合回收：从老年代区域复制出去的字节、扫描的记忆集卡数、回收区域放回空闲块表的字节
+    size_t evacuatedBytes() const { return _evacuated_bytes; }
+    size_t rememberedCardCount() const { return _remembered_cards.size(); }
+    size_t freedOldBytes() const { return _freed_old_bytes; }
+
+private:
+    struct Worker {
+        size_t id = 0;
+        uint32_t seed = 1;
+        rtda::Tlab to_plab;
+        rtda::Tlab old_plab;
+        bool to_full = false;
+        size_t copied_bytes = 0;
+        size_t promoted_bytes = 0;
+        size_t evacuated_bytes = 0;
+        bool promotion_failed = false;
+        std::vector<std::pair<rtda::Object*, uint64_t>> preserved;  // 晋升失败留在原地的对象和原来的标记字
+        std::vector<rtda::Object**> deferred_cards;   // 晋升对象里指向年轻代的槽位
+        std::vector<std::pair<rtda::Object*, rtda::Object**>> remembered;   // 老年代里指向候选区域的槽位和所在的对象
+
+        void reset(size_t worker_id) {
+            id = worker_id;
+            seed = static_cast<uint32_t>(worker_id) * 2654435761u + 1;
+            to_full = false;
+            copied_bytes = 0;
+            promoted_bytes = 0;
+            evacuated_bytes = 0;
+            promotion_failed = false;
+        }
+    };
+
+    static size_t plab_size(size_t capacity) {
+        size_t size = capacity / 16;
+        size &= ~(CardTable::CARD_SIZE - 1);
+        return std::min(std::max(size, MIN_PLAB_SIZE), MAX_PLAB_SIZE);
+    }
+
+    void drain(Worker& w, TaskTerminator& terminator) {
+        TaskQueue<rtda::Object**>& queue = _queues.queue(w.id);
+        rtda::Object** p_ref;
+        for (;;) {
+            while (queue.pop(p_ref) || _queues.steal(w.id, w.seed, p_ref)) {
+                process(w, p_ref, true);
+            }
+            if (terminator.offerTermination(_queues)) {
+                return;
+            }
+        }
+    }
+
+    // 老年代原有部分里的脏卡：卡上可能有指向年轻代的引用。按CARDS_PER_CHUNK张一组领取
+    void scanCards(Worker& w, char* old_top, std::atomic<size_t>& next_chunk) {
+        char* bottom = _g.old.bottom();
+        size_t chunk_bytes = CARDS_PER_CHUNK << CardTable::CARD_SHIFT;
+        for (;;) {
+            size_t chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= static_cast<size_t>(old_top - bottom + chunk_bytes - 1) / chunk_bytes) {
+                return;
+            }
+            char* lo = bottom + chunk * chunk_bytes;
+            char* hi = std::min(lo + chunk_bytes, old_top);
+            _g.cards.forEachDirtyCard(lo, hi, [&](char* card, char* card_end) {
+                scanCard(w, card, card_end, old_top, false);
+            });
+        }
+    }
+
+    // 回收集合里老年代区域的记忆集：合并去重，去掉已经是脏卡的（scanCards会扫）和整个在回收范围里的。
+    // 回收范围之前的卡上是从前一个区域跨进来的对象，不随区域复制，照样要扫
+    void collectRememberedCards() {
+        _remembered_cards.clear();
+        for (HeapRegion* p_region : _g.regions.collectionSet()) {
+            for (size_t card : p_region->remembered_set) {
+                char* card_start = _g.cards.cardStart(card);
+                HeapRegion& r = _g.regions.regionFor(card_start);
+                if (!_g.cards.isDirty(card) && !(r.in_cset && card_start >= r.span_start)) {
+                    _remembered_cards.push_back(card);
+                }
+            }
+        }
+        std::sort(_remembered_cards.begin(), _remembered_cards.end());
+        _remembered_cards.erase(std::unique(_remembered_cards.begin(), _remembered_cards.end()),
+                                _remembered_cards.end());
+    }
+
+    // 扫描记忆集里的卡，按CARDS_PER_CHUNK张一组领取。这些卡不是脏卡，
+    // 处理时重新标脏会和scanCards冲突，推迟到回收结束（deferred为true）
+    void scanRememberedCards(Worker& w, char* old_top, std::atomic<size_t>& next_remembered) {
+        for (;;) {
+            size_t first = next_remembered.fetch_add(CARDS_PER_CHUNK, std::memory_order_relaxed);
+            if (first >= _remembered_cards.size()) {
+                return;
+            }
+            size_t last = std::min(first + CARDS_PER_CHUNK, _remembered_cards.size());
+            for (size_t i = first; i < last; i++) {
+                size_t card = _remembered_cards[i];
+                scanCard(w, _g.cards.cardStart(card), _g.cards.cardStart(card + 1), old_top, true);
+            }
+        }
+    }
+
+    // 处理卡上的对象里落在卡内的引用字段，处理完仍指向候选区域的槽位记下来。
+    // 回收集合里的老年代对象的标记字可能正被别的线程装上转发指针，原子地读
+    void scanCard(Worker& w, char* card, char* card_end, char* old_top, bool deferred) {
+        char* limit = std::min(card_end, old_top);
+        for (char* p = _g.offsets.blockStart(card); p < limit;) {
+            if (__atomic_load_n(reinterpret_cast<const uint64_t*>(p), __ATOMIC_RELAXED) == rtda::markword::FILLER_WORD) {
+                p += sizeof(uint64_t);
+                continue;
+            }
+            rtda::Object* p_object = reinterpret_cast<rtda::Object*>(p);
+            p += rtda::object_size(p_object);
+            if (_g.inCollectionSet(p_object) || _g.isDead(p_object)) continue;
+            for_each_reference_in(p_object, card, card_end, [this, &w, p_object, deferred](rtda::Object** p_ref) {
+                process(w, p_ref, deferred);
+                if (_g.regions.isCandidate(*p_ref)) {
+                    w.remembered.emplace_back(p_object, p_ref);
+                }
+            });
+        }
+    }
+
+    // 处理一个引用槽位：指向回收集合的改成新地址；槽位在老年代而新地址仍在年轻代时，
+    // 所在的卡重新标脏，下次回收还要扫描。队列里的槽位都在刚复制的对象里，
+    // 在老年代的就是晋升对象，它的卡推迟到回收结束再标脏（deferred为true）
+    void process(Worker& w, rtda::Object** p_ref, bool deferred = false) {
+        rtda::Object* p_object = *p_ref;
+        if (p_object == nullptr || !_g.inCollectionSet(p_object)) return;
+        rtda::Object* p_new = evacuate(w, p_object);
+        *p_ref = p_new;
+        if (_g.old.contains(p_ref) && _g.inYoung(p_new)) {
+            if (deferred) {
+                w.deferred_cards.push_back(p_ref);
+            } else {
+                _g.cards.dirty(p_ref);
+            }
+        }
+    }
+
+    rtda::Object* evacuate(Worker& w, rtda::Object* p_object) {
+        uint64_t mark = p_object->markWord().load(std::memory_order_acquire);
+        if ((mark & rtda::markword::LOCK_MASK) == rtda::markword::FORWARDED) {
+            return forwardee(mark);
+        }
+        size_t size = rtda::object_size(p_object);
+        size_t alignment = p_object->getClass()->isArray() ? rtda::ArrayObject::ALIGNMENT : sizeof(uint64_t);
+        uint32_t age = static_cast<uint32_t>((mark & rtda::markword::AGE_MASK) >> rtda::markword::AGE_SHIFT) + 1;
+
+        // 老年代区域里的对象复制到老年代
+        bool from_old = _g.old.contains(p_object);
+        bool promoted = false;
+        char* p_copy = nullptr;
+        if (age < TENURING_THRESHOLD && !from_old) {
+            p_copy = allocateSurvivor(w, size, alignment);
+        }
+        if (p_copy == nullptr) {
+            // 年龄到了或者to放不下，晋升
+            p_copy = allocateOld(w, size, alignment);
+            if (p_copy == nullptr) {
+                return selfForward(w, p_object, mark);
+            }
+            promoted = true;
+        }
+
+        // 标记字可能正被别的线程CAS，只复制它后面的部分
+        std::memcpy(p_copy + sizeof(uint64_t), reinterpret_cast<char*>(p_object) + sizeof(uint64_t),
+                    size - sizeof(uint64_t));
+        rtda::Object* p_new = reinterpret_cast<rtda::Object*>(p_copy);
+        uint64_t new_age = static_cast<uint64_t>(std::min(age, TENURING_THRESHOLD)) << rtda::markword::AGE_SHIFT;
+        p_new->markWord().store((mark & ~rtda::markword::AGE_MASK) | new_age, std::memory_order_relaxed);
+        if (!p_object->tryForwardTo(mark, p_new)) {
+            // 别的线程先复制完了，这份副本作废
+            rtda::Tlab::fill(p_copy, p_copy + size);
+            return forwardee(mark);
+        }
+
+        (from_old ? w.evacuated_bytes : promoted ? w.promoted_bytes : w.copied_bytes) += size;
+        TaskQueue<rtda::Object**>& queue = _queues.queue(w.id);
+        for_each_reference(p_new, [this, &w, &queue, p_new, promoted](rtda::Object** p_ref) {
+            rtda::Object* p_target = *p_ref;
+            if (p_target == nullptr) return;
+            if (_g.inCollectionSet(p_target)) {
+                queue.push(p_ref);
+            } else if (promoted && _g.regions.isCandidate(p_target)) {
+                w.remembered.emplace_back(p_new, p_ref);
+            }
+        });
+        return p_new;
+    }
+
+    // 晋升失败：对象留在原地，转发指针指向自己，引用它的槽位都不变。
+    // 原来的标记字另存起来，回收结束后恢复；它的引用字段照常处理
+    rtda::Object* selfForward(Worker& w, rtda::Object* p_object, uint64_t mark) {
+        if (!p_object->tryForwardTo(mark, p_object)) {
+            return forwardee(mark);
+        }
+        w.promotion_failed = true;
+        w.preserved.emplace_back(p_object, mark);
+        TaskQueue<rtda::Object**>& queue = _queues.queue(w.id);
+        for_each_reference(p_object, [this, &queue](rtda::Object** p_ref) {
+            rtda::Object* p_target = *p_ref;
+            if (p_target != nullptr && _g.inCollectionSet(p_target)) {
+                queue.push(p_ref);
+            }
+        });
+        return p_object;
+    }
+
+    // 晋升失败后：复制走了的对象原地只剩转发指针，做成填充；留在原地的恢复标记字。
+    // 之后整个堆（包括to）都可以按地址遍历，整堆回收把它们和老年代一起压缩
+    void undoForwarding() {
+        auto fill_copied = [](rtda::Object* p_object) {
+            if (p_object->isForwarded() && p_object->forwardee() != p_object) {
+                char* p = reinterpret_cast<char*>(p_object);
+                rtda::Tlab::fill(p, p + rtda::object_size(p_object));
+            }
+        };
+        _g.eden.forEachObject(fill_copied);
+        _g.from().forEachObject(fill_copied);
+        for (HeapRegion* p_region : _g.regions.collectionSet()) {
+            ContiguousSpace::forEachObject(p_region->span_start, p_region->span_end, [this](rtda::Object* p_object) {
+                if (p_object->isForwarded() && p_object->forwardee() != p_object) {
+                    char* p = reinterpret_cast<char*>(p_object);
+                    _g.formatOld(p, p + rtda::object_size(p_object));
+                }
+            });
+        }
+        for (Worker& w : _workers) {
+            for (const auto& [p_object, mark] : w.preserved) {
+                p_object->markWord().store(mark, std::memory_order_relaxed);
+            }
+            w.preserved.clear();
+        }
+    }
+
+    static rtda::Object* forwardee(uint64_t mark) {
+        return reinterpret_cast<rtda::Object*>(mark & ~rtda::markword::LOCK_MASK);
+    }
+
+    char* allocateSurvivor(Worker& w, size_t size, size_t alignment) {
+        ContiguousSpace& to = _g.to();
+        char* p_block;
+        if (size > _to_plab_size / 4) {
+            return to.allocateAligned(size, alignment, &p_block);
+        }
+        void* p = w.to_plab.allocateAligned(size, alignment);
+        if (p != nullptr || w.to_full) {
+            return static_cast<char*>(p);
+        }
+        w.to_plab.retire();
+        char* chunk = to.allocate(_to_plab_size);
+        if (chunk == nullptr) {
+            // to快满了：剩下的零头留给别的线程的小对象，本线程以后都晋升
+            w.to_full = true;
+            return to.allocateAligned(size, alignment, &p_block);
+        }
+        w.to_plab.reset(chunk, chunk + _to_plab_size);
+        return static_cast<char*>(w.to_plab.allocateAligned(size, alignment));
+    }
+
+    // 老年代PLAB里的每个对象都要记进块偏移表，下次扫描脏卡时才找得到
+    char* allocateOld(Worker& w, size_t size, size_t alignment) {
+        if (size > _old_plab_size / 4) {
+            return _g.allocateOld(size, alignment);
+        }
+        char* before = w.old_plab.top();
+        char* p = static_cast<char*>(w.old_plab.allocateAligned(size, alignment));
+        if (p == nullptr) {
+            retireOldPlab(w);
+            char* chunk_end = nullptr;
+            char* chunk = _g.allocateOldChunk(_old_plab_size, &chunk_end);
+            if (chunk == nullptr) {
+                return _g.allocateOld(size, alignment);
+            }
+            w.old_plab.reset(chunk, chunk_end);
+            before = chunk;
+            p = static_cast<char*>(w.old_plab.allocateAligned(size, alignment));
+            if (p == nullptr) {
+                // 取到的是比PLAB小的空闲块，放不下
+                return _g.allocateOld(size, alignment);
+            }
+        }
+        _g.offsets.record(before, p + size);
+        _g.markAllocated(p, size);
+        return p;
+    }
+
+    void retireOldPlab(Worker& w) {
+        char* top = w.old_plab.top();
+        char* end = w.old_plab.end();
+        w.old_plab.retire();
+        if (top < end) {
+            _g.offsets.record(top, end);
+        }
+    }
+
+    Generations& _g;
+    WorkGang& _gang;
+    TaskQueueSet<rtda::Object**> _queues;
+    std::vector<Worker> _workers;
+    size_t _to_plab_size = MIN_PLAB_SIZE;
+    size_t _old_plab_size = MIN_PLAB_SIZE;
+    std::vector<size_t> _remembered_cards;     // 这次要扫描的记忆集卡
+    size_t _copied_bytes = 0;
+    size_t _promoted_bytes = 0;
+    size_t _evacuated_bytes = 0;
+    size_t _freed_old_bytes = 0;
+    bool _promotion_failed = false;
+};
+
+} // namespace gc
+} // namespace jvm
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../../log.hpp"
+#include <cstdint>
+#include <stdexcept>
 #include <vector>
 
 namespace jvm {
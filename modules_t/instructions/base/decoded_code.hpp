@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "opcode_info.hpp"
+
+namespace jvm {
+namespace instructions {
+
+// 预解码后的一条指令，操作数已按OPCODE_TABLE的布局展开，跳转目标换算成绝对pc
+struct DecodedInstruction {
+    uint32_t pc = 0;
+    uint16_t length = 0;
+    Opcode opcode = Opcode::NOP;    // wide指令记录被修饰的操作码
+    bool wide = false;
+    // 局部变量索引、立即数、常量池索引、跳转目标、newarray的类型或switch的default目标
+    int32_t operand = 0;
+    // iinc的增量、invokeinterface的参数槽位数、multianewarray的维数或switch的case数
+    int32_t operand2 = 0;
+    // switch的(key, target)对在DecodedCode::switch_pairs中的起始下标
+    uint32_t switch_begin = 0;
+};
+
+// 方法字节码的预解码结果：指令数组 + pc到指令下标的索引
+// 解码一次之后解释器和分析工具按下标顺序访问，不再重复解析操作数和变长指令
+class DecodedCode {
+public:
+    // 解码并检查：每条指令都完整、操作码已定义、所有跳转目标都落在指令边界上。
+    // 失败返回false，error_pc为出错指令的pc
+    bool decode(const uint8_t* code, uint32_t code_length, uint32_t& error_pc) {
+        _instructions.clear();
+        _switch_pairs.clear();
+        _index.assign(code_length, NOT_AN_INSTRUCTION);
+
+        for (uint32_t pc = 0; pc < code_length; ) {
+            uint32_t length = instruction_length(code, code_length, pc);
+            if (length == 0 || opcode_info(code[pc]).has(opflag::RESERVED)) {
+                error_pc = pc;
+                return false;
+            }
+            _index[pc] = static_cast<int32_t>(_instructions.size());
+            _instructions.push_back(decode_one(code, pc, length));
+            pc += length;
+        }
+
+        for (const DecodedInstruction& insn : _instructions) {
+            if (!targets_valid(insn)) {
+                error_pc = insn.pc;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const std::vector<DecodedInstruction>& instructions() const { return _instructions; }
+
+    // pc处指令的下标，不在指令边界上时返回-1
+    int32_t index_of(uint32_t pc) const {
+        return pc < _index.size() ? _index[pc] : NOT_AN_INSTRUCTION;
+    }
+
+    // switch指令的第i个(key, target)对，tableswitch的key为low + i
+    int32_t switch_key(const DecodedInstruction& insn, int32_t i) const { return _switch_pairs[insn.switch_begin + 2 * i]; }
+    int32_t switch_target(const DecodedInstruction& insn, int32_t i) const { return _switch_pairs[insn.switch_begin + 2 * i + 1]; }
+
+private:
+    static constexpr int32_t NOT_AN_INSTRUCTION = -1;
+
+    static uint16_t u2(const uint8_t* code, uint32_t at) {
+        return static_cast<uint16_t>((code[at] << 8) | code[at + 1]);
+    }
+
+    DecodedInstruction decode_one(const uint8_t* code, uint32_t pc, uint32_t length) {
+        DecodedInstruction insn;
+        insn.pc = pc;
+        insn.length = static_cast<uint16_t>(length);
+        insn.opcode = static_cast<Opcode>(code[pc]);
+        const int32_t ipc = static_cast<int32_t>(pc);
+
+        switch (opcode_info(code[pc]).layout) {
+            case OperandLayout::NONE:
+                break;
+            case OperandLayout::LOCAL:
+            case OperandLayout::CP_U1:
+            case OperandLayout::ATYPE:
+                insn.operand = code[pc + 1];
+                break;
+            case OperandLayout::BYTE:
+                insn.operand = static_cast<int8_t>(code[pc + 1]);
+                break;
+            case OperandLayout::SHORT:
+                insn.operand = static_cast<int16_t>(u2(code, pc + 1));
+                break;
+            case OperandLayout::CP_U2:
+            case OperandLayout::INVOKEDYNAMIC:
+                insn.operand = u2(code, pc + 1);
+                break;
+            case OperandLayout::BRANCH2:
+                insn.operand = ipc + static_cast<int16_t>(u2(code, pc + 1));
+                break;
+            case OperandLayout::BRANCH4:
+                insn.operand = ipc + detail::code_s4(code, pc + 1);
+                break;
+            case OperandLayout::IINC:
+                insn.operand = code[pc + 1];
+                insn.operand2 = static_cast<int8_t>(code[pc + 2]);
+                break;
+            case OperandLayout::INVOKEINTERFACE:
+                insn.operand = u2(code, pc + 1);
+                insn.operand2 = code[pc + 3];
+                break;
+            case OperandLayout::MULTIANEWARRAY:
+                insn.operand = u2(code, pc + 1);
+                insn.operand2 = code[pc + 3];
+                break;
+            case OperandLayout::TABLESWITCH: {
+                uint32_t base = (pc + 4) & ~3u;
+                int32_t low = detail::code_s4(code, base + 4);
+                int32_t high = detail::code_s4(code, base + 8);
+                insn.operand = ipc + detail::code_s4(code, base);
+                insn.operand2 = high - low + 1;
+                insn.switch_begin = static_cast<uint32_t>(_switch_pairs.size());
+                for (int32_t i = 0; i < insn.operand2; i++) {
+                    _switch_pairs.push_back(low + i);
+                    _switch_pairs.push_back(ipc + detail::code_s4(code, base + 12 + 4 * static_cast<uint32_t>(i)));
+                }
+                break;
+            }
+            case OperandLayout::LOOKUPSWITCH: {
+                uint32_t base = (pc + 4) & ~3u;
+                insn.operand = ipc + detail::code_s4(code, base);
+                insn.operand2 = detail::code_s4(code, base + 4);
+                insn.switch_begin = static_cast<uint32_t>(_switch_pairs.size());
+                for (int32_t i = 0; i < insn.operand2; i++) {
+                    uint32_t at = base + 8 + 8 * static_cast<uint32_t>(i);
+                    _switch_pairs.push_back(detail::code_s4(code, at));
+                    _switch_pairs.push_back(ipc + detail::code_s4(code, at + 4));
+                }
+                break;
+            }
+            case OperandLayout::WIDE:
+                insn.wide = true;
+                insn.opcode = static_cast<Opcode>(code[pc + 1]);
+                insn.operand = u2(code, pc + 2);
+                if (insn.opcode == Opcode::IINC) {
+                    insn.operand2 = static_cast<int16_t>(u2(code, pc + 4));
+                }
+                break;
+        }
+        return insn;
+    }
+
+    bool is_target(int64_t pc) const {
+        return pc >= 0 && pc < static_cast<int64_t>(_index.size()) && _index[pc] != NOT_AN_INSTRUCTION;
+    }
+
+    bool targets_valid(const DecodedInstruction& insn) const {
+        const OpcodeInfo& info = opcode_info(insn.opcode);
+        if (insn.wide || !info.has(opflag::BRANCH)) return true;
+        if (!is_target(insn.operand)) return false;
+        if (info.has(opflag::SWITCH)) {
+            for (int32_t i = 0; i < insn.operand2; i++) {
+                if (!is_target(switch_target(insn, i))) return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<DecodedInstruction> _instructions;
+    std::vector<int32_t> _switch_pairs;
+    std::vector<int32_t> _index;
+};
+
+} // namespace instructions
+} // namespace jvm
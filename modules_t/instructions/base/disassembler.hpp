@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+#include "decoded_code.hpp"
+
+namespace jvm {
+namespace instructions {
+
+// javap -c风格的反汇编，每条指令一行："  pc: mnemonic operands"
+// 助记符和操作数格式都来自OPCODE_TABLE，常量池索引只输出#index，不做解析
+class Disassembler {
+public:
+    static std::string disassemble(const uint8_t* code, uint32_t code_length) {
+        DecodedCode decoded;
+        uint32_t error_pc = 0;
+        if (!decoded.decode(code, code_length, error_pc)) {
+            char buf[64];
+            snprintf(buf, sizeof(buf), "%6u: <invalid bytecode>\n", error_pc);
+            return buf;
+        }
+
+        std::string text;
+        for (const DecodedInstruction& insn : decoded.instructions()) {
+            append_instruction(decoded, insn, text);
+        }
+        return text;
+    }
+
+private:
+    static void append_instruction(const DecodedCode& decoded, const DecodedInstruction& insn, std::string& text) {
+        const OpcodeInfo& info = opcode_info(insn.opcode);
+        char buf[96];
+        if (insn.wide) {
+            snprintf(buf, sizeof(buf), "%6u: wide %s %d", insn.pc, info.mnemonic, insn.operand);
+            text += buf;
+            if (insn.opcode == Opcode::IINC) {
+                snprintf(buf, sizeof(buf), ", %d", insn.operand2);
+                text += buf;
+            }
+            text += '\n';
+            return;
+        }
+
+        snprintf(buf, sizeof(buf), "%6u: %-15s", insn.pc, info.mnemonic);
+        text += buf;
+        switch (info.layout) {
+            case OperandLayout::NONE:
+                break;
+            case OperandLayout::LOCAL:
+            case OperandLayout::BYTE:
+            case OperandLayout::SHORT:
+            case OperandLayout::BRANCH2:
+            case OperandLayout::BRANCH4:
+                snprintf(buf, sizeof(buf), "%d", insn.operand);
+                text += buf;
+                break;
+            case OperandLayout::CP_U1:
+            case OperandLayout::CP_U2:
+            case OperandLayout::INVOKEDYNAMIC:
+                snprintf(buf, sizeof(buf), "#%d", insn.operand);
+                text += buf;
+                break;
+            case OperandLayout::IINC:
+                snprintf(buf, sizeof(buf), "%d, %d", insn.operand, insn.operand2);
+                text += buf;
+                break;
+            case OperandLayout::INVOKEINTERFACE:
+            case OperandLayout::MULTIANEWARRAY:
+                snprintf(buf, sizeof(buf), "#%d, %d", insn.operand, insn.operand2);
+                text += buf;
+                break;
+            case OperandLayout::ATYPE:
+                text += array_type_name(insn.operand);
+                break;
+            case OperandLayout::TABLESWITCH:
+            case OperandLayout::LOOKUPSWITCH:
+                text += "{ ";
+                for (int32_t i = 0; i < insn.operand2; i++) {
+                    snprintf(buf, sizeof(buf), "%d: %d, ", decoded.switch_key(insn, i), decoded.switch_target(insn, i));
+                    text += buf;
+                }
+                snprintf(buf, sizeof(buf), "default: %d }", insn.operand);
+                text += buf;
+                break;
+            case OperandLayout::WIDE:
+                break;
+        }
+        while (!text.empty() && text.back() == ' ') text.pop_back();
+        text += '\n';
+    }
+
+    static const char* array_type_name(int32_t atype) {
+        static const char* const NAMES[] = {"boolean", "char", "float", "double", "byte", "short", "int", "long"};
+        return atype >= 4 && atype <= 11 ? NAMES[atype - 4] : "?";
+    }
+};
+
+} // namespace instructions
+} // namespace jvm
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+#include "opcode_info.hpp"
+
+namespace jvm {
+namespace instructions {
+
+// 由OPCODE_TABLE在编译期生成的256项分派表
+// Handler为每个已定义的操作码提供 template <Opcode OP> static R execute(Args...)，
+// 并提供 static R invalid(Args...) 处理未定义和保留的操作码；
+// 只有已定义操作码的execute<OP>会被实例化，分派时就是一次数组下标 + 间接调用
+template <typename Handler, typename R, typename... Args>
+class DispatchTable {
+public:
+    using Fn = R (*)(Args...);
+
+    static R dispatch(uint8_t opcode, Args... args) {
+        return TABLE[opcode](std::forward<Args>(args)...);
+    }
+
+    static constexpr Fn handler(uint8_t opcode) { return TABLE[opcode]; }
+
+private:
+    template <size_t I>
+    static constexpr Fn entry() {
+        constexpr const OpcodeInfo& info = opcode_info(static_cast<uint8_t>(I));
+        if constexpr (info.valid() && !info.has(opflag::RESERVED)) {
+            return &Handler::template execute<static_cast<Opcode>(I)>;
+        } else {
+            return &Handler::invalid;
+        }
+    }
+
+    template <size_t... I>
+    static constexpr std::array<Fn, 256> build(std::index_sequence<I...>) {
+        return {{entry<I>()...}};
+    }
+
+    static constexpr std::array<Fn, 256> TABLE = build(std::make_index_sequence<256>{});
+};
+
+} // namespace instructions
+} // namespace jvm
@@ -7,21 +7,21 @@ namespace instructions {
 
 
 // NoOperandsInstruction
-void NoOperandsInstruction::fetchOperands(std::shared_ptr<BytecodeReader> p_rd) override {
+void NoOperandsInstruction::fetchOperands(std::shared_ptr<BytecodeReader> /*p_rd*/) {
     // No operands to fetch
 }
 
-void NoOperandsInstruction::execute(std::shared_ptr<Frame> p_frame) override {
+void NoOperandsInstruction::execute(std::shared_ptr<Frame> /*p_frame*/) {
     // No operation
 }
 
 
 // BranchInstruction
-void BranchInstruction::fetchOperands(std::shared_ptr<BytecodeReader> p_rd) override {
+void BranchInstruction::fetchOperands(std::shared_ptr<BytecodeReader> p_rd) {
     _offset = p_rd->readInt16();
 }
 
-void BranchInstruction::execute(std::shared_ptr<Frame> p_frame) override {
+void BranchInstruction::execute(std::shared_ptr<Frame> /*p_frame*/) {
     // Branch logic to be implemented in derived classes
 }
 
@@ -31,11 +31,11 @@ int16_t BranchInstruction::getOffset() const {
 
 
 // Index8Instruction
-void Index8Instruction::fetchOperands(std::shared_ptr<BytecodeReader> p_rd) override {
+void Index8Instruction::fetchOperands(std::shared_ptr<BytecodeReader> p_rd) {
     _index = p_rd->readUint8();
 }
 
-void Index8Instruction::execute(std::shared_ptr<Frame> p_frame) override {
+void Index8Instruction::execute(std::shared_ptr<Frame> /*p_frame*/) {
     // Execution logic to be implemented in derived classes
 }
 
@@ -44,11 +44,11 @@ uint8_t Index8Instruction::getIndex() const {
 }
 
 // Index16Instruction
-void Index16Instruction::fetchOperands(std::shared_ptr<BytecodeReader> p_rd) override {
+void Index16Instruction::fetchOperands(std::shared_ptr<BytecodeReader> p_rd) {
     _index = p_rd->readUint16();
 }
 
-void Index16Instruction::execute(std::shared_ptr<Frame> p_frame) override {
+void Index16Instruction::execute(std::shared_ptr<Frame> /*p_frame*/) {
     // Execution logic to be implemented in derived classes
 }
 
@@ -9,6 +9,8 @@
 namespace jvm {
 namespace instructions {
 
+using rtda::Frame;
+
 class Instruction{
 public:
     virtual ~Instruction() = default;
@@ -0,0 +1,396 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "opcodes.hpp"
+
+namespace jvm {
+namespace instructions {
+
+// 操作码元数据（JVMS 第6章）
+// 每个操作码的助记符、操作数布局、栈效应和控制流属性都只在下面的OPCODE_DEFS中写一次，
+// 验证器、预解码器、反汇编器和解释器分派表都从这张编译期表生成，不做任何运行时查找
+
+// 紧跟在操作码之后的操作数布局，决定指令长度和操作数的解释方式
+enum class OperandLayout : uint8_t {
+    NONE,               // 无操作数
+    LOCAL,              // u1 局部变量索引（可被wide扩展为u2）
+    BYTE,               // s1 立即数（bipush）
+    SHORT,              // s2 立即数（sipush）
+    CP_U1,              // u1 常量池索引（ldc）
+    CP_U2,              // u2 常量池索引
+    BRANCH2,            // s2 相对跳转偏移
+    BRANCH4,            // s4 相对跳转偏移
+    IINC,               // u1 局部变量索引 + s1 增量（可被wide扩展为u2 + s2）
+    ATYPE,              // u1 基本类型数组的元素类型（newarray）
+    INVOKEINTERFACE,    // u2 常量池索引 + u1 参数槽位数 + u1 0
+    INVOKEDYNAMIC,      // u2 常量池索引 + u2 0
+    MULTIANEWARRAY,     // u2 常量池索引 + u1 维数
+    TABLESWITCH,        // 变长：0-3字节对齐填充 + default, low, high + 跳转表
+    LOOKUPSWITCH,       // 变长：0-3字节对齐填充 + default, npairs + (key, offset)对
+    WIDE,               // 变长：被修饰的操作码 + 加宽的操作数
+};
+
+namespace opflag {
+constexpr uint16_t BRANCH         = 1 << 0;    // 有跳转目标
+constexpr uint16_t SWITCH         = 1 << 1;    // tableswitch/lookupswitch
+constexpr uint16_t NO_FALLTHROUGH = 1 << 2;    // 执行后不会落到下一条指令（goto、switch、return、athrow、ret）
+constexpr uint16_t INVOKE         = 1 << 3;
+constexpr uint16_t RETURN         = 1 << 4;
+constexpr uint16_t FIELD_ACCESS   = 1 << 5;
+constexpr uint16_t CAN_THROW      = 1 << 6;    // 执行时可能抛出异常（不含VirtualMachineError）
+constexpr uint16_t LOCAL_ACCESS   = 1 << 7;    // 读写局部变量
+constexpr uint16_t CONSTANT_POOL  = 1 << 8;    // 操作数中含常量池索引
+constexpr uint16_t RESERVED       = 1 << 9;    // 保留操作码，不能出现在类文件中
+} // namespace opflag
+
+// 栈效应取决于操作数（字段/方法描述符、数组维数、wide修饰的指令）
+constexpr int8_t VARIES = -1;
+
+struct OpcodeInfo {
+    const char* mnemonic = nullptr;     // nullptr表示未定义的操作码
+    OperandLayout layout = OperandLayout::NONE;
+    uint8_t length = 0;                 // 指令总字节数，0表示变长
+    int8_t pops = 0;                    // 弹出的槽位数（long/double占2），或VARIES
+    int8_t pushes = 0;                  // 压入的槽位数，或VARIES
+    uint16_t flags = 0;
+
+    constexpr bool valid() const { return mnemonic != nullptr; }
+    constexpr bool has(uint16_t flag) const { return (flags & flag) != 0; }
+};
+
+namespace detail {
+
+struct OpcodeDef {
+    Opcode opcode;
+    const char* mnemonic;
+    OperandLayout layout;
+    int8_t pops;
+    int8_t pushes;
+    uint16_t flags;
+};
+
+constexpr uint8_t operand_layout_length(OperandLayout layout) {
+    switch (layout) {
+        case OperandLayout::NONE:            return 1;
+        case OperandLayout::LOCAL:           return 2;
+        case OperandLayout::BYTE:            return 2;
+        case OperandLayout::SHORT:           return 3;
+        case OperandLayout::CP_U1:           return 2;
+        case OperandLayout::CP_U2:           return 3;
+        case OperandLayout::BRANCH2:         return 3;
+        case OperandLayout::BRANCH4:         return 5;
+        case OperandLayout::IINC:            return 3;
+        case OperandLayout::ATYPE:           return 2;
+        case OperandLayout::INVOKEINTERFACE: return 5;
+        case OperandLayout::INVOKEDYNAMIC:   return 5;
+        case OperandLayout::MULTIANEWARRAY:  return 4;
+        case OperandLayout::TABLESWITCH:
+        case OperandLayout::LOOKUPSWITCH:
+        case OperandLayout::WIDE:            return 0;
+    }
+    return 0;
+}
+
+constexpr OpcodeDef OPCODE_DEFS[] = {
+    {Opcode::NOP,             "nop",             OperandLayout::NONE,            0,      0,      0},
+    {Opcode::ACONST_NULL,     "aconst_null",     OperandLayout::NONE,            0,      1,      0},
+    {Opcode::ICONST_M1,       "iconst_m1",       OperandLayout::NONE,            0,      1,      0},
+    {Opcode::ICONST_0,        "iconst_0",        OperandLayout::NONE,            0,      1,      0},
+    {Opcode::ICONST_1,        "iconst_1",        OperandLayout::NONE,            0,      1,      0},
+    {Opcode::ICONST_2,        "iconst_2",        OperandLayout::NONE,            0,      1,      0},
+    {Opcode::ICONST_3,        "iconst_3",        OperandLayout::NONE,            0,      1,      0},
+    {Opcode::ICONST_4,        "iconst_4",        OperandLayout::NONE,            0,      1,      0},
+    {Opcode::ICONST_5,        "iconst_5",        OperandLayout::NONE,            0,      1,      0},
+    {Opcode::LCONST_0,        "lconst_0",        OperandLayout::NONE,            0,      2,      0},
+    {Opcode::LCONST_1,        "lconst_1",        OperandLayout::NONE,            0,      2,      0},
+    {Opcode::FCONST_0,        "fconst_0",        OperandLayout::NONE,            0,      1,      0},
+    {Opcode::FCONST_1,        "fconst_1",        OperandLayout::NONE,            0,      1,      0},
+    {Opcode::FCONST_2,        "fconst_2",        OperandLayout::NONE,            0,      1,      0},
+    {Opcode::DCONST_0,        "dconst_0",        OperandLayout::NONE,            0,      2,      0},
+    {Opcode::DCONST_1,        "dconst_1",        OperandLayout::NONE,            0,      2,      0},
+    {Opcode::BIPUSH,          "bipush",          OperandLayout::BYTE,            0,      1,      0},
+    {Opcode::SIPUSH,          "sipush",          OperandLayout::SHORT,           0,      1,      0},
+    {Opcode::LDC,             "ldc",             OperandLayout::CP_U1,           0,      1,      opflag::CONSTANT_POOL | opflag::CAN_THROW},
+    {Opcode::LDC_W,           "ldc_w",           OperandLayout::CP_U2,           0,      1,      opflag::CONSTANT_POOL | opflag::CAN_THROW},
+    {Opcode::LDC2_W,          "ldc2_w",          OperandLayout::CP_U2,           0,      2,      opflag::CONSTANT_POOL},
+    {Opcode::ILOAD,           "iload",           OperandLayout::LOCAL,           0,      1,      opflag::LOCAL_ACCESS},
+    {Opcode::LLOAD,           "lload",           OperandLayout::LOCAL,           0,      2,      opflag::LOCAL_ACCESS},
+    {Opcode::FLOAD,           "fload",           OperandLayout::LOCAL,           0,      1,      opflag::LOCAL_ACCESS},
+    {Opcode::DLOAD,           "dload",           OperandLayout::LOCAL,           0,      2,      opflag::LOCAL_ACCESS},
+    {Opcode::ALOAD,           "aload",           OperandLayout::LOCAL,           0,      1,      opflag::LOCAL_ACCESS},
+    {Opcode::ILOAD_0,         "iload_0",         OperandLayout::NONE,            0,      1,      opflag::LOCAL_ACCESS},
+    {Opcode::ILOAD_1,         "iload_1",         OperandLayout::NONE,            0,      1,      opflag::LOCAL_ACCESS},
+    {Opcode::ILOAD_2,         "iload_2",         OperandLayout::NONE,            0,      1,      opflag::LOCAL_ACCESS},
+    {Opcode::ILOAD_3,         "iload_3",         OperandLayout::NONE,            0,      1,      opflag::LOCAL_ACCESS},
+    {Opcode::LLOAD_0,         "lload_0",         OperandLayout::NONE,            0,      2,      opflag::LOCAL_ACCESS},
+    {Opcode::LLOAD_1,         "lload_1",         OperandLayout::NONE,            0,      2,      opflag::LOCAL_ACCESS},
+    {Opcode::LLOAD_2,         "lload_2",         OperandLayout::NONE,            0,      2,      opflag::LOCAL_ACCESS},
+    {Opcode::LLOAD_3,         "lload_3",         OperandLayout::NONE,            0,      2,      opflag::LOCAL_ACCESS},
+    {Opcode::FLOAD_0,         "fload_0",         OperandLayout::NONE,            0,      1,      opflag::LOCAL_ACCESS},
+    {Opcode::FLOAD_1,         "fload_1",         OperandLayout::NONE,            0,      1,      opflag::LOCAL_ACCESS},
+    {Opcode::FLOAD_2,         "fload_2",         OperandLayout::NONE,            0,      1,      opflag::LOCAL_ACCESS},
+    {Opcode::FLOAD_3,         "fload_3",         OperandLayout::NONE,            0,      1,      opflag::LOCAL_ACCESS},
+    {Opcode::DLOAD_0,         "dload_0",         OperandLayout::NONE,            0,      2,      opflag::LOCAL_ACCESS},
+    {Opcode::DLOAD_1,         "dload_1",         OperandLayout::NONE,            0,      2,      opflag::LOCAL_ACCESS},
+    {Opcode::DLOAD_2,         "dload_2",         OperandLayout::NONE,            0,      2,      opflag::LOCAL_ACCESS},
+    {Opcode::DLOAD_3,         "dload_3",         OperandLayout::NONE,            0,      2,      opflag::LOCAL_ACCESS},
+    {Opcode::ALOAD_0,         "aload_0",         OperandLayout::NONE,            0,      1,      opflag::LOCAL_ACCESS},
+    {Opcode::ALOAD_1,         "aload_1",         OperandLayout::NONE,            0,      1,      opflag::LOCAL_ACCESS},
+    {Opcode::ALOAD_2,         "aload_2",         OperandLayout::NONE,            0,      1,      opflag::LOCAL_ACCESS},
+    {Opcode::ALOAD_3,         "aload_3",         OperandLayout::NONE,            0,      1,      opflag::LOCAL_ACCESS},
+    {Opcode::IALOAD,          "iaload",          OperandLayout::NONE,            2,      1,      opflag::CAN_THROW},
+    {Opcode::LALOAD,          "laload",          OperandLayout::NONE,            2,      2,      opflag::CAN_THROW},
+    {Opcode::FALOAD,          "faload",          OperandLayout::NONE,            2,      1,      opflag::CAN_THROW},
+    {Opcode::DALOAD,          "daload",          OperandLayout::NONE,            2,      2,      opflag::CAN_THROW},
+    {Opcode::AALOAD,          "aaload",          OperandLayout::NONE,            2,      1,      opflag::CAN_THROW},
+    {Opcode::BALOAD,          "baload",          OperandLayout::NONE,            2,      1,      opflag::CAN_THROW},
+    {Opcode::CALOAD,          "caload",          OperandLayout::NONE,            2,      1,      opflag::CAN_THROW},
+    {Opcode::SALOAD,          "saload",          OperandLayout::NONE,            2,      1,      opflag::CAN_THROW},
+    {Opcode::ISTORE,          "istore",          OperandLayout::LOCAL,           1,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::LSTORE,          "lstore",          OperandLayout::LOCAL,           2,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::FSTORE,          "fstore",          OperandLayout::LOCAL,           1,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::DSTORE,          "dstore",          OperandLayout::LOCAL,           2,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::ASTORE,          "astore",          OperandLayout::LOCAL,           1,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::ISTORE_0,        "istore_0",        OperandLayout::NONE,            1,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::ISTORE_1,        "istore_1",        OperandLayout::NONE,            1,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::ISTORE_2,        "istore_2",        OperandLayout::NONE,            1,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::ISTORE_3,        "istore_3",        OperandLayout::NONE,            1,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::LSTORE_0,        "lstore_0",        OperandLayout::NONE,            2,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::LSTORE_1,        "lstore_1",        OperandLayout::NONE,            2,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::LSTORE_2,        "lstore_2",        OperandLayout::NONE,            2,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::LSTORE_3,        "lstore_3",        OperandLayout::NONE,            2,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::FSTORE_0,        "fstore_0",        OperandLayout::NONE,            1,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::FSTORE_1,        "fstore_1",        OperandLayout::NONE,            1,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::FSTORE_2,        "fstore_2",        OperandLayout::NONE,            1,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::FSTORE_3,        "fstore_3",        OperandLayout::NONE,            1,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::DSTORE_0,        "dstore_0",        OperandLayout::NONE,            2,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::DSTORE_1,        "dstore_1",        OperandLayout::NONE,            2,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::DSTORE_2,        "dstore_2",        OperandLayout::NONE,            2,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::DSTORE_3,        "dstore_3",        OperandLayout::NONE,            2,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::ASTORE_0,        "astore_0",        OperandLayout::NONE,            1,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::ASTORE_1,        "astore_1",        OperandLayout::NONE,            1,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::ASTORE_2,        "astore_2",        OperandLayout::NONE,            1,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::ASTORE_3,        "astore_3",        OperandLayout::NONE,            1,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::IASTORE,         "iastore",         OperandLayout::NONE,            3,      0,      opflag::CAN_THROW},
+    {Opcode::LASTORE,         "lastore",         OperandLayout::NONE,            4,      0,      opflag::CAN_THROW},
+    {Opcode::FASTORE,         "fastore",         OperandLayout::NONE,            3,      0,      opflag::CAN_THROW},
+    {Opcode::DASTORE,         "dastore",         OperandLayout::NONE,            4,      0,      opflag::CAN_THROW},
+    {Opcode::AASTORE,         "aastore",         OperandLayout::NONE,            3,      0,      opflag::CAN_THROW},
+    {Opcode::BASTORE,         "bastore",         OperandLayout::NONE,            3,      0,      opflag::CAN_THROW},
+    {Opcode::CASTORE,         "castore",         OperandLayout::NONE,            3,      0,      opflag::CAN_THROW},
+    {Opcode::SASTORE,         "sastore",         OperandLayout::NONE,            3,      0,      opflag::CAN_THROW},
+    {Opcode::POP,             "pop",             OperandLayout::NONE,            1,      0,      0},
+    {Opcode::POP2,            "pop2",            OperandLayout::NONE,            2,      0,      0},
+    {Opcode::DUP,             "dup",             OperandLayout::NONE,            1,      2,      0},
+    {Opcode::DUP_X1,          "dup_x1",          OperandLayout::NONE,            2,      3,      0},
+    {Opcode::DUP_X2,          "dup_x2",          OperandLayout::NONE,            3,      4,      0},
+    {Opcode::DUP2,            "dup2",            OperandLayout::NONE,            2,      4,      0},
+    {Opcode::DUP2_X1,         "dup2_x1",         OperandLayout::NONE,            3,      5,      0},
+    {Opcode::DUP2_X2,         "dup2_x2",         OperandLayout::NONE,            4,      6,      0},
+    {Opcode::SWAP,            "swap",            OperandLayout::NONE,            2,      2,      0},
+    {Opcode::IADD,            "iadd",            OperandLayout::NONE,            2,      1,      0},
+    {Opcode::LADD,            "ladd",            OperandLayout::NONE,            4,      2,      0},
+    {Opcode::FADD,            "fadd",            OperandLayout::NONE,            2,      1,      0},
+    {Opcode::DADD,            "dadd",            OperandLayout::NONE,            4,      2,      0},
+    {Opcode::ISUB,            "isub",            OperandLayout::NONE,            2,      1,      0},
+    {Opcode::LSUB,            "lsub",            OperandLayout::NONE,            4,      2,      0},
+    {Opcode::FSUB,            "fsub",            OperandLayout::NONE,            2,      1,      0},
+    {Opcode::DSUB,            "dsub",            OperandLayout::NONE,            4,      2,      0},
+    {Opcode::IMUL,            "imul",            OperandLayout::NONE,            2,      1,      0},
+    {Opcode::LMUL,            "lmul",            OperandLayout::NONE,            4,      2,      0},
+    {Opcode::FMUL,            "fmul",            OperandLayout::NONE,            2,      1,      0},
+    {Opcode::DMUL,            "dmul",            OperandLayout::NONE,            4,      2,      0},
+    {Opcode::IDIV,            "idiv",            OperandLayout::NONE,            2,      1,      opflag::CAN_THROW},
+    {Opcode::LDIV,            "ldiv",            OperandLayout::NONE,            4,      2,      opflag::CAN_THROW},
+    {Opcode::FDIV,            "fdiv",            OperandLayout::NONE,            2,      1,      0},
+    {Opcode::DDIV,            "ddiv",            OperandLayout::NONE,            4,      2,      0},
+    {Opcode::IREM,            "irem",            OperandLayout::NONE,            2,      1,      opflag::CAN_THROW},
+    {Opcode::LREM,            "lrem",            OperandLayout::NONE,            4,      2,      opflag::CAN_THROW},
+    {Opcode::FREM,            "frem",            OperandLayout::NONE,            2,      1,      0},
+    {Opcode::DREM,            "drem",            OperandLayout::NONE,            4,      2,      0},
+    {Opcode::INEG,            "ineg",            OperandLayout::NONE,            1,      1,      0},
+    {Opcode::LNEG,            "lneg",            OperandLayout::NONE,            2,      2,      0},
+    {Opcode::FNEG,            "fneg",            OperandLayout::NONE,            1,      1,      0},
+    {Opcode::DNEG,            "dneg",            OperandLayout::NONE,            2,      2,      0},
+    {Opcode::ISHL,            "ishl",            OperandLayout::NONE,            2,      1,      0},
+    {Opcode::LSHL,            "lshl",            OperandLayout::NONE,            3,      2,      0},
+    {Opcode::ISHR,            "ishr",            OperandLayout::NONE,            2,      1,      0},
+    {Opcode::LSHR,            "lshr",            OperandLayout::NONE,            3,      2,      0},
+    {Opcode::IUSHR,           "iushr",           OperandLayout::NONE,            2,      1,      0},
+    {Opcode::LUSHR,           "lushr",           OperandLayout::NONE,            3,      2,      0},
+    {Opcode::IAND,            "iand",            OperandLayout::NONE,            2,      1,      0},
+    {Opcode::LAND,            "land",            OperandLayout::NONE,            4,      2,      0},
+    {Opcode::IOR,             "ior",             OperandLayout::NONE,            2,      1,      0},
+    {Opcode::LOR,             "lor",             OperandLayout::NONE,            4,      2,      0},
+    {Opcode::IXOR,            "ixor",            OperandLayout::NONE,            2,      1,      0},
+    {Opcode::LXOR,            "lxor",            OperandLayout::NONE,            4,      2,      0},
+    {Opcode::IINC,            "iinc",            OperandLayout::IINC,            0,      0,      opflag::LOCAL_ACCESS},
+    {Opcode::I2L,             "i2l",             OperandLayout::NONE,            1,      2,      0},
+    {Opcode::I2F,             "i2f",             OperandLayout::NONE,            1,      1,      0},
+    {Opcode::I2D,             "i2d",             OperandLayout::NONE,            1,      2,      0},
+    {Opcode::L2I,             "l2i",             OperandLayout::NONE,            2,      1,      0},
+    {Opcode::L2F,             "l2f",             OperandLayout::NONE,            2,      1,      0},
+    {Opcode::L2D,             "l2d",             OperandLayout::NONE,            2,      2,      0},
+    {Opcode::F2I,             "f2i",             OperandLayout::NONE,            1,      1,      0},
+    {Opcode::F2L,             "f2l",             OperandLayout::NONE,            1,      2,      0},
+    {Opcode::F2D,             "f2d",             OperandLayout::NONE,            1,      2,      0},
+    {Opcode::D2I,             "d2i",             OperandLayout::NONE,            2,      1,      0},
+    {Opcode::D2L,             "d2l",             OperandLayout::NONE,            2,      2,      0},
+    {Opcode::D2F,             "d2f",             OperandLayout::NONE,            2,      1,      0},
+    {Opcode::I2B,             "i2b",             OperandLayout::NONE,            1,      1,      0},
+    {Opcode::I2C,             "i2c",             OperandLayout::NONE,            1,      1,      0},
+    {Opcode::I2S,             "i2s",             OperandLayout::NONE,            1,      1,      0},
+    {Opcode::LCMP,            "lcmp",            OperandLayout::NONE,            4,      1,      0},
+    {Opcode::FCMPL,           "fcmpl",           OperandLayout::NONE,            2,      1,      0},
+    {Opcode::FCMPG,           "fcmpg",           OperandLayout::NONE,            2,      1,      0},
+    {Opcode::DCMPL,           "dcmpl",           OperandLayout::NONE,            4,      1,      0},
+    {Opcode::DCMPG,           "dcmpg",           OperandLayout::NONE,            4,      1,      0},
+    {Opcode::IFEQ,            "ifeq",            OperandLayout::BRANCH2,         1,      0,      opflag::BRANCH},
+    {Opcode::IFNE,            "ifne",            OperandLayout::BRANCH2,         1,      0,      opflag::BRANCH},
+    {Opcode::IFLT,            "iflt",            OperandLayout::BRANCH2,         1,      0,      opflag::BRANCH},
+    {Opcode::IFGE,            "ifge",            OperandLayout::BRANCH2,         1,      0,      opflag::BRANCH},
+    {Opcode::IFGT,            "ifgt",            OperandLayout::BRANCH2,         1,      0,      opflag::BRANCH},
+    {Opcode::IFLE,            "ifle",            OperandLayout::BRANCH2,         1,      0,      opflag::BRANCH},
+    {Opcode::IF_ICMPEQ,       "if_icmpeq",       OperandLayout::BRANCH2,         2,      0,      opflag::BRANCH},
+    {Opcode::IF_ICMPNE,       "if_icmpne",       OperandLayout::BRANCH2,         2,      0,      opflag::BRANCH},
+    {Opcode::IF_ICMPLT,       "if_icmplt",       OperandLayout::BRANCH2,         2,      0,      opflag::BRANCH},
+    {Opcode::IF_ICMPGE,       "if_icmpge",       OperandLayout::BRANCH2,         2,      0,      opflag::BRANCH},
+    {Opcode::IF_ICMPGT,       "if_icmpgt",       OperandLayout::BRANCH2,         2,      0,      opflag::BRANCH},
+    {Opcode::IF_ICMPLE,       "if_icmple",       OperandLayout::BRANCH2,         2,      0,      opflag::BRANCH},
+    {Opcode::IF_ACMPEQ,       "if_acmpeq",       OperandLayout::BRANCH2,         2,      0,      opflag::BRANCH},
+    {Opcode::IF_ACMPNE,       "if_acmpne",       OperandLayout::BRANCH2,         2,      0,      opflag::BRANCH},
+    {Opcode::GOTO,            "goto",            OperandLayout::BRANCH2,         0,      0,      opflag::BRANCH | opflag::NO_FALLTHROUGH},
+    {Opcode::JSR,             "jsr",             OperandLayout::BRANCH2,         0,      1,      opflag::BRANCH},
+    {Opcode::RET,             "ret",             OperandLayout::LOCAL,           0,      0,      opflag::LOCAL_ACCESS | opflag::NO_FALLTHROUGH},
+    {Opcode::TABLESWITCH,     "tableswitch",     OperandLayout::TABLESWITCH,     1,      0,      opflag::BRANCH | opflag::SWITCH | opflag::NO_FALLTHROUGH},
+    {Opcode::LOOKUPSWITCH,    "lookupswitch",    OperandLayout::LOOKUPSWITCH,    1,      0,      opflag::BRANCH | opflag::SWITCH | opflag::NO_FALLTHROUGH},
+    {Opcode::IRETURN,         "ireturn",         OperandLayout::NONE,            1,      0,      opflag::RETURN | opflag::NO_FALLTHROUGH | opflag::CAN_THROW},
+    {Opcode::LRETURN,         "lreturn",         OperandLayout::NONE,            2,      0,      opflag::RETURN | opflag::NO_FALLTHROUGH | opflag::CAN_THROW},
+    {Opcode::FRETURN,         "freturn",         OperandLayout::NONE,            1,      0,      opflag::RETURN | opflag::NO_FALLTHROUGH | opflag::CAN_THROW},
+    {Opcode::DRETURN,         "dreturn",         OperandLayout::NONE,            2,      0,      opflag::RETURN | opflag::NO_FALLTHROUGH | opflag::CAN_THROW},
+    {Opcode::ARETURN,         "areturn",         OperandLayout::NONE,            1,      0,      opflag::RETURN | opflag::NO_FALLTHROUGH | opflag::CAN_THROW},
+    {Opcode::RETURN,          "return",          OperandLayout::NONE,            0,      0,      opflag::RETURN | opflag::NO_FALLTHROUGH | opflag::CAN_THROW},
+    {Opcode::GETSTATIC,       "getstatic",       OperandLayout::CP_U2,           VARIES, VARIES, opflag::CONSTANT_POOL | opflag::FIELD_ACCESS | opflag::CAN_THROW},
+    {Opcode::PUTSTATIC,       "putstatic",       OperandLayout::CP_U2,           VARIES, VARIES, opflag::CONSTANT_POOL | opflag::FIELD_ACCESS | opflag::CAN_THROW},
+    {Opcode::GETFIELD,        "getfield",        OperandLayout::CP_U2,           VARIES, VARIES, opflag::CONSTANT_POOL | opflag::FIELD_ACCESS | opflag::CAN_THROW},
+    {Opcode::PUTFIELD,        "putfield",        OperandLayout::CP_U2,           VARIES, VARIES, opflag::CONSTANT_POOL | opflag::FIELD_ACCESS | opflag::CAN_THROW},
+    {Opcode::INVOKEVIRTUAL,   "invokevirtual",   OperandLayout::CP_U2,           VARIES, VARIES, opflag::CONSTANT_POOL | opflag::INVOKE | opflag::CAN_THROW},
+    {Opcode::INVOKESPECIAL,   "invokespecial",   OperandLayout::CP_U2,           VARIES, VARIES, opflag::CONSTANT_POOL | opflag::INVOKE | opflag::CAN_THROW},
+    {Opcode::INVOKESTATIC,    "invokestatic",    OperandLayout::CP_U2,           VARIES, VARIES, opflag::CONSTANT_POOL | opflag::INVOKE | opflag::CAN_THROW},
+    {Opcode::INVOKEINTERFACE, "invokeinterface", OperandLayout::INVOKEINTERFACE, VARIES, VARIES, opflag::CONSTANT_POOL | opflag::INVOKE | opflag::CAN_THROW},
+    {Opcode::INVOKEDYNAMIC,   "invokedynamic",   OperandLayout::INVOKEDYNAMIC,   VARIES, VARIES, opflag::CONSTANT_POOL | opflag::INVOKE | opflag::CAN_THROW},
+    {Opcode::NEW,             "new",             OperandLayout::CP_U2,           0,      1,      opflag::CONSTANT_POOL | opflag::CAN_THROW},
+    {Opcode::NEWARRAY,        "newarray",        OperandLayout::ATYPE,           1,      1,      opflag::CAN_THROW},
+    {Opcode::ANEWARRAY,       "anewarray",       OperandLayout::CP_U2,           1,      1,      opflag::CONSTANT_POOL | opflag::CAN_THROW},
+    {Opcode::ARRAYLENGTH,     "arraylength",     OperandLayout::NONE,            1,      1,      opflag::CAN_THROW},
+    {Opcode::ATHROW,          "athrow",          OperandLayout::NONE,            1,      0,      opflag::NO_FALLTHROUGH | opflag::CAN_THROW},
+    {Opcode::CHECKCAST,       "checkcast",       OperandLayout::CP_U2,           1,      1,      opflag::CONSTANT_POOL | opflag::CAN_THROW},
+    {Opcode::INSTANCEOF,      "instanceof",      OperandLayout::CP_U2,           1,      1,      opflag::CONSTANT_POOL | opflag::CAN_THROW},
+    {Opcode::MONITORENTER,    "monitorenter",    OperandLayout::NONE,            1,      0,      opflag::CAN_THROW},
+    {Opcode::MONITOREXIT,     "monitorexit",     OperandLayout::NONE,            1,      0,      opflag::CAN_THROW},
+    {Opcode::WIDE,            "wide",            OperandLayout::WIDE,            VARIES, VARIES, 0},
+    {Opcode::MULTIANEWARRAY,  "multianewarray",  OperandLayout::MULTIANEWARRAY,  VARIES, 1,      opflag::CONSTANT_POOL | opflag::CAN_THROW},
+    {Opcode::IFNULL,          "ifnull",          OperandLayout::BRANCH2,         1,      0,      opflag::BRANCH},
+    {Opcode::IFNONNULL,       "ifnonnull",       OperandLayout::BRANCH2,         1,      0,      opflag::BRANCH},
+    {Opcode::GOTO_W,          "goto_w",          OperandLayout::BRANCH4,         0,      0,      opflag::BRANCH | opflag::NO_FALLTHROUGH},
+    {Opcode::JSR_W,           "jsr_w",           OperandLayout::BRANCH4,         0,      1,      opflag::BRANCH},
+    {Opcode::BREAKPOINT,      "breakpoint",      OperandLayout::NONE,            0,      0,      opflag::RESERVED},
+    {Opcode::IMPDEP1,         "impdep1",         OperandLayout::NONE,            0,      0,      opflag::RESERVED},
+    {Opcode::IMPDEP2,         "impdep2",         OperandLayout::NONE,            0,      0,      opflag::RESERVED},
+};
+
+constexpr std::array<OpcodeInfo, 256> build_opcode_table() {
+    std::array<OpcodeInfo, 256> table{};
+    for (const OpcodeDef& def : OPCODE_DEFS) {
+        table[static_cast<uint8_t>(def.opcode)] = OpcodeInfo{
+            def.mnemonic, def.layout, operand_layout_length(def.layout), def.pops, def.pushes, def.flags};
+    }
+    return table;
+}
+
+// 每个操作码恰好定义一次，且0x00-0xc9连续定义
+constexpr bool opcode_defs_consistent() {
+    bool seen[256] = {};
+    for (const OpcodeDef& def : OPCODE_DEFS) {
+        uint8_t op = static_cast<uint8_t>(def.opcode);
+        if (seen[op]) return false;
+        seen[op] = true;
+    }
+    for (size_t op = 0; op <= static_cast<uint8_t>(Opcode::JSR_W); op++) {
+        if (!seen[op]) return false;
+    }
+    return true;
+}
+
+static_assert(opcode_defs_consistent(), "OPCODE_DEFS must define every opcode exactly once");
+
+} // namespace detail
+
+constexpr std::array<OpcodeInfo, 256> OPCODE_TABLE = detail::build_opcode_table();
+
+constexpr const OpcodeInfo& opcode_info(uint8_t opcode) { return OPCODE_TABLE[opcode]; }
+constexpr const OpcodeInfo& opcode_info(Opcode opcode) { return OPCODE_TABLE[static_cast<uint8_t>(opcode)]; }
+
+static_assert(opcode_info(Opcode::INVOKEINTERFACE).length == 5, "opcode table layout mismatch");
+static_assert(opcode_info(Opcode::LDC2_W).pushes == 2, "opcode table stack effect mismatch");
+static_assert(!opcode_info(0xcb).valid(), "0xcb-0xfd are undefined");
+
+namespace detail {
+
+constexpr int32_t code_s4(const uint8_t* code, uint32_t at) {
+    return static_cast<int32_t>((static_cast<uint32_t>(code[at]) << 24) | (static_cast<uint32_t>(code[at + 1]) << 16) |
+                                (static_cast<uint32_t>(code[at + 2]) << 8) | code[at + 3]);
+}
+
+} // namespace detail
+
+// pc处指令的字节数，包括tableswitch/lookupswitch的对齐填充和wide加宽的操作数。
+// 操作码未定义、wide修饰了不能加宽的指令、switch的表头非法（low > high、npairs < 0）
+// 或指令超出code_length时返回0
+constexpr uint32_t instruction_length(const uint8_t* code, uint32_t code_length, uint32_t pc) {
+    if (pc >= code_length) return 0;
+    const OpcodeInfo& info = opcode_info(code[pc]);
+    if (!info.valid()) return 0;
+
+    uint64_t length = info.length;
+    switch (info.layout) {
+        case OperandLayout::TABLESWITCH: {
+            uint32_t base = (pc + 4) & ~3u;
+            if (static_cast<uint64_t>(base) + 12 > code_length) return 0;
+            int32_t low = detail::code_s4(code, base + 4);
+            int32_t high = detail::code_s4(code, base + 8);
+            if (low > high) return 0;
+            length = (base - pc) + 12 + 4 * (static_cast<uint64_t>(static_cast<int64_t>(high) - low) + 1);
+            break;
+        }
+        case OperandLayout::LOOKUPSWITCH: {
+            uint32_t base = (pc + 4) & ~3u;
+            if (static_cast<uint64_t>(base) + 8 > code_length) return 0;
+            int32_t npairs = detail::code_s4(code, base + 4);
+            if (npairs < 0) return 0;
+            length = (base - pc) + 8 + 8 * static_cast<uint64_t>(npairs);
+            break;
+        }
+        case OperandLayout::WIDE: {
+            if (pc + 1 >= code_length) return 0;
+            const OpcodeInfo& modified = opcode_info(code[pc + 1]);
+            if (modified.layout == OperandLayout::IINC) {
+                length = 6;
+            } else if (modified.layout == OperandLayout::LOCAL) {
+                length = 4;
+            } else {
+                return 0;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return static_cast<uint64_t>(pc) + length <= code_length ? static_cast<uint32_t>(length) : 0;
+}
+
+} // namespace instructions
+} // namespace jvm
@@ -1,12 +1,17 @@
 #pragma once
 
-#include 
+#include <memory>
+
+#include "../base/instructions.h"
 
 namespace jvm {
 namespace instructions {
 
-class NOP{};
-
+// 0x00 nop：什么都不做
+class NOP : public NoOperandsInstruction {
+public:
+    void execute(std::shared_ptr<Frame> /*p_frame*/) override {}
+};
 
 } // namespace instructions
 } // namespace jvm
@@ -1,9 +1,18 @@
 #pragma once
 
-#include <iostream>
-#include <cstdio>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 // enum
 enum LEVEL
@@ -15,16 +24,205 @@ enum LEVEL
     FATAL
 };
 
-#define DEFAULT_LEVEL DEBUG
+// 编译期日志级别：低于它的LOG整条语句在编译期丢弃，参数也不求值
+// 编译时可用 -DLOG_LEVEL=WARNING 之类覆盖
+#ifndef LOG_LEVEL
+#define LOG_LEVEL DEBUG
+#endif
+
+#define DEFAULT_LEVEL LOG_LEVEL
 
-#define LOGBUFFERSIZE 1024
+#define LOGBUFFERSIZE 256       // 每个线程环形缓冲区的记录数
+#define LOGMESSAGESIZE 256      // 单条消息的最大长度（含结尾0），超出部分截断
 #define TMBUFSIZE 32
 
+namespace util
+{
+    /**
+     * @brief 异步日志
+     * 调用线程只格式化消息正文，连同粗粒度时间戳、文件、行号写进本线程的单生产者/单消费者
+     * 无锁环形缓冲区；后台线程轮询所有缓冲区，加上时间前缀后批量写stdout。
+     * 同一线程的日志保持顺序，不同线程之间按后台线程取到的先后输出。
+     * FATAL会等缓冲区清空再返回，进程退出时（atexit）停止后台线程并同步写完剩余记录，
+     * 之后的日志直接同步输出。
+     */
+    class Logger
+    {
+    public:
+        static Logger& instance()
+        {
+            // 故意不析构：其他静态对象析构时仍可能写日志
+            static Logger* p_logger = new Logger();
+            return *p_logger;
+        }
+
+        void log(LEVEL level, const char* file, int line, const char* format, ...)
+            __attribute__((format(printf, 5, 6)))
+        {
+            Ring& ring = local_ring();
+            size_t tail = ring.tail.load(std::memory_order_relaxed);
+            while (tail - ring.head.load(std::memory_order_acquire) >= LOGBUFFERSIZE) {
+                if (!_running.load(std::memory_order_acquire)) {
+                    drain_all();
+                    continue;
+                }
+                std::this_thread::yield(); // 缓冲区满，等后台线程取走
+            }
+
+            Record& record = ring.records[tail % LOGBUFFERSIZE];
+            record.seconds = _now.load(std::memory_order_relaxed);
+            record.file = file;
+            record.line = line;
+            va_list args;
+            va_start(args, format);
+            vsnprintf(record.message, LOGMESSAGESIZE, format, args);
+            va_end(args);
+            ring.tail.store(tail + 1, std::memory_order_release);
+
+            if (level >= FATAL || !_running.load(std::memory_order_acquire)) {
+                flush();
+            }
+        }
+
+        // 等待当前所有已提交的记录写出
+        void flush()
+        {
+            if (!_running.load(std::memory_order_acquire)) {
+                drain_all();
+                return;
+            }
+            uint64_t target = _drain_count.load(std::memory_order_acquire) + 2;
+            while (_drain_count.load(std::memory_order_acquire) < target &&
+                   _running.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+
+    private:
+        struct Record
+        {
+            int64_t seconds;
+            const char* file;
+            int line;
+            char message[LOGMESSAGESIZE];
+        };
+
+        // 单生产者（所属线程）/单消费者（后台线程）
+        struct Ring
+        {
+            alignas(64) std::atomic<size_t> head{0};
+            alignas(64) std::atomic<size_t> tail{0};
+            Record records[LOGBUFFERSIZE];
+        };
+
+        Logger() : _now(time(NULL)), _running(true), _drain_count(0)
+        {
+            _worker = std::thread([this] { run(); });
+            std::atexit([] { instance().shutdown(); });
+        }
+
+        // 线程退出后shared_ptr只剩注册表持有，后台线程取空后回收
+        Ring& local_ring()
+        {
+            thread_local std::shared_ptr<Ring> t_ring;
+            if (!t_ring) {
+                t_ring = std::make_shared<Ring>();
+                std::lock_guard<std::mutex> lock(_rings_mutex);
+                _rings.push_back(t_ring);
+            }
+            return *t_ring;
+        }
+
+        void run()
+        {
+            auto idle = std::chrono::microseconds(100);
+            while (_running.load(std::memory_order_acquire)) {
+                _now.store(time(NULL), std::memory_order_relaxed);
+                bool wrote = drain_all();
+                _drain_count.fetch_add(1, std::memory_order_acq_rel);
+                if (wrote) {
+                    idle = std::chrono::microseconds(100);
+                } else {
+                    std::this_thread::sleep_for(idle);
+                    idle = std::min(idle * 2, std::chrono::microseconds(10000));
+                }
+            }
+        }
+
+        void shutdown()
+        {
+            if (!_running.exchange(false)) return;
+            _worker.join();
+            drain_all();
+        }
+
+        // 取出所有缓冲区中的记录写到stdout，返回是否写了内容
+        bool drain_all()
+        {
+            std::lock_guard<std::mutex> drain_lock(_drain_mutex);
+            std::vector<std::shared_ptr<Ring>> rings;
+            {
+                std::lock_guard<std::mutex> lock(_rings_mutex);
+                rings = _rings;
+            }
+
+            bool wrote = false;
+            for (const auto& p_ring : rings) {
+                size_t head = p_ring->head.load(std::memory_order_relaxed);
+                size_t tail = p_ring->tail.load(std::memory_order_acquire);
+                for (; head != tail; ++head) {
+                    write(p_ring->records[head % LOGBUFFERSIZE]);
+                    wrote = true;
+                }
+                p_ring->head.store(head, std::memory_order_release);
+            }
+            if (wrote) {
+                fflush(stdout);
+            }
+
+            std::lock_guard<std::mutex> lock(_rings_mutex);
+            for (size_t i = 0; i < _rings.size(); ) {
+                // 注册表 + 上面的快照各持有一份，=2说明所属线程已退出
+                if (_rings[i].use_count() <= 2 &&
+                    _rings[i]->head.load(std::memory_order_relaxed) == _rings[i]->tail.load(std::memory_order_acquire)) {
+                    _rings[i] = std::move(_rings.back());
+                    _rings.pop_back();
+                } else {
+                    ++i;
+                }
+            }
+            return wrote;
+        }
+
+        // 时间前缀按秒缓存，同一秒内的记录不重复调用localtime_r/strftime
+        void write(const Record& record)
+        {
+            if (record.seconds != _formatted_seconds) {
+                time_t t = static_cast<time_t>(record.seconds);
+                struct tm lt;
+                localtime_r(&t, &lt);
+                strftime(_time_buf, TMBUFSIZE - 1, "%H:%M:%S", &lt);
+                _formatted_seconds = record.seconds;
+            }
+            fprintf(stdout, "[%s %s:%d] %s\n", _time_buf, record.file, record.line, record.message);
+        }
+
+        std::atomic<int64_t> _now;          // 后台线程每轮刷新的粗粒度时间（秒）
+        std::atomic<bool> _running;
+        std::atomic<uint64_t> _drain_count;
+        std::thread _worker;
+
+        std::mutex _rings_mutex;
+        std::vector<std::shared_ptr<Ring>> _rings;
+
+        std::mutex _drain_mutex;            // 只有一个消费者在取
+        int64_t _formatted_seconds = -1;
+        char _time_buf[TMBUFSIZE] = {0};
+    };
+} // namespace util
+
 #define LOG(level, format, ...) do{\
-    if (level < DEFAULT_LEVEL) break;\
-    time_t t = time(NULL);\
-    struct tm *lt = localtime(&t);\
-    char buf[32] = {0};\
-    strftime(buf, 31, "%H:%M:%S", lt);\
-    fprintf(stdout, "[%s %s:%d] " format "\n", buf, __FILE__, __LINE__, ##__VA_ARGS__);\
+    if constexpr ((level) >= LOG_LEVEL) {\
+        ::util::Logger::instance().log(level, __FILE__, __LINE__, format, ##__VA_ARGS__);\
+    }\
 }while(0)
@@ -4,6 +4,9 @@
 #include "cmd.hpp"
 #include "classpath/class_path.hpp"
 #include "classfile/class_file.hpp"
+#include "classloader/class_inspector.hpp"
+#include "classloader/verifier.hpp"
+#include "rtda/heap.hpp"
 
 using namespace jvm;
 using namespace jvm::classpath;
@@ -68,6 +71,17 @@ void startJVM(const Cmd& cmd)
 
     ClassPath cp(jre_path, classpath);
 
+    rtda::Heap::install(std::make_shared<rtda::Heap>(cmd.get_initial_heap_size(), cmd.get_max_heap_size(),
+                                                     cmd.get_parallel_gc_threads(),
+                                                     cmd.get_initiating_heap_occupancy_percent(),
+                                                     cmd.get_max_gc_pause_millis()));
+
+    classloader::Verifier::install(std::make_shared<classloader::Verifier>());
+
+    if (!cmd.get_parse_cache_dir().empty()) {
+        ParseCache::install(std::make_shared<ParseCache>(cmd.get_parse_cache_dir()));
+    }
+
     // Here you would typically initialize the JVM using JNI or similar APIs
     // For demonstration, we will just print the parameters
     std::cout << "Starting JVM with classpath: " << cp.to_string() << std::endl;
@@ -123,6 +137,12 @@ int main(int argc, char* argv[])
 
     // cmd.test_parse_args();
 
+    if(cmd.is_inspect()) {
+        classloader::ClassInspector inspector(cmd.is_inspect_table() ? classloader::InspectFormat::TABLE
+                                                                     : classloader::InspectFormat::JSON);
+        return inspector.inspect(cmd.get_inspect_paths(), stdout) ? 0 : 1;
+    }
+
     try{
         startJVM(cmd);
     }
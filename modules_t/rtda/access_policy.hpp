@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "../log.hpp"
+
+namespace jvm {
+namespace rtda {
+
+// 局部变量表/操作数栈的访问策略，作为BasicLocalVars/BasicOperandStack的模板参数。
+// 同一份实现实例化两次：Checked用于未验证的代码和调试，每次访问检查越界并抛异常；
+// Unchecked用于已通过验证的方法，验证器已经证明不会越界，检查全部在编译期消失
+#define RTDA_INLINE inline __attribute__((always_inline))
+
+struct CheckedAccess {
+    static constexpr bool CHECKED = true;
+
+    static void overflow(const char* what) {
+        LOG(ERROR, "%s overflow", what);
+        throw std::out_of_range(std::string(what) + " overflow");
+    }
+    static void underflow(const char* what) {
+        LOG(ERROR, "%s underflow", what);
+        throw std::out_of_range(std::string(what) + " underflow");
+    }
+
+    // 还能压入count个槽位
+    static RTDA_INLINE void check_push(size_t top, size_t count, size_t size) {
+        if (count > size - top) overflow("OperandStack");
+    }
+    // 至少还有count个槽位可弹出
+    static RTDA_INLINE void check_pop(size_t top, size_t count) {
+        if (top < count) underflow("OperandStack");
+    }
+    // [index, index + count) 落在局部变量表内
+    static RTDA_INLINE void check_index(size_t index, size_t count, size_t max_locals) {
+        if (index > max_locals || count > max_locals - index) overflow("LocalVars");
+    }
+};
+
+struct UncheckedAccess {
+    static constexpr bool CHECKED = false;
+
+    static RTDA_INLINE void check_push(size_t, size_t, size_t) {}
+    static RTDA_INLINE void check_pop(size_t, size_t) {}
+    static RTDA_INLINE void check_index(size_t, size_t, size_t) {}
+};
+
+// 解释器按方法的验证状态选择策略：fn以策略对象为参数，两种实例都会生成
+template <typename Fn>
+decltype(auto) with_access_policy(bool verified, Fn&& fn) {
+    if (verified) {
+        return std::forward<Fn>(fn)(UncheckedAccess{});
+    }
+    return std::forward<Fn>(fn)(CheckedAccess{});
+}
+
+} // namespace rtda
+} // namespace jvm
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "object.hpp"
+#include "array_type.hpp"
+#include "class.hpp"
+
+namespace jvm {
+namespace rtda {
+
+// Java数组对象：对象头(16) + 长度(4) + 填充，元素从第32字节开始按自然宽度紧密存放。
+// 数组对象本身按32字节对齐分配，于是元素区也是32字节对齐的，批量处理（填充、拷贝、比较）可以向量化。
+// *aload/*astore只做一次无符号比较的越界检查，然后是一次按类型的读写
+class ArrayObject : public Object {
+public:
+    static constexpr uint32_t ALIGNMENT = 32;
+    static constexpr uint32_t DATA_OFFSET = 32;
+
+    // 长度为length的type数组需要的字节数（向上取整到ALIGNMENT）；length为负时抛NegativeArraySizeException
+    static size_t allocationSize(ArrayType type, int32_t length) {
+        if (length < 0) {
+            throw std::runtime_error("java.lang.NegativeArraySizeException: " + std::to_string(length));
+        }
+        size_t bytes = DATA_OFFSET + static_cast<size_t>(length) * array_element_size(type);
+        return (bytes + ALIGNMENT - 1) & ~static_cast<size_t>(ALIGNMENT - 1);
+    }
+
+    // 在memory（ALIGNMENT对齐，至少allocationSize()字节）上构造数组，元素全部清零
+    static ArrayObject* initialize(void* memory, Class* p_array_class, int32_t length) {
+        size_t size = allocationSize(p_array_class->elementType(), length);
+        std::memset(memory, 0, size);
+        return new (memory) ArrayObject(p_array_class, length);
+    }
+
+    // 只写对象头和长度，元素保持原样（填充用的数组不需要清零）
+    static ArrayObject* initializeHeader(void* memory, Class* p_array_class, int32_t length) {
+        return new (memory) ArrayObject(p_array_class, length);
+    }
+
+    // newarray：atype取指令操作数
+    static ArrayObject* initializePrimitive(void* memory, uint8_t atype, int32_t length) {
+        return initialize(memory, Class::primitiveArrayClass(static_cast<ArrayType>(atype)), length);
+    }
+
+    // arraylength
+    int32_t length() const { return _length; }
+    ArrayType elementType() const { return getClass()->elementType(); }
+
+    template <typename T>
+    T* elements() {
+        return static_cast<T*>(__builtin_assume_aligned(reinterpret_cast<char*>(this) + DATA_OFFSET, ALIGNMENT));
+    }
+    template <typename T>
+    const T* elements() const {
+        return static_cast<const T*>(__builtin_assume_aligned(reinterpret_cast<const char*>(this) + DATA_OFFSET, ALIGNMENT));
+    }
+
+    // *aload / *astore，T与数组元素类型一致：
+    // baload用int8_t（boolean数组同样按字节存取），caload用uint16_t，saload用int16_t，
+    // iaload用int32_t，laload用int64_t，faload用float，daload用double，aaload用Object*
+    template <typename T>
+    T get(int32_t index) const {
+        checkIndex(index);
+        return elements<T>()[index];
+    }
+
+    // aastore（T为Object*）和putfield一样经过SATB写前屏障和卡表写屏障
+    template <typename T>
+    void set(int32_t index, T value) {
+        checkIndex(index);
+        if constexpr (std::is_same<T, Object*>::value) {
+            Object** p_element = &elements<T>()[index];
+            gc::pre_write_barrier(p_element);
+            __atomic_store_n(p_element, value, __ATOMIC_RELAXED);
+            gc::post_write_barrier(p_element);
+        } else {
+            elements<T>()[index] = value;
+        }
+    }
+
+    // System.arraycopy：区间检查一次，然后整段memmove（允许src和dest是同一个数组）。
+    // 引用数组只处理元素类型相同的情况，逐个元素的类型检查由调用者负责
+    static void copy(const ArrayObject* src, int32_t src_pos, ArrayObject* dest, int32_t dest_pos, int32_t count) {
+        if (src->elementType() != dest->elementType()) {
+            throw std::runtime_error("java.lang.ArrayStoreException: type mismatch");
+        }
+        if (count < 0 || src_pos < 0 || dest_pos < 0 ||
+            src_pos > src->_length - count || dest_pos > dest->_length - count) {
+            throw std::runtime_error("java.lang.ArrayIndexOutOfBoundsException: arraycopy out of bounds");
+        }
+        uint32_t size = array_element_size(src->elementType());
+        if (src->elementType() == ArrayType::REFERENCE) {
+            gc::pre_write_barrier_range(dest->elements<Object*>() + dest_pos, static_cast<size_t>(count));
+        }
+        std::memmove(dest->elements<char>() + static_cast<size_t>(dest_pos) * size,
+                     src->elements<char>() + static_cast<size_t>(src_pos) * size,
+                     static_cast<size_t>(count) * size);
+        if (src->elementType() == ArrayType::REFERENCE) {
+            gc::post_write_barrier_range(dest->elements<char>() + static_cast<size_t>(dest_pos) * size,
+                                         static_cast<size_t>(count) * size);
+        }
+    }
+
+private:
+    ArrayObject(Class* p_array_class, int32_t length) : Object(p_array_class), _length(length) {}
+
+    void checkIndex(int32_t index) const {
+        // 负数转成无符号后一定大于长度，一次比较同时检查两端
+        if (__builtin_expect(static_cast<uint32_t>(index) >= static_cast<uint32_t>(_length), 0)) {
+            throw std::runtime_error("java.lang.ArrayIndexOutOfBoundsException: Index " + std::to_string(index) +
+                                     " out of bounds for length " + std::to_string(_length));
+        }
+    }
+
+    int32_t _length;
+    uint32_t _reserved[3];  // 填充到DATA_OFFSET
+};
+
+static_assert(sizeof(ArrayObject) == ArrayObject::DATA_OFFSET, "array elements must start at DATA_OFFSET");
+
+// 对象在堆中占的字节数，遍历堆时按它跳到下一个对象
+inline size_t object_size(const Object* p_object) {
+    const Class* p_class = p_object->getClass();
+    if (p_class->isArray()) {
+        return ArrayObject::allocationSize(p_class->elementType(), static_cast<const ArrayObject*>(p_object)->length());
+    }
+    return p_class->instanceSize();
+}
+
+} // namespace rtda
+} // namespace jvm
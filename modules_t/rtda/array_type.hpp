@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace jvm {
+namespace rtda {
+
+class Object;
+
+// 数组元素类型，基本类型的取值与newarray指令的atype操作数相同（JVMS 6.5.newarray）
+enum class ArrayType : uint8_t {
+    NONE = 0,           // 不是数组
+    REFERENCE = 1,      // anewarray / multianewarray
+    BOOLEAN = 4,
+    CHAR = 5,
+    FLOAT = 6,
+    DOUBLE = 7,
+    BYTE = 8,
+    SHORT = 9,
+    INT = 10,
+    LONG = 11,
+};
+
+constexpr size_t ARRAY_TYPE_COUNT = 12;
+
+// newarray的atype是否合法
+constexpr bool is_primitive_array_type(uint8_t atype) {
+    return atype >= static_cast<uint8_t>(ArrayType::BOOLEAN) && atype <= static_cast<uint8_t>(ArrayType::LONG);
+}
+
+// 元素按自然宽度紧密存放：boolean/byte 1字节，char/short 2字节，int/float 4字节，long/double 8字节
+constexpr uint32_t array_element_size(ArrayType type) {
+    switch (type) {
+        case ArrayType::BOOLEAN:
+        case ArrayType::BYTE: return 1;
+        case ArrayType::CHAR:
+        case ArrayType::SHORT: return 2;
+        case ArrayType::INT:
+        case ArrayType::FLOAT: return 4;
+        case ArrayType::LONG:
+        case ArrayType::DOUBLE: return 8;
+        case ArrayType::REFERENCE: return sizeof(Object*);
+        default: return 0;
+    }
+}
+
+constexpr char array_type_descriptor(ArrayType type) {
+    switch (type) {
+        case ArrayType::BOOLEAN: return 'Z';
+        case ArrayType::CHAR: return 'C';
+        case ArrayType::FLOAT: return 'F';
+        case ArrayType::DOUBLE: return 'D';
+        case ArrayType::BYTE: return 'B';
+        case ArrayType::SHORT: return 'S';
+        case ArrayType::INT: return 'I';
+        case ArrayType::LONG: return 'J';
+        default: return 'L';
+    }
+}
+
+} // namespace rtda
+} // namespace jvm
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../classfile/class_file.hpp"
+#include "../classfile/method_descriptor.hpp"
+#include "../classloader/verifier.hpp"
+#include "object.hpp"
+#include "array_type.hpp"
+
+namespace jvm {
+namespace rtda {
+
+// 实例字段在对象中的位置
+struct FieldLayout {
+    uint32_t offset;
+    classfile::ValueKind kind;
+};
+
+// 一段连续的引用字段，GC扫描对象时按区间遍历，不需要逐个字段判断类型
+struct ReferenceRange {
+    uint32_t offset;
+    uint32_t count;
+};
+
+// 该类型的字段在对象中占的字节数
+constexpr uint32_t field_bytes(classfile::ValueKind kind) {
+    switch (kind) {
+        case classfile::ValueKind::BOOLEAN:
+        case classfile::ValueKind::BYTE: return 1;
+        case classfile::ValueKind::CHAR:
+        case classfile::ValueKind::SHORT: return 2;
+        case classfile::ValueKind::INT:
+        case classfile::ValueKind::FLOAT: return 4;
+        case classfile::ValueKind::LONG:
+        case classfile::ValueKind::DOUBLE: return 8;
+        case classfile::ValueKind::REFERENCE: return sizeof(Object*);
+        default: return 0;
+    }
+}
+
+// 运行时类：对象头里的类指针指向它。
+// 链接时计算实例字段布局：父类字段在前，本类字段按大小分组依次排列——
+// 引用在最前面（与父类的引用区间相邻时合并），然后是8/4/2/1字节的基本类型，
+// 每组只在组首对齐，组内没有填充。静态字段按同样的规则放在类自己的静态区里
+class Class {
+public:
+    // hierarchy是定义这个类的类加载器的类层次，链接时按它验证
+    Class(std::shared_ptr<classfile::ClassFile> p_class_file, Class* p_super,
+          const classloader::ClassHierarchy& hierarchy = classloader::ClassHierarchy::bootstrap())
+        : _p_class_file(std::move(p_class_file)), _p_super(p_super), _p_hierarchy(&hierarchy),
+          _name(_p_class_file->class_name()) {}
+
+    // 数组类：没有类文件，名字是描述符形式（[I、[[J、[Ljava/lang/String;），
+    // 引用数组的p_component是元素类，基本类型数组为nullptr
+    Class(std::string name, ArrayType element_type, Class* p_component)
+        : _p_super(nullptr), _name(std::move(name)),
+          _element_type(element_type), _p_component(p_component) {}
+
+    Class(const Class&) = delete;
+    Class& operator=(const Class&) = delete;
+
+    ~Class() {
+        if (!_static_reference_ranges.empty()) {
+            StaticRegistry& registry = static_registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.classes.erase(std::remove(registry.classes.begin(), registry.classes.end(), this),
+                                   registry.classes.end());
+        }
+    }
+
+    const std::string& name() const { return _name; }
+    Class* superClass() const { return _p_super; }
+    // 数组类没有类文件，调用前先检查isArray()
+    const classfile::ClassFile& classFile() const { return *_p_class_file; }
+
+    bool isArray() const { return _element_type != ArrayType::NONE; }
+    ArrayType elementType() const { return _element_type; }
+    Class* componentClass() const { return _p_component; }
+
+    // 基本类型数组类（[I等），进程内单例；type不能是REFERENCE或NONE
+    static Class* primitiveArrayClass(ArrayType type) {
+        static Class* classes[ARRAY_TYPE_COUNT] = {};
+        static std::once_flag once;
+        std::call_once(once, [] {
+            for (ArrayType t : {ArrayType::BOOLEAN, ArrayType::CHAR, ArrayType::FLOAT, ArrayType::DOUBLE,
+                                ArrayType::BYTE, ArrayType::SHORT, ArrayType::INT, ArrayType::LONG}) {
+                classes[static_cast<size_t>(t)] = new Class(std::string("[") + array_type_descriptor(t), t, nullptr);
+            }
+        });
+        return classes[static_cast<size_t>(type)];
+    }
+
+    // 以本类为元素的数组类（anewarray），第一次调用时创建，之后返回同一个
+    Class* arrayClass() {
+        std::call_once(_array_class_once, [this] {
+            std::string name = isArray() ? "[" + _name : "[L" + _name + ";";
+            _p_array_class.reset(new Class(std::move(name), ArrayType::REFERENCE, this));
+        });
+        return _p_array_class.get();
+    }
+
+    // 链接：先链接父类，再建成员查找表、验证方法并算出GC用的引用位图、计算实例布局；
+    // 只执行一次，可以并发调用。验证失败抛出java.lang.VerifyError，之后再调用会重试
+    void link() {
+        std::call_once(_link_once, [this] {
+            if (_p_super) {
+                _p_super->link();
+            }
+            if (_p_class_file) {
+                _p_class_file->link();
+                verify();
+                compute_layout();
+            }
+        });
+    }
+
+    // 对象总大小（含对象头），8字节对齐
+    uint32_t instanceSize() const { return _instance_size; }
+    const std::vector<ReferenceRange>& referenceRanges() const { return _reference_ranges; }
+
+    // 按名字和描述符解析实例字段，本类没有时沿父类向上找；找不到返回nullptr
+    const FieldLayout* findInstanceField(std::string_view name, std::string_view descriptor) const {
+        for (const Class* p_class = this; p_class != nullptr; p_class = p_class->_p_super) {
+            if (!p_class->_p_class_file) continue;
+            const classfile::MemberInfo* p_field = p_class->_p_class_file->find_field(name, descriptor);
+            if (p_field != nullptr) {
+                auto it = p_class->_fields.find(p_field);
+                return it == p_class->_fields.end() ? nullptr : &it->second;
+            }
+        }
+        return nullptr;
+    }
+
+    // 按名字和描述符解析本类声明的静态字段，偏移相对于staticData()；找不到返回nullptr
+    const FieldLayout* findStaticField(std::string_view name, std::string_view descriptor) const {
+        if (!_p_class_file) return nullptr;
+        const classfile::MemberInfo* p_field = _p_class_file->find_field(name, descriptor);
+        if (p_field == nullptr) return nullptr;
+        auto it = _static_fields.find(p_field);
+        return it == _static_fields.end() ? nullptr : &it->second;
+    }
+
+    // 静态字段区（getstatic/putstatic），链接后分配并清零；没有静态字段时为nullptr
+    char* staticData() const { return reinterpret_cast<char*>(_p_static_data.get()); }
+    const std::vector<ReferenceRange>& staticReferenceRanges() const { return _static_reference_ranges; }
+
+    // 依次访问所有已链接类的静态引用字段（Object**），GC扫描根时在安全点调用
+    template <typename F>
+    static void forEachStaticReference(F&& fn) {
+        StaticRegistry& registry = static_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (Class* p_class : registry.classes) {
+            for (const ReferenceRange& range : p_class->_static_reference_ranges) {
+                Object** p_refs = reinterpret_cast<Object**>(p_class->staticData() + range.offset);
+                for (uint32_t i = 0; i < range.count; i++) {
+                    fn(&p_refs[i]);
+                }
+            }
+        }
+    }
+
+    // 在memory（至少instanceSize()字节，8字节对齐）上构造本类的实例，字段全部清零
+    Object* initializeObject(void* memory) {
+        std::memset(memory, 0, _instance_size);
+        return new (memory) Object(this);
+    }
+
+private:
+    static uint32_t align_up(uint32_t value, uint32_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    // 用进程级的验证器验证全部方法，同时给每个Code属性写入verified位和引用位图
+    void verify() {
+        classloader::Verifier* p_verifier = classloader::Verifier::instance();
+        if (p_verifier == nullptr) {
+            throw std::runtime_error("java.lang.InternalError: no verifier installed");
+        }
+        classloader::ClassVerifyResult result = p_verifier->verify_class(*_p_class_file, *_p_hierarchy);
+        if (!result.verified) {
+            throw std::runtime_error("java.lang.VerifyError: " + _name + "." + result.method + " at pc " +
+                                     std::to_string(result.error.pc) + ": " + result.error.message);
+        }
+    }
+
+    void compute_layout() {
+        uint32_t offset = Object::HEADER_SIZE;
+        if (_p_super) {
+            offset = _p_super->_instance_size;
+            _reference_ranges = _p_super->_reference_ranges;
+        }
+        _instance_size = align_up(layout_fields(false, offset, _reference_ranges, _fields), 8);
+
+        // 静态字段按同样的规则排在类自己的静态区里，从0开始，不继承
+        uint32_t static_size = layout_fields(true, 0, _static_reference_ranges, _static_fields);
+        if (static_size > 0) {
+            _p_static_data.reset(new uint64_t[(static_size + 7) / 8]());
+        }
+        if (!_static_reference_ranges.empty()) {
+            StaticRegistry& registry = static_registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.classes.push_back(this);
+        }
+    }
+
+    // 把本类声明的实例字段或静态字段从offset开始排好，返回末尾偏移
+    uint32_t layout_fields(bool is_static, uint32_t offset, std::vector<ReferenceRange>& ranges,
+                           std::unordered_map<const classfile::MemberInfo*, FieldLayout>& fields) {
+        // 按字节数分组：引用、8、4、2、1
+        std::vector<std::pair<const classfile::MemberInfo*, classfile::ValueKind>> groups[5];
+        for (const auto& p_field : _p_class_file->fields()) {
+            if (((p_field->access_flags() & 0x0008) != 0) != is_static) continue;    // ACC_STATIC
+            const std::string* p_descriptor = _p_class_file->constant_pool().find_utf8(p_field->descriptor_index());
+            classfile::ValueKind kind = p_descriptor ? classfile::field_kind(*p_descriptor) : classfile::ValueKind::VOID;
+            if (kind == classfile::ValueKind::VOID) continue;
+            size_t group = kind == classfile::ValueKind::REFERENCE ? 0 : group_of(field_bytes(kind));
+            groups[group].emplace_back(p_field.get(), kind);
+        }
+
+        for (const auto& group : groups) {
+            if (group.empty()) continue;
+            uint32_t size = field_bytes(group.front().second);
+            offset = align_up(offset, size);
+            if (group.front().second == classfile::ValueKind::REFERENCE) {
+                add_reference_range(ranges, offset, static_cast<uint32_t>(group.size()));
+            }
+            for (const auto& [p_field, kind] : group) {
+                fields.emplace(p_field, FieldLayout{offset, kind});
+                offset += size;
+            }
+        }
+        return offset;
+    }
+
+    static size_t group_of(uint32_t bytes) {
+        switch (bytes) {
+            case 8: return 1;
+            case 4: return 2;
+            case 2: return 3;
+            default: return 4;
+        }
+    }
+
+    static void add_reference_range(std::vector<ReferenceRange>& ranges, uint32_t offset, uint32_t count) {
+        if (!ranges.empty()) {
+            ReferenceRange& last = ranges.back();
+            if (last.offset + last.count * sizeof(Object*) == offset) {
+                last.count += count;
+                return;
+            }
+        }
+        ranges.push_back(ReferenceRange{offset, count});
+    }
+
+    // 有静态引用字段的已链接类，GC把它们的静态引用当作根
+    struct StaticRegistry {
+        std::mutex mutex;
+        std::vector<Class*> classes;
+    };
+
+    static StaticRegistry& static_registry() {
+        static StaticRegistry registry;
+        return registry;
+    }
+
+    std::shared_ptr<classfile::ClassFile> _p_class_file;
+    Class* _p_super;
+    const classloader::ClassHierarchy* _p_hierarchy = nullptr;
+    std::string _name;
+
+    ArrayType _element_type = ArrayType::NONE;
+    Class* _p_component = nullptr;
+    std::once_flag _array_class_once;
+    std::unique_ptr<Class> _p_array_class;
+
+    std::once_flag _link_once;
+    uint32_t _instance_size = Object::HEADER_SIZE;
+    std::vector<ReferenceRange> _reference_ranges;
+    std::unordered_map<const classfile::MemberInfo*, FieldLayout> _fields;
+
+    std::unique_ptr<uint64_t[]> _p_static_data;
+    std::vector<ReferenceRange> _static_reference_ranges;
+    std::unordered_map<const classfile::MemberInfo*, FieldLayout> _static_fields;
+};
+
+} // namespace rtda
+} // namespace jvm
@@ -1,4 +1,3 @@
-<<<<<<< HEAD
 #pragma once
 
 #include <memory>
@@ -6,54 +5,59 @@
 
 #include "local_vars.h"
 #include "operand_stack.h"
+#include "../classfile/attribute_info.hpp"
 
 namespace jvm {
+namespace classfile {
+class MemberInfo;
+}
+
 namespace rtda {
 
+class Class;
+
 class Frame{
 public:
-    Frame(const size_t& max_lac_size, const size_t& max_op_size) 
-        : _local_vars(max_lac_size), 
-          _p_operand_stack(std::make_shared<OperandStack>(max_op_size)) {};
-
-    Frame(const Frame&) = delete; // 禁止拷贝构造
-    Frame& operator=(const Frame&) = delete; // 禁止赋值操作
-    Frame(Frame&&) = default; // 允许移动构造
-    Frame& operator=(Frame&&) = default; // 允许移动赋值
-    ~Frame() = default;
-
-    LocalVars& getLoaclVars() {
-        return _local_vars;
+    // 自带存储的栈帧
+    Frame(const size_t& max_lac_size, const size_t& max_op_size)
+        : _local_vars(max_lac_size),
+          _operand_stack(max_op_size),
+          _p_slab_mark(nullptr) {};
+
+    // 建在FrameSlab上的栈帧：局部变量表从locals开始，操作数栈紧随其后；
+    // slab_mark是分配前槽位区的栈顶，帧返回时退回到这里
+    Frame(Slot* locals, uint16_t max_locals, uint16_t max_stack, Slot* slab_mark)
+        : _local_vars(locals, max_locals),
+          _operand_stack(locals + max_locals, max_stack),
+          _p_slab_mark(slab_mark) {}
+
+    // 空帧，供JvmStack的帧池预先分配，使用前由reset()指向槽位区
+    Frame() : _p_slab_mark(nullptr) {}
+
+    // 大小取自方法的CodeAttribute，同时记下方法是否已通过验证，决定执行时的访问策略
+    void reset(Slot* locals, const classfile::CodeAttribute& code, Slot* slab_mark) {
+        _local_vars.reset(locals, code.getMaxLocals());
+        _operand_stack.reset(locals + code.getMaxLocals(), code.getMaxStack());
+        _p_slab_mark = slab_mark;
+        _verified = code.isVerified();
+        _p_class = nullptr;
+        _p_method = nullptr;
+        _pc = 0;
     }
 
-    std::shared_ptr<OperandStack> getOperandStack() {
-        return _p_operand_stack;
+    // 正在执行的方法。GC按方法字节码在pc处的类型状态找出哪些槽位是引用，
+    // 没有绑定方法的帧不参与根扫描，不能持有堆中的对象
+    void setMethod(const Class* p_class, const classfile::MemberInfo* p_method) {
+        _p_class = p_class;
+        _p_method = p_method;
     }
+    const Class* getClass() const { return _p_class; }
+    const classfile::MemberInfo* getMethod() const { return _p_method; }
 
-private:
-    LocalVars _local_vars;
-    std::shared_ptr<OperandStack> _p_operand_stack;
-};
-
-} // namespace rtda
-} // namespace jvm
-=======
-#pragma once
-
-#include <memory>
-#include <stdexcept>
-
-#include "local_vars.h"
-#include "operand_stack.h"
-
-namespace jvm {
-namespace rtda {
-
-class Frame{
-public:
-    Frame(const size_t& max_lac_size, const size_t& max_op_size) 
-        : _local_vars(max_lac_size), 
-          _p_operand_stack(std::make_shared<OperandStack>(max_op_size)) {};
+    // 当前指令的pc。解释器在可能触发GC的指令（分配、调用、安全点检查）之前写回这里，
+    // 并且先弹出该指令的操作数再分配
+    uint32_t getPC() const { return _pc; }
+    void setPC(uint32_t pc) { _pc = pc; }
 
     Frame(const Frame&) = delete; // 禁止拷贝构造
     Frame& operator=(const Frame&) = delete; // 禁止赋值操作
@@ -65,15 +69,48 @@ public:
         return _local_vars;
     }
 
-    std::shared_ptr<OperandStack> getOperandStack() {
-        return _p_operand_stack;
+    OperandStack& getOperandStack() {
+        return _operand_stack;
+    }
+
+    Slot* slabMark() const { return _p_slab_mark; }
+
+    bool isVerified() const { return _verified; }
+
+    // 按方法的验证状态选择访问策略执行fn(locals, stack)：参数是本帧局部变量表和操作数栈的视图，
+    // 已验证的方法拿到UncheckedAccess的视图，越界检查在编译期去掉。
+    // fn返回（或抛出异常）时把视图的栈顶写回帧里的操作数栈
+    template <typename Fn>
+    decltype(auto) withAccessPolicy(Fn&& fn) {
+        return with_access_policy(_verified, [&](auto policy) -> decltype(auto) {
+            using Policy = decltype(policy);
+            BasicLocalVars<Policy> locals(_local_vars);
+            BasicOperandStack<Policy> stack(_operand_stack);
+            struct SyncBack {
+                OperandStack& frame_stack;
+                BasicOperandStack<Policy>& view;
+                ~SyncBack() { frame_stack.syncFrom(view); }
+            } sync{_operand_stack, stack};
+            return fn(locals, stack);
+        });
+    }
+
+    // 自带存储的帧从调用者操作数栈接收参数（实例方法含this），
+    // param_slots取自被调方法的MethodSignature::param_slots()，不再逐个解析描述符。
+    // 建在FrameSlab上的帧不需要：参数区就是它的局部变量表开头
+    void receiveArgs(OperandStack& caller_stack, uint16_t param_slots) {
+        _local_vars.setSlots(0, caller_stack.popSlots(param_slots), param_slots);
     }
 
 private:
     LocalVars _local_vars;
-    std::shared_ptr<OperandStack> _p_operand_stack;
+    OperandStack _operand_stack;
+    Slot* _p_slab_mark;
+    const Class* _p_class = nullptr;
+    const classfile::MemberInfo* _p_method = nullptr;
+    uint32_t _pc = 0;
+    bool _verified = false;
 };
 
 } // namespace rtda
 } // namespace jvm
->>>>>>> a8025d7fab866028dca65f3bf553e900af845786
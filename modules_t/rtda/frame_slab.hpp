@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+
+#include <sys/mman.h>
+
+#include "slot.hpp"
+
+namespace jvm {
+namespace rtda {
+
+// 线程私有的连续槽位区，所有栈帧的局部变量表和操作数栈都从这里按栈的顺序分配。
+// 一次mmap保留整段虚拟地址（MAP_NORESERVE，用到哪页才占用物理内存），
+// 分配和释放只是移动栈顶指针；被调帧的局部变量表与调用者操作数栈顶的参数区重叠，
+// 参数原地传递，不需要拷贝。
+// 新分配的槽位不清零（可能残留之前帧的值），读之前必须先写，由验证器保证
+class FrameSlab {
+public:
+    // 默认保留1M个槽位（8MB虚拟地址）
+    static const size_t DEFAULT_SLOTS = 1 << 20;
+
+    explicit FrameSlab(size_t max_slots = DEFAULT_SLOTS) : _max_slots(max_slots) {
+        void* p = mmap(nullptr, max_slots * sizeof(Slot), PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::runtime_error("Cannot reserve frame slab");
+        }
+        _base = static_cast<Slot*>(p);
+        _top = _base;
+        _limit = _base + max_slots;
+    }
+
+    FrameSlab(const FrameSlab&) = delete;
+    FrameSlab& operator=(const FrameSlab&) = delete;
+
+    ~FrameSlab() {
+        munmap(_base, _max_slots * sizeof(Slot));
+    }
+
+    Slot* top() const { return _top; }
+    size_t used() const { return static_cast<size_t>(_top - _base); }
+    size_t capacity() const { return _max_slots; }
+
+    // 从start开始占用count个槽位并把栈顶移到末尾，start可以低于当前栈顶（与调用者的参数区重叠）。
+    // 超出保留区时返回nullptr，调用者应抛出StackOverflowError
+    Slot* allocate(Slot* start, size_t count) {
+        if (start < _base || start > _top || count > static_cast<size_t>(_limit - start)) {
+            return nullptr;
+        }
+        _top = start + count;
+        return start;
+    }
+
+    // 栈顶退回到mark（分配前的top()），用于帧返回
+    void release(Slot* mark) {
+        _top = mark;
+    }
+
+private:
+    size_t _max_slots;
+    Slot* _base;
+    Slot* _top;
+    Slot* _limit;
+};
+
+} // namespace rtda
+} // namespace jvm
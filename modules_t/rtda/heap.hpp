@@ -0,0 +1,450 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../log.hpp"
+#include "object.hpp"
+#include "array_object.hpp"
+#include "class.hpp"
+#include "tlab.hpp"
+#include "thread.hpp"
+#include "../gc/concurrent_marker.hpp"
+#include "../gc/generations.hpp"
+#include "../gc/young_collector.hpp"
+#include "../gc/mark_compact.hpp"
+#include "../gc/pause_policy.hpp"
+#include "../gc/reference_map.hpp"
+#include "../gc/safepoint.hpp"
+#include "../gc/work_gang.hpp"
+
+namespace jvm {
+namespace rtda {
+
+// Java堆（分代）：启动时按-Xmx保留一整段连续的虚拟地址，划分为老年代和年轻代（见gc/generations.hpp），
+// 年轻代按-Xms的三分之一定大小，其余都归老年代，老年代按需提交。
+// 分配：
+//   1. 线程在自己的TLAB里移动指针，不加锁（newObject/newArray的快速路径）；
+//   2. TLAB用完时从eden用CAS领一块新的TLAB，无锁；
+//   3. 大对象直接在老年代分配，不进TLAB，也不在survivor之间反复复制。
+// eden满时在安全点做年轻代复制回收（-XX:ParallelGCThreads个工作线程并行）。回收前按最近几次实际晋升的字节给晋升留出空间，
+// 留不出时有候选区域就先做混合回收，否则改做整堆标记-压缩；预计偏少、回收中途晋升失败时在同一个停顿里接着整堆回收，
+// 仍然不够才抛OutOfMemoryError。
+// 老年代占用（加上晋升预留）超过-XX:InitiatingHeapOccupancyPercent后，后台线程并发标记、清扫老年代（见gc/concurrent_marker.hpp），
+// 只有初始标记（搭在年轻代回收里）、重新标记和清理三次短停顿，清扫出的空隙供晋升和大对象复用。
+// 老年代划分成等大小的区域，标记后存活少的区域成为候选，之后的年轻代回收变成混合回收：
+// 按-XX:MaxGCPauseMillis预测能带上多少个候选区域，把其中的存活对象一起复制出去，整个区域回收（见gc/heap_region.hpp）。
+// 根是所有Java线程栈帧里的引用（按字节码算出的引用位图，见gc/reference_map.hpp）、线程的本地句柄和类的静态引用字段。
+// 回收会移动对象：可能触发GC的调用（分配、Safepoint::poll）之前，解释器要把pc写回栈帧（Frame::setPC），
+// 调用之后从槽位重新读取引用；C++代码要跨过这些调用持有对象时放进本地句柄（Thread::pushHandle）
+class Heap {
+public:
+    static constexpr size_t DEFAULT_INITIAL_SIZE = size_t(64) << 20;
+    static constexpr size_t DEFAULT_MAX_SIZE = size_t(1) << 30;
+
+    // eden分出去的块和TLAB边界始终按CHUNK_ALIGNMENT对齐，数组（ArrayObject::ALIGNMENT）可以直接放在块首
+    static constexpr size_t CHUNK_ALIGNMENT = ArrayObject::ALIGNMENT;
+    static constexpr size_t TLAB_SIZE = size_t(256) << 10;
+    // TLAB剩余不超过这么多时才换新的，否则这次分配直接在eden分配，TLAB留着继续用
+    static constexpr size_t TLAB_REFILL_WASTE = TLAB_SIZE / 64;
+    // 不小于这个大小的对象直接在老年代分配
+    static constexpr size_t LARGE_OBJECT_SIZE = TLAB_SIZE / 8;
+    // 年轻代最小1MB，最多占整个堆的一半；survivor各占年轻代的1/10
+    static constexpr size_t MIN_YOUNG_SIZE = size_t(1) << 20;
+    static constexpr size_t SURVIVOR_RATIO = 10;
+
+    // initial_size/max_size/gc_threads为0时使用默认值。
+    // initiating_occupancy：老年代占用达到这个百分比时开始并发标记，100以上不启动。
+    // max_pause_millis：停顿时间目标，决定混合回收每次带上多少个老年代区域
+    Heap(size_t initial_size = 0, size_t max_size = 0, size_t gc_threads = 0,
+         size_t initiating_occupancy = gc::ConcurrentMarker::DEFAULT_INITIATING_OCCUPANCY,
+         uint64_t max_pause_millis = gc::PausePolicy::DEFAULT_MAX_PAUSE_MILLIS)
+        : _gang(gc_threads != 0 ? gc_threads : gc::WorkGang::defaultWorkerCount()),
+          _young_collector(_g, _gang),
+          _full_collector(_g, _gang),
+          _marker(_g, initiating_occupancy, [this](uint64_t nanos) { recordPause(nanos); }),
+          _policy(max_pause_millis) {
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        if (max_size == 0) max_size = std::max(DEFAULT_MAX_SIZE, initial_size);
+        if (initial_size == 0) initial_size = std::min(DEFAULT_INITIAL_SIZE, max_size);
+        initial_size = std::min(initial_size, max_size);
+        size_t granule = std::max(page, gc::CardTable::CARD_SIZE);
+        _reserved_size = align_up(std::max(max_size, 2 * MIN_YOUNG_SIZE), granule);
+
+        size_t young = std::min(std::max(initial_size / 3, MIN_YOUNG_SIZE), _reserved_size / 2);
+        size_t survivor = align_up(young / SURVIVOR_RATIO, granule);
+        size_t eden = align_up(young - 2 * survivor, granule);
+        size_t old = _reserved_size - eden - 2 * survivor;
+        size_t old_initial = align_up(initial_size > young ? initial_size - young : 0, granule);
+
+        void* p = mmap(nullptr, _reserved_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::runtime_error("Cannot reserve Java heap");
+        }
+        _base = static_cast<char*>(p);
+        char* eden_bottom = _base + old;
+        char* s0_bottom = eden_bottom + eden;
+        char* s1_bottom = s0_bottom + survivor;
+        if (!_g.old.initialize(_base, eden_bottom, std::min(old_initial, old), page) ||
+            !_g.eden.initialize(eden_bottom, s0_bottom, eden, page) ||
+            !_g.survivors[0].initialize(s0_bottom, s1_bottom, survivor, page) ||
+            !_g.survivors[1].initialize(s1_bottom, _base + _reserved_size, survivor, page)) {
+            munmap(_base, _reserved_size);
+            throw std::runtime_error("Cannot commit initial Java heap");
+        }
+        _g.cards.initialize(_base, old);
+        _g.offsets.initialize(_base, old);
+        _g.marks.initialize(_base, old);
+        _g.regions.initialize(_base, old, gc::HeapRegionTable::regionSizeFor(_reserved_size));
+        _tlab_size = std::max(CHUNK_ALIGNMENT, std::min(TLAB_SIZE, align_up(eden / 16, CHUNK_ALIGNMENT)));
+        _marker.start();
+    }
+
+    Heap(const Heap&) = delete;
+    Heap& operator=(const Heap&) = delete;
+
+    // 析构时不能有登记的Java线程
+    ~Heap() {
+        _marker.stop();
+        munmap(_base, _reserved_size);
+    }
+
+    // new：p_class必须已经链接，字段全部清零。可能触发GC
+    Object* newObject(Thread& thread, Class* p_class) {
+        size_t size = p_class->instanceSize();
+        void* p = thread.getTlab().allocate(size);
+        if (p == nullptr) {
+            p = allocateSlow(thread, size, sizeof(uint64_t));
+        }
+        return p_class->initializeObject(p);
+    }
+
+    // newarray/anewarray：元素全部清零，length为负时抛NegativeArraySizeException。可能触发GC
+    ArrayObject* newArray(Thread& thread, Class* p_array_class, int32_t length) {
+        size_t size = ArrayObject::allocationSize(p_array_class->elementType(), length);
+        void* p = thread.getTlab().allocateAligned(size, ArrayObject::ALIGNMENT);
+        if (p == nullptr) {
+            p = allocateSlow(thread, size, ArrayObject::ALIGNMENT);
+        }
+        return ArrayObject::initialize(p, p_array_class, length);
+    }
+
+    // newarray：atype取指令操作数
+    ArrayObject* newPrimitiveArray(Thread& thread, uint8_t atype, int32_t length) {
+        if (!is_primitive_array_type(atype)) {
+            throw std::runtime_error("Invalid newarray type: " + std::to_string(atype));
+        }
+        return newArray(thread, Class::primitiveArrayClass(static_cast<ArrayType>(atype)), length);
+    }
+
+    // 把TLAB剩余部分填充后交回
+    void retireTlab(Tlab& tlab) { tlab.retire(); }
+
+    // 在安全点回收：full为false时做年轻代回收（老年代可能放不下晋升对象时先做混合回收，没有候选区域或者晋升失败时改为整堆回收）。
+    // 已经有别的线程在回收时等它结束后返回false。整堆回收后存活对象仍超过老年代时抛OutOfMemoryError
+    bool collect(bool full = false) {
+        if (!gc::Safepoint::begin()) {
+            return false;
+        }
+        SafepointScope scope;
+        collectAtSafepoint(full);
+        return true;
+    }
+
+    // 对象在堆中占的字节数，遍历堆时按它跳到下一个对象
+    static size_t objectSize(const Object* p_object) { return object_size(p_object); }
+
+    // 按地址顺序访问堆中每个对象（填充字跳过，填充数组照常访问）。
+    // 调用时不能有线程在分配，并且所有TLAB都已经交回
+    template <typename F>
+    void forEachObject(F&& fn) {
+        _g.forEachObject(std::forward<F>(fn));
+    }
+
+    bool contains(const void* p) const { return _g.contains(p); }
+    bool inYoung(const void* p) const { return _g.inYoung(p); }
+
+    size_t used() { return _g.oldOccupied() + _g.eden.used() + _g.from().used(); }
+    size_t committed() const {
+        return _g.old.committed() + _g.eden.committed() + _g.survivors[0].committed() + _g.survivors[1].committed();
+    }
+    size_t maxSize() const { return _reserved_size; }
+    size_t parallelGcThreads() const { return _gang.size(); }
+    size_t youngCapacity() const { return _g.eden.capacity() + 2 * _g.survivors[0].capacity(); }
+    size_t oldUsed() { return _g.oldOccupied(); }
+    size_t oldCapacity() const { return _g.old.capacity(); }
+    size_t regionSize() const { return _g.regions.regionSize(); }
+
+    uint64_t tlabRefills() const { return _tlab_refills.load(std::memory_order_relaxed); }
+    uint64_t sharedAllocations() const { return _shared_allocations.load(std::memory_order_relaxed); }
+    uint64_t largeAllocations() const { return _large_allocations.load(std::memory_order_relaxed); }
+    uint64_t youngGcCount() const { return _young_gc_count.load(std::memory_order_relaxed); }
+    uint64_t fullGcCount() const { return _full_gc_count.load(std::memory_order_relaxed); }
+    // 带上了老年代区域的年轻代回收（也计入youngGcCount）
+    uint64_t mixedGcCount() const { return _mixed_gc_count.load(std::memory_order_relaxed); }
+    uint64_t lastPauseNanos() const { return _last_pause_nanos.load(std::memory_order_relaxed); }
+    uint64_t totalPauseNanos() const { return _total_pause_nanos.load(std::memory_order_relaxed); }
+    uint64_t maxPauseNanos() const { return _max_pause_nanos.load(std::memory_order_relaxed); }
+    uint64_t concurrentCycleCount() const { return _marker.cycleCount(); }
+    uint64_t abortedConcurrentCycleCount() const { return _marker.abortedCount(); }
+    bool concurrentCycleActive() const { return _marker.isActive(); }
+
+    // 进程级的堆，启动时按-Xms/-Xmx安装，解释器的new/newarray从这里分配
+    static void install(std::shared_ptr<Heap> p_heap) { global() = std::move(p_heap); }
+    static Heap* instance() { return global().get(); }
+
+private:
+    // 异常退出collect时也要放开其他线程
+    struct SafepointScope {
+        ~SafepointScope() { gc::Safepoint::end(); }
+    };
+
+    static size_t align_up(size_t value, size_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    // 根任务：每个Java线程（栈帧和本地句柄）各是一个，所有类的静态字段是最后一个。
+    // 各工作线程用next领取任务编号，按顺序走一遍线程表，只扫描编号是自己领到的那些；
+    // 单线程调用时领到全部任务
+    template <typename F>
+    void forEachRoot(std::atomic<size_t>& next, F& visit) {
+        size_t claimed = next.fetch_add(1, std::memory_order_relaxed);
+        size_t index = 0;
+        gc::Safepoint::forEachThread([&](Thread& thread) {
+            if (index++ != claimed) return;
+            JvmStack& stack = thread.getStack();
+            for (size_t depth = 0; depth < stack.size(); depth++) {
+                gc::for_each_frame_reference(*stack.frameAt(depth), visit);
+            }
+            for (Object*& p_handle : thread.handles()) {
+                visit(&p_handle);
+            }
+            claimed = next.fetch_add(1, std::memory_order_relaxed);
+        });
+        if (index == claimed) {
+            Class::forEachStaticReference(visit);
+        }
+    }
+
+    // 慢速路径：先响应别的线程发起的GC，分配失败时回收。
+    // 回收后在同一个安全点里先为本线程分配，避免腾出的空间被别的线程抢先用掉；
+    // 等到的是别的线程发起的回收时重新尝试
+    void* allocateSlow(Thread& thread, size_t size, size_t alignment) {
+        gc::Safepoint::poll();
+        for (;;) {
+            void* p = tryAllocate(thread, size, alignment);
+            if (p != nullptr) {
+                return p;
+            }
+            if (!gc::Safepoint::begin()) {
+                continue;
+            }
+            SafepointScope scope;
+            p = collectAndAllocate(thread, size, alignment);
+            if (p == nullptr) {
+                throw std::runtime_error("java.lang.OutOfMemoryError: Java heap space");
+            }
+            return p;
+        }
+    }
+
+    void* tryAllocate(Thread& thread, size_t size, size_t alignment) {
+        return size >= LARGE_OBJECT_SIZE ? allocateLarge(size, alignment)
+                                         : allocateYoung(thread.getTlab(), size, alignment);
+    }
+
+    // 安全点内：先年轻代回收，还分配不到再整堆回收。大对象在老年代，年轻代回收腾不出空间，直接整堆回收
+    void* collectAndAllocate(Thread& thread, size_t size, size_t alignment) {
+        bool full = collectAtSafepoint(size >= LARGE_OBJECT_SIZE);
+        void* p = tryAllocate(thread, size, alignment);
+        if (p == nullptr && !full) {
+            collectAtSafepoint(true);
+            p = tryAllocate(thread, size, alignment);
+        }
+        return p;
+    }
+
+    // 在安全点内回收一次，返回是否做了整堆回收
+    bool collectAtSafepoint(bool full) {
+        auto start = std::chrono::steady_clock::now();
+
+        gc::Safepoint::forEachThread([](Thread& thread) { thread.getTlab().retire(); });
+        size_t young_used = _g.youngUsed();
+        // 空闲块只算够一整块PLAB的
+        size_t old_free = _g.old.reservedFree() + _g.free_list.freeBytesInChunksOf(gc::YoungCollector::MAX_PLAB_SIZE);
+        size_t reserve = promotionReserve(young_used);
+        bool replaces_young = !full;
+        // to里还有对象：上次晋升失败后的整堆回收没能完成，年轻代回收处理不了，只能再整堆回收
+        if (!full && _g.to().used() != 0) {
+            full = true;
+        }
+
+        auto roots = [this](std::atomic<size_t>& next, auto&& visit) { forEachRoot(next, visit); };
+        bool ok = true;
+        bool initial_mark = false;
+        bool promotion_failed = false;
+        size_t old_regions = 0;
+        uint64_t predicted_nanos = 0;
+        _cset.clear();
+        if (!full && _g.regions.hasCandidates()) {
+            // 混合回收：晋升预留之外的老年代空间和停顿时间目标决定带上多少个区域。
+            // 留不出预留时也先试混合回收，拿一半空闲复制候选区域，回收后腾出的空间比复制占用的多
+            size_t budget = old_free >= reserve ? old_free - reserve : old_free / 2;
+            predicted_nanos = _policy.chooseCollectionSet(_g.regions, budget, &gc::YoungCollector::copyReserve, _cset);
+        }
+        // 留不出预留、也没有能带上的候选区域，只能整堆回收
+        if (!full && old_free < reserve && _cset.empty()) {
+            full = true;
+        }
+        if (!full) {
+            for (gc::HeapRegion* p_region : _cset) {
+                _g.addToCollectionSet(*p_region);
+            }
+            old_regions = _cset.size();
+            auto collect_start = std::chrono::steady_clock::now();
+            _young_collector.collect(roots);
+            _young_gc_count.fetch_add(1, std::memory_order_relaxed);
+            if (old_regions != 0) {
+                _mixed_gc_count.fetch_add(1, std::memory_order_relaxed);
+            }
+            promotion_failed = _young_collector.promotionFailed();
+            if (promotion_failed) {
+                // 没复制走的对象还在原地，接着整堆回收
+                full = true;
+            } else {
+                _policy.recordCollection(
+                    static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - collect_start).count()),
+                    _young_collector.copiedBytes() + _young_collector.promotedBytes(),
+                    _young_collector.evacuatedBytes(), _young_collector.rememberedCardCount());
+                _policy.recordPromotion(_young_collector.promotedBytes());
+                initial_mark = _marker.shouldStartCycle(promotionReserve(_g.eden.capacity() + _g.from().used()));
+                if (initial_mark) {
+                    _marker.initialMark(roots);
+                }
+            }
+        }
+        if (full) {
+            _marker.abort();
+            ok = _full_collector.collect(roots);
+            _full_gc_count.fetch_add(1, std::memory_order_relaxed);
+            if (ok && replaces_young) {
+                // 代替年轻代回收的整堆回收也是晋升样本，否则一次预计偏多之后会一直整堆回收
+                _policy.recordPromotion(_full_collector.youngLiveBytes());
+            }
+        }
+
+        uint64_t nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        recordPause(nanos);
+        if (full) {
+            LOG(DEBUG, "GC(full%s): live %zuK, old %zuK/%zuK, pause %.3fms", promotion_failed ? ", promotion failed" : "",
+                _full_collector.liveBytes() >> 10, _g.old.used() >> 10, _g.old.capacity() >> 10, nanos / 1e6);
+        } else if (old_regions != 0) {
+            LOG(DEBUG, "GC(mixed): young %zuK->%zuK, promoted %zuK, %zu old regions: evacuated %zuK, freed %zuK, "
+                "remembered cards %zu, old %zuK/%zuK, pause %.3fms (predicted %.3fms)",
+                young_used >> 10, _young_collector.copiedBytes() >> 10, _young_collector.promotedBytes() >> 10,
+                old_regions, _young_collector.evacuatedBytes() >> 10, _young_collector.freedOldBytes() >> 10,
+                _young_collector.rememberedCardCount(), _g.oldOccupied() >> 10, _g.old.capacity() >> 10,
+                nanos / 1e6, predicted_nanos / 1e6);
+        } else {
+            LOG(DEBUG, "GC(young%s): young %zuK->%zuK, promoted %zuK, old %zuK/%zuK, pause %.3fms",
+                initial_mark ? ", initial mark" : "", young_used >> 10, _young_collector.copiedBytes() >> 10,
+                _young_collector.promotedBytes() >> 10, _g.oldOccupied() >> 10, _g.old.capacity() >> 10, nanos / 1e6);
+        }
+        if (!ok) {
+            throw std::runtime_error("java.lang.OutOfMemoryError: Java heap space");
+        }
+        return full;
+    }
+
+    // 年轻代回收前老年代要留出的空间，按最近几次回收晋升的字节预测
+    size_t promotionReserve(size_t young_used) const {
+        return _young_collector.promotionReserve(_policy.predictPromotedBytes(young_used));
+    }
+
+    // 停顿统计：回收停顿和并发周期的重新标记、清理停顿
+    void recordPause(uint64_t nanos) {
+        _last_pause_nanos.store(nanos, std::memory_order_relaxed);
+        _total_pause_nanos.fetch_add(nanos, std::memory_order_relaxed);
+        if (nanos > _max_pause_nanos.load(std::memory_order_relaxed)) {
+            _max_pause_nanos.store(nanos, std::memory_order_relaxed);
+        }
+    }
+
+    // TLAB剩余较多时本次直接在eden分配；否则换一块新的TLAB。eden满时返回nullptr
+    void* allocateYoung(Tlab& tlab, size_t size, size_t alignment) {
+        if (tlab.freeBytes() > TLAB_REFILL_WASTE) {
+            _shared_allocations.fetch_add(1, std::memory_order_relaxed);
+            return allocateEden(size);
+        }
+        tlab.retire();
+        char* chunk = _g.eden.allocate(_tlab_size);
+        if (chunk == nullptr) {
+            // 剩下的空间不够一整块TLAB，只分配这一个对象
+            _shared_allocations.fetch_add(1, std::memory_order_relaxed);
+            return allocateEden(size);
+        }
+        _tlab_refills.fetch_add(1, std::memory_order_relaxed);
+        tlab.reset(chunk, chunk + _tlab_size);
+        return tlab.allocateAligned(size, alignment);
+    }
+
+    // 绕过TLAB在eden分配，尾部按CHUNK_ALIGNMENT补齐的部分填充
+    void* allocateEden(size_t size) {
+        size_t rounded = align_up(size, CHUNK_ALIGNMENT);
+        char* p = _g.eden.allocate(rounded);
+        if (p != nullptr) {
+            Tlab::fill(p + size, p + rounded);
+        }
+        return p;
+    }
+
+    void* allocateLarge(size_t size, size_t alignment) {
+        void* p = _g.allocateOld(size, alignment);
+        if (p != nullptr) {
+            _large_allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+        return p;
+    }
+
+    static std::shared_ptr<Heap>& global() {
+        static std::shared_ptr<Heap> p_heap;
+        return p_heap;
+    }
+
+    char* _base;
+    size_t _reserved_size;
+    size_t _tlab_size;
+
+    gc::Generations _g;
+    gc::WorkGang _gang;
+    gc::YoungCollector _young_collector;
+    gc::MarkCompactCollector _full_collector;
+    gc::ConcurrentMarker _marker;
+    gc::PausePolicy _policy;
+    std::vector<gc::HeapRegion*> _cset;     // 这次混合回收选中的老年代区域
+
+    std::atomic<uint64_t> _tlab_refills{0};
+    std::atomic<uint64_t> _shared_allocations{0};
+    std::atomic<uint64_t> _large_allocations{0};
+    std::atomic<uint64_t> _young_gc_count{0};
+    std::atomic<uint64_t> _full_gc_count{0};
+    std::atomic<uint64_t> _mixed_gc_count{0};
+    std::atomic<uint64_t> _last_pause_nanos{0};
+    std::atomic<uint64_t> _total_pause_nanos{0};
+    std::atomic<uint64_t> _max_pause_nanos{0};
+};
+
+} // namespace rtda
+} // namespace jvm
@@ -1,127 +1,85 @@
-<<<<<<< HEAD
 #pragma once
 
-
-#include <list>
 #include <memory>
 #include <stdexcept>
 
 #include "frame.hpp" // 引入Frame类
+#include "frame_slab.hpp"
 
 namespace jvm {
 namespace rtda {
 
+// 线程的Java虚拟机栈：定长的栈帧数组 + 槽位区
+// 栈帧对象在构造时一次分配好，压栈只是按深度取下一个并重新指向槽位区，出栈后留给下次复用；
+// 解释器拿到的是不拥有所有权的Frame*，有效期到该帧出栈为止
 class JvmStack {
 public:
-    JvmStack(size_t max_size) : _max_size(max_size), _size(0), _top(nullptr) {}
+    JvmStack(size_t max_size, size_t slab_slots = FrameSlab::DEFAULT_SLOTS)
+        : _max_size(max_size), _size(0),
+          _p_frames(std::make_unique<Frame[]>(max_size)),
+          _p_slab(std::make_unique<FrameSlab>(slab_slots)) {}
     JvmStack(const JvmStack&) = delete; // 禁止拷贝构造
     JvmStack& operator=(const JvmStack&) = delete; // 禁止赋值操作
     JvmStack(JvmStack&&) = default; // 允许移动构造
     JvmStack& operator=(JvmStack&&) = default; // 允许移动赋值
     ~JvmStack() = default;
 
-    void push(std::shared_ptr<Frame> frame) {
+    // 在槽位区上为code所属的方法压入新帧，帧的大小和验证状态都取自code。
+    // param_slots个参数（含this）从当前帧操作数栈顶弹出，原地成为新帧局部变量表的开头
+    Frame* pushFrame(const classfile::CodeAttribute& code, uint16_t param_slots) {
+        const uint16_t max_locals = code.getMaxLocals();
+        const uint16_t max_stack = code.getMaxStack();
         if (_size >= _max_size) {
             throw std::runtime_error("java.lang.StackOverflowError");
         }
-        _frames.push_back(frame);
-        _top = frame;
-        ++_size;
-    }
-
-    std::shared_ptr<Frame> pop() {
-        if (_size == 0) {
-            throw std::runtime_error("Jvm Stack underflow");
+        if (param_slots > max_locals) {
+            throw std::runtime_error("Argument slots exceed max_locals");
         }
-        auto frame = _top;
-        _frames.pop_back();
-        if (_frames.empty()) {
-            _top = nullptr;
-        } else {
-            _top = _frames.back();
+        Slot* mark = _p_slab->top();
+        Slot* locals = mark;
+        if (param_slots > 0) {
+            if (_size == 0) {
+                throw std::runtime_error("Jvm Stack is empty");
+            }
+            locals = top()->getOperandStack().popSlots(param_slots);
         }
-        --_size;
-        return frame;
-    }
-
-    std::shared_ptr<Frame> top() const 
-    {
-        if (_top == nullptr) {
-            throw std::runtime_error("Jvm Stack is empty");
-        } 
-        return _top; 
-    }
-
-private:
-    size_t _max_size;
-    size_t _size;
-    std::shared_ptr<Frame> _top;
-    std::list<std::shared_ptr<Frame>> _frames;
-};
-
-} // namespace rtda
-} // namespace jvm
-=======
-#pragma once
-
-
-#include <list>
-#include <memory>
-#include <stdexcept>
-
-#include "frame.hpp" // 引入Frame类
-
-namespace jvm {
-namespace rtda {
-
-class JvmStack {
-public:
-    JvmStack(size_t max_size) : _max_size(max_size), _size(0), _top(nullptr) {}
-    JvmStack(const JvmStack&) = delete; // 禁止拷贝构造
-    JvmStack& operator=(const JvmStack&) = delete; // 禁止赋值操作
-    JvmStack(JvmStack&&) = default; // 允许移动构造
-    JvmStack& operator=(JvmStack&&) = default; // 允许移动赋值
-    ~JvmStack() = default;
-
-    void push(std::shared_ptr<Frame> frame) {
-        if (_size >= _max_size) {
+        if (_p_slab->allocate(locals, static_cast<size_t>(max_locals) + max_stack) == nullptr) {
             throw std::runtime_error("java.lang.StackOverflowError");
         }
-        _frames.push_back(frame);
-        _top = frame;
-        ++_size;
+        Frame* frame = &_p_frames[_size++];
+        frame->reset(locals, code, mark);
+        return frame;
     }
 
-    std::shared_ptr<Frame> pop() {
+    void pop() {
         if (_size == 0) {
             throw std::runtime_error("Jvm Stack underflow");
         }
-        auto frame = _top;
-        _frames.pop_back();
-        if (_frames.empty()) {
-            _top = nullptr;
-        } else {
-            _top = _frames.back();
-        }
         --_size;
-        return frame;
+        _p_slab->release(_p_frames[_size].slabMark());
     }
 
-    std::shared_ptr<Frame> top() const 
+    Frame* top() const
     {
-        if (_top == nullptr) {
+        if (_size == 0) {
             throw std::runtime_error("Jvm Stack is empty");
-        } 
-        return _top; 
+        }
+        return &_p_frames[_size - 1];
     }
 
+    // 栈底为0，遍历栈帧（异常栈回溯、GC扫描根）时使用
+    Frame* frameAt(size_t depth) const { return &_p_frames[depth]; }
+
+    size_t size() const { return _size; }
+    size_t maxSize() const { return _max_size; }
+    bool empty() const { return _size == 0; }
+
 private:
     size_t _max_size;
     size_t _size;
-    std::shared_ptr<Frame> _top;
-    std::list<std::shared_ptr<Frame>> _frames;
+    std::unique_ptr<Frame[]> _p_frames;     // 帧池，下标即深度
+    std::unique_ptr<FrameSlab> _p_slab;     // 本线程所有栈帧的槽位
 };
 
 } // namespace rtda
 } // namespace jvm
->>>>>>> a8025d7fab866028dca65f3bf553e900af845786
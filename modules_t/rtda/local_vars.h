@@ -1,72 +1,102 @@
-<<<<<<< HEAD
 #pragma once
 
 #include <vector>
 #include <cstdint>
+#include <cstring>
+
 #include "slot.hpp"
+#include "access_policy.hpp"
 
 namespace jvm {
 namespace rtda {
 
-class LocalVars {
+// 局部变量表：槽位区上的一段视图，槽位可以来自线程的FrameSlab，也可以自带存储
+// Policy决定是否检查下标，见access_policy.hpp
+template <typename Policy>
+class BasicLocalVars {
 private:
-    std::vector<Slot> _slots;
+    std::vector<Slot> _storage;     // 自带存储时使用，视图模式下为空
+    Slot* _slots;
+    uint32_t _max_locals;
 
 public:
-    explicit LocalVars(uint32_t maxLocals);
-    
-    // Basic setters and getters
-    void setInt(uint32_t index, int32_t val);
-    int32_t getInt(uint32_t index) const;
-    
-    void setFloat(uint32_t index, float val);
-    float getFloat(uint32_t index) const;
-    
-    void setLong(uint32_t index, int64_t val);
-    int64_t getLong(uint32_t index) const;
-    
-    void setDouble(uint32_t index, double val);
-    double getDouble(uint32_t index) const;
-    
-    void setRef(uint32_t index, Object* pRef);
-    Object* getRef(uint32_t index) const;
-};
+    // 自带存储
+    explicit BasicLocalVars(uint32_t maxLocals)
+        : _storage(maxLocals), _slots(_storage.data()), _max_locals(maxLocals) {}
+    // 视图：槽位由调用者（FrameSlab）管理
+    BasicLocalVars(Slot* slots, uint32_t maxLocals) : _slots(slots), _max_locals(maxLocals) {}
+    BasicLocalVars() : _slots(nullptr), _max_locals(0) {}
 
-} // namespace rtda
-=======
-#pragma once
+    // 以另一种策略访问同一段槽位（只是视图，不拷贝存储）
+    template <typename Other>
+    explicit BasicLocalVars(BasicLocalVars<Other>& other) : _slots(other.slots()), _max_locals(other.maxLocals()) {}
 
-#include <vector>
-#include <cstdint>
-#include "slot.hpp"
+    // 重新指向另一段槽位，栈帧复用时使用
+    void reset(Slot* slots, uint32_t maxLocals) {
+        _slots = slots;
+        _max_locals = maxLocals;
+    }
 
-namespace jvm {
-namespace rtda {
+    uint32_t maxLocals() const { return _max_locals; }
+    Slot* slots() { return _slots; }
 
-class LocalVars {
-private:
-    std::vector<Slot> _slots;
+    RTDA_INLINE void setInt(uint32_t index, int32_t val) {
+        Policy::check_index(index, 1, _max_locals);
+        _slots[index].setNum(val);
+    }
+    RTDA_INLINE int32_t getInt(uint32_t index) const {
+        Policy::check_index(index, 1, _max_locals);
+        return _slots[index].getNum();
+    }
 
-public:
-    explicit LocalVars(uint32_t maxLocals);
-    
-    // Basic setters and getters
-    void setInt(uint32_t index, int32_t val);
-    int32_t getInt(uint32_t index) const;
-    
-    void setFloat(uint32_t index, float val);
-    float getFloat(uint32_t index) const;
-    
-    void setLong(uint32_t index, int64_t val);
-    int64_t getLong(uint32_t index) const;
-    
-    void setDouble(uint32_t index, double val);
-    double getDouble(uint32_t index) const;
-    
-    void setRef(uint32_t index, Object* pRef);
-    Object* getRef(uint32_t index) const;
+    RTDA_INLINE void setFloat(uint32_t index, float val) {
+        Policy::check_index(index, 1, _max_locals);
+        _slots[index].setFloat(val);
+    }
+    RTDA_INLINE float getFloat(uint32_t index) const {
+        Policy::check_index(index, 1, _max_locals);
+        return _slots[index].getFloat();
+    }
+
+    // long/double整个存放在index槽位，index+1只占位
+    RTDA_INLINE void setLong(uint32_t index, int64_t val) {
+        Policy::check_index(index, 2, _max_locals);
+        _slots[index].setLong(val);
+    }
+    RTDA_INLINE int64_t getLong(uint32_t index) const {
+        Policy::check_index(index, 2, _max_locals);
+        return _slots[index].getLong();
+    }
+
+    RTDA_INLINE void setDouble(uint32_t index, double val) {
+        Policy::check_index(index, 2, _max_locals);
+        _slots[index].setDouble(val);
+    }
+    RTDA_INLINE double getDouble(uint32_t index) const {
+        Policy::check_index(index, 2, _max_locals);
+        return _slots[index].getDouble();
+    }
+
+    RTDA_INLINE void setRef(uint32_t index, Object* pRef) {
+        Policy::check_index(index, 1, _max_locals);
+        _slots[index].setRef(pRef);
+    }
+    RTDA_INLINE Object* getRef(uint32_t index) const {
+        Policy::check_index(index, 1, _max_locals);
+        return _slots[index].getRef();
+    }
+
+    // 从index开始整块写入count个槽位，调用时把参数从调用者操作数栈拷进来
+    RTDA_INLINE void setSlots(uint32_t index, const Slot* src, uint32_t count) {
+        Policy::check_index(index, count, _max_locals);
+        if (count > 0) {
+            std::memcpy(_slots + index, src, count * sizeof(Slot));
+        }
+    }
 };
 
+using LocalVars = BasicLocalVars<CheckedAccess>;
+using UncheckedLocalVars = BasicLocalVars<UncheckedAccess>;
+
 } // namespace rtda
->>>>>>> a8025d7fab866028dca65f3bf553e900af845786
-} // namespace jvm
\ No newline at end of file
+} // namespace jvm
@@ -1,25 +1,149 @@
-<<<<<<< HEAD
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "../gc/card_table.hpp"
+#include "../gc/satb_queue.hpp"
+
 namespace jvm {
 namespace rtda {
 
-class Object {
-    // to do
-};
+class Class;
 
-} // namespace rtda
-} // namespace jvm
-=======
-#pragma once
+// 标记字（mark word）的位布局：
+//   [1:0]   锁状态       00 无锁 / 01 轻量锁 / 10 已膨胀 / 11 GC转发中
+//   [5:2]   GC年龄       对象熬过的年轻代回收次数
+//   [6]     GC标记位
+//   [62:32] 身份哈希     0表示还没有生成
+//   [63]    始终为0；整字为FILLER_WORD时不是对象，而是堆中8字节的填充
+namespace markword {
+constexpr uint64_t LOCK_MASK = 0x3;
+constexpr uint64_t UNLOCKED = 0x0;
+constexpr uint64_t THIN_LOCKED = 0x1;
+constexpr uint64_t INFLATED = 0x2;
+constexpr uint64_t FORWARDED = 0x3;
 
-namespace jvm {
-namespace rtda {
+constexpr int AGE_SHIFT = 2;
+constexpr uint64_t AGE_MASK = uint64_t(0xF) << AGE_SHIFT;
+constexpr uint64_t MARK_BIT = uint64_t(1) << 6;
+
+constexpr int HASH_SHIFT = 32;
+constexpr uint64_t HASH_MASK = uint64_t(0x7FFFFFFF) << HASH_SHIFT;
 
+constexpr uint64_t FILLER_WORD = ~uint64_t(0);
+} // namespace markword
+
+// Java对象：16字节对象头（标记字 + 类指针），后面是按Class计算好的实例字段。
+// 字段偏移在类链接时算好，getfield/putfield就是在常量偏移处的一次读写
 class Object {
-    // to do
+public:
+    static constexpr uint32_t HEADER_SIZE = 16;
+
+    explicit Object(Class* p_class) : _mark(markword::UNLOCKED), _p_class(p_class) {}
+
+    Object(const Object&) = delete;
+    Object& operator=(const Object&) = delete;
+
+    Class* getClass() const { return _p_class; }
+
+    std::atomic<uint64_t>& markWord() { return _mark; }
+
+    // 身份哈希（System.identityHashCode），第一次调用时生成并写进标记字，之后不变
+    int32_t identityHash() {
+        uint64_t mark = _mark.load(std::memory_order_relaxed);
+        while ((mark & markword::HASH_MASK) == 0) {
+            uint64_t hash = next_hash();
+            if (_mark.compare_exchange_weak(mark, mark | (hash << markword::HASH_SHIFT),
+                                            std::memory_order_relaxed)) {
+                return static_cast<int32_t>(hash);
+            }
+        }
+        return static_cast<int32_t>((mark & markword::HASH_MASK) >> markword::HASH_SHIFT);
+    }
+
+    uint32_t gcAge() const {
+        return static_cast<uint32_t>((_mark.load(std::memory_order_relaxed) & markword::AGE_MASK) >> markword::AGE_SHIFT);
+    }
+    void setGcAge(uint32_t age) {
+        uint64_t mark = _mark.load(std::memory_order_relaxed);
+        uint64_t bits = (static_cast<uint64_t>(age) << markword::AGE_SHIFT) & markword::AGE_MASK;
+        while (!_mark.compare_exchange_weak(mark, (mark & ~markword::AGE_MASK) | bits, std::memory_order_relaxed)) {
+        }
+    }
+
+    bool isMarked() const { return (_mark.load(std::memory_order_relaxed) & markword::MARK_BIT) != 0; }
+    // 设置标记位，已被标记时返回false（并发标记时只有一个线程会成功）
+    bool tryMark() {
+        return (_mark.fetch_or(markword::MARK_BIT, std::memory_order_relaxed) & markword::MARK_BIT) == 0;
+    }
+    void clearMark() { _mark.fetch_and(~markword::MARK_BIT, std::memory_order_relaxed); }
+
+    // 复制式回收时旧对象的标记字换成新地址（低两位为FORWARDED），
+    // 之后再遇到指向旧对象的引用都改成指向新地址
+    bool isForwarded() const {
+        return (_mark.load(std::memory_order_relaxed) & markword::LOCK_MASK) == markword::FORWARDED;
+    }
+    Object* forwardee() const {
+        return reinterpret_cast<Object*>(_mark.load(std::memory_order_relaxed) & ~markword::LOCK_MASK);
+    }
+    void forwardTo(Object* p_new) {
+        _mark.store(reinterpret_cast<uint64_t>(p_new) | markword::FORWARDED, std::memory_order_relaxed);
+    }
+    // 并行复制：标记字仍是mark时换成转发指针。失败说明别的线程抢先复制了，mark更新为当前值
+    bool tryForwardTo(uint64_t& mark, Object* p_new) {
+        return _mark.compare_exchange_strong(mark, reinterpret_cast<uint64_t>(p_new) | markword::FORWARDED,
+                                             std::memory_order_acq_rel, std::memory_order_acquire);
+    }
+
+    // 实例字段读写，offset取自Class::findInstanceField()
+    template <typename T>
+    T getField(uint32_t offset) const {
+        T value;
+        std::memcpy(&value, reinterpret_cast<const char*>(this) + offset, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void setField(uint32_t offset, T value) {
+        std::memcpy(reinterpret_cast<char*>(this) + offset, &value, sizeof(T));
+    }
+
+    Object* getRefField(uint32_t offset) const { return getField<Object*>(offset); }
+    // putfield的引用路径：写入前经过SATB写前屏障，写入后经过卡表写屏障。
+    // 并发标记线程可能同时在读这个字段，按原子方式写
+    void setRefField(uint32_t offset, Object* ref) {
+        Object** p_field = refFieldAddress(offset);
+        gc::pre_write_barrier(p_field);
+        __atomic_store_n(p_field, ref, __ATOMIC_RELAXED);
+        gc::post_write_barrier(p_field);
+    }
+
+    // 引用字段的地址，GC更新引用时使用
+    Object** refFieldAddress(uint32_t offset) {
+        return reinterpret_cast<Object**>(reinterpret_cast<char*>(this) + offset);
+    }
+
+private:
+    // 31位非零哈希，线程私有的xorshift，不需要同步
+    static uint64_t next_hash() {
+        thread_local uint32_t state = 0x9E3779B9u ^ static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&state));
+        uint64_t hash;
+        do {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            hash = state & 0x7FFFFFFF;
+        } while (hash == 0);
+        return hash;
+    }
+
+    std::atomic<uint64_t> _mark;
+    Class* _p_class;
 };
 
+static_assert(sizeof(Object) == Object::HEADER_SIZE, "Object header must stay 16 bytes");
+
 } // namespace rtda
 } // namespace jvm
->>>>>>> a8025d7fab866028dca65f3bf553e900af845786
@@ -1,89 +1,119 @@
-<<<<<<< HEAD
 #pragma once
 
 #include <stdexcept>
 #include <vector>
 
 #include "slot.hpp"
+#include "access_policy.hpp"
 
 namespace jvm {
 namespace rtda {
 
-class OperandStack {
+// 操作数栈：与LocalVars一样，是槽位区上的一段视图或自带存储
+// Policy决定是否检查上溢/下溢，见access_policy.hpp
+template <typename Policy>
+class BasicOperandStack {
 public:
-    explicit OperandStack(size_t size) : _top(0), _slots(size) {}
-
-    OperandStack(const OperandStack&) = delete; // 禁止拷贝构造
-    OperandStack& operator=(const OperandStack&) = delete; // 禁止拷贝赋值
-
-    OperandStack(OperandStack&&) = default;
-    OperandStack& operator=(OperandStack&&) = default;
-
-    void pushInt(const int32_t& value);
-    int32_t popInt();
-
-    void pushFloat(const float& value);
-    float popFloat();
-
-    void pushLong(const int64_t& value);
-    int64_t popLong();
-
-    void pushDouble(const double& value);
-    double popDouble();
-
-    void pushRef(Object* ref);
-    Object* popRef();
-
+    // 自带存储
+    explicit BasicOperandStack(size_t size) : _storage(size), _slots(_storage.data()), _size(size), _top(0) {}
+    // 视图：槽位由调用者（FrameSlab）管理
+    BasicOperandStack(Slot* slots, size_t size) : _slots(slots), _size(size), _top(0) {}
+    BasicOperandStack() : _slots(nullptr), _size(0), _top(0) {}
+
+    // 以另一种策略访问同一个栈：解释器进入方法时取一份视图（栈顶可以放进寄存器），
+    // 调用或返回前用syncFrom()把栈顶写回帧里的栈
+    template <typename Other>
+    explicit BasicOperandStack(BasicOperandStack<Other>& other)
+        : _slots(other.slots()), _size(other.maxSize()), _top(other.size()) {}
+
+    template <typename Other>
+    void syncFrom(const BasicOperandStack<Other>& other) { _top = other.size(); }
+
+    // 重新指向另一段槽位并清空，栈帧复用时使用
+    void reset(Slot* slots, size_t size) {
+        _slots = slots;
+        _size = size;
+        _top = 0;
+    }
+
+    BasicOperandStack(const BasicOperandStack&) = delete; // 禁止拷贝构造
+    BasicOperandStack& operator=(const BasicOperandStack&) = delete; // 禁止拷贝赋值
+
+    BasicOperandStack(BasicOperandStack&&) = default;
+    BasicOperandStack& operator=(BasicOperandStack&&) = default;
+
+    RTDA_INLINE void pushInt(int32_t value) {
+        Policy::check_push(_top, 1, _size);
+        _slots[_top++].setNum(value);
+    }
+    RTDA_INLINE int32_t popInt() {
+        Policy::check_pop(_top, 1);
+        return _slots[--_top].getNum();
+    }
+
+    RTDA_INLINE void pushFloat(float value) {
+        Policy::check_push(_top, 1, _size);
+        _slots[_top++].setFloat(value);
+    }
+    RTDA_INLINE float popFloat() {
+        Policy::check_pop(_top, 1);
+        return _slots[--_top].getFloat();
+    }
+
+    // long/double占两个槽位，整个值存放在下面一个槽位里，上面一个只占位
+    RTDA_INLINE void pushLong(int64_t value) {
+        Policy::check_push(_top, 2, _size);
+        _slots[_top].setLong(value);
+        _top += 2;
+    }
+    RTDA_INLINE int64_t popLong() {
+        Policy::check_pop(_top, 2);
+        _top -= 2;
+        return _slots[_top].getLong();
+    }
+
+    RTDA_INLINE void pushDouble(double value) {
+        Policy::check_push(_top, 2, _size);
+        _slots[_top].setDouble(value);
+        _top += 2;
+    }
+    RTDA_INLINE double popDouble() {
+        Policy::check_pop(_top, 2);
+        _top -= 2;
+        return _slots[_top].getDouble();
+    }
+
+    RTDA_INLINE void pushRef(Object* ref) {
+        Policy::check_push(_top, 1, _size);
+        _slots[_top++].setRef(ref);
+    }
+    RTDA_INLINE Object* popRef() {
+        Policy::check_pop(_top, 1);
+        return _slots[--_top].getRef();
+    }
+
+    // 一次弹出栈顶count个槽位，返回其中最底下一个的地址，用于调用时传参：
+    // 槽位区上的被调帧直接把这里当作自己局部变量表的开头，自带存储的帧则从这里拷贝。
+    // 返回的指针在下一次入栈之前有效
+    RTDA_INLINE Slot* popSlots(size_t count) {
+        Policy::check_pop(_top, count);
+        _top -= count;
+        return _slots + _top;
+    }
+
+    Slot* slots() { return _slots; }
+    size_t size() const { return _top; }
+    size_t maxSize() const { return _size; }
 
 private:
+    std::vector<Slot> _storage;     // 自带存储时使用，视图模式下为空
+    Slot* _slots;
+    size_t _size;
     size_t _top;
-    std::vector<Slot> _slots;
 };
 
-} // namespace rtda
-} // namespace jvms
-=======
-#pragma once
-
-#include <stdexcept>
-#include <vector>
-
-#include "slot.hpp"
-
-namespace jvm {
-namespace rtda {
-
-class OperandStack {
-public:
-    explicit OperandStack(size_t size) : _top(0), _slots(size) {}
-
-    OperandStack(const OperandStack&) = delete; // 禁止拷贝构造
-    OperandStack& operator=(const OperandStack&) = delete; // 禁止拷贝赋值
-
-    OperandStack(OperandStack&&) = default;
-    OperandStack& operator=(OperandStack&&) = default;
-
-    void pushInt(const int32_t& value);
-    int32_t popInt();
-
-    void pushFloat(const float& value);
-    float popFloat();
-
-    void pushLong(const int64_t& value);
-    int64_t popLong();
-
-    void pushDouble(const double& value);
-    double popDouble();
-
-    void pushRef(Object* ref);
-    Object* popRef();
-
-
-private:
-    size_t _top;
-    std::vector<Slot> _slots;
-};
+using OperandStack = BasicOperandStack<CheckedAccess>;
+using UncheckedOperandStack = BasicOperandStack<UncheckedAccess>;
 
 } // namespace rtda
-} // namespace jvms
->>>>>>> a8025d7fab866028dca65f3bf553e900af845786
+} // namespace jvm
@@ -1,9 +1,7 @@
-<<<<<<< HEAD
 #pragma once
 
-// #include <memory>
-// #include <stdexcept>
 #include <cstdint>
+#include <type_traits>
 
 #include "object.hpp" // 引入Object类
 
@@ -12,92 +10,44 @@ namespace rtda {
 
 class Object;
 
+// 局部变量表/操作数栈的一个槽位：8字节，不带类型标记
+// int、float、引用各占一个槽位；long、double按JVM规范占两个槽位，
+// 整个64位值存放在第一个槽位里，一次对齐的64位读写，第二个槽位只占位不使用。
+// 槽位里是什么类型由字节码（验证器保证）和方法签名的引用位图决定，GC据此找引用
 class Slot {
 private:
-    int32_t _num;
-    // Object* _p_ref = nullptr;  // 使用nullptr初始化，表明这是一个非拥有型指针
-    Object* _p_ref;
+    union {
+        int32_t _num;
+        float _float;
+        Object* _p_ref;
+        int64_t _long;
+        double _double;
+    };
 
 public:
-    Slot() : _num(0), _p_ref(nullptr) {} // 默认构造函数
-    
-    // 删除拷贝构造和赋值操作
-    Slot(const Slot&) = delete;
-    Slot& operator=(const Slot&) = delete;
+    Slot() : _long(0) {} // 默认构造函数
 
-    // 允许移动构造和赋值
-    Slot(Slot&& other) noexcept : _num(other._num), _p_ref(other._p_ref) {
-        other._p_ref = nullptr; // 移动后，原对象的引用置为nullptr
-    }
-    Slot& operator=(Slot&& other) noexcept {
-        if (this != &other) {
-            _num = other._num;
-            _p_ref = other._p_ref;
-            other._p_ref = nullptr; // 移动后，原对象的引用置为nullptr
-        }
-        return *this;
-    }
+    // 槽位只是值，不拥有引用的对象；保持可平凡拷贝，调用时参数可以整块memcpy进局部变量表
+    Slot(const Slot&) = default;
+    Slot& operator=(const Slot&) = default;
     ~Slot() = default; // 默认析构函数
-    
-    // getter/setter保持不变
-    int32_t getNum() const { return _num; }
-    void setNum(int32_t num) { _num = num; }
-    Object* getRef() const { return _p_ref; }
-    void setRef(Object* ref) { _p_ref = ref; }
-};
-
-} // namespace rtda
-} // namespace jvm
-
-=======
-#pragma once
-
-// #include <memory>
-// #include <stdexcept>
-#include <cstdint>
-
-#include "object.hpp" // 引入Object类
 
-namespace jvm {
-namespace rtda {
-
-class Object;
-
-class Slot {
-private:
-    int32_t _num;
-    // Object* _p_ref = nullptr;  // 使用nullptr初始化，表明这是一个非拥有型指针
-    Object* _p_ref;
-
-public:
-    Slot() : _num(0), _p_ref(nullptr) {} // 默认构造函数
-    
-    // 删除拷贝构造和赋值操作
-    Slot(const Slot&) = delete;
-    Slot& operator=(const Slot&) = delete;
-
-    // 允许移动构造和赋值
-    Slot(Slot&& other) noexcept : _num(other._num), _p_ref(other._p_ref) {
-        other._p_ref = nullptr; // 移动后，原对象的引用置为nullptr
-    }
-    Slot& operator=(Slot&& other) noexcept {
-        if (this != &other) {
-            _num = other._num;
-            _p_ref = other._p_ref;
-            other._p_ref = nullptr; // 移动后，原对象的引用置为nullptr
-        }
-        return *this;
-    }
-    ~Slot() = default; // 默认析构函数
-    
-    // getter/setter保持不变
     int32_t getNum() const { return _num; }
     void setNum(int32_t num) { _num = num; }
+    float getFloat() const { return _float; }
+    void setFloat(float value) { _float = value; }
     Object* getRef() const { return _p_ref; }
     void setRef(Object* ref) { _p_ref = ref; }
+    // GC移动对象后原地更新槽位里的引用
+    Object** refAddress() { return &_p_ref; }
+    int64_t getLong() const { return _long; }
+    void setLong(int64_t value) { _long = value; }
+    double getDouble() const { return _double; }
+    void setDouble(double value) { _double = value; }
 };
 
+static_assert(sizeof(Slot) == 8, "Slot must be 8 bytes");
+static_assert(std::is_trivially_copyable<Slot>::value, "Slot must be trivially copyable");
+
 } // namespace rtda
 } // namespace jvm
-
->>>>>>> a8025d7fab866028dca65f3bf553e900af845786
@@ -1,76 +1,66 @@
-<<<<<<< HEAD
 #pragma once
 
 #include <memory>
 #include <stdexcept>
-#include "stack.hpp" // 引入Stack类
+#include <vector>
+#include "jvm_stack.hpp" // 引入JvmStack类
+#include "tlab.hpp"
+#include "../gc/safepoint.hpp"
 
 namespace jvm {
 namespace rtda {
 
 class Thread{
 public:
-    Thread(const size_t& st_size = 1024) : _pc(0), _p_stack(std::make_shared<Stack>(st_size)) {}
+    // 构造时登记到安全点，GC从所有登记的线程栈里找根
+    Thread(const size_t& st_size = 1024) : _pc(0), _p_stack(std::make_unique<JvmStack>(st_size)) {
+        gc::Safepoint::attach(this);
+    }
     Thread(const Thread&) = delete; // 禁止拷贝构造
     Thread& operator=(const Thread&) = delete; // 禁止赋值操作
-    Thread(Thread&&) = default; // 允许移动构造
-    Thread& operator=(Thread&&) = default; // 允许移动赋值
-    ~Thread() = default;
+    Thread(Thread&&) = delete; // 安全点按地址登记，不能移动
+    Thread& operator=(Thread&&) = delete;
+    // 线程结束时把TLAB剩余部分交回堆，保证堆可以遍历
+    ~Thread() {
+        _tlab.retire();
+        gc::Safepoint::detach(this);
+    }
 
     int getPC() const { return _pc; }
     void setPC(int pc) { _pc = pc; }
 
-    std::shared_ptr<Stack> getStack() const { return _p_stack.get(); }
+    JvmStack& getStack() const { return *_p_stack; }
 
-    void pushFrame(std::shared_ptr<Frame> frame) { _p_stack->push(frame); }
-    std::shared_ptr<Frame> popFrame() { return _p_stack->pop(); }
+    Frame* pushFrame(const classfile::CodeAttribute& code, uint16_t param_slots) {
+        return _p_stack->pushFrame(code, param_slots);
+    }
+    void popFrame() { _p_stack->pop(); }
 
-    std::shared_ptr<Frame> currentFrame() const { return _p_stack->top(); }
+    Frame* currentFrame() const { return _p_stack->top(); }
 
-    // bool isAlive() const { return true; } // Placeholder for actual implementation
-
-private:
-    int _pc;
-    std::shared_ptr<Stack> _p_stack;
-};
-
-} // namespace rtda
-=======
-#pragma once
-
-#include <memory>
-#include <stdexcept>
-#include "stack.hpp" // 引入Stack类
-
-namespace jvm {
-namespace rtda {
-
-class Thread{
-public:
-    Thread(const size_t& st_size = 1024) : _pc(0), _p_stack(std::make_shared<Stack>(st_size)) {}
-    Thread(const Thread&) = delete; // 禁止拷贝构造
-    Thread& operator=(const Thread&) = delete; // 禁止赋值操作
-    Thread(Thread&&) = default; // 允许移动构造
-    Thread& operator=(Thread&&) = default; // 允许移动赋值
-    ~Thread() = default;
-
-    int getPC() const { return _pc; }
-    void setPC(int pc) { _pc = pc; }
-
-    std::shared_ptr<Stack> getStack() const { return _p_stack.get(); }
-
-    void pushFrame(std::shared_ptr<Frame> frame) { _p_stack->push(frame); }
-    std::shared_ptr<Frame> popFrame() { return _p_stack->pop(); }
+    // new/newarray在这里分配：Heap::newObject(thread, ...)
+    Tlab& getTlab() { return _tlab; }
 
-    std::shared_ptr<Frame> currentFrame() const { return _p_stack->top(); }
+    // 本地句柄：C++代码（本地方法、运行时辅助函数）要跨过可能触发GC的调用持有对象时放在这里，
+    // GC把它们当作根，对象移动后更新。按栈使用：先记下handleCount()，用完popHandles()回到原处
+    size_t pushHandle(Object* p_object) {
+        _handles.push_back(p_object);
+        return _handles.size() - 1;
+    }
+    Object* handle(size_t index) const { return _handles[index]; }
+    void setHandle(size_t index, Object* p_object) { _handles[index] = p_object; }
+    size_t handleCount() const { return _handles.size(); }
+    void popHandles(size_t count) { _handles.resize(count); }
+    std::vector<Object*>& handles() { return _handles; }
 
     // bool isAlive() const { return true; } // Placeholder for actual implementation
 
 private:
     int _pc;
-    std::shared_ptr<Stack> _p_stack;
+    std::unique_ptr<JvmStack> _p_stack;
+    Tlab _tlab;
+    std::vector<Object*> _handles;
 };
 
 } // namespace rtda
->>>>>>> a8025d7fab866028dca65f3bf553e900af845786
-} // namespace jvm
\ No newline at end of file
+} // namespace jvm
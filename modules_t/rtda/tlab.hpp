@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "object.hpp"
+#include "array_object.hpp"
+#include "class.hpp"
+
+namespace jvm {
+namespace rtda {
+
+// 线程本地分配缓冲（TLAB）：线程从堆里整块领来的一段内存，只有所属线程在里面分配，
+// 分配就是移动_top，不需要任何同步。用完或线程退出时把剩余部分填充后交回（retire）
+class Tlab {
+public:
+    Tlab() : _start(nullptr), _top(nullptr), _end(nullptr) {}
+
+    Tlab(const Tlab&) = delete;
+    Tlab& operator=(const Tlab&) = delete;
+
+    // 快速路径：放不下时返回nullptr，由Heap走慢速路径
+    void* allocate(size_t size) {
+        char* p = _top;
+        if (size <= static_cast<size_t>(_end - p)) {
+            _top = p + size;
+            return p;
+        }
+        return nullptr;
+    }
+
+    // 按alignment（2的幂，不小于8）对齐分配，对齐产生的空隙用填充字补上，保证堆可以顺序遍历
+    void* allocateAligned(size_t size, size_t alignment) {
+        char* p = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(_top) + alignment - 1) & ~(alignment - 1));
+        if (p > _end || size > static_cast<size_t>(_end - p)) {
+            return nullptr;
+        }
+        for (char* gap = _top; gap < p; gap += sizeof(uint64_t)) {
+            *reinterpret_cast<uint64_t*>(gap) = markword::FILLER_WORD;
+        }
+        _top = p + size;
+        return p;
+    }
+
+    // 填充剩余部分并清空，之后第一次分配会走慢速路径重新领取
+    void retire() {
+        if (_start != nullptr) {
+            fill(_top, _end);
+        }
+        reset(nullptr, nullptr);
+    }
+
+    // 用填充覆盖[start, end)（8字节对齐），使堆可以逐个对象遍历：
+    // 先用填充字对齐到ArrayObject::ALIGNMENT，中间整段做成一个int[]，零头再用填充字
+    static void fill(char* start, char* end) {
+        while (start < end && (reinterpret_cast<uintptr_t>(start) % ArrayObject::ALIGNMENT) != 0) {
+            *reinterpret_cast<uint64_t*>(start) = markword::FILLER_WORD;
+            start += sizeof(uint64_t);
+        }
+        size_t bytes = static_cast<size_t>(end - start) & ~static_cast<size_t>(ArrayObject::ALIGNMENT - 1);
+        if (bytes >= ArrayObject::DATA_OFFSET) {
+            int32_t length = static_cast<int32_t>((bytes - ArrayObject::DATA_OFFSET) / sizeof(int32_t));
+            ArrayObject::initializeHeader(start, Class::primitiveArrayClass(ArrayType::INT), length);
+            start += bytes;
+        }
+        for (; start < end; start += sizeof(uint64_t)) {
+            *reinterpret_cast<uint64_t*>(start) = markword::FILLER_WORD;
+        }
+    }
+
+    void reset(char* start, char* end) {
+        _start = start;
+        _top = start;
+        _end = end;
+    }
+
+    char* start() const { return _start; }
+    char* top() const { return _top; }
+    char* end() const { return _end; }
+    size_t freeBytes() const { return static_cast<size_t>(_end - _top); }
+    size_t size() const { return static_cast<size_t>(_end - _start); }
+
+private:
+    char* _start;
+    char* _top;
+    char* _end;
+};
+
+} // namespace rtda
+} // namespace jvm
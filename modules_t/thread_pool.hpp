@@ -0,0 +1,214 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util
+{
+    /**
+     * @brief 工作窃取线程池
+     * 每个工作线程拥有自己的任务队列：自己从队尾取（LIFO，缓存友好），
+     * 空闲时从其他线程的队首窃取（FIFO，优先偷大块的旧任务）。
+     * 在工作线程内提交的任务进入本线程队列，外部提交的任务轮询分发。
+     */
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(size_t thread_count = 0)
+            : _stop(false), _pending(0), _next_queue(0)
+        {
+            if (thread_count == 0) {
+                thread_count = std::max(1u, std::thread::hardware_concurrency());
+            }
+            _queues.reserve(thread_count);
+            for (size_t i = 0; i < thread_count; ++i) {
+                _queues.push_back(std::make_unique<WorkQueue>());
+            }
+            _workers.reserve(thread_count);
+            for (size_t i = 0; i < thread_count; ++i) {
+                _workers.emplace_back([this, i] { worker_loop(i); });
+            }
+        }
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_wait_mutex);
+                _stop = true;
+            }
+            _wait_cv.notify_all();
+            for (auto& worker : _workers) {
+                worker.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t size() const { return _workers.size(); }
+
+        // 提交任务，返回future获取结果（任务中抛出的异常也通过future传递）
+        template <typename F>
+        auto submit(F&& task) -> std::future<decltype(task())>
+        {
+            using R = decltype(task());
+            auto p_task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+            std::future<R> result = p_task->get_future();
+            push([p_task] { (*p_task)(); });
+            return result;
+        }
+
+        // 把[0, count)按grain切块并行执行fn(begin, end)，阻塞直到全部完成
+        template <typename F>
+        void parallel_for(size_t count, size_t grain, F&& fn)
+        {
+            if (grain == 0) grain = 1;
+            std::vector<std::future<void>> futures;
+            futures.reserve((count + grain - 1) / grain);
+            for (size_t begin = 0; begin < count; begin += grain) {
+                size_t end = std::min(count, begin + grain);
+                futures.push_back(submit([&fn, begin, end] { fn(begin, end); }));
+            }
+            for (auto& f : futures) {
+                wait_for(f);
+            }
+            for (auto& f : futures) {
+                f.get();
+            }
+        }
+
+        // 等待future就绪；若在本池的工作线程中调用，则一边等待一边执行其他任务，避免嵌套提交时死锁
+        template <typename T>
+        void wait_for(std::future<T>& f)
+        {
+            if (t_worker_pool != this) {
+                f.wait();
+                return;
+            }
+            while (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                if (!try_run_one(t_worker_index)) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        // 阻塞直到所有已提交的任务执行完毕
+        void wait_idle()
+        {
+            std::unique_lock<std::mutex> lock(_wait_mutex);
+            _idle_cv.wait(lock, [this] { return _pending.load() == 0; });
+        }
+
+    private:
+        struct WorkQueue
+        {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        void push(std::function<void()> task)
+        {
+            size_t index = (t_worker_pool == this) ? t_worker_index
+                         : _next_queue.fetch_add(1, std::memory_order_relaxed) % _queues.size();
+            // 先计数再入队，保证_pending不会在任务完成时下溢；
+            // 入队时持有_wait_mutex，避免空闲线程检查完队列、尚未进入等待时丢失通知
+            {
+                std::lock_guard<std::mutex> lock(_wait_mutex);
+                ++_pending;
+                std::lock_guard<std::mutex> queue_lock(_queues[index]->mutex);
+                _queues[index]->tasks.push_back(std::move(task));
+            }
+            _wait_cv.notify_one();
+        }
+
+        bool pop_local(size_t index, std::function<void()>& task)
+        {
+            WorkQueue& q = *_queues[index];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.empty()) return false;
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+            return true;
+        }
+
+        bool steal(size_t thief, std::function<void()>& task)
+        {
+            for (size_t n = 1; n < _queues.size(); ++n) {
+                WorkQueue& q = *_queues[(thief + n) % _queues.size()];
+                std::lock_guard<std::mutex> lock(q.mutex);
+                if (!q.tasks.empty()) {
+                    task = std::move(q.tasks.front());
+                    q.tasks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // 取一个任务（先本地后窃取）并执行，没有任务时返回false
+        bool try_run_one(size_t index)
+        {
+            std::function<void()> task;
+            if (!pop_local(index, task) && !steal(index, task)) {
+                return false;
+            }
+            task();
+            bool idle;
+            {
+                std::lock_guard<std::mutex> lock(_wait_mutex);
+                idle = (--_pending == 0);
+            }
+            if (idle) _idle_cv.notify_all();
+            return true;
+        }
+
+        void worker_loop(size_t index)
+        {
+            t_worker_pool = this;
+            t_worker_index = index;
+            for (;;) {
+                if (try_run_one(index)) {
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(_wait_mutex);
+                // _pending包含正在执行的任务，可能出现虚假唤醒后再次窃取失败，循环即可
+                _wait_cv.wait(lock, [this] { return _stop || has_queued_work(); });
+                if (_stop && !has_queued_work()) return;
+            }
+        }
+
+        bool has_queued_work()
+        {
+            for (auto& q : _queues) {
+                std::lock_guard<std::mutex> lock(q->mutex);
+                if (!q->tasks.empty()) return true;
+            }
+            return false;
+        }
+
+    private:
+        std::vector<std::unique_ptr<WorkQueue>> _queues;
+        std::vector<std::thread> _workers;
+
+        std::mutex _wait_mutex;
+        std::condition_variable _wait_cv;
+        std::condition_variable _idle_cv;
+        bool _stop;
+        std::atomic<size_t> _pending;
+        std::atomic<size_t> _next_queue;
+
+        // 当前线程所属的线程池及其队列下标，非工作线程为nullptr
+        static inline thread_local ThreadPool* t_worker_pool = nullptr;
+        static inline thread_local size_t t_worker_index = 0;
+    };
+}
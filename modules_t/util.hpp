@@ -4,6 +4,7 @@
 #include <fstream>    // 文件输入输出流
 #include <sstream>    // 字符串流处理
 #include <cstdint>
+#include <vector>
 #include <cstring>   // 字符串处理
 #include <algorithm>
 #include "log.hpp"    // 自定义日志模块（需确保项目中有该头文件）
@@ -209,6 +210,104 @@ namespace util  // 工具类命名空间，封装通用工具函数
         }
     };
 
+    /// @brief 快速非加密哈希工具类（XXH64算法），用于按内容给类文件做键
+    class util_hash {
+    public:
+        /// @brief 计算数据的XXH64哈希值
+        /// @param data 数据起始地址
+        /// @param len 数据长度
+        /// @param seed 种子
+        /// @return 64 位哈希值
+        static uint64_t xxh64(const uint8_t* data, size_t len, uint64_t seed = 0) {
+            const uint8_t* p = data;
+            const uint8_t* const end = data + len;
+            uint64_t h;
+
+            if (len >= 32) {
+                uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+                uint64_t v2 = seed + PRIME64_2;
+                uint64_t v3 = seed;
+                uint64_t v4 = seed - PRIME64_1;
+                const uint8_t* const limit = end - 32;
+                do {
+                    v1 = round(v1, read64(p));      p += 8;
+                    v2 = round(v2, read64(p));      p += 8;
+                    v3 = round(v3, read64(p));      p += 8;
+                    v4 = round(v4, read64(p));      p += 8;
+                } while (p <= limit);
+
+                h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+                h = merge(h, v1);
+                h = merge(h, v2);
+                h = merge(h, v3);
+                h = merge(h, v4);
+            } else {
+                h = seed + PRIME64_5;
+            }
+
+            h += static_cast<uint64_t>(len);
+
+            while (p + 8 <= end) {
+                h ^= round(0, read64(p));
+                h = rotl(h, 27) * PRIME64_1 + PRIME64_4;
+                p += 8;
+            }
+            if (p + 4 <= end) {
+                h ^= static_cast<uint64_t>(read32(p)) * PRIME64_1;
+                h = rotl(h, 23) * PRIME64_2 + PRIME64_3;
+                p += 4;
+            }
+            while (p < end) {
+                h ^= static_cast<uint64_t>(*p) * PRIME64_5;
+                h = rotl(h, 11) * PRIME64_1;
+                ++p;
+            }
+
+            h ^= h >> 33;
+            h *= PRIME64_2;
+            h ^= h >> 29;
+            h *= PRIME64_3;
+            h ^= h >> 32;
+            return h;
+        }
+
+    private:
+        util_hash() = delete;
+        util_hash(const util_hash&) = delete;
+        util_hash& operator=(const util_hash&) = delete;
+
+        static constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+        static constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+        static constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+        static constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+        static constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+        static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+        static uint64_t round(uint64_t acc, uint64_t input) {
+            acc += input * PRIME64_2;
+            acc = rotl(acc, 31);
+            return acc * PRIME64_1;
+        }
+
+        static uint64_t merge(uint64_t acc, uint64_t val) {
+            acc ^= round(0, val);
+            return acc * PRIME64_1 + PRIME64_4;
+        }
+
+        // XXH64按小端读取，逐字节拼装与主机字节序无关
+        static uint64_t read64(const uint8_t* p) {
+            uint64_t v = 0;
+            for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+            return v;
+        }
+
+        static uint32_t read32(const uint8_t* p) {
+            return static_cast<uint32_t>(p[0])       | (static_cast<uint32_t>(p[1]) << 8) |
+                   (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+    };
+
     // 添加在 namespace util 中，其他工具类的旁边
     /// @brief MUTF-8字符串编码转换工具类
     class util_mutf8 {
@@ -223,17 +322,22 @@ namespace util  // 工具类命名空间，封装通用工具函数
          * 2. 补充字符使用6字节表示而不是4字节
          */
         static std::string decode(const std::vector<uint8_t>& bytes) {
+            return decode(bytes.data(), bytes.size());
+        }
+
+        /// @brief 同上，直接从字节区间解码，避免先拷贝到临时vector
+        static std::string decode(const uint8_t* bytes, size_t size) {
             std::string result;
-            result.reserve(bytes.size());
+            result.reserve(size);
             
-            for (size_t i = 0; i < bytes.size(); ) {
+            for (size_t i = 0; i < size; ) {
                 uint32_t b1 = bytes[i++];
                 
                 if ((b1 & 0x80) == 0) {  // 1字节ASCII字符
                     result += static_cast<char>(b1);
                 }
                 else if ((b1 & 0xE0) == 0xC0) {  // 2字节序列
-                    if (i >= bytes.size()) break;  // 防止越界
+                    if (i >= size) break;  // 防止越界
                     uint32_t b2 = bytes[i++];
                     
                     // 检查是否为null字符的特殊表示
@@ -245,7 +349,7 @@ namespace util  // 工具类命名空间，封装通用工具函数
                     }
                 }
                 else if ((b1 & 0xF0) == 0xE0) {  // 3字节序列
-                    if (i + 1 >= bytes.size()) break;  // 防止越界
+                    if (i + 1 >= size) break;  // 防止越界
                     uint32_t b2 = bytes[i++];
                     uint32_t b3 = bytes[i++];
                     